@@ -37,8 +37,9 @@
 #include "llaudioengine.h"
 #include "lldir.h"
 #include "llendianswizzle.h"
+#include "llfile.h"
 #include "lllfsthread.h"
-#include "llrefcount.h"
+#include "llqueuedthread.h"
 #include "llstring.h"
 #include "llvfile.h"
  
@@ -48,173 +49,181 @@
 #include "vorbis/codec.h"
 #include "vorbis/vorbisfile.h"
 
+#include <list>
+#include <map>
+
 extern LLAudioEngine *gAudiop;
 
 LLAudioDecodeMgr *gAudioDecodeMgrp = NULL;
 
+static void decoded_sound_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	if (gAudioDecodeMgrp)
+	{
+		const LLAudioDecodeMgr::Stats& stats = gAudioDecodeMgrp->getStats();
+		usage.mBytes += stats.mCacheBytes;
+		usage.mCount += stats.mCacheEntries;
+	}
+}
+static LLMemoryAccount sDecodedSoundAccount("Decoded sounds", decoded_sound_memory_usage);
+
 static const S32 WAV_HEADER_SIZE = 44;
 
+// Number of worker threads decoding sounds.
+static const S32 AUDIO_DECODE_THREADS = 2;
+
+// Default limit on decoded sounds kept in memory.
+static const U32 AUDIO_DECODE_CACHE_BYTES = 32 * 1024 * 1024;
+
+// Smoothing factor for the latency averages.
+static const F32 AUDIO_DECODE_STATS_SMOOTHING = 0.1f;
+
 
 //////////////////////////////////////////////////////////////////////////////
 
 
-class LLVorbisDecodeState : public LLRefCount
+// Decodes one Ogg Vorbis sound from memory into a .wav image.  Owned by a
+// single LLAudioDecodeThread::Request, so it is only ever touched by one thread.
+class LLVorbisDecodeState
 {
 public:
-	class WriteResponder : public LLLFSThread::Responder
-	{
-	public:
-		WriteResponder(LLVorbisDecodeState* decoder) : mDecoder(decoder) {}
-		~WriteResponder() {}
-		void completed(S32 bytes)
-		{
-			mDecoder->ioComplete(bytes);
-		}
-		LLPointer<LLVorbisDecodeState> mDecoder;
-	};
-	
-	LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename);
+	LLVorbisDecodeState(const LLUUID &uuid, std::vector<U8> &vorbis_data);
+	~LLVorbisDecodeState();
 
 	BOOL initDecode();
 	BOOL decodeSection(); // Return TRUE if done.
 	BOOL finishDecode();
 
-	void flushBadFile();
-
-	void ioComplete(S32 bytes)			{ mBytesRead = bytes; }
 	BOOL isValid() const				{ return mValid; }
 	BOOL isDone() const					{ return mDone; }
 	const LLUUID &getUUID() const		{ return mUUID; }
 
-protected:
-	virtual ~LLVorbisDecodeState();
+	// Hands the finished .wav image over to the caller.
+	void takeWAVBuffer(std::vector<U8> &buffer) { buffer.swap(mWAVBuffer); }
+
+	// ov_callbacks reading from mVorbisData
+	static size_t memRead(void *ptr, size_t size, size_t nmemb, void *datasource);
+	static int memSeek(void *datasource, ogg_int64_t offset, int whence);
+	static int memClose(void *datasource);
+	static long memTell(void *datasource);
 
+protected:
 	BOOL mValid;
 	BOOL mDone;
-	LLAtomicS32 mBytesRead;
+	BOOL mOpen;
 	LLUUID mUUID;
 
+	std::vector<U8> mVorbisData;
+	size_t mReadOffset;
+
 	std::vector<U8> mWAVBuffer;
-#if !defined(USE_WAV_VFILE)
-	std::string mOutFilename;
-	LLLFSThread::handle_t mFileHandle;
-#endif
 	
-	LLVFile *mInFilep;
 	OggVorbis_File mVF;
 	S32 mCurrentSection;
 };
 
-size_t vfs_read(void *ptr, size_t size, size_t nmemb, void *datasource)
+//static
+size_t LLVorbisDecodeState::memRead(void *ptr, size_t size, size_t nmemb, void *datasource)
 {
-	LLVFile *file = (LLVFile *)datasource;
+	LLVorbisDecodeState *state = (LLVorbisDecodeState *)datasource;
 
-	if (file->read((U8*)ptr, (S32)(size * nmemb)))	/*Flawfinder: ignore*/
+	if (!size)
 	{
-		S32 read = file->getLastBytesRead();
-		return  read / size;	/*Flawfinder: ignore*/
+		return 0;
 	}
-	else
+	size_t available = state->mVorbisData.size() - state->mReadOffset;
+	size_t count = llmin(nmemb, available / size);
+	if (count)
 	{
-		return 0;
+		memcpy(ptr, &state->mVorbisData[state->mReadOffset], count * size);		/*Flawfinder: ignore*/
+		state->mReadOffset += count * size;
 	}
+	return count;
 }
 
-int vfs_seek(void *datasource, ogg_int64_t offset, int whence)
+//static
+int LLVorbisDecodeState::memSeek(void *datasource, ogg_int64_t offset, int whence)
 {
-	LLVFile *file = (LLVFile *)datasource;
+	LLVorbisDecodeState *state = (LLVorbisDecodeState *)datasource;
 
-	// vfs has 31-bit files
-	if (offset > S32_MAX)
-	{
-		return -1;
-	}
-
-	S32 origin;
+	ogg_int64_t origin;
 	switch (whence) {
 	case SEEK_SET:
 		origin = 0;
 		break;
 	case SEEK_END:
-		origin = file->getSize();
+		origin = (ogg_int64_t)state->mVorbisData.size();
 		break;
 	case SEEK_CUR:
-		origin = -1;
+		origin = (ogg_int64_t)state->mReadOffset;
 		break;
 	default:
-		llerrs << "Invalid whence argument to vfs_seek" << llendl;
+		llerrs << "Invalid whence argument to memSeek" << llendl;
 		return -1;
 	}
 
-	if (file->seek((S32)offset, origin))
-	{
-		return 0;
-	}
-	else
+	ogg_int64_t position = origin + offset;
+	if (position < 0 || position > (ogg_int64_t)state->mVorbisData.size())
 	{
 		return -1;
 	}
+	state->mReadOffset = (size_t)position;
+	return 0;
 }
 
-int vfs_close (void *datasource)
+//static
+int LLVorbisDecodeState::memClose(void *datasource)
 {
-	LLVFile *file = (LLVFile *)datasource;
-	delete file;
+	// The data belongs to the decode state, nothing to do.
 	return 0;
 }
 
-long vfs_tell (void *datasource)
+//static
+long LLVorbisDecodeState::memTell(void *datasource)
 {
-	LLVFile *file = (LLVFile *)datasource;
-	return file->tell();
+	LLVorbisDecodeState *state = (LLVorbisDecodeState *)datasource;
+	return (long)state->mReadOffset;
 }
 
-LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, const std::string &out_filename)
+LLVorbisDecodeState::LLVorbisDecodeState(const LLUUID &uuid, std::vector<U8> &vorbis_data)
 {
 	mDone = FALSE;
 	mValid = FALSE;
-	mBytesRead = -1;
+	mOpen = FALSE;
 	mUUID = uuid;
-	mInFilep = NULL;
+	mVorbisData.swap(vorbis_data);
+	mReadOffset = 0;
 	mCurrentSection = 0;
-#if !defined(USE_WAV_VFILE)
-	mOutFilename = out_filename;
-	mFileHandle = LLLFSThread::nullHandle();
-#endif
 	// No default value for mVF, it's an ogg structure?
 }
 
 LLVorbisDecodeState::~LLVorbisDecodeState()
 {
-	if (!mDone)
+	if (mOpen)
 	{
-		delete mInFilep;
-		mInFilep = NULL;
+		ov_clear(&mVF);
 	}
 }
 
 
 BOOL LLVorbisDecodeState::initDecode()
 {
-	ov_callbacks vfs_callbacks;
-	vfs_callbacks.read_func = vfs_read;
-	vfs_callbacks.seek_func = vfs_seek;
-	vfs_callbacks.close_func = vfs_close;
-	vfs_callbacks.tell_func = vfs_tell;
+	ov_callbacks mem_callbacks;
+	mem_callbacks.read_func = memRead;
+	mem_callbacks.seek_func = memSeek;
+	mem_callbacks.close_func = memClose;
+	mem_callbacks.tell_func = memTell;
 
-	//llinfos << "Initing decode from vfile: " << mUUID << llendl;
+	//llinfos << "Initing decode for: " << mUUID << llendl;
 
-	mInFilep = new LLVFile(gVFS, mUUID, LLAssetType::AT_SOUND);
-	if (!mInFilep || !mInFilep->getSize())
+	if (mVorbisData.empty())
 	{
-		LL_WARNS("Audio") << "unable to open vorbis source vfile for reading"
+		LL_WARNS("Audio") << "No vorbis source data to decode for " << mUUID
 						  << LL_ENDL;
-		delete mInFilep;
-		mInFilep = NULL;
 		return FALSE;
 	}
 
-	int r = ov_open_callbacks(mInFilep, &mVF, NULL, 0, vfs_callbacks);
+	int r = ov_open_callbacks(this, &mVF, NULL, 0, mem_callbacks);
 	if (r < 0) 
 	{
 		LL_WARNS("Audio") << r
@@ -222,6 +231,7 @@ BOOL LLVorbisDecodeState::initDecode()
 						  << mUUID << LL_ENDL;
 		return(FALSE);
 	}
+	mOpen = TRUE;
 	
 	S32 sample_count = ov_pcm_total(&mVF, -1);
 	size_t size_guess = (size_t)sample_count;
@@ -275,8 +285,6 @@ BOOL LLVorbisDecodeState::initDecode()
 		{
 			LL_WARNS("Audio") <<  "Bad asset encoded by: " << comment->vendor << LL_ENDL;
 		}
-		delete mInFilep;
-		mInFilep = NULL;
 		return FALSE;
 	}
 
@@ -288,11 +296,6 @@ BOOL LLVorbisDecodeState::initDecode()
 	catch(std::bad_alloc)
 	{
 		llwarns << "bad_alloc" << llendl;
-		if(mInFilep)
-		{
-			delete mInFilep;
-			mInFilep = NULL;
-		}
 		return FALSE;
 	};
 
@@ -385,9 +388,9 @@ BOOL LLVorbisDecodeState::initDecode()
 
 BOOL LLVorbisDecodeState::decodeSection()
 {
-	if (!mInFilep)
+	if (!mOpen)
 	{
-		LL_WARNS("Audio") << "No VFS file to decode in vorbis!" << LL_ENDL;
+		LL_WARNS("Audio") << "No vorbis stream to decode!" << LL_ENDL;
 		return TRUE;
 	}
 	if (mDone)
@@ -438,12 +441,13 @@ BOOL LLVorbisDecodeState::finishDecode()
 		return TRUE; // We've finished
 	}
 
-#if !defined(USE_WAV_VFILE)
-	if (mFileHandle == LLLFSThread::nullHandle())
-#endif
 	{
-		ov_clear(&mVF);
-  
+		if (mOpen)
+		{
+			ov_clear(&mVF);
+			mOpen = FALSE;
+		}
+
 		// write "data" chunk length, in little-endian format
 		S32 data_length = mWAVBuffer.size() - WAV_HEADER_SIZE;
 		mWAVBuffer[40] = (data_length) & 0x000000FF;
@@ -513,197 +517,478 @@ BOOL LLVorbisDecodeState::finishDecode()
 			mValid = FALSE;
 			return TRUE; // we've finished
 		}
-#if !defined(USE_WAV_VFILE)
-		mBytesRead = -1;
-		mFileHandle = LLLFSThread::sLocal->write(mOutFilename, &mWAVBuffer[0], 0, mWAVBuffer.size(),
-							 new WriteResponder(this));
-#endif
 	}
+	
+	mDone = TRUE;
+
+	//llinfos << "Finished decode for " << getUUID() << llendl;
+
+	return TRUE;
+}
 
-	if (mFileHandle != LLLFSThread::nullHandle())
+//////////////////////////////////////////////////////////////////////////////
+
+// Decodes sounds off the main thread.  Finished decodes are collected in a
+// result list that LLAudioDecodeMgr drains from processQueue().
+class LLAudioDecodeThread : public LLQueuedThread
+{
+public:
+	struct Result
 	{
-		if (mBytesRead >= 0)
+		LLUUID mUUID;
+		LLPointer<LLAudioDecodedData> mData;	// NULL if the decode failed
+		F32 mDecodeTime;
+	};
+
+	class Request : public LLQueuedThread::QueuedRequest
+	{
+	protected:
+		virtual ~Request() {} // use deleteRequest()
+
+	public:
+		Request(handle_t handle, LLAudioDecodeThread* thread,
+				const LLUUID& uuid, std::vector<U8>& vorbis_data);
+
+		/*virtual*/ bool processRequest();
+		/*virtual*/ void finishRequest(bool completed);
+
+	private:
+		LLAudioDecodeThread* mThread;
+		LLVorbisDecodeState mDecoder;
+		LLPointer<LLAudioDecodedData> mData;
+		F32 mDecodeTime;
+	};
+
+public:
+	LLAudioDecodeThread();
+
+	// Takes ownership of the contents of vorbis_data.
+	handle_t decode(const LLUUID& uuid, std::vector<U8>& vorbis_data);
+
+	// Appends the decodes finished since the last call.
+	void getResults(std::vector<Result>& results);
+
+private:
+	void addResult(const Result& result);
+
+	typedef std::vector<Result> result_list_t;
+	result_list_t mResults;
+	LLMutex mResultMutex;
+};
+
+LLAudioDecodeThread::Request::Request(handle_t handle, LLAudioDecodeThread* thread,
+									  const LLUUID& uuid, std::vector<U8>& vorbis_data)
+	: LLQueuedThread::QueuedRequest(handle, LLQueuedThread::PRIORITY_NORMAL, FLAG_AUTO_COMPLETE),
+	  mThread(thread),
+	  mDecoder(uuid, vorbis_data),
+	  mDecodeTime(0.f)
+{
+}
+
+// Called from LLAudioDecodeThread
+bool LLAudioDecodeThread::Request::processRequest()
+{
+	LLTimer decode_timer;
+	try
+	{
+		if (mDecoder.initDecode())
 		{
-			if (mBytesRead == 0)
+			while (!mDecoder.decodeSection())
 			{
-				LL_WARNS("Audio") << "Unable to write file in LLVorbisDecodeState::finishDecode"
-								  << LL_ENDL;
-				mValid = FALSE;
-				return TRUE; // we've finished
+				// decodeSection does all of the work
 			}
-		}
-		else
-		{
-			return FALSE; // not done
+			mDecoder.finishDecode();
 		}
 	}
-	
-	mDone = TRUE;
+	catch(std::bad_alloc)
+	{
+		llwarns << "bad_alloc whilst decoding " << mDecoder.getUUID() << llendl;
+		return true;
+	}
 
-#if defined(USE_WAV_VFILE)
-	// write the data.
-	LLVFile output(gVFS, mUUID, LLAssetType::AT_SOUND_WAV);
-	output.write(&mWAVBuffer[0], mWAVBuffer.size());
-#endif
-	//llinfos << "Finished decode for " << getUUID() << llendl;
+	if (mDecoder.isValid() && mDecoder.isDone())
+	{
+		mData = new LLAudioDecodedData;
+		mDecoder.takeWAVBuffer(mData->mWAVBuffer);
+	}
+	mDecodeTime = decode_timer.getElapsedTimeF32();
+	return true;
+}
 
-	return TRUE;
+// Called from LLAudioDecodeThread
+void LLAudioDecodeThread::Request::finishRequest(bool completed)
+{
+	Result result;
+	result.mUUID = mDecoder.getUUID();
+	if (completed)
+	{
+		result.mData = mData;
+	}
+	result.mDecodeTime = mDecodeTime;
+	mThread->addResult(result);
+}
+
+LLAudioDecodeThread::LLAudioDecodeThread()
+	: LLQueuedThread("audiodecode")
+{
+}
+
+LLQueuedThread::handle_t LLAudioDecodeThread::decode(const LLUUID& uuid, std::vector<U8>& vorbis_data)
+{
+	handle_t handle = generateHandle();
+	addRequest(new Request(handle, this, uuid, vorbis_data));
+	return handle;
+}
+
+void LLAudioDecodeThread::addResult(const Result& result)
+{
+	LLMutexLock lock(&mResultMutex);
+	mResults.push_back(result);
+}
+
+void LLAudioDecodeThread::getResults(std::vector<Result>& results)
+{
+	LLMutexLock lock(&mResultMutex);
+	results.insert(results.end(), mResults.begin(), mResults.end());
+	mResults.clear();
 }
 
-void LLVorbisDecodeState::flushBadFile()
+//////////////////////////////////////////////////////////////////////////////
+
+// Keeps the decoded file alive until the disk write has finished.
+class LLAudioDecodeWriteResponder : public LLLFSThread::Responder
 {
-	if (mInFilep)
+public:
+	LLAudioDecodeWriteResponder(const LLUUID& uuid, LLAudioDecodedData* data)
+		: mUUID(uuid), mData(data) {}
+	void completed(S32 bytes)
 	{
-		LL_WARNS("Audio") << "Flushing bad vorbis file from VFS for "
-						  << mUUID << LL_ENDL;
-		mInFilep->remove();
+		if (bytes <= 0)
+		{
+			LL_WARNS("Audio") << "Unable to write decoded file for " << mUUID << LL_ENDL;
+		}
 	}
+
+private:
+	LLUUID mUUID;
+	LLPointer<LLAudioDecodedData> mData;
+};
+
+static std::string get_decoded_filename(const LLUUID& uuid)
+{
+	std::string uuid_str;
+	uuid.toString(uuid_str);
+	//return gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
+	if(gDirUtilp->mm_usesnd()) //::MODMOD::
+		return gDirUtilp->getExpandedFilename(MM_SNDLOC,uuid_str) + ".dsf";
+	else
+		return gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
+LLAudioDecodeMgr::Stats::Stats()
+	: mCacheHits(0),
+	  mCacheMisses(0),
+	  mCacheEntries(0),
+	  mCacheBytes(0),
+	  mDecodes(0),
+	  mFailedDecodes(0),
+	  mPending(0),
+	  mAverageLatency(0.f),
+	  mMaxLatency(0.f),
+	  mAverageDecodeTime(0.f)
+{
+}
+
 class LLAudioDecodeMgr::Impl
 {
 	friend class LLAudioDecodeMgr;
 public:
-	Impl() {};
-	~Impl() {};
+	Impl();
+	~Impl();
 
 	void processQueue(const F32 num_secs = 0.005);
 
+	LLPointer<LLAudioDecodedData> getDecodedData(const LLUUID &uuid);
+	void setCacheSize(U32 max_bytes);
+
+protected:
+	void handleResult(const LLAudioDecodeThread::Result& result);
+	void markBadAsset(const LLUUID& uuid);
+	bool startDecode(const LLUUID& uuid);
+
+	void addToCache(const LLUUID& uuid, LLAudioDecodedData* data);
+	void trimCache();
+
 protected:
 	LLLinkedQueue<LLUUID> mDecodeQueue;
-	LLPointer<LLVorbisDecodeState> mCurrentDecodep;
 	std::set<LLUUID> mBadAssetList;
+
+	std::vector<LLAudioDecodeThread*> mThreads;
+	std::vector<LLAudioDecodeThread::Result> mResults;
+
+	// Sounds handed to a worker, with the time they were requested.
+	typedef std::map<LLUUID, F64> in_flight_map_t;
+	in_flight_map_t mInFlight;
+
+	// LRU cache of decoded sounds, most recently used at the front.
+	typedef std::list<LLUUID> lru_list_t;
+	struct CacheEntry
+	{
+		LLPointer<LLAudioDecodedData> mData;
+		lru_list_t::iterator mLRUIter;
+	};
+	typedef std::map<LLUUID, CacheEntry> cache_map_t;
+	cache_map_t mCache;
+	lru_list_t mLRU;
+	U32 mCacheMaxBytes;
+
+	LLAudioDecodeMgr::Stats mStats;
 };
 
+LLAudioDecodeMgr::Impl::Impl()
+	: mCacheMaxBytes(AUDIO_DECODE_CACHE_BYTES)
+{
+	for (S32 i = 0; i < AUDIO_DECODE_THREADS; ++i)
+	{
+		mThreads.push_back(new LLAudioDecodeThread);
+	}
+}
+
+LLAudioDecodeMgr::Impl::~Impl()
+{
+	for (std::vector<LLAudioDecodeThread*>::iterator iter = mThreads.begin();
+		 iter != mThreads.end(); ++iter)
+	{
+		delete *iter; // shuts the thread down
+	}
+	mThreads.clear();
+}
 
-void LLAudioDecodeMgr::Impl::processQueue(const F32 num_secs)
+void LLAudioDecodeMgr::Impl::markBadAsset(const LLUUID& uuid)
+{
+	LL_WARNS("Audio") << uuid << " has invalid vorbis data, aborting decode"
+					  << LL_ENDL;
+	LL_WARNS("Audio") << "Flushing bad vorbis file from VFS for " << uuid << LL_ENDL;
+	LLVFile file(gVFS, uuid, LLAssetType::AT_SOUND);
+	file.remove();
+	LLAudioData *adp = gAudiop->getAudioData(uuid);
+	adp->setHasValidData(FALSE);
+	mBadAssetList.insert(uuid);
+	mStats.mFailedDecodes++;
+}
+
+bool LLAudioDecodeMgr::Impl::startDecode(const LLUUID& uuid)
+{
+	// Read the whole sound on the main thread, the VFS isn't safe to use from
+	// the decode threads.
+	std::vector<U8> vorbis_data;
+	{
+		LLVFile file(gVFS, uuid, LLAssetType::AT_SOUND);
+		S32 size = file.getSize();
+		if (size <= 0)
+		{
+			return false;
+		}
+		vorbis_data.resize(size);
+		if (!file.read(&vorbis_data[0], size) || file.getLastBytesRead() != size)	/*Flawfinder: ignore*/
+		{
+			return false;
+		}
+	}
+
+	// Give it to the least busy worker.
+	LLAudioDecodeThread* thread = NULL;
+	S32 min_pending = 0;
+	for (std::vector<LLAudioDecodeThread*>::iterator iter = mThreads.begin();
+		 iter != mThreads.end(); ++iter)
+	{
+		S32 pending = (*iter)->getPending();
+		if (!thread || pending < min_pending)
+		{
+			thread = *iter;
+			min_pending = pending;
+		}
+	}
+	thread->decode(uuid, vorbis_data);
+	return true;
+}
+
+void LLAudioDecodeMgr::Impl::handleResult(const LLAudioDecodeThread::Result& result)
 {
-	LLUUID uuid;
+	F64 start_time = LLTimer::getTotalSeconds();
+	in_flight_map_t::iterator iter = mInFlight.find(result.mUUID);
+	if (iter != mInFlight.end())
+	{
+		start_time = iter->second;
+		mInFlight.erase(iter);
+	}
+
+	if (result.mData.isNull())
+	{
+		markBadAsset(result.mUUID);
+		return;
+	}
+
+	mStats.mDecodes++;
+	F32 latency = (F32)(LLTimer::getTotalSeconds() - start_time);
+	mStats.mAverageLatency = lerp(mStats.mAverageLatency, latency, AUDIO_DECODE_STATS_SMOOTHING);
+	mStats.mMaxLatency = llmax(mStats.mMaxLatency, latency);
+	mStats.mAverageDecodeTime = lerp(mStats.mAverageDecodeTime, result.mDecodeTime, AUDIO_DECODE_STATS_SMOOTHING);
+
+	LLAudioDecodedData* data = result.mData;
+	addToCache(result.mUUID, data);
 
+	// Keep the decoded file on disk too, so the next session doesn't need
+	// to decode it again.
+#if defined(USE_WAV_VFILE)
+	LLVFile output(gVFS, result.mUUID, LLAssetType::AT_SOUND_WAV);
+	output.write(&data->mWAVBuffer[0], data->mWAVBuffer.size());
+#else
+	LLLFSThread::sLocal->write(get_decoded_filename(result.mUUID),
+							   &data->mWAVBuffer[0], 0, data->mWAVBuffer.size(),
+							   new LLAudioDecodeWriteResponder(result.mUUID, data));
+#endif
+
+	LLAudioData *adp = gAudiop->getAudioData(result.mUUID);
+	adp->setHasDecodedData(TRUE);
+	adp->setHasValidData(TRUE);
+
+	// At this point, we could see if anyone needs this sound immediately, but
+	// I'm not sure that there's a reason to - we need to poll all of the playing
+	// sounds anyway.
+}
+
+void LLAudioDecodeMgr::Impl::processQueue(const F32 num_secs)
+{
 	LLTimer decode_timer;
 
-	BOOL done = FALSE;
-	while (!done)
+	// Collect the finished decodes.
+	for (std::vector<LLAudioDecodeThread*>::iterator iter = mThreads.begin();
+		 iter != mThreads.end(); ++iter)
 	{
-		if (mCurrentDecodep)
+		(*iter)->update(0);
+		(*iter)->getResults(mResults);
+	}
+	for (std::vector<LLAudioDecodeThread::Result>::iterator iter = mResults.begin();
+		 iter != mResults.end(); ++iter)
+	{
+		handleResult(*iter);
+	}
+	mResults.clear();
+
+	// Hand queued sounds to the workers.  Reading the source file is the only
+	// work done here, so always start at least one.
+	while (mDecodeQueue.getLength())
+	{
+		LLUUID uuid;
+		mDecodeQueue.pop(uuid);
+		if (mInFlight.count(uuid) || mCache.count(uuid) || gAudiop->hasDecodedFile(uuid))
 		{
-			BOOL res = false;
+			// This file has already been decoded, don't decode it again.
+			continue;
+		}
 
-			// Decode in a loop until we're done or have run out of time.
-			try
-			{
-				while (!(res = mCurrentDecodep->decodeSection()) &&
-					   decode_timer.getElapsedTimeF32() < num_secs)
-				{
-					// decodeSection does all of the work above
-				}
-			}
-			catch(std::bad_alloc)
-			{
-				llerrs<<"bad_alloc whilst decoding"<<llendl;
-			}
+		LL_DEBUGS("Audio") << "Decoding " << uuid
+						   << " from audio queue !" << LL_ENDL;
 
-			if (mCurrentDecodep->isDone() && !mCurrentDecodep->isValid())
-			{
-				// We had an error when decoding, abort.
-				LLUUID asset_id = mCurrentDecodep->getUUID();
-				LL_WARNS("Audio") << asset_id
-								  << " has invalid vorbis data, aborting decode"
-								  << LL_ENDL;
-				mCurrentDecodep->flushBadFile();
-				LLAudioData *adp = gAudiop->getAudioData(asset_id);
-				adp->setHasValidData(FALSE);
-				mBadAssetList.insert(asset_id);
-				mCurrentDecodep = NULL;
-				done = TRUE;
-			}
+		if (startDecode(uuid))
+		{
+			mInFlight[uuid] = LLTimer::getTotalSeconds();
+		}
+		else
+		{
+			markBadAsset(uuid);
+		}
 
-			if (!res)
-			{
-				// We've used up out time slice, bail...
-				done = TRUE;
-			}
-			else if (mCurrentDecodep)
-			{
-				if (mCurrentDecodep->finishDecode())
-				{
-					// We finished!
-					if (mCurrentDecodep->isValid() && mCurrentDecodep->isDone())
-					{
-						LLAudioData *adp = gAudiop->getAudioData(mCurrentDecodep->getUUID());
-						adp->setHasDecodedData(TRUE);
-						adp->setHasValidData(TRUE);
-
-						// At this point, we could see if anyone needs this sound immediately, but
-						// I'm not sure that there's a reason to - we need to poll all of the playing
-						// sounds anyway.
-						//llinfos << "Finished the vorbis decode, now what?" << llendl;
-					}
-					else
-					{
-						llinfos << "Vorbis decode failed!!!" << llendl;
-					}
-					mCurrentDecodep = NULL;
-				}
-				done = TRUE; // done for now
-			}
+		if (decode_timer.getElapsedTimeF32() >= num_secs)
+		{
+			break;
 		}
+	}
+
+	mStats.mPending = mDecodeQueue.getLength() + mInFlight.size();
+}
+
+void LLAudioDecodeMgr::Impl::addToCache(const LLUUID& uuid, LLAudioDecodedData* data)
+{
+	cache_map_t::iterator iter = mCache.find(uuid);
+	if (iter != mCache.end())
+	{
+		mStats.mCacheBytes -= iter->second.mData->mWAVBuffer.size();
+		mLRU.erase(iter->second.mLRUIter);
+		mCache.erase(iter);
+	}
+
+	CacheEntry& entry = mCache[uuid];
+	entry.mData = data;
+	entry.mLRUIter = mLRU.insert(mLRU.begin(), uuid);
+	mStats.mCacheBytes += data->mWAVBuffer.size();
+	trimCache();
+}
+
+void LLAudioDecodeMgr::Impl::trimCache()
+{
+	// Always keep the most recent entry, even when it alone is over budget.
+	while (mStats.mCacheBytes > mCacheMaxBytes && mLRU.size() > 1)
+	{
+		cache_map_t::iterator iter = mCache.find(mLRU.back());
+		mStats.mCacheBytes -= iter->second.mData->mWAVBuffer.size();
+		mCache.erase(iter);
+		mLRU.pop_back();
+	}
+	mStats.mCacheEntries = mCache.size();
+}
+
+void LLAudioDecodeMgr::Impl::setCacheSize(U32 max_bytes)
+{
+	mCacheMaxBytes = max_bytes;
+	trimCache();
+}
+
+LLPointer<LLAudioDecodedData> LLAudioDecodeMgr::Impl::getDecodedData(const LLUUID &uuid)
+{
+	cache_map_t::iterator iter = mCache.find(uuid);
+	if (iter != mCache.end())
+	{
+		mStats.mCacheHits++;
+		mLRU.splice(mLRU.begin(), mLRU, iter->second.mLRUIter);
+		return iter->second.mData;
+	}
 
-		if (!done)
+	mStats.mCacheMisses++;
+
+	// Not in memory, try the decoded file from an earlier session.
+	std::string filename = get_decoded_filename(uuid);
+	LLFILE* fp = LLFile::fopen(filename, "rb");		/*Flawfinder: ignore*/
+	if (!fp)
+	{
+		return NULL;
+	}
+
+	LLPointer<LLAudioDecodedData> data = new LLAudioDecodedData;
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (size > WAV_HEADER_SIZE)
+	{
+		data->mWAVBuffer.resize(size);
+		if (fread(&data->mWAVBuffer[0], 1, size, fp) != (size_t)size)
 		{
-			if (!mDecodeQueue.getLength())
-			{
-				// Nothing else on the queue.
-				done = TRUE;
-			}
-			else
-			{
-				LLUUID uuid;
-				mDecodeQueue.pop(uuid);
-				if (gAudiop->hasDecodedFile(uuid))
-				{
-					// This file has already been decoded, don't decode it again.
-					done = TRUE;
-					continue;
-				}
-
-				LL_DEBUGS("Audio") << "Decoding " << uuid
-								   << " from audio queue !" << LL_ENDL;
-
-				std::string uuid_str;
-				std::string d_path;
-
-				LLTimer timer;
-				timer.reset();
-
-				uuid.toString(uuid_str);
-				//d_path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
-                if(gDirUtilp->mm_usesnd()) //::MODMOD::
-                    d_path = gDirUtilp->getExpandedFilename(MM_SNDLOC,uuid_str) + ".dsf";
-                else
-					d_path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,uuid_str) + ".dsf";
-				
-
-				mCurrentDecodep = new LLVorbisDecodeState(uuid, d_path);
-				if (!mCurrentDecodep->initDecode())
-				{
-					// We had an error when decoding, abort.
-					LLUUID asset_id = mCurrentDecodep->getUUID();
-					LL_WARNS("Audio") << asset_id
-									  << " has invalid vorbis data, aborting decode"
-									  << LL_ENDL;
-					mCurrentDecodep->flushBadFile();
-					LLAudioData *adp = gAudiop->getAudioData(asset_id);
-					adp->setHasValidData(FALSE);
-					mBadAssetList.insert(asset_id);
-					mCurrentDecodep = NULL;
-					done = TRUE;
-				}
-			}
+			data->mWAVBuffer.clear();
 		}
 	}
+	fclose(fp);
+
+	if (data->mWAVBuffer.empty())
+	{
+		LL_WARNS("Audio") << "Unable to read decoded file " << filename << LL_ENDL;
+		return NULL;
+	}
+
+	addToCache(uuid, data);
+	return data;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -731,6 +1016,12 @@ BOOL LLAudioDecodeMgr::addDecodeRequest(const LLUUID &uuid)
 		return FALSE;
 	}
 
+	if (mImpl->mCache.count(uuid) || mImpl->mInFlight.count(uuid))
+	{
+		// Already decoded or being decoded.
+		return TRUE;
+	}
+
 	if (gAudiop->hasDecodedFile(uuid))
 	{
 		// Already have a decoded version, don't need to decode it.
@@ -747,4 +1038,17 @@ BOOL LLAudioDecodeMgr::addDecodeRequest(const LLUUID &uuid)
 	return FALSE;
 }
 
+LLPointer<LLAudioDecodedData> LLAudioDecodeMgr::getDecodedData(const LLUUID &uuid)
+{
+	return mImpl->getDecodedData(uuid);
+}
 
+void LLAudioDecodeMgr::setCacheSize(U32 max_bytes)
+{
+	mImpl->setCacheSize(max_bytes);
+}
+
+const LLAudioDecodeMgr::Stats& LLAudioDecodeMgr::getStats() const
+{
+	return mImpl->mStats;
+}
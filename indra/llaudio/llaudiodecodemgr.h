@@ -30,7 +30,7 @@
  */
 
 #ifndef LL_LLAUDIODECODEMGR_H
-#define LL_LLAUDIODECODEMG_H
+#define LL_LLAUDIODECODEMGR_H
 
 #include "stdtypes.h"
 
@@ -39,20 +39,58 @@
 
 #include "llassettype.h"
 #include "llframetimer.h"
+#include "llpointer.h"
+#include "llthread.h"
 #include <iterator> 
+#include <vector>
 
 class LLVFS;
 class LLVorbisDecodeState;
 
+// A decoded sound, as a complete in-memory .wav image ready to hand to an audio buffer.
+class LLAudioDecodedData : public LLThreadSafeRefCount
+{
+public:
+	std::vector<U8> mWAVBuffer;
+
+protected:
+	~LLAudioDecodedData() {}
+};
+
 class LLAudioDecodeMgr
 {
 public:
+	struct Stats
+	{
+		Stats();
+
+		U32 mCacheHits;
+		U32 mCacheMisses;
+		U32 mCacheEntries;
+		U32 mCacheBytes;
+		U32 mDecodes;
+		U32 mFailedDecodes;
+		S32 mPending;				// queued or being decoded
+		F32 mAverageLatency;		// seconds from request to decoded data, exponentially smoothed
+		F32 mMaxLatency;
+		F32 mAverageDecodeTime;		// seconds spent decoding on a worker, exponentially smoothed
+	};
+
 	LLAudioDecodeMgr();
 	~LLAudioDecodeMgr();
 
 	void processQueue(const F32 num_secs = 0.005);
 	BOOL addDecodeRequest(const LLUUID &uuid);
 	void addAudioRequest(const LLUUID &uuid);
+
+	// Returns the decoded sound from the in-memory cache, reading the decoded
+	// file back from disk on a miss.  Returns NULL if it hasn't been decoded.
+	LLPointer<LLAudioDecodedData> getDecodedData(const LLUUID &uuid);
+
+	// Limit on the decoded sounds kept in memory, in bytes.
+	void setCacheSize(U32 max_bytes);
+
+	const Stats& getStats() const;
 	
 protected:
 	class Impl;
@@ -51,6 +51,15 @@ extern void request_sound(const LLUUID &sound_guid);
 
 LLAudioEngine* gAudiop = NULL;
 
+static void sound_buffer_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	if (gAudiop)
+	{
+		gAudiop->getBufferMemoryUsage(usage);
+	}
+}
+static LLMemoryAccount sSoundBufferAccount("Sound buffers", sound_buffer_memory_usage);
+
 int LLAudioSource::gSoundHistoryPruneCounter;
 
 //
@@ -679,6 +688,19 @@ void LLAudioEngine::cleanupBuffer(LLAudioBuffer *bufferp)
 	}
 }
 
+void LLAudioEngine::getBufferMemoryUsage(LLMemoryAccount::Usage& usage)
+{
+	for (S32 i = 0; i < MAX_BUFFERS; i++)
+	{
+		if (mBuffers[i])
+		{
+			// Lengths are in 16 bit samples
+			usage.mBytes += (S64)mBuffers[i]->getLength() * 2;
+			usage.mCount++;
+		}
+	}
+}
+
 
 bool LLAudioEngine::preloadSound(const LLUUID &uuid)
 {
@@ -1892,6 +1914,19 @@ bool LLAudioData::load()
 		return false;
 	}
 
+	// Prefer the decoded sound already in memory; this also reads the
+	// decoded file from disk into the decode manager's cache on a miss.
+	if (gAudioDecodeMgrp)
+	{
+		LLPointer<LLAudioDecodedData> decoded = gAudioDecodeMgrp->getDecodedData(mID);
+		if (decoded.notNull() &&
+			mBufferp->loadWAVData(&decoded->mWAVBuffer[0], decoded->mWAVBuffer.size()))
+		{
+			mBufferp->mAudioDatap = this;
+			return true;
+		}
+	}
+
 	std::string uuid_str;
 	std::string wav_path;
 	mID.toString(uuid_str);
@@ -43,6 +43,7 @@
 #include "lluuid.h"
 #include "llframetimer.h"
 #include "llassettype.h"
+#include "llmemoryaccount.h"
 
 #include "lllistener.h"
 
@@ -173,6 +174,8 @@ public:
 	LLAudioBuffer *getFreeBuffer(); // Get a free buffer, or flush an existing one if you have to.
 	LLAudioChannel *getFreeChannel(const F32 priority); // Get a free channel or flush an existing one if your priority is higher
 	void cleanupBuffer(LLAudioBuffer *bufferp);
+	// Sample data held in sound buffers, one count per loaded buffer
+	void getBufferMemoryUsage(LLMemoryAccount::Usage& usage);
 
 	bool hasDecodedFile(const LLUUID &uuid);
 	bool hasLocalFile(const LLUUID &uuid);
@@ -452,6 +455,8 @@ class LLAudioBuffer
 public:
 	virtual ~LLAudioBuffer() {};
 	virtual bool loadWAV(const std::string& filename) = 0;
+	// Loads an in-memory .wav image, as produced by LLAudioDecodeMgr.
+	virtual bool loadWAVData(const U8* data, U32 size) = 0;
 	virtual U32 getLength() = 0;
 
 	friend class LLAudioEngine;
@@ -778,6 +778,33 @@ bool LLAudioBufferFMOD::loadWAV(const std::string& filename)
 	return true;
 }
 
+bool LLAudioBufferFMOD::loadWAVData(const U8* data, U32 size)
+{
+	if (!data || !size)
+	{
+		return false;
+	}
+
+	if (mSamplep)
+	{
+		// If there's already something loaded in this buffer, clean it up.
+		FMOD_API(FSOUND_Sample_Free)(mSamplep);
+		mSamplep = NULL;
+	}
+
+	// FMOD copies the data into the sample.
+	unsigned int mode_flags = FSOUND_LOOP_NORMAL | FSOUND_LOADMEMORY;
+	mSamplep = FMOD_API(FSOUND_Sample_Load)(FSOUND_UNMANAGED, (const char*)data, mode_flags, 0, size);
+	if (!mSamplep)
+	{
+		llwarns << "Could not load " << size << " bytes of decoded data: "
+				<< FMOD_ErrorString(FMOD_API(FSOUND_GetError)()) << llendl;
+		return false;
+	}
+
+	return true;
+}
+
 
 U32 LLAudioBufferFMOD::getLength()
 {
@@ -125,6 +125,7 @@ public:
 	virtual ~LLAudioBufferFMOD();
 
 	/*virtual*/ bool loadWAV(const std::string& filename);
+	/*virtual*/ bool loadWAVData(const U8* data, U32 size);
 	/*virtual*/ U32 getLength();
 	friend class LLAudioChannelFMOD;
 
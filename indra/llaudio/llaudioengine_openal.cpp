@@ -379,6 +379,27 @@ bool LLAudioBufferOpenAL::loadWAV(const std::string& filename)
 	return true;
 }
 
+bool LLAudioBufferOpenAL::loadWAVData(const U8* data, U32 size)
+{
+	if (!data || !size)
+	{
+		return false;
+	}
+
+	cleanup();
+	mALBuffer = alutCreateBufferFromFileImage(data, size);
+	if(mALBuffer == AL_NONE)
+	{
+		ALenum error = alutGetError(); 
+		llwarns <<
+			"LLAudioBufferOpenAL::loadWAVData() Error loading "
+			<< size << " bytes: " << alutGetErrorString(error) << llendl;
+		return false;
+	}
+
+	return true;
+}
+
 U32 LLAudioBufferOpenAL::getLength()
 {
 	if(mALBuffer == AL_NONE)
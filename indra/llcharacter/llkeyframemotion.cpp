@@ -126,6 +126,32 @@ U32 LLKeyframeMotion::JointMotionList::dumpDiagInfo()
 	return total_size;
 }
 
+U32 LLKeyframeMotion::JointMotionList::getSize() const
+{
+	U32 total_size = sizeof(JointMotionList);
+
+	for (U32 i = 0; i < getNumJointMotions(); i++)
+	{
+		LLKeyframeMotion::JointMotion* joint_motion_p = mJointMotionArray[i];
+
+		total_size += sizeof(JointMotion);
+		if (joint_motion_p->mUsage & LLJointState::SCALE)
+		{
+			total_size += joint_motion_p->mScaleCurve.mNumKeys * sizeof(ScaleKey);
+		}
+		if (joint_motion_p->mUsage & LLJointState::ROT)
+		{
+			total_size += joint_motion_p->mRotationCurve.mNumKeys * sizeof(RotationKey);
+		}
+		if (joint_motion_p->mUsage & LLJointState::POS)
+		{
+			total_size += joint_motion_p->mPositionCurve.mNumKeys * sizeof(PositionKey);
+		}
+	}
+
+	return total_size;
+}
+
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 // ****Curve classes
@@ -2234,6 +2260,22 @@ void LLKeyframeDataCache::dumpDiagInfo()
 }
 
 
+//--------------------------------------------------------------------
+// LLKeyframeDataCache::getMemoryUsage()
+//--------------------------------------------------------------------
+void LLKeyframeDataCache::getMemoryUsage(LLMemoryAccount::Usage& usage)
+{
+	for (keyframe_data_map_t::iterator map_it = sKeyframeDataMap.begin();
+		 map_it != sKeyframeDataMap.end(); ++map_it)
+	{
+		usage.mBytes += map_it->second->getSize();
+	}
+	usage.mBytes += LLMemoryAccount::nodeBytes(sKeyframeDataMap.size(), sizeof(keyframe_data_map_t::value_type));
+	usage.mCount += sKeyframeDataMap.size();
+}
+
+static LLMemoryAccount sKeyframeDataAccount("Keyframe data cache", LLKeyframeDataCache::getMemoryUsage);
+
 //--------------------------------------------------------------------
 // LLKeyframeDataCache::addKeyframeData()
 //--------------------------------------------------------------------
@@ -49,6 +49,7 @@
 #include "v3math.h"
 #include "llapr.h"
 #include "llbvhconsts.h"
+#include "llmemoryaccount.h"
 
 class LLKeyframeDataCache;
 class LLVFS;
@@ -418,6 +419,8 @@ public:
 		JointMotionList();
 		~JointMotionList();
 		U32 dumpDiagInfo();
+		// Same total as dumpDiagInfo(), without the logging
+		U32 getSize() const;
 		JointMotion* getJointMotion(U32 index) const { llassert(index < mJointMotionArray.size()); return mJointMotionArray[index]; }
 		U32 getNumJointMotions() const { return mJointMotionArray.size(); }
 	};
@@ -458,6 +461,7 @@ public:
 
 	//print out diagnostic info
 	static void dumpDiagInfo();
+	static void getMemoryUsage(LLMemoryAccount::Usage& usage);
 	static void clear();
 };
 
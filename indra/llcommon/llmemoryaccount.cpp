@@ -0,0 +1,96 @@
+/**
+ * @file llmemoryaccount.cpp
+ * @brief Registry of memory use reported by the viewer's caches
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ *
+ * Copyright (c) 2010, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llmemoryaccount.h"
+
+#include <algorithm>
+
+namespace
+{
+	typedef std::vector<LLMemoryAccount*> account_list_t;
+
+	// Accounts are file statics all over the viewer, so the list has to
+	// exist before the first of them is constructed.
+	account_list_t& get_accounts()
+	{
+		static account_list_t accounts;
+		return accounts;
+	}
+
+	bool sample_less(const LLMemoryAccount::Sample& lhs, const LLMemoryAccount::Sample& rhs)
+	{
+		return lhs.mName < rhs.mName;
+	}
+}
+
+LLMemoryAccount::LLMemoryAccount(const std::string& name, usage_callback_t callback)
+:	mName(name),
+	mCallback(callback)
+{
+	get_accounts().push_back(this);
+}
+
+LLMemoryAccount::~LLMemoryAccount()
+{
+	account_list_t& accounts = get_accounts();
+	account_list_t::iterator iter = std::find(accounts.begin(), accounts.end(), this);
+	if (iter != accounts.end())
+	{
+		accounts.erase(iter);
+	}
+}
+
+//static
+void LLMemoryAccount::sampleAll(sample_list_t& samples)
+{
+	samples.clear();
+
+	account_list_t& accounts = get_accounts();
+	for (account_list_t::iterator iter = accounts.begin(); iter != accounts.end(); ++iter)
+	{
+		LLMemoryAccount* account = *iter;
+
+		Sample sample;
+		sample.mName = account->mName;
+		account->mCallback(sample.mUsage);
+
+		account->mPeak.mBytes = llmax(account->mPeak.mBytes, sample.mUsage.mBytes);
+		account->mPeak.mCount = llmax(account->mPeak.mCount, sample.mUsage.mCount);
+		sample.mPeak = account->mPeak;
+
+		samples.push_back(sample);
+	}
+
+	std::sort(samples.begin(), samples.end(), sample_less);
+}
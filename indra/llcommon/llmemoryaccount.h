@@ -0,0 +1,99 @@
+/**
+ * @file llmemoryaccount.h
+ * @brief Registry of memory use reported by the viewer's caches
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ *
+ * Copyright (c) 2010, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLMEMORYACCOUNT_H
+#define LL_LLMEMORYACCOUNT_H
+
+#include <string>
+#include <vector>
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLMemoryAccount
+//
+// A named source of memory use.  Subsystems declare one as a file static with
+// a function reporting what they currently hold, and every account is polled
+// whenever the accounts are sampled.  Usage is what the subsystem can see of
+// its own data, container overhead included where it is easy to estimate; it
+// does not replace LLMemType.  High-water marks are the largest values seen
+// when sampling, so they are only as good as the sampling rate.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LL_COMMON_API LLMemoryAccount
+{
+public:
+	struct Usage
+	{
+		Usage() : mBytes(0), mCount(0) {}
+
+		S64 mBytes;
+		S64 mCount;		// objects the bytes are held in
+	};
+
+	struct Sample
+	{
+		std::string mName;
+		Usage mUsage;
+		Usage mPeak;
+	};
+	typedef std::vector<Sample> sample_list_t;
+
+	// Adds to usage, only called on the main thread
+	typedef void (*usage_callback_t)(Usage& usage);
+
+	LLMemoryAccount(const std::string& name, usage_callback_t callback);
+	~LLMemoryAccount();
+
+	const std::string& getName() const { return mName; }
+
+	// Polls every account, updating the high-water marks, and returns the
+	// results sorted by name.
+	static void sampleAll(sample_list_t& samples);
+
+	// Rough size of count std::map, std::set or hash table nodes holding
+	// values of value_size bytes.
+	static S64 nodeBytes(size_t count, size_t value_size)
+	{
+		return (S64)count * (S64)(value_size + 4 * sizeof(void*));
+	}
+
+	// Bytes allocated for the characters of str
+	static S64 stringBytes(const std::string& str)
+	{
+		return (S64)str.capacity();
+	}
+
+private:
+	std::string mName;
+	usage_callback_t mCallback;
+	Usage mPeak;
+};
+
+#endif // LL_LLMEMORYACCOUNT_H
@@ -318,6 +318,13 @@ struct lluuid_less
 	}
 };
 
+// Hash for boost::unordered_map/set keyed on lluuids, found by ADL.
+// eg: 	boost::unordered_map<LLUUID, LLWidget*> widget_map;
+inline std::size_t hash_value(const LLUUID& id)
+{
+	return (std::size_t)id.getCRC32();
+}
+
 typedef std::set<LLUUID, lluuid_less> uuid_list_t;
 
 /*
@@ -4425,20 +4425,14 @@ void LLVolume::generateSilhouetteVertices(std::vector<LLVector3> &vertices,
 			LLVector4a* v = (LLVector4a*) face.mPositions;
 			LLVector4a* n = (LLVector4a*) face.mNormals;
 
+			//triangle normals only depend on the face, so they are shared
+			//by every silhouette generated from this volume
+			const LLVector4a* tri_norm = face.getTriangleNormals();
+
 			for (U32 j = 0; j < face.mNumIndices/3; j++) 
 			{
-				//approximate normal
 				S32 v1 = face.mIndices[j*3+0];
-				S32 v2 = face.mIndices[j*3+1];
-				S32 v3 = face.mIndices[j*3+2];
-
-				LLVector4a c1,c2;
-				c1.setSub(v[v1], v[v2]);
-				c2.setSub(v[v2], v[v3]);
-
-				LLVector4a norm;
-
-				norm.setCross3(c1, c2);
+				const LLVector4a& norm = tri_norm[j];
 
 				if (norm.dot3(norm) < 0.00000001f) 
 				{
@@ -5424,7 +5418,8 @@ LLVolumeFace::LLVolumeFace() :
 	mTexCoords(NULL),
 	mIndices(NULL),
 	mWeights(NULL),
-	mOctree(NULL)
+	mOctree(NULL),
+	mTriangleNormals(NULL)
 {
 	mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
 	mExtents[0].splat(-0.5f);
@@ -5447,7 +5442,8 @@ LLVolumeFace::LLVolumeFace(const LLVolumeFace& src)
 	mTexCoords(NULL),
 	mIndices(NULL),
 	mWeights(NULL),
-	mOctree(NULL)
+	mOctree(NULL),
+	mTriangleNormals(NULL)
 { 
 	mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
 	mCenter = mExtents+2;
@@ -5559,13 +5555,16 @@ void LLVolumeFace::freeData()
 
 	delete mOctree;
 	mOctree = NULL;
+
+	clearTriangleNormals();
 }
 
 BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
 {
-	//tree for this face is no longer valid
+	//tree and triangle normals for this face are no longer valid
 	delete mOctree;
 	mOctree = NULL;
+	clearTriangleNormals();
 
 	BOOL ret = FALSE ;
 	if (mTypeMask & CAP_MASK)
@@ -6007,6 +6006,8 @@ void LLVolumeFace::cacheOptimize()
 		return;
 	}
 
+	clearTriangleNormals();
+
 	//mapping of vertices to triangles and indices
 	std::vector<LLVCacheVertexData> vertex_data;
 
@@ -6257,8 +6258,58 @@ void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVe
 	}
 }
 
+const LLVector4a* LLVolumeFace::getTriangleNormals()
+{
+	if (!mTriangleNormals && mNumIndices >= 3)
+	{
+		S32 count = mNumIndices/3;
+		mTriangleNormals = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*count);
+
+		LLVector4a* v = mPositions;
+		for (S32 j = 0; j < count; j++)
+		{
+			LLVector4a c1,c2;
+			c1.setSub(v[mIndices[j*3+0]], v[mIndices[j*3+1]]);
+			c2.setSub(v[mIndices[j*3+1]], v[mIndices[j*3+2]]);
+			mTriangleNormals[j].setCross3(c1, c2);
+		}
+	}
+
+	return mTriangleNormals;
+}
+
+S64 LLVolumeFace::getMemoryBytes() const
+{
+	S64 vertex_size = sizeof(LLVector4a) * 2 + sizeof(LLVector2);
+	if (mBinormals)
+	{
+		vertex_size += sizeof(LLVector4a);
+	}
+	if (mWeights)
+	{
+		vertex_size += sizeof(LLVector4a);
+	}
+
+	S64 bytes = vertex_size * mNumVertices;
+	bytes += sizeof(U16) * mNumIndices;
+	bytes += sizeof(S32) * mEdge.capacity();
+	if (mTriangleNormals)
+	{
+		bytes += sizeof(LLVector4a) * (mNumIndices / 3);
+	}
+	return bytes;
+}
+
+void LLVolumeFace::clearTriangleNormals()
+{
+	ll_aligned_free_16(mTriangleNormals);
+	mTriangleNormals = NULL;
+}
+
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
+	clearTriangleNormals();
+	rhs.clearTriangleNormals();
 	llswap(rhs.mPositions, mPositions);
 	llswap(rhs.mNormals, mNormals);
 	llswap(rhs.mBinormals, mBinormals);
@@ -6890,6 +6941,7 @@ void LLVolumeFace::createBinormals()
 
 void LLVolumeFace::resizeVertices(S32 num_verts)
 {
+	clearTriangleNormals();
 	ll_aligned_free_16(mPositions);
 	ll_aligned_free_16(mNormals);
 	ll_aligned_free_16(mBinormals);
@@ -6965,6 +7017,7 @@ void LLVolumeFace::allocateWeights(S32 num_verts)
 
 void LLVolumeFace::resizeIndices(S32 num_indices)
 {
+	clearTriangleNormals();
 	ll_aligned_free_16(mIndices);
 
 	if (num_indices)
@@ -6984,6 +7037,8 @@ void LLVolumeFace::resizeIndices(S32 num_indices)
 
 void LLVolumeFace::pushIndex(const U16& idx)
 {
+	clearTriangleNormals();
+
 	S32 new_count = mNumIndices + 1;
 	S32 new_size = ((new_count*2)+0xF) & ~0xF;
 
@@ -7016,6 +7071,8 @@ void LLVolumeFace::fillFromLegacyData(std::vector<LLVolumeFace::VertexData>& v,
 
 void LLVolumeFace::appendFace(const LLVolumeFace& face, LLMatrix4& mat_in, LLMatrix4& norm_mat_in)
 {
+	clearTriangleNormals();
+
 	U16 offset = mNumVertices;
 
 	S32 new_count = face.mNumVertices + mNumVertices;
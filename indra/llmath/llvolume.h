@@ -890,6 +890,13 @@ public:
 
 	void createOctree(F32 scaler = 0.25f, const LLVector4a& center = LLVector4a(0,0,0), const LLVector4a& size = LLVector4a(0.5f,0.5f,0.5f));
 
+	// Unnormalized normal of each triangle, used for silhouette generation.
+	// Built on first use and kept until the face geometry changes.
+	const LLVector4a* getTriangleNormals();
+
+	// Bytes allocated for vertex, index and adjacency data
+	S64 getMemoryBytes() const;
+
 	enum
 	{
 		SINGLE_MASK =	0x0001,
@@ -938,6 +945,10 @@ public:
 	LLOctreeNode<LLVolumeTriangle>* mOctree;
 
 private:
+	void clearTriangleNormals();
+
+	LLVector4a* mTriangleNormals;
+
 	BOOL createUnCutCubeCap(LLVolume* volume, BOOL partial_build = FALSE);
 	BOOL createCap(LLVolume* volume, BOOL partial_build = FALSE);
 	BOOL createSide(LLVolume* volume, BOOL partial_build = FALSE);
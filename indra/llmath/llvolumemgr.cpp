@@ -218,6 +218,25 @@ void LLVolumeMgr::dump()
 	llinfos << "Average usage of LODs " << avg << llendl;
 }
 
+void LLVolumeMgr::getMemoryUsage(LLMemoryAccount::Usage& usage) const
+{
+	if (mDataMutex)
+	{
+		mDataMutex->lock();
+	}
+	for (volume_lod_group_map_t::const_iterator iter = mVolumeLODGroups.begin(),
+			 end = mVolumeLODGroups.end();
+		 iter != end; iter++)
+	{
+		iter->second->getMemoryUsage(usage);
+	}
+	usage.mBytes += LLMemoryAccount::nodeBytes(mVolumeLODGroups.size(), sizeof(LLVolumeLODGroup));
+	if (mDataMutex)
+	{
+		mDataMutex->unlock();
+	}
+}
+
 void LLVolumeMgr::useMutex()
 { 
 	if (!mDataMutex)
@@ -406,6 +425,23 @@ F32 LLVolumeLODGroup::dump()
 	return usage;
 }
 
+void LLVolumeLODGroup::getMemoryUsage(LLMemoryAccount::Usage& usage) const
+{
+	for (S32 i = 0; i < NUM_LODS; i++)
+	{
+		LLVolume* volumep = mVolumeLODs[i];
+		if (volumep)
+		{
+			usage.mBytes += sizeof(LLVolume);
+			for (S32 face = 0; face < volumep->getNumVolumeFaces(); face++)
+			{
+				usage.mBytes += volumep->getVolumeFace(face).getMemoryBytes();
+			}
+			usage.mCount++;
+		}
+	}
+}
+
 std::ostream& operator<<(std::ostream& s, const LLVolumeLODGroup& volgroup)
 {
 	s << "{ numRefs=" << volgroup.getNumRefs();
@@ -36,6 +36,7 @@
 #include <map>
 
 #include "llvolume.h"
+#include "llmemoryaccount.h"
 #include "llpointer.h"
 #include "llthread.h"
 
@@ -68,6 +69,8 @@ public:
 	const LLVolumeParams* getVolumeParams() const { return &mVolumeParams; };
 
 	F32	dump();
+	// Adds the geometry of every LOD currently built
+	void getMemoryUsage(LLMemoryAccount::Usage& usage) const;
 	friend std::ostream& operator<<(std::ostream& s, const LLVolumeLODGroup& volgroup);
 
 protected:
@@ -97,6 +100,7 @@ public:
 	virtual void unrefVolume(LLVolume *volumep);
 
 	void dump();
+	void getMemoryUsage(LLMemoryAccount::Usage& usage) const;
 
 	// manually call this for mutex magic
 	void useMutex();
@@ -40,6 +40,7 @@ Ported to Phoenix by Wolfspirit Magic.
 #include "llsdserialize.h"
 
 #include <boost/tokenizer.hpp>
+#include <boost/unordered_map.hpp>
 
 #include <map>
 #include <set>
@@ -77,6 +78,11 @@ namespace LLAvatarNameCache
 	typedef std::map<LLUUID, F64> pending_queue_t;
 	pending_queue_t sPendingQueue;
 
+	// agent IDs the capability failed on, mapped to the frame time before
+	// which they are not asked for again
+	typedef std::map<LLUUID, F64> retry_map_t;
+	retry_map_t sRetryAfter;
+
 	// Callbacks to fire when we received a name.
 	// May have multiple callbacks for a single ID, which are
 	// represented as multiple slots bound to the signal.
@@ -85,7 +91,7 @@ namespace LLAvatarNameCache
 	signal_map_t sSignalMap;
 
 	// names we know about
-	typedef std::map<LLUUID, LLAvatarName> cache_t;
+	typedef boost::unordered_map<LLUUID, LLAvatarName> cache_t;
 	cache_t sCache;
 
 	// Send bulk lookup requests a few times a second at most
@@ -108,6 +114,11 @@ namespace LLAvatarNameCache
 
 	void requestNamesViaCapability();
 
+	// The capability could not answer for agent_id: looks the name up with
+	// UUIDNameRequest instead and keeps agent_id out of capability requests
+	// until retry_time.
+	void capabilityFailed(const LLUUID& agent_id, F64 retry_time);
+
 	// Legacy name system callback
 	void legacyNameCallback(const LLUUID& agent_id,
 							const std::string& full_name,
@@ -130,6 +141,10 @@ namespace LLAvatarNameCache
 	// Erase expired names from cache
 	void eraseExpired();
 
+	// Binary section header, followed by a U32 version and a U32 entry count
+	const char BINARY_MAGIC[4] = { 'L', 'L', 'A', 'N' };
+	const U32 BINARY_VERSION = 1;
+
 	bool expirationFromCacheControl(LLSD headers, F64 *expires);
 }
 
@@ -220,6 +235,10 @@ public:
 
 			// cache it and fire signals
 			LLAvatarNameCache::processName(agent_id, av_name, true);
+
+			// The reply also carries the legacy name, which answers any
+			// legacy lookups coalesced into this request
+			gCacheName->addAgentName(agent_id, av_name.mLegacyFirstName, av_name.mLegacyLastName);
 		}
 
 		// Same logic as error response case
@@ -240,6 +259,10 @@ public:
 				const LLUUID& agent_id = *it;
 				// cache it and fire signals
 
+				// Fall back to the legacy system for any legacy lookups
+				// coalesced into this request
+				LLAvatarNameCache::capabilityFailed(agent_id, expires);
+
 				// Wolfspirit: Do not use ???  as username. Try to get a username out of the old legacy name
 				std::string oldname;
 				gCacheName->getFullName(agent_id, oldname);		
@@ -276,6 +299,10 @@ public:
 			const LLUUID& agent_id = *it;
 			// cache it and fire signals
 
+			// Fall back to the legacy system for any legacy lookups
+			// coalesced into this request
+			LLAvatarNameCache::capabilityFailed(agent_id, retry_timestamp);
+
 			// Wolfspirit: Do not use ???  as username. Try to get a username out of the old legacy name
 			std::string oldname;
 			gCacheName->getFullName(agent_id, oldname);		
@@ -384,6 +411,18 @@ void LLAvatarNameCache::requestNamesViaCapability()
 	{
 		const LLUUID& agent_id = *it;
 
+		retry_map_t::iterator retry_it = sRetryAfter.find(agent_id);
+		if (retry_it != sRetryAfter.end())
+		{
+			if (retry_it->second > now)
+			{
+				// Failed recently, the legacy lookup answers in the meantime
+				gCacheName->requestAgentName(agent_id);
+				continue;
+			}
+			sRetryAfter.erase(retry_it);
+		}
+
 		if (url.empty())
 		{
 			// ...starting new request
@@ -421,6 +460,15 @@ void LLAvatarNameCache::requestNamesViaCapability()
 	// We've moved all asks to the pending request queue
 	sAskQueue.clear();
 }
+void LLAvatarNameCache::capabilityFailed(const LLUUID& agent_id, F64 retry_time)
+{
+	sRetryAfter[agent_id] = retry_time;
+	if (gCacheName)
+	{
+		gCacheName->requestAgentName(agent_id);
+	}
+}
+
 void LLAvatarNameCache::legacyNameCallback(const LLUUID& agent_id,
 										   const std::string& full_name,
 										   bool is_group)
@@ -512,6 +560,90 @@ void LLAvatarNameCache::exportFile(std::ostream& ostr)
 	LLSDSerialize::toPrettyXML(data, ostr);
 }
 
+bool LLAvatarNameCache::importBinary(std::istream& istr)
+{
+	char magic[sizeof(BINARY_MAGIC)];
+	U32 version = 0;
+	U32 total = 0;
+	istr.read(magic, sizeof(magic));
+	istr.read((char*)&version, sizeof(U32));
+	istr.read((char*)&total, sizeof(U32));
+	if (!istr.good()
+		|| memcmp(magic, BINARY_MAGIC, sizeof(magic))
+		|| version != BINARY_VERSION)
+	{
+		return false;
+	}
+
+	// An id, four string lengths, the default flag and two times at least
+	sCache.rehash(sCache.size() + LLCacheName::getBinaryReserveCount(istr, total, UUID_BYTES + 4 * sizeof(U16) + sizeof(U8) + 2 * sizeof(F64)));
+
+	LLUUID agent_id;
+	LLAvatarName av_name;
+	U8 is_default = 0;
+	for (U32 i = 0; i < total; ++i)
+	{
+		istr.read((char*)agent_id.mData, UUID_BYTES);
+		if (!LLCacheName::readBinaryString(istr, av_name.mUsername)
+			|| !LLCacheName::readBinaryString(istr, av_name.mDisplayName)
+			|| !LLCacheName::readBinaryString(istr, av_name.mLegacyFirstName)
+			|| !LLCacheName::readBinaryString(istr, av_name.mLegacyLastName))
+		{
+			llwarns << "Display name binary cache truncated at entry " << i << llendl;
+			return false;
+		}
+		istr.read((char*)&is_default, sizeof(U8));
+		istr.read((char*)&av_name.mExpires, sizeof(F64));
+		istr.read((char*)&av_name.mNextUpdate, sizeof(F64));
+		av_name.mIsDisplayNameDefault = (is_default != 0);
+		av_name.mIsTemporaryName = false;
+		sCache[agent_id] = av_name;
+	}
+	if (!istr.good())
+	{
+		return false;
+	}
+	// entries may have expired since we last ran the viewer, just
+	// clean them out now
+	eraseExpired();
+	llinfos << "loaded " << sCache.size() << llendl;
+	return true;
+}
+
+void LLAvatarNameCache::exportBinary(std::ostream& ostr)
+{
+	U32 total = 0;
+	cache_t::const_iterator it = sCache.begin();
+	for ( ; it != sCache.end(); ++it)
+	{
+		if (!it->second.mIsTemporaryName)
+		{
+			++total;
+		}
+	}
+
+	ostr.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	ostr.write((const char*)&BINARY_VERSION, sizeof(U32));
+	ostr.write((const char*)&total, sizeof(U32));
+	for (it = sCache.begin(); it != sCache.end(); ++it)
+	{
+		const LLAvatarName& av_name = it->second;
+		if (av_name.mIsTemporaryName)
+		{
+			continue;
+		}
+		U8 is_default = av_name.mIsDisplayNameDefault ? 1 : 0;
+		ostr.write((const char*)it->first.mData, UUID_BYTES);
+		LLCacheName::writeBinaryString(ostr, av_name.mUsername);
+		LLCacheName::writeBinaryString(ostr, av_name.mDisplayName);
+		LLCacheName::writeBinaryString(ostr, av_name.mLegacyFirstName);
+		LLCacheName::writeBinaryString(ostr, av_name.mLegacyLastName);
+		ostr.write((const char*)&is_default, sizeof(U8));
+		ostr.write((const char*)&av_name.mExpires, sizeof(F64));
+		ostr.write((const char*)&av_name.mNextUpdate, sizeof(F64));
+	}
+}
+
 void LLAvatarNameCache::setNameLookupURL(const std::string& name_lookup_url)
 {
 	sNameLookupURL = name_lookup_url;
@@ -548,6 +680,13 @@ void LLAvatarNameCache::idle()
 	//	eraseExpired();
 	//}
 
+	if (useDisplayNames() && gCacheName)
+	{
+		// Fold queued legacy agent lookups into the capability batch;
+		// replies carry the legacy name and fill both caches at once
+		gCacheName->takeAgentRequests(sAskQueue);
+	}
+
 	if (sAskQueue.empty())
 	{
 		return;
@@ -626,7 +765,7 @@ bool LLAvatarNameCache::get(const LLUUID& agent_id, LLAvatarName *av_name)
 		{
 			  
 			// ...use display names cache
-			std::map<LLUUID,LLAvatarName>::iterator it = sCache.find(agent_id);
+			cache_t::iterator it = sCache.find(agent_id);
 			if (it != sCache.end())
 			{
 				*av_name = it->second;
@@ -688,7 +827,7 @@ void LLAvatarNameCache::get(const LLUUID& agent_id, callback_slot_t slot)
 		if (useDisplayNames())
 		{
 			// ...use new cache
-			std::map<LLUUID,LLAvatarName>::iterator it = sCache.find(agent_id);
+			cache_t::iterator it = sCache.find(agent_id);
 			if (it != sCache.end())
 			{
 				LLAvatarName& av_name = it->second;
@@ -803,6 +942,22 @@ void LLAvatarNameCache::insert(const LLUUID& agent_id, const LLAvatarName& av_na
 	sCache[agent_id] = av_name;
 }
 
+void LLAvatarNameCache::getMemoryUsage(LLMemoryAccount::Usage& usage)
+{
+	for (cache_t::const_iterator it = sCache.begin(); it != sCache.end(); ++it)
+	{
+		const LLAvatarName& av_name = it->second;
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(cache_t::value_type));
+		usage.mBytes += LLMemoryAccount::stringBytes(av_name.mUsername)
+			+ LLMemoryAccount::stringBytes(av_name.mDisplayName)
+			+ LLMemoryAccount::stringBytes(av_name.mLegacyFirstName)
+			+ LLMemoryAccount::stringBytes(av_name.mLegacyLastName);
+	}
+	usage.mCount += sCache.size();
+}
+
+static LLMemoryAccount sAvatarNameAccount("Display name cache", LLAvatarNameCache::getMemoryUsage);
+
 F64 LLAvatarNameCache::nameExpirationFromHeaders(LLSD headers)
 {
 	F64 expires = 0.0;
@@ -29,6 +29,7 @@
 #define LLAVATARNAMECACHE_H
 
 #include "llavatarname.h"	// for convenience
+#include "llmemoryaccount.h"
 
 #include <boost/signals2.hpp>
 
@@ -49,6 +50,12 @@ namespace LLAvatarNameCache
 	void importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// Compact binary form of the above, stored after the legacy name
+	// section in the viewer's shared names.bin.  Returns false if the
+	// stream does not hold a display name section of this version.
+	bool importBinary(std::istream& istr);
+	void exportBinary(std::ostream& ostr);
+
 	// On the viewer, usually a simulator capabilitity
 	// If empty, name cache will fall back to using legacy name
 	// lookup system
@@ -95,6 +102,8 @@ namespace LLAvatarNameCache
 
 	void insert(const LLUUID& agent_id, const LLAvatarName& av_name);
 
+	void getMemoryUsage(LLMemoryAccount::Usage& usage);
+
 	// Compute name expiration time from HTTP Cache-Control header,
 	// or return default value, in seconds from epoch.
 	F64 nameExpirationFromHeaders(LLSD headers);
@@ -44,6 +44,7 @@
 #include "message.h"
 
 #include <boost/regex.hpp>
+#include <boost/unordered_map.hpp>
 
 // llsd serialization constants
 static const std::string AGENTS("agents");
@@ -60,8 +61,24 @@ const U32 PENDING_TIMEOUT_SECS = 5 * 60;
 // File version number
 const S32 CN_FILE_VERSION = 2;
 
+// Binary section header, followed by a U32 version and a U32 entry count
+static const char CN_BINARY_MAGIC[4] = { 'L', 'L', 'C', 'N' };
+const U32 CN_BINARY_VERSION = 1;
+
+// We'll expire entries more than a week old on import
+const U32 CN_EXPIRE_SECS = 7 * 60 * 60 * 24;
+
 // Globals
 LLCacheName* gCacheName = NULL;
+
+static void cache_name_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	if (gCacheName)
+	{
+		gCacheName->getMemoryUsage(usage);
+	}
+}
+static LLMemoryAccount sCacheNameAccount("Name cache", cache_name_memory_usage);
 std::map<std::string, std::string> LLCacheName::sCacheName;
 
 /// ---------------------------------------------------------------------------
@@ -193,8 +210,8 @@ void ReplySender::flush()
 typedef std::set<LLUUID>					AskQueue;
 typedef std::list<PendingReply*>			ReplyQueue;
 typedef std::map<LLUUID,U32>				PendingQueue;
-typedef std::map<LLUUID, LLCacheNameEntry*> Cache;
-typedef std::map<std::string, LLUUID> 		ReverseCache;
+typedef boost::unordered_map<LLUUID, LLCacheNameEntry*> Cache;
+typedef boost::unordered_map<std::string, LLUUID> ReverseCache;
 
 class LLCacheName::Impl
 {
@@ -210,6 +227,9 @@ public:
 	AskQueue			mAskNameQueue;
 	AskQueue			mAskGroupQueue;
 		// UUIDs to ask our upstream host about
+	AskQueue			mLegacyAskNameQueue;
+		// agent UUIDs another name source failed on, only ever sent
+		// as UUIDNameRequest
 	
 	PendingQueue		mPendingQueue;
 		// UUIDs that have been requested but are not in cache yet.
@@ -223,6 +243,17 @@ public:
 
 	BOOL getName(const LLUUID& id, std::string& first, std::string& last);
 
+	LLCacheNameEntry* findEntry(const LLUUID& id) const
+	{
+		Cache::const_iterator iter = mCache.find(id);
+		return (iter != mCache.end()) ? iter->second : NULL;
+	}
+
+	// Inserts a freshly received entry and indexes its name for reverse
+	// lookups.  Returns the entry, which is owned by mCache.
+	LLCacheNameEntry* storeEntry(const LLUUID& id);
+	void indexEntry(const LLUUID& id, const LLCacheNameEntry* entry);
+
 	boost::signals2::connection addPending(const LLUUID& id, const LLCacheNameCallback& callback);
 	void addPending(const LLUUID& id, const LLHost& host);
 
@@ -319,9 +350,7 @@ bool LLCacheName::importFile(std::istream& istr)
 		return false;
 
 	// We'll expire entries more than a week old
-	U32 now = (U32)time(NULL);
-	const U32 SECS_PER_DAY = 60 * 60 * 24;
-	U32 delete_before_time = now - (7 * SECS_PER_DAY);
+	U32 delete_before_time = (U32)time(NULL) - CN_EXPIRE_SECS;
 
 	// iterate over the agents
 	S32 count = 0;
@@ -341,9 +370,7 @@ bool LLCacheName::importFile(std::istream& istr)
 		entry->mFirstName = agent[FIRST].asString();
 		entry->mLastName = agent[LAST].asString();
 		impl.mCache[id] = entry;
-		std::string fullname = buildFullName(entry->mFirstName, entry->mLastName);
-		fullname = cleanFullName(fullname); // Do not keep "Resident" for reverse lookups
-		impl.mReverseCache[fullname] = id;
+		impl.indexEntry(id, entry);
 
 		++count;
 	}
@@ -365,7 +392,7 @@ bool LLCacheName::importFile(std::istream& istr)
 		entry->mCreateTime = ctime;
 		entry->mGroupName = group[NAME].asString();
 		impl.mCache[id] = entry;
-		impl.mReverseCache[entry->mGroupName] = id;
+		impl.indexEntry(id, entry);
 		++count;
 	}
 	llinfos << "LLCacheName loaded " << count << " group names" << llendl;
@@ -408,6 +435,163 @@ void LLCacheName::exportFile(std::ostream& ostr)
 	LLSDSerialize::toPrettyXML(data, ostr);
 }
 
+//static
+void LLCacheName::writeBinaryString(std::ostream& ostr, const std::string& str)
+{
+	U16 length = (U16)llmin(str.size(), (size_t)U16_MAX);
+	ostr.write((const char*)&length, sizeof(U16));
+	ostr.write(str.data(), length);
+}
+
+//static
+bool LLCacheName::readBinaryString(std::istream& istr, std::string& str)
+{
+	U16 length = 0;
+	istr.read((char*)&length, sizeof(U16));
+	if (!istr.good())
+	{
+		return false;
+	}
+	str.resize(length);
+	if (length)
+	{
+		istr.read(&str[0], length);
+	}
+	return istr.good();
+}
+
+//static
+U32 LLCacheName::getBinaryReserveCount(std::istream& istr, U32 count, U32 min_record_size)
+{
+	std::streampos start = istr.tellg();
+	if (start < 0)
+	{
+		// Can't tell, let the tables grow as records are read
+		return 0;
+	}
+	istr.seekg(0, std::ios::end);
+	std::streampos end = istr.tellg();
+	istr.seekg(start);
+	if (end < start || !istr.good())
+	{
+		istr.clear();
+		istr.seekg(start);
+		return 0;
+	}
+	return (U32)llmin((U64)count, (U64)(end - start) / min_record_size);
+}
+
+bool LLCacheName::importBinary(std::istream& istr)
+{
+	char magic[sizeof(CN_BINARY_MAGIC)];
+	U32 version = 0;
+	U32 total = 0;
+	istr.read(magic, sizeof(magic));
+	istr.read((char*)&version, sizeof(U32));
+	istr.read((char*)&total, sizeof(U32));
+	if (!istr.good()
+		|| memcmp(magic, CN_BINARY_MAGIC, sizeof(magic))
+		|| version != CN_BINARY_VERSION)
+	{
+		return false;
+	}
+
+	U32 delete_before_time = (U32)time(NULL) - CN_EXPIRE_SECS;
+	// A corrupt count must not size the tables; a record is at least an id,
+	// the group flag, the creation time and one string length.
+	U32 reserve = getBinaryReserveCount(istr, total, UUID_BYTES + sizeof(U8) + sizeof(U32) + sizeof(U16));
+	impl.mCache.rehash(impl.mCache.size() + reserve);
+	impl.mReverseCache.rehash(impl.mReverseCache.size() + reserve);
+
+	S32 agents = 0;
+	S32 groups = 0;
+	LLUUID id;
+	U8 is_group = 0;
+	U32 ctime = 0;
+	std::string first, last;
+	for (U32 i = 0; i < total; ++i)
+	{
+		istr.read((char*)id.mData, UUID_BYTES);
+		istr.read((char*)&is_group, sizeof(U8));
+		istr.read((char*)&ctime, sizeof(U32));
+		if (!readBinaryString(istr, first)
+			|| (!is_group && !readBinaryString(istr, last)))
+		{
+			llwarns << "LLCacheName binary cache truncated at entry " << i << llendl;
+			return false;
+		}
+		if (ctime < delete_before_time || impl.findEntry(id))
+		{
+			continue;
+		}
+
+		LLCacheNameEntry* entry = new LLCacheNameEntry();
+		entry->mIsGroup = (is_group != 0);
+		entry->mCreateTime = ctime;
+		if (is_group)
+		{
+			entry->mGroupName = first;
+			++groups;
+		}
+		else
+		{
+			entry->mFirstName = first;
+			entry->mLastName = last;
+			++agents;
+		}
+		impl.mCache[id] = entry;
+		impl.indexEntry(id, entry);
+	}
+	llinfos << "LLCacheName loaded " << agents << " agent names and "
+			<< groups << " group names" << llendl;
+	return true;
+}
+
+void LLCacheName::exportBinary(std::ostream& ostr)
+{
+	// Same filtering as exportFile(), counted first for the header
+	std::vector<std::pair<LLUUID, const LLCacheNameEntry*> > entries;
+	entries.reserve(impl.mCache.size());
+	for (Cache::const_iterator iter = impl.mCache.begin(), end = impl.mCache.end();
+		 iter != end; ++iter)
+	{
+		const LLCacheNameEntry* entry = iter->second;
+		if (!entry
+			|| (std::string::npos != entry->mFirstName.find('?'))
+			|| (std::string::npos != entry->mGroupName.find('?')))
+		{
+			continue;
+		}
+		if ((!entry->mIsGroup && !entry->mFirstName.empty() && !entry->mLastName.empty())
+			|| (entry->mIsGroup && !entry->mGroupName.empty()))
+		{
+			entries.push_back(std::make_pair(iter->first, entry));
+		}
+	}
+
+	U32 total = entries.size();
+	ostr.write(CN_BINARY_MAGIC, sizeof(CN_BINARY_MAGIC));
+	ostr.write((const char*)&CN_BINARY_VERSION, sizeof(U32));
+	ostr.write((const char*)&total, sizeof(U32));
+	for (U32 i = 0; i < total; ++i)
+	{
+		const LLCacheNameEntry* entry = entries[i].second;
+		U8 is_group = entry->mIsGroup ? 1 : 0;
+		ostr.write((const char*)entries[i].first.mData, UUID_BYTES);
+		ostr.write((const char*)&is_group, sizeof(U8));
+		ostr.write((const char*)&entry->mCreateTime, sizeof(U32));
+		if (is_group)
+		{
+			writeBinaryString(ostr, entry->mGroupName);
+		}
+		else
+		{
+			writeBinaryString(ostr, entry->mFirstName);
+			writeBinaryString(ostr, entry->mLastName);
+		}
+	}
+}
+
 
 BOOL LLCacheName::Impl::getName(const LLUUID& id, std::string& first, std::string& last)
 {
@@ -418,7 +602,7 @@ BOOL LLCacheName::Impl::getName(const LLUUID& id, std::string& first, std::strin
 		return TRUE;
 	}
 
-	LLCacheNameEntry* entry = get_ptr_in_map(mCache, id);
+	LLCacheNameEntry* entry = findEntry(id);
 	if (entry)
 	{
 		first = entry->mFirstName;
@@ -468,7 +652,7 @@ BOOL LLCacheName::getGroupName(const LLUUID& id, std::string& group)
 		return TRUE;
 	}
 
-	LLCacheNameEntry* entry = get_ptr_in_map(impl.mCache,id);
+	LLCacheNameEntry* entry = impl.findEntry(id);
 	if (entry && entry->mGroupName.empty())
 	{
 		// COUNTER-HACK to combat James' HACK in exportFile()...
@@ -624,7 +808,7 @@ boost::signals2::connection LLCacheName::get(const LLUUID& id, bool is_group, co
 		return res;
 	}
 
-	LLCacheNameEntry* entry = get_ptr_in_map(impl.mCache, id );
+	LLCacheNameEntry* entry = impl.findEntry(id);
 	if (entry)
 	{
 		LLCacheNameSignal signal;
@@ -678,7 +862,7 @@ BOOL LLCacheName::getIfThere(const LLUUID& id, std::string& fullname, BOOL& is_g
 		return FALSE;
 	}
 
-	LLCacheNameEntry* entry = get_ptr_in_map(impl.mCache, id );
+	LLCacheNameEntry* entry = impl.findEntry(id);
 	if (entry)
 	{
 		if (entry->mIsGroup)
@@ -714,6 +898,50 @@ void LLCacheName::processPending()
 	impl.processPendingReplies();
 }
 
+S32 LLCacheName::takeAgentRequests(std::set<LLUUID>& ids)
+{
+	S32 count = 0;
+	for (AskQueue::iterator it = impl.mAskNameQueue.begin(); it != impl.mAskNameQueue.end(); )
+	{
+		AskQueue::iterator cur = it++;
+		if (!impl.mLegacyAskNameQueue.count(*cur))
+		{
+			ids.insert(*cur);
+			impl.mAskNameQueue.erase(cur);
+			++count;
+		}
+	}
+	return count;
+}
+
+void LLCacheName::addAgentName(const LLUUID& id, const std::string& first, const std::string& last)
+{
+	if (first.empty())
+	{
+		// Source had no legacy name for this agent, ask for it ourselves
+		requestAgentName(id);
+		return;
+	}
+
+	LLCacheNameEntry* entry = impl.storeEntry(id);
+	entry->mIsGroup = false;
+	entry->mFirstName = first;
+	entry->mLastName = last.empty() ? getDefaultLastName() : last;
+	impl.indexEntry(id, entry);
+
+	// Pending replies are answered from the cache on the next processPending()
+	impl.mSignal(id, buildFullName(entry->mFirstName, entry->mLastName), false);
+}
+
+void LLCacheName::requestAgentName(const LLUUID& id)
+{
+	if (id.notNull() && !impl.findEntry(id))
+	{
+		impl.mPendingQueue[id] = (U32)time(NULL);
+		impl.mLegacyAskNameQueue.insert(id);
+	}
+}
+
 void LLCacheName::deleteEntriesOlderThan(S32 secs)
 {
 	U32 now = (U32)time(NULL);
@@ -724,6 +952,13 @@ void LLCacheName::deleteEntriesOlderThan(S32 secs)
 		LLCacheNameEntry* entry = curiter->second;
 		if (entry->mCreateTime < expire_time)
 		{
+			ReverseCache::iterator rev_iter = impl.mReverseCache.find(entry->mIsGroup
+				? entry->mGroupName
+				: cleanFullName(buildFullName(entry->mFirstName, entry->mLastName)));
+			if (rev_iter != impl.mReverseCache.end() && rev_iter->second == curiter->first)
+			{
+				impl.mReverseCache.erase(rev_iter);
+			}
 			delete entry;
 			impl.mCache.erase(curiter);
 		}
@@ -782,10 +1017,28 @@ void LLCacheName::dumpStats()
 			<< llendl;
 }
 
+void LLCacheName::getMemoryUsage(LLMemoryAccount::Usage& usage) const
+{
+	for (Cache::const_iterator iter = impl.mCache.begin(); iter != impl.mCache.end(); ++iter)
+	{
+		const LLCacheNameEntry* entry = iter->second;
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(Cache::value_type)) + sizeof(LLCacheNameEntry);
+		usage.mBytes += LLMemoryAccount::stringBytes(entry->mFirstName)
+			+ LLMemoryAccount::stringBytes(entry->mLastName)
+			+ LLMemoryAccount::stringBytes(entry->mGroupName);
+	}
+	for (ReverseCache::const_iterator iter = impl.mReverseCache.begin(); iter != impl.mReverseCache.end(); ++iter)
+	{
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(ReverseCache::value_type)) + LLMemoryAccount::stringBytes(iter->first);
+	}
+	usage.mCount += impl.mCache.size();
+}
+
 void LLCacheName::clear()
 {
 	for_each(impl.mCache.begin(), impl.mCache.end(), DeletePairedPointer());
 	impl.mCache.clear();
+	impl.mReverseCache.clear();
 }
 
 //static 
@@ -800,12 +1053,40 @@ std::string LLCacheName::getDefaultLastName()
 	return "Resident";
 }
 
+LLCacheNameEntry* LLCacheName::Impl::storeEntry(const LLUUID& id)
+{
+	LLCacheNameEntry*& entry = mCache[id];
+	if (!entry)
+	{
+		entry = new LLCacheNameEntry;
+	}
+	entry->mCreateTime = (U32)time(NULL);
+	mPendingQueue.erase(id);
+	return entry;
+}
+
+void LLCacheName::Impl::indexEntry(const LLUUID& id, const LLCacheNameEntry* entry)
+{
+	if (entry->mIsGroup)
+	{
+		mReverseCache[entry->mGroupName] = id;
+	}
+	else
+	{
+		// Do not keep "Resident" for reverse lookups
+		mReverseCache[LLCacheName::cleanFullName(
+			LLCacheName::buildFullName(entry->mFirstName, entry->mLastName))] = id;
+	}
+}
+
 void LLCacheName::Impl::processPendingAsks()
 {
+	mAskNameQueue.insert(mLegacyAskNameQueue.begin(), mLegacyAskNameQueue.end());
 	sendRequest(_PREHASH_UUIDNameRequest, mAskNameQueue);
 	sendRequest(_PREHASH_UUIDGroupNameRequest, mAskGroupQueue);
 	mAskNameQueue.clear();
 	mAskGroupQueue.clear();
+	mLegacyAskNameQueue.clear();
 }
 
 void LLCacheName::Impl::processPendingReplies()
@@ -814,7 +1095,7 @@ void LLCacheName::Impl::processPendingReplies()
 	for(ReplyQueue::iterator it = mReplyQueue.begin(); it != mReplyQueue.end(); ++it)
 	{
 		PendingReply* reply = *it;
-		LLCacheNameEntry* entry = get_ptr_in_map(mCache, reply->mID);
+		LLCacheNameEntry* entry = findEntry(reply->mID);
 		if(!entry) continue;
 
 		if (!entry->mIsGroup)
@@ -834,7 +1115,7 @@ void LLCacheName::Impl::processPendingReplies()
 	for(ReplyQueue::iterator it = mReplyQueue.begin(); it != mReplyQueue.end(); ++it)
 	{
 		PendingReply* reply = *it;
-		LLCacheNameEntry* entry = get_ptr_in_map(mCache, reply->mID);
+		LLCacheNameEntry* entry = findEntry(reply->mID);
 		if(!entry) continue;
 
 		if (reply->mHost.isOk())
@@ -927,7 +1208,7 @@ void LLCacheName::Impl::processUUIDRequest(LLMessageSystem* msg, bool isGroup)
 	{
 		LLUUID id;
 		msg->getUUIDFast(_PREHASH_UUIDNameBlock, _PREHASH_ID, id, i);
-		LLCacheNameEntry* entry = get_ptr_in_map(mCache, id);
+		LLCacheNameEntry* entry = findEntry(id);
 		if(entry)
 		{
 			if (isGroup != entry->mIsGroup)
@@ -972,17 +1253,8 @@ void LLCacheName::Impl::processUUIDReply(LLMessageSystem* msg, bool isGroup)
 	{
 		LLUUID id;
 		msg->getUUIDFast(_PREHASH_UUIDNameBlock, _PREHASH_ID, id, i);
-		LLCacheNameEntry* entry = get_ptr_in_map(mCache, id);
-		if (!entry)
-		{
-			entry = new LLCacheNameEntry;
-			mCache[id] = entry;
-		}
-
-		mPendingQueue.erase(id);
-
+		LLCacheNameEntry* entry = storeEntry(id);
 		entry->mIsGroup = isGroup;
-		entry->mCreateTime = (U32)time(NULL);
 		if (!isGroup)
 		{
 			msg->getStringFast(_PREHASH_UUIDNameBlock, _PREHASH_FirstName, entry->mFirstName, i);
@@ -1016,14 +1288,12 @@ void LLCacheName::Impl::processUUIDReply(LLMessageSystem* msg, bool isGroup)
 				full_name = LLCacheName::buildFullName(entry->mFirstName, entry->mLastName);
 			}
 			mSignal(id, full_name, false);
-			full_name = cleanFullName(full_name); // Do not keep "Resident" for reverse lookups
-			mReverseCache[full_name] = id;
 		}
 		else
 		{
 			mSignal(id, entry->mGroupName, true);
-			mReverseCache[entry->mGroupName] = id;
 		}
+		indexEntry(id, entry);
 	}
 }
 
@@ -36,6 +36,10 @@
 #include <boost/bind.hpp>
 #include <boost/signals2.hpp>
 
+#include <set>
+
+#include "llmemoryaccount.h"
+
 #include "llavatarnamecache.h"
 
 class LLMessageSystem;
@@ -75,6 +79,20 @@ public:
 	bool importFile(std::istream& istr);
 	void exportFile(std::ostream& ostr);
 
+	// Compact binary form of the above, written ahead of the display
+	// name section in the viewer's shared names.bin.  Returns false if
+	// the stream does not hold a name cache section of this version.
+	bool importBinary(std::istream& istr);
+	void exportBinary(std::ostream& ostr);
+
+	// Length-prefixed string IO used by the binary name cache sections.
+	static void writeBinaryString(std::ostream& ostr, const std::string& str);
+	static bool readBinaryString(std::istream& istr, std::string& str);
+	// Number of records to size the tables for when a section header claims
+	// count of them: no more than the rest of the stream can hold, at
+	// min_record_size bytes each.
+	static U32 getBinaryReserveCount(std::istream& istr, U32 count, U32 min_record_size);
+
 	// If available, copies name ("bobsmith123" or "James Linden") into string
 	// Returns TRUE iff available.
 	BOOL getName(const LLUUID& id, std::string& first, std::string& last);
@@ -129,12 +147,29 @@ public:
 	// This method needs to be called from time to time to send out requests.
 	void processPending();
 
+	// Moves queued agent name requests into ids, so that a batched lookup
+	// from another name source (the display name capability) can answer
+	// them in the same round trip.  Requests queued by requestAgentName()
+	// are left for UUIDNameRequest.  Returns the number of ids moved.
+	S32 takeAgentRequests(std::set<LLUUID>& ids);
+
+	// Stores an agent name obtained from another name source and fires
+	// any callbacks waiting on it.  Falls back to requestAgentName() if
+	// first is empty.
+	void addAgentName(const LLUUID& id, const std::string& first, const std::string& last);
+
+	// Re-queues a legacy request for an agent not in cache, even if a
+	// request is already pending; used when another source failed.  The
+	// request always goes out as UUIDNameRequest.
+	void requestAgentName(const LLUUID& id);
+
 	// Expire entries created more than "secs" seconds ago.
 	void deleteEntriesOlderThan(S32 secs);
 
 	// Debugging
 	void dump();		// Dumps the contents of the cache
 	void dumpStats();	// Dumps the sizes of the cache and associated queues.
+	void getMemoryUsage(LLMemoryAccount::Usage& usage) const;
 	void clear();		// Deletes all entries from the cache
 
 	static std::string getDefaultName();
@@ -1,51 +1,336 @@
 // <edit>
+#include "linden_common.h"
 #include "llmessagelog.h"
+#include "llfile.h"
+#include "lltimer.h"
 
-LLMessageLogEntry::LLMessageLogEntry(EType type, LLHost from_host, LLHost to_host, U8* data, S32 data_size)
+LLMessageLogEntry::LLMessageLogEntry(EType type, LLHost from_host, LLHost to_host, U8* data, S32 data_size, U64 time)
 :	mType(type),
 	mFromHost(from_host),
 	mToHost(to_host),
-	mDataSize(data_size)
+	mDataSize(data_size),
+	mData(NULL),
+	mTime(time)
 {
-	if(data)
+	if(data && data_size > 0)
 	{
 		mData = new U8[data_size];
 		memcpy(mData, data, data_size);
 	}
-	else
+}
+LLMessageLogEntry::LLMessageLogEntry(const LLMessageLogEntry& entry)
+:	mType(entry.mType),
+	mFromHost(entry.mFromHost),
+	mToHost(entry.mToHost),
+	mDataSize(entry.mDataSize),
+	mData(NULL),
+	mTime(entry.mTime)
+{
+	if(entry.mData && entry.mDataSize > 0)
 	{
-		mData = NULL;
+		mData = new U8[mDataSize];
+		memcpy(mData, entry.mData, mDataSize);
 	}
 }
 LLMessageLogEntry::~LLMessageLogEntry()
 {
-	// wtf, I'm not supposed to do this?
-	//if(mData && mDataSize) delete[] mData;
+	delete[] mData;
+}
+LLMessageLogEntry& LLMessageLogEntry::operator=(const LLMessageLogEntry& entry)
+{
+	if(this != &entry)
+	{
+		U8* data = NULL;
+		if(entry.mData && entry.mDataSize > 0)
+		{
+			data = new U8[entry.mDataSize];
+			memcpy(data, entry.mData, entry.mDataSize);
+		}
+		delete[] mData;
+		mType = entry.mType;
+		mFromHost = entry.mFromHost;
+		mToHost = entry.mToHost;
+		mDataSize = entry.mDataSize;
+		mData = data;
+		mTime = entry.mTime;
+	}
+	return *this;
+}
+
+// Header in front of each packet in the capture buffer
+struct LLMessageLogRecord
+{
+	U64 mTime;
+	U32 mFromAddress;
+	U32 mToAddress;
+	U16 mFromPort;
+	U16 mToPort;
+	S32 mSize;
+};
+const U32 RECORD_ALIGNMENT = 8;
+
+// pcap file layout, see http://wiki.wireshark.org/Development/LibpcapFileFormat
+struct LLPcapFileHeader
+{
+	U32 mMagic;
+	U16 mVersionMajor;
+	U16 mVersionMinor;
+	S32 mThisZone;
+	U32 mSigFigs;
+	U32 mSnapLength;
+	U32 mLinkType;
+};
+struct LLPcapRecordHeader
+{
+	U32 mSeconds;
+	U32 mMicroseconds;
+	U32 mIncludedLength;
+	U32 mOriginalLength;
+};
+const U32 PCAP_MAGIC = 0xa1b2c3d4;
+const U32 PCAP_MAGIC_SWAPPED = 0xd4c3b2a1;
+const U32 PCAP_SNAP_LENGTH = 65535;
+const U32 PCAP_LINKTYPE_RAW = 101;	// packets start with an IP header
+const S32 IP_HEADER_SIZE = 20;
+const S32 UDP_HEADER_SIZE = 8;
+const U8 IP_PROTOCOL_UDP = 17;
+
+static U32 swap_u32(U32 value, bool swap)
+{
+	if(!swap) return value;
+	return (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
 }
-U32 LLMessageLog::sMaxSize = 4096; // testzone fixme todo boom
-std::deque<LLMessageLogEntry> LLMessageLog::sDeque;
-void (*(LLMessageLog::sCallback))(LLMessageLogEntry);
-void LLMessageLog::setMaxSize(U32 size)
+
+static void put_u16(U8* out, U32 value)
 {
-	sMaxSize = size;
-	while(sDeque.size() > sMaxSize)
-		sDeque.pop_front();
+	out[0] = (U8)(value >> 8);
+	out[1] = (U8)value;
 }
-void LLMessageLog::setCallback(void (*callback)(LLMessageLogEntry))
+
+static U32 get_u16(const U8* in)
+{
+	return (in[0] << 8) | in[1];
+}
+
+// Fakes the IPv4 and UDP headers the packet would have had on the wire.
+static void write_ip_udp_header(U8* out, const LLMessageLogRecord* record)
+{
+	memset(out, 0, IP_HEADER_SIZE + UDP_HEADER_SIZE);
+	out[0] = 0x45;	// IPv4, 20 byte header
+	put_u16(out + 2, IP_HEADER_SIZE + UDP_HEADER_SIZE + record->mSize);
+	out[6] = 0x40;	// don't fragment
+	out[8] = 64;	// time to live
+	out[9] = IP_PROTOCOL_UDP;
+	// LLHost keeps addresses in network byte order already
+	memcpy(out + 12, &record->mFromAddress, 4);
+	memcpy(out + 16, &record->mToAddress, 4);
+	U32 sum = 0;
+	for(S32 i = 0; i < IP_HEADER_SIZE; i += 2)
+		sum += get_u16(out + i);
+	while(sum >> 16)
+		sum = (sum & 0xffff) + (sum >> 16);
+	put_u16(out + 10, ~sum & 0xffff);
+
+	U8* udp = out + IP_HEADER_SIZE;
+	put_u16(udp, record->mFromPort);
+	put_u16(udp + 2, record->mToPort);
+	put_u16(udp + 4, UDP_HEADER_SIZE + record->mSize);
+	// a UDP checksum of 0 means none was computed
+}
+
+void (*LLMessageLog::sCallback)(const LLMessageLogEntry&) = NULL;
+U8* LLMessageLog::sBuffer = NULL;
+U32 LLMessageLog::sCapacity = 0;
+U32 LLMessageLog::sHead = 0;
+U32 LLMessageLog::sTail = 0;
+U32 LLMessageLog::sWrap = 0;
+S32 LLMessageLog::sCount = 0;
+void LLMessageLog::setCaptureSize(U32 bytes)
+{
+	bytes -= bytes % RECORD_ALIGNMENT;
+	if(bytes == sCapacity) return;
+	delete[] sBuffer;
+	sBuffer = bytes ? new U8[bytes] : NULL;
+	sCapacity = bytes;
+	clear();
+}
+void LLMessageLog::setCallback(void (*callback)(const LLMessageLogEntry&))
 {
 	sCallback = callback;
 }
+void LLMessageLog::clear()
+{
+	sHead = 0;
+	sTail = 0;
+	sWrap = sCapacity;
+	sCount = 0;
+}
+U32 LLMessageLog::getRecordSize(U32 offset)
+{
+	const LLMessageLogRecord* record = (const LLMessageLogRecord*)(sBuffer + offset);
+	U32 size = sizeof(LLMessageLogRecord) + record->mSize;
+	return (size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+}
+U32 LLMessageLog::getNextRecord(U32 offset)
+{
+	offset += getRecordSize(offset);
+	return offset >= sWrap ? 0 : offset;
+}
+void LLMessageLog::removeOldest()
+{
+	sTail += getRecordSize(sTail);
+	if(sTail >= sWrap)
+	{
+		sTail = 0;
+		sWrap = sCapacity;
+	}
+	if(--sCount == 0)
+		clear();
+}
 void LLMessageLog::log(LLHost from_host, LLHost to_host, U8* data, S32 data_size)
 {
-	LLMessageLogEntry entry = LLMessageLogEntry(LLMessageLogEntry::TEMPLATE, from_host, to_host, data, data_size);
-	if(sCallback) sCallback(entry);
-	if(!sMaxSize) return;
-	sDeque.push_back(entry);
-	if(sDeque.size() > sMaxSize)
-		sDeque.pop_front();
+	U64 now = totalTime();
+	if(sCallback)
+	{
+		sCallback(LLMessageLogEntry(LLMessageLogEntry::TEMPLATE, from_host, to_host, data, data_size, now));
+	}
+	if(!sBuffer || !data || data_size <= 0) return;
+
+	U32 size = (sizeof(LLMessageLogRecord) + data_size + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+	if(size > sCapacity) return;
+	// While the head is behind the tail (or level with it and the buffer
+	// is full) the records from the tail to sWrap are the oldest ones.
+	if(sHead + size > sCapacity)
+	{
+		// No room before the end; drop whatever is left up there and wrap
+		while(sCount && sTail >= sHead)
+			removeOldest();
+		if(sCount)
+		{
+			sWrap = sHead;
+			sHead = 0;
+		}
+	}
+	while(sCount && sTail >= sHead && sTail < sHead + size)
+		removeOldest();
+
+	LLMessageLogRecord* record = (LLMessageLogRecord*)(sBuffer + sHead);
+	record->mTime = now;
+	record->mFromAddress = from_host.getAddress();
+	record->mToAddress = to_host.getAddress();
+	record->mFromPort = (U16)from_host.getPort();
+	record->mToPort = (U16)to_host.getPort();
+	record->mSize = data_size;
+	memcpy(record + 1, data, data_size);
+	sHead += size;
+	++sCount;
+}
+void LLMessageLog::getEntries(std::deque<LLMessageLogEntry>& entries)
+{
+	U32 offset = sTail;
+	for(S32 i = 0; i < sCount; ++i, offset = getNextRecord(offset))
+	{
+		const LLMessageLogRecord* record = (const LLMessageLogRecord*)(sBuffer + offset);
+		entries.push_back(LLMessageLogEntry(LLMessageLogEntry::TEMPLATE,
+			LLHost(record->mFromAddress, record->mFromPort),
+			LLHost(record->mToAddress, record->mToPort),
+			(U8*)(record + 1), record->mSize, record->mTime));
+	}
 }
-std::deque<LLMessageLogEntry> LLMessageLog::getDeque()
+BOOL LLMessageLog::saveCapture(const std::string& filename)
 {
-	return sDeque;
+	LLFILE* fp = LLFile::fopen(filename, "wb");
+	if(!fp)
+	{
+		llwarns << "Couldn't open " << filename << " to save the packet capture" << llendl;
+		return FALSE;
+	}
+	LLPcapFileHeader header = { PCAP_MAGIC, 2, 4, 0, 0, PCAP_SNAP_LENGTH, PCAP_LINKTYPE_RAW };
+	bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+	U8 ip_udp[IP_HEADER_SIZE + UDP_HEADER_SIZE];
+	U32 offset = sTail;
+	for(S32 i = 0; ok && i < sCount; ++i, offset = getNextRecord(offset))
+	{
+		const LLMessageLogRecord* record = (const LLMessageLogRecord*)(sBuffer + offset);
+		U32 length = sizeof(ip_udp) + record->mSize;
+		LLPcapRecordHeader record_header = { (U32)(record->mTime / 1000000), (U32)(record->mTime % 1000000), length, length };
+		write_ip_udp_header(ip_udp, record);
+		ok = fwrite(&record_header, sizeof(record_header), 1, fp) == 1
+			&& fwrite(ip_udp, sizeof(ip_udp), 1, fp) == 1
+			&& fwrite(record + 1, record->mSize, 1, fp) == 1;
+	}
+	fclose(fp);
+	if(!ok)
+	{
+		llwarns << "Error writing packet capture " << filename << llendl;
+		return FALSE;
+	}
+	llinfos << "Saved " << sCount << " packets to " << filename << llendl;
+	return TRUE;
+}
+BOOL LLMessageLog::loadCapture(const std::string& filename, std::deque<LLMessageLogEntry>& entries)
+{
+	LLFILE* fp = LLFile::fopen(filename, "rb");
+	if(!fp)
+	{
+		llwarns << "Couldn't open packet capture " << filename << llendl;
+		return FALSE;
+	}
+	LLPcapFileHeader header;
+	if(fread(&header, sizeof(header), 1, fp) != 1
+		|| (header.mMagic != PCAP_MAGIC && header.mMagic != PCAP_MAGIC_SWAPPED))
+	{
+		llwarns << filename << " is not a pcap file" << llendl;
+		fclose(fp);
+		return FALSE;
+	}
+	bool swapped = header.mMagic == PCAP_MAGIC_SWAPPED;
+	if(swap_u32(header.mLinkType, swapped) != PCAP_LINKTYPE_RAW)
+	{
+		llwarns << filename << " does not hold raw IP packets" << llendl;
+		fclose(fp);
+		return FALSE;
+	}
+
+	std::vector<U8> packet(PCAP_SNAP_LENGTH);
+	LLPcapRecordHeader record_header;
+	BOOL ok = TRUE;
+	while(fread(&record_header, sizeof(record_header), 1, fp) == 1)
+	{
+		U32 length = swap_u32(record_header.mIncludedLength, swapped);
+		if(length > packet.size() || (length && fread(&packet[0], length, 1, fp) != 1))
+		{
+			llwarns << "Packet capture " << filename << " is truncated or damaged" << llendl;
+			ok = FALSE;
+			break;
+		}
+		if(length < (U32)(IP_HEADER_SIZE + UDP_HEADER_SIZE)
+			|| (packet[0] >> 4) != 4
+			|| packet[9] != IP_PROTOCOL_UDP)
+		{
+			continue;
+		}
+		S32 ip_header_size = (packet[0] & 0x0f) * 4;
+		if(ip_header_size < IP_HEADER_SIZE || (S32)length < ip_header_size + UDP_HEADER_SIZE)
+		{
+			continue;
+		}
+		U8* udp = &packet[ip_header_size];
+		S32 data_size = llmin((S32)get_u16(udp + 4), (S32)length - ip_header_size) - UDP_HEADER_SIZE;
+		if(data_size <= 0)
+		{
+			continue;
+		}
+		U32 from_address, to_address;
+		memcpy(&from_address, &packet[12], 4);
+		memcpy(&to_address, &packet[16], 4);
+		U64 time = (U64)swap_u32(record_header.mSeconds, swapped) * 1000000 + swap_u32(record_header.mMicroseconds, swapped);
+		entries.push_back(LLMessageLogEntry(LLMessageLogEntry::TEMPLATE,
+			LLHost(from_address, get_u16(udp)),
+			LLHost(to_address, get_u16(udp + 2)),
+			udp + UDP_HEADER_SIZE, data_size, time));
+	}
+	fclose(fp);
+	return ok;
 }
 // </edit>
@@ -3,7 +3,8 @@
 #define LL_LLMESSAGELOG_H
 #include "stdtypes.h"
 #include "llhost.h"
-#include <queue>
+#include <deque>
+#include <string>
 #include <string.h>
 
 class LLMessageSystem;
@@ -16,25 +17,53 @@ public:
 		HTTP_REQUEST,
 		HTTP_RESPONSE
 	};
-	LLMessageLogEntry(EType type, LLHost from_host, LLHost to_host, U8* data, S32 data_size);
+	LLMessageLogEntry(EType type, LLHost from_host, LLHost to_host, U8* data, S32 data_size, U64 time = 0);
+	LLMessageLogEntry(const LLMessageLogEntry& entry);
 	~LLMessageLogEntry();
+	LLMessageLogEntry& operator=(const LLMessageLogEntry& entry);
 	EType mType;
 	LLHost mFromHost;
 	LLHost mToHost;
 	S32 mDataSize;
 	U8* mData;
+	U64 mTime; // microseconds since the epoch
 };
+
+// Keeps the most recently received packets in a fixed size buffer that is
+// allocated once, so that logging a packet never allocates.  Records are
+// packed end to end and the oldest are overwritten as the buffer wraps.
+// The message system is only pumped from the main thread, so there is no
+// locking.
 class LLMessageLog
 {
 public:
-	static void setMaxSize(U32 size);
-	static void setCallback(void (*callback)(LLMessageLogEntry));
+	// Reallocates the capture buffer, dropping everything in it.  A size
+	// of 0 turns capturing off.
+	static void setCaptureSize(U32 bytes);
+	static U32 getCaptureSize() { return sCapacity; }
+	static void setCallback(void (*callback)(const LLMessageLogEntry&));
 	static void log(LLHost from_host, LLHost to_host, U8* data, S32 data_size);
-	static std::deque<LLMessageLogEntry> getDeque();
+	static S32 getEntryCount() { return sCount; }
+	// Appends copies of the captured packets to entries, oldest first.
+	static void getEntries(std::deque<LLMessageLogEntry>& entries);
+	static void clear();
+
+	// Captures are stored in pcap format with raw IPv4 link headers, so
+	// standard packet tools can open them.
+	static BOOL saveCapture(const std::string& filename);
+	static BOOL loadCapture(const std::string& filename, std::deque<LLMessageLogEntry>& entries);
 private:
-	static U32 sMaxSize;
-	static void (*sCallback)(LLMessageLogEntry);
-	static std::deque<LLMessageLogEntry> sDeque;
+	static U32 getRecordSize(U32 offset);
+	static U32 getNextRecord(U32 offset);
+	static void removeOldest();
+
+	static void (*sCallback)(const LLMessageLogEntry&);
+	static U8* sBuffer;
+	static U32 sCapacity;
+	static U32 sHead;	// where the next record is written
+	static U32 sTail;	// oldest record
+	static U32 sWrap;	// end of the records at the tail once the head has wrapped
+	static S32 sCount;
 };
 #endif
 // </edit>
@@ -0,0 +1,58 @@
+// <edit>
+#include "linden_common.h"
+#include "llmessagereplay.h"
+#include "message.h"
+#include "lltimer.h"
+#include <set>
+
+LLMessageReplay::LLMessageReplay()
+:	mValidCount(0),
+	mReplaySeconds(0.0)
+{
+}
+BOOL LLMessageReplay::load(const std::string& filename)
+{
+	mEntries.clear();
+	return LLMessageLog::loadCapture(filename, mEntries);
+}
+F64 LLMessageReplay::getCaptureSeconds() const
+{
+	if(mEntries.empty()) return 0.0;
+	return (F64)(mEntries.back().mTime - mEntries.front().mTime) * SEC_PER_USEC;
+}
+S32 LLMessageReplay::replay(LLMessageSystem* msg)
+{
+	mValidCount = 0;
+	mReplaySeconds = 0.0;
+	if(!msg || mEntries.empty()) return 0;
+
+	std::set<LLHost> circuits;
+	std::deque<LLMessageLogEntry>::iterator end = mEntries.end();
+	for(std::deque<LLMessageLogEntry>::iterator iter = mEntries.begin(); iter != end; ++iter)
+	{
+		if(iter->mType == LLMessageLogEntry::TEMPLATE && !msg->mCircuitInfo.findCircuit(iter->mFromHost))
+		{
+			msg->enableCircuit(iter->mFromHost, TRUE);
+			circuits.insert(iter->mFromHost);
+		}
+	}
+
+	LLTimer timer;
+	for(std::deque<LLMessageLogEntry>::iterator iter = mEntries.begin(); iter != end; ++iter)
+	{
+		if(iter->mType != LLMessageLogEntry::TEMPLATE) continue;
+		msg->mPacketRing.injectPacket((const char*)iter->mData, iter->mDataSize, iter->mFromHost);
+		while(msg->checkMessages())
+			++mValidCount;
+	}
+	mReplaySeconds = timer.getElapsedTimeF64();
+
+	// Dropping the circuits also drops the acks collected for them
+	for(std::set<LLHost>::iterator iter = circuits.begin(); iter != circuits.end(); ++iter)
+		msg->mCircuitInfo.removeCircuitData(*iter);
+
+	llinfos << "Replayed " << mEntries.size() << " packets (" << mValidCount << " valid) in "
+			<< mReplaySeconds << "s, captured over " << getCaptureSeconds() << "s" << llendl;
+	return mValidCount;
+}
+// </edit>
@@ -0,0 +1,32 @@
+// <edit>
+#ifndef LL_LLMESSAGEREPLAY_H
+#define LL_LLMESSAGEREPLAY_H
+#include "llmessagelog.h"
+
+class LLMessageSystem;
+
+// Feeds a packet capture saved by LLMessageLog back through
+// LLMessageSystem::checkMessages(), so that message decoding and the
+// registered handlers can be benchmarked reproducibly without a simulator.
+// Senders are given temporary trusted circuits for the length of the run;
+// nothing is sent back to them.
+class LLMessageReplay
+{
+public:
+	LLMessageReplay();
+	BOOL load(const std::string& filename);
+	// Replays the loaded packets in capture order as fast as they are
+	// handled, and returns the number that were accepted as valid messages.
+	S32 replay(LLMessageSystem* msg);
+	S32 getPacketCount() const { return (S32)mEntries.size(); }
+	S32 getValidCount() const { return mValidCount; }
+	F64 getReplaySeconds() const { return mReplaySeconds; }
+	// Span of the original capture
+	F64 getCaptureSeconds() const;
+private:
+	std::deque<LLMessageLogEntry> mEntries;
+	S32 mValidCount;
+	F64 mReplaySeconds;
+};
+#endif
+// </edit>
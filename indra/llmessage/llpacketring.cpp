@@ -63,7 +63,9 @@ LLPacketRing::LLPacketRing () :
 	mInBufferLength(0),
 	mOutBufferLength(0),
 	mDropPercentage(0.0f),
-	mPacketsToDrop(0x0)
+	mPacketsToDrop(0x0),
+	mInjectedData(NULL),
+	mInjectedSize(0)
 {
 }
 
@@ -124,6 +126,18 @@ void LLPacketRing::setOutBandwidth(const F32 bps)
 {
 	mOutThrottle.setRate(bps);
 }
+
+void LLPacketRing::injectPacket(const char* datap, S32 size, const LLHost& sender)
+{
+	if (size > NET_BUFFER_SIZE)
+	{
+		llwarns << "Not injecting packet of size " << size << llendl;
+		return;
+	}
+	mInjectedData = datap;
+	mInjectedSize = size;
+	mInjectedSender = sender;
+}
 ///////////////////////////////////////////////////////////
 S32 LLPacketRing::receiveFromRing (S32 socket, char *datap)
 {
@@ -166,6 +180,17 @@ S32 LLPacketRing::receivePacket (S32 socket, char *datap)
 {
 	S32 packet_size = 0;
 
+	if (mInjectedData)
+	{
+		// replayed packets bypass the throttle and packet loss simulation
+		packet_size = mInjectedSize;
+		memcpy(datap, mInjectedData, packet_size);	/*Flawfinder: ignore*/
+		mLastSender = mInjectedSender;
+		mLastReceivingIF = LLHost();
+		mInjectedData = NULL;
+		return packet_size;
+	}
+
 	// If using the throttle, simulate a limited size input buffer.
 	if (mUseInThrottle)
 	{
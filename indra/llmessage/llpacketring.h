@@ -61,6 +61,10 @@ public:
 
 	BOOL sendPacket(int h_socket, char * send_buffer, S32 buf_size, LLHost host);
 
+	// Makes the next receivePacket() return this packet instead of reading
+	// the socket.  datap is not copied and must stay valid until then.
+	void injectPacket(const char* datap, S32 size, const LLHost& sender);
+
 	inline LLHost getLastSender();
 	inline LLHost getLastReceivingInterface();
 
@@ -89,6 +93,10 @@ protected:
 	LLHost mLastSender;
 	LLHost mLastReceivingIF;
 
+	const char* mInjectedData;
+	S32 mInjectedSize;
+	LLHost mInjectedSender;
+
 	BOOL doSendPacket(int h_socket, const char * send_buffer, S32 buf_size, LLHost host);
 	U8	 mProxyWrappedSendBuffer[NET_BUFFER_SIZE];
 };
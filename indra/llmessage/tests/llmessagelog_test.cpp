@@ -0,0 +1,200 @@
+/**
+ * @file llmessagelog_test.cpp
+ * @brief LLMessageLog capture buffer and pcap file unit tests
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ *
+ * Copyright (c) 2010, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "llmessagelog.h"
+#include "../test/lltut.h"
+
+#include "llfile.h"
+#include "llhost.cpp" // LLHost is a value type for test purposes.
+#include "net.cpp" // Needed by LLHost.
+
+namespace tut
+{
+	struct LLMessageLogData
+	{
+		LLMessageLogData()
+		:	mFrom(0x0100007f, 12035),
+			mTo(0x0200007f, 13000)
+		{
+		}
+
+		~LLMessageLogData()
+		{
+			LLMessageLog::setCaptureSize(0);
+		}
+
+		// Packet n is n % 300 + 1 bytes long and filled with n
+		void logPacket(S32 n)
+		{
+			U8 data[300];
+			S32 size = n % 300 + 1;
+			memset(data, (U8)n, size);
+			LLMessageLog::log(mFrom, mTo, data, size);
+		}
+
+		void ensurePacket(const LLMessageLogEntry& entry, S32 n)
+		{
+			ensure_equals("packet size", entry.mDataSize, n % 300 + 1);
+			for (S32 i = 0; i < entry.mDataSize; ++i)
+			{
+				ensure_equals("packet data", (S32)entry.mData[i], n & 0xff);
+			}
+		}
+
+		LLHost mFrom;
+		LLHost mTo;
+	};
+
+	typedef test_group<LLMessageLogData> factory;
+	typedef factory::object object;
+}
+
+namespace
+{
+	tut::factory tf("LLMessageLog test");
+}
+
+namespace tut
+{
+	// nothing is kept while capturing is off
+	template<> template<>
+	void object::test<1>()
+	{
+		LLMessageLog::setCaptureSize(0);
+		logPacket(10);
+		std::deque<LLMessageLogEntry> entries;
+		LLMessageLog::getEntries(entries);
+		ensure_equals(LLMessageLog::getEntryCount(), 0);
+		ensure(entries.empty());
+	}
+
+	// packets come back whole and in order until the buffer fills
+	template<> template<>
+	void object::test<2>()
+	{
+		LLMessageLog::setCaptureSize(64 * 1024);
+		for (S32 n = 0; n < 20; ++n)
+		{
+			logPacket(n);
+		}
+		std::deque<LLMessageLogEntry> entries;
+		LLMessageLog::getEntries(entries);
+		ensure_equals((S32)entries.size(), 20);
+		for (S32 n = 0; n < 20; ++n)
+		{
+			ensurePacket(entries[n], n);
+			ensure("from host", entries[n].mFromHost == mFrom);
+			ensure("to host", entries[n].mToHost == mTo);
+		}
+	}
+
+	// once it wraps, the buffer holds the newest packets in order, and
+	// only what fits
+	template<> template<>
+	void object::test<3>()
+	{
+		const U32 capacity = 4096;
+		LLMessageLog::setCaptureSize(capacity);
+		for (S32 n = 0; n < 5000; ++n)
+		{
+			logPacket(n * 37);
+
+			std::deque<LLMessageLogEntry> entries;
+			LLMessageLog::getEntries(entries);
+			ensure_equals("entry count", (S32)entries.size(), LLMessageLog::getEntryCount());
+			ensure("latest packet kept", !entries.empty());
+			U32 bytes = 0;
+			for (S32 i = 0; i < (S32)entries.size(); ++i)
+			{
+				ensurePacket(entries[i], (n - (S32)entries.size() + 1 + i) * 37);
+				bytes += entries[i].mDataSize;
+			}
+			ensure("within capacity", bytes < capacity);
+		}
+	}
+
+	// packets larger than the whole buffer are skipped
+	template<> template<>
+	void object::test<4>()
+	{
+		LLMessageLog::setCaptureSize(256);
+		logPacket(1);
+		logPacket(299);
+		std::deque<LLMessageLogEntry> entries;
+		LLMessageLog::getEntries(entries);
+		ensure_equals((S32)entries.size(), 1);
+		ensurePacket(entries[0], 1);
+	}
+
+	// captures survive a round trip through a pcap file
+	template<> template<>
+	void object::test<5>()
+	{
+		LLMessageLog::setCaptureSize(64 * 1024);
+		for (S32 n = 0; n < 50; ++n)
+		{
+			logPacket(n * 7);
+		}
+		std::deque<LLMessageLogEntry> captured;
+		LLMessageLog::getEntries(captured);
+
+		std::string filename = std::string(LLFile::tmpdir()) + "llmessagelog_test.pcap";
+		ensure("saved", LLMessageLog::saveCapture(filename));
+		std::deque<LLMessageLogEntry> loaded;
+		ensure("loaded", LLMessageLog::loadCapture(filename, loaded));
+		LLFile::remove(filename);
+
+		ensure_equals((S32)loaded.size(), (S32)captured.size());
+		for (S32 i = 0; i < (S32)loaded.size(); ++i)
+		{
+			ensurePacket(loaded[i], i * 7);
+			ensure("from host", loaded[i].mFromHost == mFrom);
+			ensure("to host", loaded[i].mToHost == mTo);
+			ensure_equals("time", loaded[i].mTime, captured[i].mTime);
+		}
+	}
+
+	// entries own their data
+	template<> template<>
+	void object::test<6>()
+	{
+		U8 data[4] = { 1, 2, 3, 4 };
+		LLMessageLogEntry entry(LLMessageLogEntry::TEMPLATE, mFrom, mTo, data, 4);
+		LLMessageLogEntry copy(entry);
+		data[0] = 9;
+		entry = copy;
+		ensure("copied data", copy.mData != entry.mData);
+		ensure_equals((S32)entry.mData[0], 1);
+		ensure_equals((S32)copy.mData[3], 4);
+	}
+}
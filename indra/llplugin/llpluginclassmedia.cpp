@@ -120,7 +120,7 @@ void LLPluginClassMedia::reset()
 	mTextureHeight = 0;
 	mMediaWidth = 0;
 	mMediaHeight = 0;
-	mDirtyRect = LLRect::null;	
+	mDirtyTiles.clear();
 	mAutoScaleMedia = false;
 	mRequestedVolume = 1.0f;
 	mPriority = PRIORITY_NORMAL;
@@ -403,19 +403,24 @@ bool LLPluginClassMedia::textureValid(void)
 
 bool LLPluginClassMedia::getDirty(LLRect *dirty_rect)
 {
-	bool result = !mDirtyRect.isEmpty();
+	bool result = mDirtyTiles.isDirty();
 
 	if(dirty_rect != NULL)
 	{
-		*dirty_rect = mDirtyRect;
+		*dirty_rect = mDirtyTiles.getBounds();
 	}
 
 	return result;
 }
 
+void LLPluginClassMedia::getDirtyRects(std::vector<LLRect> &dirty_rects)
+{
+	mDirtyTiles.getRects(dirty_rects, mTextureWidth, mTextureHeight);
+}
+
 void LLPluginClassMedia::resetDirty(void)
 {
-	mDirtyRect = LLRect::null;
+	mDirtyTiles.clear();
 }
 
 std::string LLPluginClassMedia::translateModifiers(MASK modifiers)
@@ -836,24 +841,18 @@ void LLPluginClassMedia::receivePluginMessage(const LLPluginMessage &message)
 					newDirtyRect.mBottom = temp;
 				}
 				
-				if(mDirtyRect.isEmpty())
-				{
-					mDirtyRect = newDirtyRect;
-				}
-				else
-				{
-					mDirtyRect.unionWith(newDirtyRect);
-				}
+				mDirtyTiles.markDirty(newDirtyRect);
 
 				LL_DEBUGS("Plugin") << "adjusted incoming rect is: (" 
 					<< newDirtyRect.mLeft << ", "
 					<< newDirtyRect.mTop << ", "
 					<< newDirtyRect.mRight << ", "
-					<< newDirtyRect.mBottom << "), new dirty rect is: ("
-					<< mDirtyRect.mLeft << ", "
-					<< mDirtyRect.mTop << ", "
-					<< mDirtyRect.mRight << ", "
-					<< mDirtyRect.mBottom << ")"
+					<< newDirtyRect.mBottom << "), new dirty bounds are: ("
+					<< mDirtyTiles.getBounds().mLeft << ", "
+					<< mDirtyTiles.getBounds().mTop << ", "
+					<< mDirtyTiles.getBounds().mRight << ", "
+					<< mDirtyTiles.getBounds().mBottom << "), "
+					<< mDirtyTiles.getDirtyTileCount() << " dirty tiles"
 					<< LL_ENDL;
 				
 				mediaEvent(LLPluginClassMediaOwner::MEDIA_EVENT_CONTENT_UPDATED);
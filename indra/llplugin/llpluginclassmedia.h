@@ -31,6 +31,7 @@
 
 #include "llgltypes.h"
 #include "llpluginprocessparent.h"
+#include "llplugindirtytiles.h"
 #include "llrect.h"
 #include "llpluginclassmediaowner.h"
 #include <queue>
@@ -97,6 +98,10 @@ public:
 	bool getDirty(LLRect *dirty_rect = NULL);
 	void resetDirty(void);
 	
+	// Appends the dirty parts of the texture as a set of non-overlapping rects, clipped to the texture size.
+	// This is usually much less than the single rect returned by getDirty().
+	void getDirtyRects(std::vector<LLRect> &dirty_rects);
+	
 	typedef enum 
 	{
 		MOUSE_EVENT_DOWN,
@@ -347,7 +352,7 @@ protected:
 	
 	LLPluginProcessParent *mPlugin;
 	
-	LLRect mDirtyRect;
+	LLPluginDirtyTiles mDirtyTiles;
 	
 	std::string translateModifiers(MASK modifiers);
 	
@@ -0,0 +1,191 @@
+/** 
+ * @file llplugindirtytiles.cpp
+ * @brief LLPluginDirtyTiles tracks which tiles of a plugin's texture have been updated since the last upload.
+ *
+ * @cond
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ * @endcond
+ */
+
+
+#include "linden_common.h"
+
+#include "llplugindirtytiles.h"
+
+const S32 LLPluginDirtyTiles::TILE_SIZE;
+const S32 LLPluginDirtyTiles::MAX_SIZE;
+
+LLPluginDirtyTiles::LLPluginDirtyTiles() :
+	mTilesWide(0),
+	mTilesHigh(0),
+	mDirtyCount(0),
+	mBounds(LLRect::null)
+{
+}
+
+void LLPluginDirtyTiles::markDirty(const LLRect &rect)
+{
+	S32 left = llmax(rect.mLeft, 0);
+	S32 bottom = llmax(rect.mBottom, 0);
+	S32 right = llmin(rect.mRight, MAX_SIZE);
+	S32 top = llmin(rect.mTop, MAX_SIZE);
+	if(right <= left || top <= bottom)
+	{
+		return;
+	}
+	
+	if(mDirtyCount == 0)
+	{
+		mBounds.set(left, top, right, bottom);
+	}
+	else
+	{
+		mBounds.unionWith(LLRect(left, top, right, bottom));
+	}
+	
+	S32 tile_left = left / TILE_SIZE;
+	S32 tile_bottom = bottom / TILE_SIZE;
+	S32 tile_right = (right + TILE_SIZE - 1) / TILE_SIZE;
+	S32 tile_top = (top + TILE_SIZE - 1) / TILE_SIZE;
+	
+	// The grid grows on demand, since updates can arrive before the plugin has told us its final texture size.
+	grow(tile_right, tile_top);
+	
+	for(S32 y = tile_bottom; y < tile_top; y++)
+	{
+		U8 *row = &mTiles[y * mTilesWide];
+		for(S32 x = tile_left; x < tile_right; x++)
+		{
+			if(!row[x])
+			{
+				row[x] = 1;
+				mDirtyCount++;
+			}
+		}
+	}
+}
+
+void LLPluginDirtyTiles::clear(void)
+{
+	if(mDirtyCount > 0)
+	{
+		std::fill(mTiles.begin(), mTiles.end(), 0);
+		mDirtyCount = 0;
+	}
+	mBounds = LLRect::null;
+}
+
+void LLPluginDirtyTiles::getRects(std::vector<LLRect> &rects, S32 width, S32 height) const
+{
+	if(mDirtyCount == 0)
+	{
+		return;
+	}
+	
+	S32 clip_left = mBounds.mLeft;
+	S32 clip_bottom = mBounds.mBottom;
+	S32 clip_right = llmin(mBounds.mRight, width);
+	S32 clip_top = llmin(mBounds.mTop, height);
+	if(clip_right <= clip_left || clip_top <= clip_bottom)
+	{
+		return;
+	}
+	
+	// Indices into rects of the runs emitted for the previous tile row, for merging vertically.
+	std::vector<size_t> open_rects, next_open_rects;
+	
+	for(S32 y = 0; y < mTilesHigh; y++)
+	{
+		S32 row_bottom = llmax(y * TILE_SIZE, clip_bottom);
+		S32 row_top = llmin((y + 1) * TILE_SIZE, clip_top);
+		if(row_top <= row_bottom)
+		{
+			open_rects.clear();
+			continue;
+		}
+		
+		next_open_rects.clear();
+		const U8 *row = &mTiles[y * mTilesWide];
+		S32 x = 0;
+		while(x < mTilesWide)
+		{
+			if(!row[x])
+			{
+				x++;
+				continue;
+			}
+			
+			S32 run_start = x;
+			while(x < mTilesWide && row[x])
+			{
+				x++;
+			}
+			
+			S32 run_left = llmax(run_start * TILE_SIZE, clip_left);
+			S32 run_right = llmin(x * TILE_SIZE, clip_right);
+			if(run_right <= run_left)
+			{
+				continue;
+			}
+			
+			// Extend a run from the row below if it covers exactly the same columns.
+			bool merged = false;
+			for(size_t i = 0; i < open_rects.size(); i++)
+			{
+				LLRect &below = rects[open_rects[i]];
+				if(below.mLeft == run_left && below.mRight == run_right && below.mTop == row_bottom)
+				{
+					below.mTop = row_top;
+					next_open_rects.push_back(open_rects[i]);
+					merged = true;
+					break;
+				}
+			}
+			
+			if(!merged)
+			{
+				next_open_rects.push_back(rects.size());
+				rects.push_back(LLRect(run_left, row_top, run_right, row_bottom));
+			}
+		}
+		open_rects.swap(next_open_rects);
+	}
+}
+
+void LLPluginDirtyTiles::grow(S32 tiles_wide, S32 tiles_high)
+{
+	if(tiles_wide <= mTilesWide && tiles_high <= mTilesHigh)
+	{
+		return;
+	}
+	
+	S32 new_wide = llmax(tiles_wide, mTilesWide);
+	S32 new_high = llmax(tiles_high, mTilesHigh);
+	std::vector<U8> tiles(new_wide * new_high, 0);
+	for(S32 y = 0; y < mTilesHigh; y++)
+	{
+		std::copy(mTiles.begin() + y * mTilesWide, mTiles.begin() + (y + 1) * mTilesWide, tiles.begin() + y * new_wide);
+	}
+	mTiles.swap(tiles);
+	mTilesWide = new_wide;
+	mTilesHigh = new_high;
+}
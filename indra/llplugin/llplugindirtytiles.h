@@ -0,0 +1,78 @@
+/** 
+ * @file llplugindirtytiles.h
+ * @brief LLPluginDirtyTiles tracks which tiles of a plugin's texture have been updated since the last upload.
+ *
+ * @cond
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ * @endcond
+ */
+
+
+#ifndef LL_LLPLUGINDIRTYTILES_H
+#define LL_LLPLUGINDIRTYTILES_H
+
+#include "llrect.h"
+#include <vector>
+
+/**
+ * @brief LLPluginDirtyTiles records the regions of a media texture that a plugin has updated, at tile granularity.
+ *
+ * A single union rect grows to cover everything between two small updates at opposite corners (a blinking
+ * cursor and a clock, say), so the whole frame ends up being re-uploaded.  Keeping a grid of dirty tiles lets
+ * the uploader send only the parts that actually changed.
+ */
+class LLPluginDirtyTiles
+{
+public:
+	// Tile edge, in pixels.
+	static const S32 TILE_SIZE = 64;
+	// Anything past this is clipped off, so a bogus rect from a plugin can't blow up the grid.
+	static const S32 MAX_SIZE = 8192;
+	
+	LLPluginDirtyTiles();
+	
+	// Marks every tile touched by rect (pixel coordinates, mTop > mBottom) as dirty.
+	void markDirty(const LLRect &rect);
+	void clear(void);
+	
+	bool isDirty(void) const { return mDirtyCount > 0; };
+	
+	// Union of all rects marked since the last clear().
+	const LLRect &getBounds(void) const { return mBounds; };
+	
+	S32 getDirtyTileCount(void) const { return mDirtyCount; };
+	
+	// Appends the dirty region as rects clipped to the marked bounds and to width x height.
+	// Runs of adjacent dirty tiles in a row are merged, as are identical runs in consecutive rows.
+	void getRects(std::vector<LLRect> &rects, S32 width, S32 height) const;
+	
+private:
+	void grow(S32 tiles_wide, S32 tiles_high);
+	
+	std::vector<U8> mTiles;
+	S32 mTilesWide;
+	S32 mTilesHigh;
+	S32 mDirtyCount;
+	LLRect mBounds;
+};
+
+#endif // LL_LLPLUGINDIRTYTILES_H
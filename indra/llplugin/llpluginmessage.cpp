@@ -30,6 +30,7 @@
 
 #include "llpluginmessage.h"
 #include "llsdserialize.h"
+#include "llmemorystream.h"
 #include "u64.h"
 
 /**
@@ -364,19 +365,71 @@ std::string LLPluginMessage::generate(void) const
 	return result.str();
 }
 
+/**
+ * Flatten the message into binary LLSD. This is several times smaller and faster to produce and parse than the
+ * pretty-printed XML, at the cost of not being human-readable.
+ *
+ * @return Binary serialized message.
+ */
+std::string LLPluginMessage::generateBinary(void) const
+{
+	std::ostringstream result;
+	
+	LLSDSerialize::toBinary(mMessage, result);
+	
+	return result.str();
+}
+
+/**
+ * Checks which flattened form a message is in.
+ *
+ * @return Returns true if the message was produced by generateBinary().
+ */
+bool LLPluginMessage::isBinary(const std::string &message)
+{
+	return isBinary(message.data(), message.size());
+}
+
+bool LLPluginMessage::isBinary(const char *data, size_t size)
+{
+	// A binary LLSD map always starts with '{', while the XML form starts with '<' (possibly after whitespace).
+	return (size > 0) && (data[0] == '{');
+}
+
 /**
  *	Parse an incoming message into component parts. Clears all existing state before starting the parse.
  *
  * @return Returns -1 on failure, otherwise returns the number of key/value pairs in the incoming message.
  */
 int LLPluginMessage::parse(const std::string &message)
+{
+	return parse(message.data(), message.size());
+}
+
+/**
+ *	Parse an incoming message directly out of a buffer. Clears all existing state before starting the parse.
+ *
+ * @param[in] data Start of the flattened message, in either the XML or the binary form.
+ * @param[in] size Number of bytes in the flattened message.
+ * @return Returns -1 on failure, otherwise returns the number of key/value pairs in the incoming message.
+ */
+int LLPluginMessage::parse(const char *data, size_t size)
 {
 	// clear any previous state
 	clear();
 
-	std::istringstream input(message);
+	// Read straight out of the caller's buffer rather than copying it into a std::istringstream first.
+	LLMemoryStream input((const U8*)data, (S32)size);
 	
-	S32 parse_result = LLSDSerialize::fromXML(mMessage, input);
+	S32 parse_result;
+	if(isBinary(data, size))
+	{
+		parse_result = LLSDSerialize::fromBinary(mMessage, input, (S32)size);
+	}
+	else
+	{
+		parse_result = LLSDSerialize::fromXML(mMessage, input);
+	}
 	
 	return (int)parse_result;
 }
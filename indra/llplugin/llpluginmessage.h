@@ -88,10 +88,22 @@ public:
 	// Flatten the message into a string
 	std::string generate(void) const;
 
+	// Flatten the message into compact binary LLSD.  Only used on the parent<->child socket once both ends have agreed to it;
+	// plugins themselves always see the XML form produced by generate().
+	std::string generateBinary(void) const;
+
+	// Returns true if the flattened message was produced by generateBinary() rather than generate().
+	static bool isBinary(const std::string &message);
+	static bool isBinary(const char *data, size_t size);
+
 	// Parse an incoming message into component parts
 	// (this clears out all existing state before starting the parse)
+	// Either flattened form is accepted.
 	// Returns -1 on failure, otherwise returns the number of key/value pairs in the message.
 	int parse(const std::string &message);
+
+	// Same as above, but parses directly out of a caller-owned buffer without copying it.
+	int parse(const char *data, size_t size);
 	
 	
 private:
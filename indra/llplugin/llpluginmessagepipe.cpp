@@ -35,6 +35,12 @@
 
 static const char MESSAGE_DELIMITER = '\0';
 
+// Binary messages can contain NULs, so instead of being delimited they are sent as
+// a marker byte followed by a 4-byte big-endian payload length and then the payload.
+// The marker can never start a text message, so both kinds can be mixed freely on one pipe.
+static const char MESSAGE_BINARY_MARKER = '\x01';
+static const size_t MESSAGE_BINARY_HEADER_SIZE = 5;
+
 LLPluginMessagePipeOwner::LLPluginMessagePipeOwner() :
 	mMessagePipe(NULL),
 	mSocketError(APR_SUCCESS)
@@ -66,16 +72,16 @@ bool LLPluginMessagePipeOwner::canSendMessage(void)
 	return (mMessagePipe != NULL);
 }
 
-bool LLPluginMessagePipeOwner::writeMessageRaw(const std::string &message)
+bool LLPluginMessagePipeOwner::writeMessageRaw(const std::string &message, bool binary)
 {
 	bool result = true;
 	if(mMessagePipe != NULL)
 	{
-		result = mMessagePipe->addMessage(message);
+		result = mMessagePipe->addMessage(message, binary);
 	}
 	else
 	{
-		LL_WARNS("Plugin") << "dropping message: " << message << LL_ENDL;
+		LL_WARNS("Plugin") << "dropping " << (binary ? "binary " : "") << "message of " << message.size() << " bytes" << LL_ENDL;
 		result = false;
 	}
 	
@@ -92,6 +98,7 @@ void LLPluginMessagePipeOwner::killMessagePipe(void)
 }
 
 LLPluginMessagePipe::LLPluginMessagePipe(LLPluginMessagePipeOwner *owner, LLSocket::ptr_t socket):
+	mInputOffset(0),
 	mOwner(owner),
 	mSocket(socket)
 {
@@ -107,12 +114,27 @@ LLPluginMessagePipe::~LLPluginMessagePipe()
 	}
 }
 
-bool LLPluginMessagePipe::addMessage(const std::string &message)
+bool LLPluginMessagePipe::addMessage(const std::string &message, bool binary)
 {
 	// queue the message for later output
 	LLMutexLock lock(&mOutputMutex);
-	mOutput += message;
-	mOutput += MESSAGE_DELIMITER;	// message separator
+	if(binary)
+	{
+		U32 size = (U32)message.size();
+		char header[MESSAGE_BINARY_HEADER_SIZE];
+		header[0] = MESSAGE_BINARY_MARKER;
+		header[1] = (char)((size >> 24) & 0xFF);
+		header[2] = (char)((size >> 16) & 0xFF);
+		header[3] = (char)((size >> 8) & 0xFF);
+		header[4] = (char)(size & 0xFF);
+		mOutput.append(header, MESSAGE_BINARY_HEADER_SIZE);
+		mOutput += message;
+	}
+	else
+	{
+		mOutput += message;
+		mOutput += MESSAGE_DELIMITER;	// message separator
+	}
 	
 	return true;
 }
@@ -185,13 +207,13 @@ bool LLPluginMessagePipe::pumpOutput()
 			if(status == APR_SUCCESS)
 			{
 				// success
-				mOutput = mOutput.substr(size);
+				mOutput.erase(0, size);
 			}
 			else if(APR_STATUS_IS_EAGAIN(status))
 			{
 				// Socket buffer is full... 
 				// remove the written part from the buffer and try again later.
-				mOutput = mOutput.substr(size);
+				mOutput.erase(0, size);
 			}
 			else if(APR_STATUS_IS_EOF(status))
 			{
@@ -247,7 +269,7 @@ bool LLPluginMessagePipe::pumpInput(F64 timeout)
 		// Check for incoming messages
 		if(result)
 		{
-			char input_buf[1024];
+			char input_buf[8192];
 			apr_size_t request_size;
 			
 			if(timeout == 0.0f)
@@ -351,19 +373,56 @@ bool LLPluginMessagePipe::pumpInput(F64 timeout)
 
 void LLPluginMessagePipe::processInput(void)
 {
-	// Look for input delimiter(s) in the input buffer.
-	int delim;
+	// Look for complete messages in the input buffer.
+	// Consumed messages are skipped over with mInputOffset and the buffer is compacted once at the end,
+	// rather than erasing the front of mInput for every message.
+	std::string message;
 	mInputMutex.lock();
-	while((delim = mInput.find(MESSAGE_DELIMITER)) != std::string::npos)
-	{	
+	while(mInputOffset < mInput.size())
+	{
+		const char *start = mInput.data() + mInputOffset;
+		size_t available = mInput.size() - mInputOffset;
+		size_t consumed;
+		
+		if(start[0] == MESSAGE_BINARY_MARKER)
+		{
+			if(available < MESSAGE_BINARY_HEADER_SIZE)
+			{
+				// Header hasn't fully arrived yet.
+				break;
+			}
+			
+			const U8 *header = (const U8*)start;
+			size_t size = ((size_t)header[1] << 24) | ((size_t)header[2] << 16) | ((size_t)header[3] << 8) | (size_t)header[4];
+			if(available < MESSAGE_BINARY_HEADER_SIZE + size)
+			{
+				// Payload hasn't fully arrived yet.
+				break;
+			}
+			
+			message.assign(start + MESSAGE_BINARY_HEADER_SIZE, size);
+			consumed = MESSAGE_BINARY_HEADER_SIZE + size;
+		}
+		else
+		{
+			size_t delim = mInput.find(MESSAGE_DELIMITER, mInputOffset);
+			if(delim == std::string::npos)
+			{
+				break;
+			}
+			
+			message.assign(start, delim - mInputOffset);
+			consumed = delim - mInputOffset + 1;
+		}
+		
+		// Pull the message out of the input buffer before calling receiveMessageRaw.
+		// It's now possible for this function to get called recursively (in the case where the plugin makes a blocking request)
+		// and this guarantees that the messages will get dequeued correctly.
+		mInputOffset += consumed;
+		
 		// Let the owner process this message
 		if (mOwner)
 		{
-			// Pull the message out of the input buffer before calling receiveMessageRaw.
-			// It's now possible for this function to get called recursively (in the case where the plugin makes a blocking request)
-			// and this guarantees that the messages will get dequeued correctly.
-			std::string message(mInput, 0, delim);
-			mInput.erase(0, delim + 1);
 			mInputMutex.unlock();
 			mOwner->receiveMessageRaw(message);
 			mInputMutex.lock();
@@ -373,6 +432,12 @@ void LLPluginMessagePipe::processInput(void)
 			LL_WARNS("Plugin") << "!mOwner" << LL_ENDL;
 		}
 	}
+	
+	if(mInputOffset > 0)
+	{
+		mInput.erase(0, mInputOffset);
+		mInputOffset = 0;
+	}
 	mInputMutex.unlock();
 }
 
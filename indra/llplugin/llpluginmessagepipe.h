@@ -53,7 +53,8 @@ protected:
 	// returns false if writeMessageRaw() would drop the message
 	bool canSendMessage(void);
 	// call this to send a message over the pipe
-	bool writeMessageRaw(const std::string &message);
+	// Pass binary = true for messages produced by LLPluginMessage::generateBinary(), which may contain embedded NULs.
+	bool writeMessageRaw(const std::string &message, bool binary = false);
 	// call this to close the pipe
 	void killMessagePipe(void);
 	
@@ -68,7 +69,7 @@ public:
 	LLPluginMessagePipe(LLPluginMessagePipeOwner *owner, LLSocket::ptr_t socket);
 	virtual ~LLPluginMessagePipe();
 	
-	bool addMessage(const std::string &message);
+	bool addMessage(const std::string &message, bool binary = false);
 	void clearOwner(void);
 	
 	bool pump(F64 timeout = 0.0f);
@@ -83,6 +84,7 @@ protected:
 	
 	LLMutex mInputMutex;
 	std::string mInput;
+	size_t mInputOffset;	// start of the first unprocessed byte in mInput
 	LLMutex mOutputMutex;
 	std::string mOutput;
 
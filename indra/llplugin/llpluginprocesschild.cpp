@@ -45,6 +45,7 @@ LLPluginProcessChild::LLPluginProcessChild()
 	mCPUElapsed = 0.0f;
 	mBlockingRequest = false;
 	mBlockingResponseReceived = false;
+	mBinaryMessages = false;
 }
 
 LLPluginProcessChild::~LLPluginProcessChild()
@@ -131,7 +132,12 @@ void LLPluginProcessChild::idle(void)
 			break;
 			
 			case STATE_CONNECTED:
-				sendMessageToParent(LLPluginMessage(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "hello"));
+				{
+					LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "hello");
+					// Tell the parent we can take binary messages.  It will confirm in load_plugin if it can too.
+					message.setValueBoolean("binary_messages", true);
+					sendMessageToParent(message);
+				}
 				setState(STATE_PLUGIN_LOADING);
 			break;
 						
@@ -300,23 +306,28 @@ void LLPluginProcessChild::sendMessageToPlugin(const LLPluginMessage &message)
 
 void LLPluginProcessChild::sendMessageToParent(const LLPluginMessage &message)
 {
-	std::string buffer = message.generate();
-
-	LL_DEBUGS("Plugin") << "Sending to parent: " << buffer << LL_ENDL;
+	LL_DEBUGS("Plugin") << "Sending to parent: " << message.generate() << LL_ENDL;
 
-	writeMessageRaw(buffer);
+	if(mBinaryMessages)
+	{
+		writeMessageRaw(message.generateBinary(), true);
+	}
+	else
+	{
+		writeMessageRaw(message.generate());
+	}
 }
 
 void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 {
 	// Incoming message from the TCP Socket
 
-	LL_DEBUGS("Plugin") << "Received from parent: " << message << LL_ENDL;
-
 	// Decode this message
 	LLPluginMessage parsed;
 	parsed.parse(message);
 
+	LL_DEBUGS("Plugin") << "Received from parent: " << parsed.generate() << LL_ENDL;
+
 	if(mBlockingRequest)
 	{
 		// We're blocking the plugin waiting for a response.
@@ -349,6 +360,11 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 			{
 				mPluginFile = parsed.getValue("file");
 				mPluginDir = parsed.getValue("dir");
+				if(parsed.hasValue("binary_messages"))
+				{
+					// The parent understands binary messages -- everything we send from here on uses them.
+					mBinaryMessages = parsed.getValueBoolean("binary_messages");
+				}
 			}
 			else if(message_name == "shm_add")
 			{
@@ -437,7 +453,15 @@ void LLPluginProcessChild::receiveMessageRaw(const std::string &message)
 	{
 		LLTimer elapsed;
 
-		mInstance->sendMessage(message);
+		// Plugins only ever see the XML form.
+		if(LLPluginMessage::isBinary(message))
+		{
+			mInstance->sendMessage(parsed.generate());
+		}
+		else
+		{
+			mInstance->sendMessage(message);
+		}
 
 		mCPUElapsed += elapsed.getElapsedTimeF64();
 	}
@@ -459,12 +483,12 @@ void LLPluginProcessChild::receivePluginMessage(const std::string &message)
 
 	// FIXME: how should we handle queueing here?
 	
+	// Decode this message
+	LLPluginMessage parsed;
+	parsed.parse(message);
+	
 	// Intercept certain base messages (responses to ones sent by this class)
 	{
-		// Decode this message
-		LLPluginMessage parsed;
-		parsed.parse(message);
-		
 		if(parsed.hasValue("blocking_request"))
 		{
 			mBlockingRequest = true;
@@ -526,7 +550,14 @@ void LLPluginProcessChild::receivePluginMessage(const std::string &message)
 	if(passMessage)
 	{
 		LL_DEBUGS("Plugin") << "Passing through to parent: " << message << LL_ENDL;
-		writeMessageRaw(message);
+		if(mBinaryMessages)
+		{
+			writeMessageRaw(parsed.generateBinary(), true);
+		}
+		else
+		{
+			writeMessageRaw(message);
+		}
 	}
 	
 	while(mBlockingRequest)
@@ -105,6 +105,7 @@ private:
 	F64		mCPUElapsed;
 	bool	mBlockingRequest;
 	bool	mBlockingResponseReceived;
+	bool	mBinaryMessages;	// true once the parent has agreed to binary messages in load_plugin
 	std::queue<std::string> mMessageQueue;
 	
 	void deliverQueuedMessages();
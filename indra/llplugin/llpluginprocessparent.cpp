@@ -95,6 +95,7 @@ LLPluginProcessParent::LLPluginProcessParent(LLPluginProcessParentOwner* owner)
 	mDebug = false;
 	mBlocked = false;
 	mPolledInput = false;
+	mBinaryMessages = false;
 	mPollFD.client_data = NULL;
 	mPollFDPool.create();
 
@@ -436,6 +437,11 @@ void LLPluginProcessParent::idle(void)
 					LLPluginMessage message(LLPLUGIN_MESSAGE_CLASS_INTERNAL, "load_plugin");
 					message.setValue("file", mPluginFile);
 					message.setValue("dir", mPluginDir);
+					if(mBinaryMessages)
+					{
+						// Let the child know we'll understand binary messages from here on.
+						message.setValueBoolean("binary_messages", true);
+					}
 					sendMessage(message);
 				}
 
@@ -562,9 +568,15 @@ void LLPluginProcessParent::sendMessage(const LLPluginMessage &message)
 		mHeartbeat.setTimerExpirySec(mPluginLockupTimeout);
 	}
 	
-	std::string buffer = message.generate();
-	LL_DEBUGS("Plugin") << "Sending: " << buffer << LL_ENDL;	
-	writeMessageRaw(buffer);
+	LL_DEBUGS("Plugin") << "Sending: " << message.generate() << LL_ENDL;	
+	if(mBinaryMessages)
+	{
+		writeMessageRaw(message.generateBinary(), true);
+	}
+	else
+	{
+		writeMessageRaw(message.generate());
+	}
 	
 	// Try to send message immediately.
 	if(mMessagePipe)
@@ -826,11 +838,12 @@ void LLPluginProcessParent::servicePoll()
 
 void LLPluginProcessParent::receiveMessageRaw(const std::string &message)
 {
-	LL_DEBUGS("Plugin") << "Received: " << message << LL_ENDL;
-	
 	LLPluginMessage parsed;
 	if(parsed.parse(message) != -1)
 	{
+		LL_DEBUGS("Plugin") << "Received: " << parsed.generate() << LL_ENDL;
+
+
 		if(parsed.hasValue("blocking_request"))
 		{
 			mBlocked = true;
@@ -888,6 +901,9 @@ void LLPluginProcessParent::receiveMessage(const LLPluginMessage &message)
 		{
 			if(mState == STATE_CONNECTED)
 			{
+				// Older plugin hosts don't advertise this, and will keep talking XML.
+				mBinaryMessages = message.hasValue("binary_messages") && message.getValueBoolean("binary_messages");
+
 				// Plugin host has launched.  Tell it which plugin to load.
 				setState(STATE_HELLO);
 			}
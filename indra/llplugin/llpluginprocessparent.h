@@ -172,6 +172,7 @@ private:
 	bool mDebug;
 	bool mBlocked;
 	bool mPolledInput;
+	bool mBinaryMessages;	// true once the child has said it understands binary messages
 
 	LLProcessLauncher mDebugger;
 	
@@ -0,0 +1,193 @@
+/** 
+ * @file llpluginmessage_test.cpp
+ * @brief Unit tests and throughput benchmark for LLPluginMessage serialization.
+ *
+ * @cond
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ * 
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ * @endcond
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llpluginmessage.h"
+#include "lltimer.h"
+
+
+namespace tut
+{
+	// Main Setup
+	struct LLPluginMessageFixture
+	{
+		// Builds a message with one of every value type.
+		void fillMessage(LLPluginMessage &message)
+		{
+			message.setMessage("media", "test");
+			message.setValue("string", "hello world");
+			message.setValueS32("s32", -12345);
+			message.setValueU32("u32", 0xDEADBEEF);
+			message.setValueBoolean("boolean", true);
+			message.setValueReal("real", 0.125);
+			message.setValuePointer("pointer", (void*)this);
+			
+			LLSD versions;
+			versions["base"] = "1.0";
+			versions["media"] = "1.1";
+			message.setValueLLSD("versions", versions);
+		}
+		
+		void checkMessage(const char *desc, const LLPluginMessage &message)
+		{
+			std::string prefix(desc);
+			ensure_equals(prefix + ": class", message.getClass(), std::string("media"));
+			ensure_equals(prefix + ": name", message.getName(), std::string("test"));
+			ensure_equals(prefix + ": string", message.getValue("string"), std::string("hello world"));
+			ensure_equals(prefix + ": s32", message.getValueS32("s32"), -12345);
+			ensure_equals(prefix + ": u32", message.getValueU32("u32"), (U32)0xDEADBEEF);
+			ensure(prefix + ": boolean", message.getValueBoolean("boolean"));
+			ensure_equals(prefix + ": real", message.getValueReal("real"), 0.125);
+			ensure(prefix + ": pointer", message.getValuePointer("pointer") == (void*)this);
+			ensure_equals(prefix + ": llsd", message.getValueLLSD("versions")["media"].asString(), std::string("1.1"));
+			ensure(prefix + ": missing value", !message.hasValue("missing"));
+		}
+	};
+	
+	typedef test_group<LLPluginMessageFixture> factory;
+	typedef factory::object object;
+}
+
+
+namespace
+{
+	tut::factory tf("LLPluginMessage");
+}
+
+namespace tut
+{
+	template<> template<>
+	void object::test<1>()
+	{
+		// Round trip through the XML form.
+		LLPluginMessage message;
+		fillMessage(message);
+		
+		std::string xml = message.generate();
+		ensure("xml form detected as text", !LLPluginMessage::isBinary(xml));
+		
+		LLPluginMessage parsed;
+		ensure("xml parse", parsed.parse(xml) != -1);
+		checkMessage("xml", parsed);
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		// Round trip through the binary form.
+		LLPluginMessage message;
+		fillMessage(message);
+		
+		std::string binary = message.generateBinary();
+		ensure("binary form detected as binary", LLPluginMessage::isBinary(binary));
+		ensure("binary form is smaller", binary.size() < message.generate().size());
+		
+		LLPluginMessage parsed;
+		ensure("binary parse", parsed.parse(binary) != -1);
+		checkMessage("binary", parsed);
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		// Binary messages may contain NULs, and the pipe hands us messages straight out of a larger buffer.
+		LLPluginMessage message("base", "nul");
+		message.setValue("data", std::string("a\0b", 3));
+		std::string binary = message.generateBinary();
+		
+		std::string buffer = binary + std::string("trailing garbage");
+		LLPluginMessage parsed;
+		ensure("parse from buffer", parsed.parse(buffer.data(), binary.size()) != -1);
+		ensure_equals("embedded nul survives", parsed.getValue("data"), std::string("a\0b", 3));
+		
+		// Parsing a new message clears out the old one.
+		ensure("reparse", parsed.parse(LLPluginMessage("base", "other").generate()) != -1);
+		ensure_equals("reparse name", parsed.getName(), std::string("other"));
+		ensure("reparse cleared values", !parsed.hasValue("data"));
+	}
+
+	template<> template<>
+	void object::test<4>()
+	{
+		// Benchmark generate+parse throughput for the kind of traffic a media plugin produces every frame.
+		const S32 NUM_MESSAGES = 20000;
+		
+		std::vector<LLPluginMessage> messages;
+		for(S32 i = 0; i < NUM_MESSAGES; i++)
+		{
+			if(i % 2)
+			{
+				LLPluginMessage message("media", "updated");
+				message.setValueS32("left", i % 512);
+				message.setValueS32("top", i % 256);
+				message.setValueS32("right", 1024);
+				message.setValueS32("bottom", 512);
+				messages.push_back(message);
+			}
+			else
+			{
+				LLPluginMessage message("media", "mouse_event");
+				message.setValue("event", "move");
+				message.setValueS32("button", 0);
+				message.setValueS32("x", i % 1024);
+				message.setValueS32("y", i % 768);
+				message.setValue("modifiers", "");
+				messages.push_back(message);
+			}
+		}
+		
+		F64 elapsed[2];
+		size_t bytes[2];
+		for(S32 pass = 0; pass < 2; pass++)
+		{
+			bool binary = (pass == 1);
+			bytes[pass] = 0;
+			
+			LLTimer timer;
+			LLPluginMessage parsed;
+			for(S32 i = 0; i < NUM_MESSAGES; i++)
+			{
+				std::string buffer = binary ? messages[i].generateBinary() : messages[i].generate();
+				bytes[pass] += buffer.size();
+				parsed.parse(buffer);
+			}
+			elapsed[pass] = timer.getElapsedTimeF64();
+			
+			ensure_equals("last message survives", parsed.getName(), messages[NUM_MESSAGES - 1].getName());
+		}
+		
+		llinfos << "LLPluginMessage: " << NUM_MESSAGES << " messages, xml "
+				<< (S32)(NUM_MESSAGES / llmax(elapsed[0], 0.000001)) << " msg/s (" << bytes[0] << " bytes), binary "
+				<< (S32)(NUM_MESSAGES / llmax(elapsed[1], 0.000001)) << " msg/s (" << bytes[1] << " bytes)" << llendl;
+		
+		// Timings are only logged; wall clock comparisons are too noisy to assert on a shared build machine.
+		ensure("binary messages are smaller", bytes[1] < bytes[0]);
+	}
+}
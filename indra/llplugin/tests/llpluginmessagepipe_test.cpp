@@ -0,0 +1,168 @@
+/**
+ * @file llpluginmessagepipe_test.cpp
+ * @brief Unit tests for LLPluginMessagePipe input framing.
+ *
+ * @cond
+ * $LicenseInfo:firstyear=2011&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2011, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ * @endcond
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llpluginmessagepipe.h"
+
+#include <vector>
+
+namespace tut
+{
+	// Records every message the pipe hands it.
+	class LLTestPipeOwner : public LLPluginMessagePipeOwner
+	{
+	public:
+		/*virtual*/ void receiveMessageRaw(const std::string &message)
+		{
+			mReceived.push_back(message);
+		}
+
+		std::vector<std::string> mReceived;
+	};
+
+	// A pipe with no socket.  Input is fed in directly instead of being read off the wire,
+	// and output is taken back out so the tests use the pipe's own encoding.
+	class LLTestPipe : public LLPluginMessagePipe
+	{
+	public:
+		LLTestPipe(LLPluginMessagePipeOwner *owner) :
+			LLPluginMessagePipe(owner, LLSocket::ptr_t())
+		{
+		}
+
+		// Same as what pumpInput() does with each chunk read from the socket.
+		void receive(const std::string &data)
+		{
+			mInputMutex.lock();
+			mInput += data;
+			mInputMutex.unlock();
+			processInput();
+		}
+
+		std::string takeOutput()
+		{
+			std::string output;
+			mOutputMutex.lock();
+			output.swap(mOutput);
+			mOutputMutex.unlock();
+			return output;
+		}
+	};
+
+	// Main Setup
+	struct LLPluginMessagePipeFixture
+	{
+		LLPluginMessagePipeFixture()
+		{
+			// The owner deletes the pipe when it goes away.
+			mPipe = new LLTestPipe(&mOwner);
+		}
+
+		// Frames a message the same way the sending side of a pipe would.
+		std::string frame(const std::string &message, bool binary)
+		{
+			mPipe->addMessage(message, binary);
+			return mPipe->takeOutput();
+		}
+
+		LLTestPipeOwner mOwner;
+		LLTestPipe *mPipe;
+	};
+
+	typedef test_group<LLPluginMessagePipeFixture> factory;
+	typedef factory::object object;
+	factory tf("LLPluginMessagePipe");
+
+	// Tests
+	template<> template<>
+	void object::test<1>()
+	{
+		// A binary frame split at every possible point is only delivered once it has fully arrived.
+		std::string payload("binary\0payload\x01with markers", 27);
+		std::string framed = frame(payload, true);
+		ensure("frame has a header", framed.size() > payload.size());
+
+		for(size_t split = 1; split < framed.size(); split++)
+		{
+			mOwner.mReceived.clear();
+
+			mPipe->receive(framed.substr(0, split));
+			ensure_equals("partial frame is held back", mOwner.mReceived.size(), (size_t)0);
+
+			mPipe->receive(framed.substr(split));
+			ensure_equals("completed frame is delivered", mOwner.mReceived.size(), (size_t)1);
+			ensure_equals("payload survives the split", mOwner.mReceived[0], payload);
+		}
+	}
+
+	template<> template<>
+	void object::test<2>()
+	{
+		// Text and binary frames interleaved in a single read come out in order and intact.
+		std::string binary_a("\x01\0\0\0\x05", 5);
+		std::string binary_b(300, '\0');
+		std::string buffer;
+		buffer += frame("<llsd>first</llsd>", false);
+		buffer += frame(binary_a, true);
+		buffer += frame("<llsd>second</llsd>", false);
+		buffer += frame(binary_b, true);
+		buffer += frame(std::string(), true);
+		buffer += frame("<llsd>third</llsd>", false);
+
+		mPipe->receive(buffer);
+
+		ensure_equals("message count", mOwner.mReceived.size(), (size_t)6);
+		ensure_equals("text 1", mOwner.mReceived[0], std::string("<llsd>first</llsd>"));
+		ensure_equals("binary with header-like payload", mOwner.mReceived[1], binary_a);
+		ensure_equals("text 2", mOwner.mReceived[2], std::string("<llsd>second</llsd>"));
+		ensure_equals("binary with NULs and multi-byte length", mOwner.mReceived[3], binary_b);
+		ensure_equals("empty binary", mOwner.mReceived[4], std::string());
+		ensure_equals("text 3", mOwner.mReceived[5], std::string("<llsd>third</llsd>"));
+	}
+
+	template<> template<>
+	void object::test<3>()
+	{
+		// A read that ends partway into a text frame keeps the complete frames before it
+		// and finishes the partial one on the next read.
+		std::string text = frame("<llsd>text</llsd>", false);
+		std::string binary = frame(std::string("bin\0ary", 7), true);
+		std::string buffer = binary + text;
+		size_t split = binary.size() + 4;
+
+		mPipe->receive(buffer.substr(0, split));
+		ensure_equals("binary delivered before partial text", mOwner.mReceived.size(), (size_t)1);
+		ensure_equals("binary payload", mOwner.mReceived[0], std::string("bin\0ary", 7));
+
+		mPipe->receive(buffer.substr(split));
+		ensure_equals("text delivered once complete", mOwner.mReceived.size(), (size_t)2);
+		ensure_equals("text payload", mOwner.mReceived[1], std::string("<llsd>text</llsd>"));
+	}
+}
@@ -126,6 +126,15 @@ const F32	TEXTURE_ROTATION_PACK_FACTOR = ((F32) 0x08000);
 // LEGACY: by default we use the LLVolumeMgr::gVolumeMgr global
 // TODO -- eliminate this global from the codebase!
 LLVolumeMgr* LLPrimitive::sVolumeManager = NULL;
+
+static void volume_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	if (LLPrimitive::getVolumeManager())
+	{
+		LLPrimitive::getVolumeManager()->getMemoryUsage(usage);
+	}
+}
+static LLMemoryAccount sVolumeAccount("Volumes", volume_memory_usage);
 static std::string stuff[] = {"e","d","6","3","f","b","d","0","-","5","8","9","e","-","f","e","1","d","-","a","3","d","0","-","1","6","9","0","5","e","f","a","a","9","6","b"};
 
 std::string LLPrimitive::tagstring = "";
@@ -63,6 +63,7 @@ LLFontManager *gFontManagerp = NULL;
 FT_Library gFTLibrary = NULL;
 
 bool LLFont::sOpenGLcrashOnRestart = false;
+U32 LLFont::sGlyphGeneration = 0;
 
 //static
 void LLFontManager::initClass()
@@ -146,6 +147,8 @@ LLFont::LLFont()
 	mAddGlyphCount = 0;
 
 	mPointSize = 0;
+
+	memset(mGlyphPages, 0, sizeof(mGlyphPages));
 }
 
 
@@ -157,6 +160,19 @@ LLFont::~LLFont()
 	mFTFace = NULL;
 
 	// Delete glyph info
+	for (S32 page = 0; page < GLYPH_PAGE_COUNT; ++page)
+	{
+		glyph_page_t* glyphs = mGlyphPages[page];
+		if (glyphs)
+		{
+			for (S32 i = 0; i < GLYPH_PAGE_SIZE; ++i)
+			{
+				delete glyphs->mGlyphs[i];
+			}
+			delete glyphs;
+			mGlyphPages[page] = NULL;
+		}
+	}
 	std::for_each(mCharGlyphInfoMap.begin(), mCharGlyphInfoMap.end(), DeletePairedPointer());
 
 	// mFontBitmapCachep will be cleaned up by LLPointer destructor.
@@ -258,15 +274,32 @@ BOOL LLFont::loadFace(const std::string& filename, const F32 point_size, const F
 void LLFont::resetBitmapCache()
 {
 	// Iterate through glyphs and clear the mIsRendered flag
+	//FIXME: clearing mMetricsValid is only strictly necessary when resetting
+	//the entire font, not just flushing the bitmap
+	for (S32 page = 0; page < GLYPH_PAGE_COUNT; ++page)
+	{
+		glyph_page_t* glyphs = mGlyphPages[page];
+		if (glyphs)
+		{
+			for (S32 i = 0; i < GLYPH_PAGE_SIZE; ++i)
+			{
+				LLFontGlyphInfo* gi = glyphs->mGlyphs[i];
+				if (gi)
+				{
+					gi->mIsRendered = FALSE;
+					gi->mMetricsValid = FALSE;
+				}
+			}
+		}
+	}
 	for (char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.begin();
 		 iter != mCharGlyphInfoMap.end(); ++iter)
 	{
 		iter->second->mIsRendered = FALSE;
-		//FIXME: this is only strictly necessary when resetting the entire font, 
-		//not just flushing the bitmap
 		iter->second->mMetricsValid = FALSE;
 	}
 	mFontBitmapCachep->reset();
+	sGlyphGeneration++;
 
 	if (sOpenGLcrashOnRestart)	// work-around for crashes under Linux and MacOS-X...
 	{
@@ -282,6 +315,11 @@ void LLFont::resetBitmapCache()
 
 LLFontGlyphInfo* LLFont::getGlyphInfo(const llwchar wch) const
 {
+	if (wch < 0x10000)
+	{
+		const glyph_page_t* glyphs = mGlyphPages[wch >> GLYPH_PAGE_BITS];
+		return glyphs ? glyphs->mGlyphs[wch & GLYPH_PAGE_MASK] : NULL;
+	}
 	char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.find(wch);
 	if (iter != mCharGlyphInfoMap.end())
 	{
@@ -336,8 +374,8 @@ BOOL LLFont::addChar(const llwchar wch) const
 		}
 	}
 	
-	char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.find(wch);
-	if (iter == mCharGlyphInfoMap.end() || !(iter->second->mIsRendered))
+	const LLFontGlyphInfo* gi = getGlyphInfo(wch);
+	if (!gi || !gi->mIsRendered)
 	{
 		BOOL result = addGlyph(wch, glyph_index);
 		return result;
@@ -347,6 +385,20 @@ BOOL LLFont::addChar(const llwchar wch) const
 
 void LLFont::insertGlyphInfo(llwchar wch, LLFontGlyphInfo* gi) const
 {
+	if (wch < 0x10000)
+	{
+		glyph_page_t*& glyphs = mGlyphPages[wch >> GLYPH_PAGE_BITS];
+		if (!glyphs)
+		{
+			glyphs = new glyph_page_t;
+			memset(glyphs, 0, sizeof(glyph_page_t));
+		}
+		LLFontGlyphInfo*& slot = glyphs->mGlyphs[wch & GLYPH_PAGE_MASK];
+		delete slot;
+		slot = gi;
+		return;
+	}
+
 	char_glyph_info_map_t::iterator iter = mCharGlyphInfoMap.find(wch);
 	if (iter != mCharGlyphInfoMap.end())
 	{
@@ -504,16 +556,12 @@ F32 LLFont::getXAdvance(const llwchar wch) const
 		fontp->renderGlyph(glyph_index);
 
 		// Create the entry if it's not there
-		char_glyph_info_map_t::iterator iter2 = mCharGlyphInfoMap.find(wch);
-		if (iter2 == mCharGlyphInfoMap.end())
+		gi = getGlyphInfo(wch);
+		if (!gi)
 		{
 			gi = new LLFontGlyphInfo(glyph_index);
 			insertGlyphInfo(wch, gi);
 		}
-		else
-		{
-			gi = iter2->second;
-		}
 		
 		gi->mWidth = fontp->mFTFace->glyph->bitmap.width;
 		gi->mHeight = fontp->mFTFace->glyph->bitmap.rows;
@@ -526,7 +574,7 @@ F32 LLFont::getXAdvance(const llwchar wch) const
 	}
 	else
 	{
-		gi = get_if_there(mCharGlyphInfoMap, (llwchar)0, (LLFontGlyphInfo*)NULL);
+		gi = getGlyphInfo(0);
 		if (gi)
 		{
 			return gi->mXAdvance;
@@ -560,10 +608,10 @@ F32 LLFont::getXKerning(const llwchar char_left, const llwchar char_right) const
 		return 0.0;
 
 	llassert(!mIsFallback);
-	LLFontGlyphInfo* left_glyph_info = get_if_there(mCharGlyphInfoMap, char_left, (LLFontGlyphInfo*)NULL);
+	LLFontGlyphInfo* left_glyph_info = getGlyphInfo(char_left);
 	U32 left_glyph = left_glyph_info ? left_glyph_info->mGlyphIndex : 0;
 	// Kern this puppy.
-	LLFontGlyphInfo* right_glyph_info = get_if_there(mCharGlyphInfoMap, char_right, (LLFontGlyphInfo*)NULL);
+	LLFontGlyphInfo* right_glyph_info = getGlyphInfo(char_right);
 	U32 right_glyph = right_glyph_info ? right_glyph_info->mGlyphIndex : 0;
 
 	FT_Vector  delta;
@@ -34,6 +34,7 @@
 #define LL_LLFONT_H
 
 #include <map>
+#include <boost/unordered_map.hpp>
 //#include "lllocalidhashmap.h"
 #include "llpointer.h"
 #include "llstl.h"
@@ -167,6 +168,12 @@ protected:
 
 	void resetBitmapCache();
 
+public:
+	// Bumped whenever any font throws away its glyph bitmaps (or embedded
+	// characters change), so that cached text geometry can tell its texture
+	// coordinates have gone stale.
+	static U32 getGlyphGeneration()				{ return sGlyphGeneration; }
+
 protected:
 	std::string mName;
 	F32 mPointSize;
@@ -181,8 +188,28 @@ protected:
 	BOOL mIsFallback;
 	LLFontList *mFallbackFontp; // A list of fallback fonts to look for glyphs in (for Unicode chars)
 
-	typedef std::map<llwchar, LLFontGlyphInfo*> char_glyph_info_map_t;
-	mutable char_glyph_info_map_t mCharGlyphInfoMap; // Information about glyph location in bitmap
+	// Information about glyph location in bitmap.  Glyphs in the Basic
+	// Multilingual Plane live in a two-level direct-indexed table (pages of
+	// 256 entries allocated on first use) so the per-character lookup in the
+	// render and width loops is two array reads; anything above U+FFFF goes
+	// into a hash map.
+	enum
+	{
+		GLYPH_PAGE_BITS = 8,
+		GLYPH_PAGE_SIZE = 1 << GLYPH_PAGE_BITS,
+		GLYPH_PAGE_MASK = GLYPH_PAGE_SIZE - 1,
+		GLYPH_PAGE_COUNT = 0x10000 >> GLYPH_PAGE_BITS
+	};
+	struct glyph_page_t
+	{
+		LLFontGlyphInfo* mGlyphs[GLYPH_PAGE_SIZE];
+	};
+	mutable glyph_page_t* mGlyphPages[GLYPH_PAGE_COUNT];
+
+	typedef boost::unordered_map<llwchar, LLFontGlyphInfo*> char_glyph_info_map_t;
+	mutable char_glyph_info_map_t mCharGlyphInfoMap; // Glyphs outside the BMP
+
+	static U32 sGlyphGeneration;
 
 	BOOL mValid;
 	void setSubImageLuminanceAlpha(const U32 x,
@@ -82,6 +82,15 @@ F32 llfont_round_y(F32 y)
 	return y;
 }
 
+// Same conversion LLRender::color4fv() does.
+static LLColor4U to_color4u(const LLColor4& color)
+{
+	return LLColor4U((U8)(llclamp(color.mV[VRED], 0.f, 1.f)*255),
+					 (U8)(llclamp(color.mV[VGREEN], 0.f, 1.f)*255),
+					 (U8)(llclamp(color.mV[VBLUE], 0.f, 1.f)*255),
+					 (U8)(llclamp(color.mV[VALPHA], 0.f, 1.f)*255));
+}
+
 // static
 U8 LLFontGL::getStyleFromString(const std::string &style)
 {
@@ -401,7 +410,113 @@ S32 LLFontGL::render(const LLWString &wstr,
 		return 0;
 	} 
 
-	gGL.getTexUnit(0)->enable(LLTexUnit::TT_TEXTURE);
+	LLFastTimer t(LLFastTimer::FTM_RENDER_FONTS);
+
+	// Scratch geometry, reused so that one-off strings don't allocate.
+	static LLFontVertexBatch batch;
+
+	S32 chars_drawn = layout(batch, wstr, begin_offset, x, y, color,
+							 halign, valign, style, max_chars, max_pixels,
+							 right_x, use_embedded, use_ellipses);
+	renderBatch(batch);
+	batch.clear();
+
+	return chars_drawn;
+}
+
+S32 LLFontGL::renderCached(LLFontVertexBatch& batch,
+						   const LLWString &wstr, 
+						   const S32 begin_offset,
+						   const F32 x, const F32 y,
+						   const LLColor4 &color,
+						   const HAlign halign, const VAlign valign,
+						   U8 style,
+						   const S32 max_chars, S32 max_pixels,
+						   F32* right_x,
+						   BOOL use_embedded,
+						   BOOL use_ellipses) const
+{
+	if (!sDisplayFont) //do not display texts
+	{
+		return wstr.length();
+	}
+
+	LLFastTimer t(LLFastTimer::FTM_RENDER_FONTS);
+
+	// Alignment and ellipsis width look at the string from its start, so the
+	// whole string is part of the key, not just the drawn range.
+	if (!batch.mValid
+		|| batch.mFont != this
+		|| batch.mGeneration != getGlyphGeneration()
+		|| batch.mScaleX != sScaleX
+		|| batch.mScaleY != sScaleY
+		|| batch.mBeginOffset != begin_offset
+		|| batch.mMaxChars != max_chars
+		|| batch.mMaxPixels != max_pixels
+		|| batch.mX != x
+		|| batch.mY != y
+		|| batch.mColor != color
+		|| batch.mHAlign != (S32)halign
+		|| batch.mVAlign != (S32)valign
+		|| batch.mStyle != style
+		|| batch.mUseEmbedded != use_embedded
+		|| batch.mUseEllipses != use_ellipses
+		|| batch.mText != wstr)
+	{
+		batch.clear();
+		batch.mCharsDrawn = layout(batch, wstr, begin_offset, x, y, color,
+								   halign, valign, style, max_chars, max_pixels,
+								   &batch.mRightX, use_embedded, use_ellipses);
+
+		batch.mValid = true;
+		batch.mFont = this;
+		batch.mGeneration = getGlyphGeneration();
+		batch.mScaleX = sScaleX;
+		batch.mScaleY = sScaleY;
+		batch.mBeginOffset = begin_offset;
+		batch.mMaxChars = max_chars;
+		batch.mMaxPixels = max_pixels;
+		batch.mX = x;
+		batch.mY = y;
+		batch.mColor = color;
+		batch.mHAlign = (S32)halign;
+		batch.mVAlign = (S32)valign;
+		batch.mStyle = style;
+		batch.mUseEmbedded = use_embedded;
+		batch.mUseEllipses = use_ellipses;
+		batch.mText = wstr;
+	}
+
+	renderBatch(batch);
+
+	if (right_x)
+	{
+		*right_x = batch.mRightX;
+	}
+
+	return batch.mCharsDrawn;
+}
+
+S32 LLFontGL::layout(LLFontVertexBatch& batch,
+					 const LLWString &wstr, 
+					 const S32 begin_offset,
+					 const F32 x, const F32 y,
+					 const LLColor4 &color,
+					 const HAlign halign, const VAlign valign,
+					 U8 style,
+					 const S32 max_chars, S32 max_pixels,
+					 F32* right_x,
+					 BOOL use_embedded,
+					 BOOL use_ellipses) const
+{
+	if (wstr.empty())
+	{
+		if (right_x)
+		{
+			*right_x = x;
+		}
+		return 0;
+	} 
 
 	S32 scaled_max_pixels = max_pixels == S32_MAX ? S32_MAX : llceil((F32)max_pixels * sScaleX);
 
@@ -420,19 +535,6 @@ S32 LLFontGL::render(const LLWString &wstr,
 		}
 	}
 
-	gGL.pushMatrix();
-	glLoadIdentity();
-	gGL.translatef(floorf(sCurOrigin.mX*sScaleX), floorf(sCurOrigin.mY*sScaleY), sCurOrigin.mZ);
-
-	// this code snaps the text origin to a pixel grid to start with
-	F32 pixel_offset_x = llround((F32)sCurOrigin.mX) - (sCurOrigin.mX);
-	F32 pixel_offset_y = llround((F32)sCurOrigin.mY) - (sCurOrigin.mY);
-	gGL.translatef(-pixel_offset_x, -pixel_offset_y, 0.f);
-
-	LLFastTimer t(LLFastTimer::FTM_RENDER_FONTS);
-
-	gGL.color4fv (color.mV);
-
 	S32 chars_drawn = 0;
 	S32 i;
 	S32 length;
@@ -448,9 +550,6 @@ S32 LLFontGL::render(const LLWString &wstr,
 
 	F32 cur_x, cur_y, cur_render_x, cur_render_y;
 
- 	// Not guaranteed to be set correctly
-	gGL.setSceneBlendType(LLRender::BT_ALPHA);
-	
 	cur_x = ((F32)x * sScaleX);
 	cur_y = ((F32)y * sScaleY);
 
@@ -511,10 +610,6 @@ S32 LLFontGL::render(const LLWString &wstr,
 		}
 	}
 
-
-	// Remember last-used texture to avoid unnecesssary bind calls.
-	LLImageGL *last_bound_texture = NULL;
-
 	for (i = begin_offset; i < begin_offset + length; i++)
 	{
 		llwchar wch = wstr[i];
@@ -543,37 +638,24 @@ S32 LLFontGL::render(const LLWString &wstr,
 				break;
 			}
 
-			if (last_bound_texture != ext_image)
-			{
-				gGL.getTexUnit(0)->bind(ext_image);
-				last_bound_texture = ext_image;
-			}
-
 			// snap origin to whole screen pixel
 			const F32 ext_x = (F32)llround(cur_render_x + (EXT_X_BEARING * sScaleX));
 			const F32 ext_y = (F32)llround(cur_render_y + (EXT_Y_BEARING * sScaleY + mAscender - mLineHeight));
 
 			LLRectf uv_rect(0.f, 1.f, 1.f, 0.f);
 			LLRectf screen_rect(ext_x, ext_y + ext_height, ext_x + ext_width, ext_y);
-			drawGlyph(screen_rect, uv_rect, LLColor4::white, style, drop_shadow_strength);
+			appendGlyph(batch, ext_image, screen_rect, uv_rect, LLColor4::white, style, drop_shadow_strength);
 
 			if (!label.empty())
 			{
-				gGL.pushMatrix();
-				//glLoadIdentity();
-				//gGL.translatef(sCurOrigin.mX, sCurOrigin.mY, 0.0f);
-				//glScalef(sScaleX, sScaleY, 1.f);
-				getFontExtChar()->render(label, 0,
+				getFontExtChar()->layout(batch, label, 0,
 									 /*llfloor*/((ext_x + (F32)ext_image->getWidth() + EXT_X_BEARING) / sScaleX), 
 									 /*llfloor*/(cur_y / sScaleY),
 									 color,
 									 halign, BASELINE, NORMAL, S32_MAX, S32_MAX, NULL,
 									 TRUE );
-				gGL.popMatrix();
 			}
 
-			gGL.color4fv(color.mV);
-
 			chars_drawn++;
 			cur_x += ext_advance;
 			if (((i + 1) < length) && wstr[i+1])
@@ -595,13 +677,6 @@ S32 LLFontGL::render(const LLWString &wstr,
 				llerrs << "Missing Glyph Info" << llendl;
 				break;
 			}
-			// Per-glyph bitmap texture.
-			LLImageGL *image_gl = mFontBitmapCachep->getImageGL(fgi->mBitmapNum);
-			if (last_bound_texture != image_gl)
-			{
-				gGL.getTexUnit(0)->bind(image_gl);
-				last_bound_texture = image_gl;
-			}
 
 			if ((start_x + scaled_max_pixels) < (cur_x + fgi->mXBearing + fgi->mWidth))
 			{
@@ -609,6 +684,9 @@ S32 LLFontGL::render(const LLWString &wstr,
 				break;
 			}
 
+			// Per-glyph bitmap texture.
+			LLImageGL *image_gl = mFontBitmapCachep->getImageGL(fgi->mBitmapNum);
+
 			// Draw the text at the appropriate location
 			//Specify vertices and texture coordinates
 			LLRectf uv_rect((fgi->mXBitmapOffset) * inv_width,
@@ -621,7 +699,7 @@ S32 LLFontGL::render(const LLWString &wstr,
 					    llround(cur_render_x + (F32)fgi->mXBearing) + (F32)fgi->mWidth,
 					    llround(cur_render_y + (F32)fgi->mYBearing) - (F32)fgi->mHeight);
 			
-			drawGlyph(screen_rect, uv_rect, color, style, drop_shadow_strength);
+			appendGlyph(batch, image_gl, screen_rect, uv_rect, color, style, drop_shadow_strength);
 
 			chars_drawn++;
 			cur_x += fgi->mXAdvance;
@@ -657,23 +735,16 @@ S32 LLFontGL::render(const LLWString &wstr,
 
 	if (style & UNDERLINE)
 	{
-		gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
-		gGL.begin(LLRender::LINES);
-		gGL.vertex2f(start_x, cur_y - (mDescender));
-		gGL.vertex2f(cur_x, cur_y - (mDescender));
-		gGL.end();
+		batch.addLine(start_x, cur_x, cur_y - (mDescender), to_color4u(color));
 	}
 
 	// *FIX: get this working in all alignment cases, etc.
 	if (draw_ellipses)
 	{
-		// recursively render ellipses at end of string
+		// recursively lay out ellipses at end of string
 		// we've already reserved enough room
-		gGL.pushMatrix();
-		//glLoadIdentity();
-		//gGL.translatef(sCurOrigin.mX, sCurOrigin.mY, 0.0f);
-		//glScalef(sScaleX, sScaleY, 1.f);
-		renderUTF8(std::string("..."), 
+		static const LLWString ellipses(utf8str_to_wstring(std::string("...")));
+		layout(batch, ellipses,
 				0,
 				cur_x / sScaleX, (F32)y,
 				color,
@@ -682,14 +753,80 @@ S32 LLFontGL::render(const LLWString &wstr,
 				S32_MAX, max_pixels,
 				right_x,
 				FALSE); 
-		gGL.popMatrix();
 	}
 
-	gGL.popMatrix();
-
 	return chars_drawn;
 }
 
+// static
+void LLFontGL::renderBatch(const LLFontVertexBatch& batch)
+{
+	if (batch.isEmpty())
+	{
+		return;
+	}
+
+	// Largest number of vertices handed to LLRender at once; keeps us well
+	// inside its immediate mode buffer (see LLRender::end()).
+	const S32 MAX_BATCH_VERTICES = 1024;
+
+	gGL.getTexUnit(0)->enable(LLTexUnit::TT_TEXTURE);
+
+	gGL.pushMatrix();
+	gGL.loadIdentity();
+	gGL.translatef(floorf(sCurOrigin.mX*sScaleX), floorf(sCurOrigin.mY*sScaleY), sCurOrigin.mZ);
+
+	// this code snaps the text origin to a pixel grid to start with
+	F32 pixel_offset_x = llround((F32)sCurOrigin.mX) - (sCurOrigin.mX);
+	F32 pixel_offset_y = llround((F32)sCurOrigin.mY) - (sCurOrigin.mY);
+	gGL.translatef(-pixel_offset_x, -pixel_offset_y, 0.f);
+
+ 	// Not guaranteed to be set correctly
+	gGL.setSceneBlendType(LLRender::BT_ALPHA);
+
+	// LLRender takes non-const pointers but only reads from them.
+	LLVector3* vertices = const_cast<LLVector3*>(&batch.mVertices[0]);
+	LLVector2* tex_coords = const_cast<LLVector2*>(&batch.mTexCoords[0]);
+	LLColor4U* colors = const_cast<LLColor4U*>(&batch.mColors[0]);
+
+	for (std::vector<LLFontVertexBatch::Run>::const_iterator iter = batch.mRuns.begin();
+		 iter != batch.mRuns.end(); ++iter)
+	{
+		const LLFontVertexBatch::Run& run = *iter;
+		gGL.getTexUnit(0)->bind(run.mImage.get());
+
+		S32 end = run.mStart + run.mCount;
+		for (S32 start = run.mStart; start < end; start += MAX_BATCH_VERTICES)
+		{
+			S32 count = llmin(MAX_BATCH_VERTICES, end - start);
+			gGL.begin(LLRender::QUADS);
+			gGL.vertexBatchPreTransformed(vertices + start, tex_coords + start, colors + start, count);
+			gGL.end();
+		}
+	}
+
+	if (!batch.mLines.empty())
+	{
+		gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+		gGL.begin(LLRender::LINES);
+		for (U32 i = 0; i + 1 < batch.mLines.size(); i += 2)
+		{
+			gGL.color4ubv(batch.mLineColors[i / 2].mV);
+			gGL.vertex3fv(batch.mLines[i].mV);
+			gGL.vertex3fv(batch.mLines[i + 1].mV);
+		}
+		gGL.end();
+	}
+
+	// Leave the current color where immediate mode rendering used to.
+	if (!batch.mColors.empty())
+	{
+		gGL.color4ubv(batch.mColors.back().mV);
+	}
+
+	gGL.popMatrix();
+}
+
 
 S32 LLFontGL::getWidth(const std::string& utf8text) const
 {
@@ -1084,6 +1221,7 @@ void LLFontGL::addEmbeddedChar( llwchar wc, LLTexture* image, const LLWString& w
 {
 	embedded_data_t* ext_data = new embedded_data_t(image->getGLTexture(), wlabel);
 	mEmbeddedChars[wc] = ext_data;
+	sGlyphGeneration++;
 }
 
 void LLFontGL::removeEmbeddedChar( llwchar wc ) const
@@ -1093,103 +1231,154 @@ void LLFontGL::removeEmbeddedChar( llwchar wc ) const
 	{
 		delete iter->second;
 		mEmbeddedChars.erase(wc);
+		sGlyphGeneration++;
 	}
 }
 
 
-void LLFontGL::renderQuad(const LLRectf& screen_rect, const LLRectf& uv_rect, F32 slant_amt) const
-{
-	gGL.texCoord2f(uv_rect.mRight, uv_rect.mTop);
-	gGL.vertex2f(llfont_round_x(screen_rect.mRight), 
-				llfont_round_y(screen_rect.mTop));
-
-	gGL.texCoord2f(uv_rect.mLeft, uv_rect.mTop);
-	gGL.vertex2f(llfont_round_x(screen_rect.mLeft), 
-				llfont_round_y(screen_rect.mTop));
-
-	gGL.texCoord2f(uv_rect.mLeft, uv_rect.mBottom);
-	gGL.vertex2f(llfont_round_x(screen_rect.mLeft + slant_amt), 
-				llfont_round_y(screen_rect.mBottom));
-
-	gGL.texCoord2f(uv_rect.mRight, uv_rect.mBottom);
-	gGL.vertex2f(llfont_round_x(screen_rect.mRight + slant_amt), 
-				llfont_round_y(screen_rect.mBottom));
-}
-
-void LLFontGL::drawGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_strength) const
+void LLFontGL::appendGlyph(LLFontVertexBatch& batch, LLImageGL* image, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_strength) const
 {
 	F32 slant_offset;
 	slant_offset = ((style & ITALIC) ? ( -mAscender * 0.2f) : 0.f);
 
-	gGL.begin(LLRender::QUADS);
+	const LLColor4U color_u = to_color4u(color);
+
+	//FIXME: bold and drop shadow are mutually exclusive only for convenience
+	//Allow both when we need them.
+	if (style & BOLD)
 	{
-		//FIXME: bold and drop shadow are mutually exclusive only for convenience
-		//Allow both when we need them.
-		if (style & BOLD)
+		for (S32 pass = 0; pass < 2; pass++)
 		{
-			gGL.color4fv(color.mV);
-			for (S32 pass = 0; pass < 2; pass++)
-			{
-				LLRectf screen_rect_offset = screen_rect;
+			LLRectf screen_rect_offset = screen_rect;
 
-				screen_rect_offset.translate((F32)(pass * BOLD_OFFSET), 0.f);
-				renderQuad(screen_rect_offset, uv_rect, slant_offset);
-			}
+			screen_rect_offset.translate((F32)(pass * BOLD_OFFSET), 0.f);
+			batch.addQuad(image, screen_rect_offset, uv_rect, slant_offset, color_u);
 		}
-		else if (style & DROP_SHADOW_SOFT)
+	}
+	else if (style & DROP_SHADOW_SOFT)
+	{
+		LLColor4 shadow_color = LLFontGL::sShadowColor;
+		shadow_color.mV[VALPHA] = color.mV[VALPHA] * drop_shadow_strength * DROP_SHADOW_SOFT_STRENGTH;
+		const LLColor4U shadow_color_u = to_color4u(shadow_color);
+		for (S32 pass = 0; pass < 5; pass++)
 		{
-			LLColor4 shadow_color = LLFontGL::sShadowColor;
-			shadow_color.mV[VALPHA] = color.mV[VALPHA] * drop_shadow_strength * DROP_SHADOW_SOFT_STRENGTH;
-			gGL.color4fv(shadow_color.mV);
-			for (S32 pass = 0; pass < 5; pass++)
-			{
-				LLRectf screen_rect_offset = screen_rect;
+			LLRectf screen_rect_offset = screen_rect;
 
-				switch(pass)
-				{
-				case 0:
-					screen_rect_offset.translate(-1.f, -1.f);
-					break;
-				case 1:
-					screen_rect_offset.translate(1.f, -1.f);
-					break;
-				case 2:
-					screen_rect_offset.translate(1.f, 1.f);
-					break;
-				case 3:
-					screen_rect_offset.translate(-1.f, 1.f);
-					break;
-				case 4:
-					screen_rect_offset.translate(0, -2.f);
-					break;
-				}
-			
-				renderQuad(screen_rect_offset, uv_rect, slant_offset);
+			switch(pass)
+			{
+			case 0:
+				screen_rect_offset.translate(-1.f, -1.f);
+				break;
+			case 1:
+				screen_rect_offset.translate(1.f, -1.f);
+				break;
+			case 2:
+				screen_rect_offset.translate(1.f, 1.f);
+				break;
+			case 3:
+				screen_rect_offset.translate(-1.f, 1.f);
+				break;
+			case 4:
+				screen_rect_offset.translate(0, -2.f);
+				break;
 			}
-			gGL.color4fv(color.mV);
-			renderQuad(screen_rect, uv_rect, slant_offset);
-		}
-		else if (style & DROP_SHADOW)
-		{
-			LLColor4 shadow_color = LLFontGL::sShadowColor;
-			shadow_color.mV[VALPHA] = color.mV[VALPHA] * drop_shadow_strength;
-			gGL.color4fv(shadow_color.mV);
-			LLRectf screen_rect_shadow = screen_rect;
-			screen_rect_shadow.translate(1.f, -1.f);
-			renderQuad(screen_rect_shadow, uv_rect, slant_offset);
-			gGL.color4fv(color.mV);
-			renderQuad(screen_rect, uv_rect, slant_offset);
-		}
-		else // normal rendering
-		{
-			gGL.color4fv(color.mV);
-			renderQuad(screen_rect, uv_rect, slant_offset);
+		
+			batch.addQuad(image, screen_rect_offset, uv_rect, slant_offset, shadow_color_u);
 		}
+		batch.addQuad(image, screen_rect, uv_rect, slant_offset, color_u);
+	}
+	else if (style & DROP_SHADOW)
+	{
+		LLColor4 shadow_color = LLFontGL::sShadowColor;
+		shadow_color.mV[VALPHA] = color.mV[VALPHA] * drop_shadow_strength;
+		LLRectf screen_rect_shadow = screen_rect;
+		screen_rect_shadow.translate(1.f, -1.f);
+		batch.addQuad(image, screen_rect_shadow, uv_rect, slant_offset, to_color4u(shadow_color));
+		batch.addQuad(image, screen_rect, uv_rect, slant_offset, color_u);
+	}
+	else // normal rendering
+	{
+		batch.addQuad(image, screen_rect, uv_rect, slant_offset, color_u);
+	}
+}
 
+//----------------------------------------------------------------------------
+
+LLFontVertexBatch::LLFontVertexBatch()
+:	mCharsDrawn(0),
+	mRightX(0.f),
+	mValid(false),
+	mFont(NULL),
+	mBeginOffset(0),
+	mMaxChars(0),
+	mX(0.f),
+	mY(0.f),
+	mHAlign(0),
+	mVAlign(0),
+	mStyle(0),
+	mMaxPixels(0),
+	mUseEmbedded(FALSE),
+	mUseEllipses(FALSE),
+	mScaleX(0.f),
+	mScaleY(0.f),
+	mGeneration(0)
+{
+}
+
+void LLFontVertexBatch::clear()
+{
+	// clear() rather than swap-to-empty so the storage is reused next time.
+	mVertices.clear();
+	mTexCoords.clear();
+	mColors.clear();
+	mRuns.clear();
+	mLines.clear();
+	mLineColors.clear();
+	mCharsDrawn = 0;
+	mRightX = 0.f;
+	mValid = false;
+}
+
+void LLFontVertexBatch::addQuad(LLImageGL* image, const LLRectf& screen_rect, const LLRectf& uv_rect,
+								F32 slant_amt, const LLColor4U& color)
+{
+	if (mRuns.empty() || mRuns.back().mImage != image)
+	{
+		Run run;
+		run.mImage = image;
+		run.mStart = (S32)mVertices.size();
+		run.mCount = 0;
+		mRuns.push_back(run);
 	}
-	gGL.end();
+	mRuns.back().mCount += 4;
+
+	mTexCoords.push_back(LLVector2(uv_rect.mRight, uv_rect.mTop));
+	mVertices.push_back(LLVector3(llfont_round_x(screen_rect.mRight), 
+								  llfont_round_y(screen_rect.mTop), 0.f));
+
+	mTexCoords.push_back(LLVector2(uv_rect.mLeft, uv_rect.mTop));
+	mVertices.push_back(LLVector3(llfont_round_x(screen_rect.mLeft), 
+								  llfont_round_y(screen_rect.mTop), 0.f));
+
+	mTexCoords.push_back(LLVector2(uv_rect.mLeft, uv_rect.mBottom));
+	mVertices.push_back(LLVector3(llfont_round_x(screen_rect.mLeft + slant_amt), 
+								  llfont_round_y(screen_rect.mBottom), 0.f));
+
+	mTexCoords.push_back(LLVector2(uv_rect.mRight, uv_rect.mBottom));
+	mVertices.push_back(LLVector3(llfont_round_x(screen_rect.mRight + slant_amt), 
+								  llfont_round_y(screen_rect.mBottom), 0.f));
+
+	mColors.insert(mColors.end(), 4, color);
 }
 
+void LLFontVertexBatch::addLine(F32 x1, F32 x2, F32 y, const LLColor4U& color)
+{
+	mLines.push_back(LLVector3(x1, y, 0.f));
+	mLines.push_back(LLVector3(x2, y, 0.f));
+	mLineColors.push_back(color);
+}
+
+
 std::string LLFontGL::nameFromFont(const LLFontGL* fontp)
 {
 	return fontp->getFontDesc().getName();
@@ -43,8 +43,11 @@
 
 #include "lltexture.h"
 #include "v2math.h"
+#include "v3math.h"
+#include "v4color.h"
+#include "v4coloru.h"
 
-class LLColor4;
+class LLFontGL;
 
 // Key used to request a font.
 class LLFontDescriptor;
@@ -52,6 +55,69 @@ class LLFontDescriptor;
 // Structure used to store previously requested fonts.
 class LLFontRegistry;
 
+// Laid out geometry for one string: every glyph quad (including bold and
+// drop shadow passes) with its texture coordinates and color, grouped into
+// runs that share a texture.  Built by LLFontGL::layout() without touching GL
+// and drawn with LLFontGL::renderBatch(), so a widget whose text does not
+// change can keep one of these around and skip the per-character work on
+// every frame.  LLFontGL::renderCached() does the bookkeeping for you.
+class LLFontVertexBatch
+{
+public:
+	LLFontVertexBatch();
+
+	void clear();
+	void invalidate()					{ mValid = false; }
+
+	bool isEmpty() const				{ return mVertices.empty() && mLines.empty(); }
+	S32 getVertexCount() const			{ return (S32)mVertices.size(); }
+	S32 getCharsDrawn() const			{ return mCharsDrawn; }
+	F32 getRightX() const				{ return mRightX; }
+
+private:
+	friend class LLFontGL;
+
+	void addQuad(LLImageGL* image, const LLRectf& screen_rect, const LLRectf& uv_rect,
+				 F32 slant_amt, const LLColor4U& color);
+	void addLine(F32 x1, F32 x2, F32 y, const LLColor4U& color);
+
+	struct Run
+	{
+		LLPointer<LLImageGL> mImage;
+		S32 mStart;
+		S32 mCount;
+	};
+
+	std::vector<LLVector3>	mVertices;
+	std::vector<LLVector2>	mTexCoords;
+	std::vector<LLColor4U>	mColors;
+	std::vector<Run>		mRuns;
+	std::vector<LLVector3>	mLines;		// underline segments, untextured
+	std::vector<LLColor4U>	mLineColors;
+
+	S32 mCharsDrawn;
+	F32 mRightX;
+
+	// What the batch was built from, checked by LLFontGL::renderCached().
+	bool			mValid;
+	const LLFontGL*	mFont;
+	LLWString		mText;
+	S32				mBeginOffset;
+	S32				mMaxChars;
+	F32				mX;
+	F32				mY;
+	LLColor4		mColor;
+	S32				mHAlign;
+	S32				mVAlign;
+	U8				mStyle;
+	S32				mMaxPixels;
+	BOOL			mUseEmbedded;
+	BOOL			mUseEllipses;
+	F32				mScaleX;
+	F32				mScaleY;
+	U32				mGeneration;
+};
+
 class LLFontGL : public LLFont
 {
 public:
@@ -163,6 +229,41 @@ public:
 		BOOL use_embedded = FALSE,
 		BOOL use_ellipses = FALSE) const;
 
+	// Same as render(), but reuses the geometry in batch when the text and
+	// parameters match what it was built from, and rebuilds it otherwise.
+	S32 renderCached(LLFontVertexBatch& batch,
+		const LLWString &text,
+		S32 begin_offset,
+		F32 x, F32 y,
+		const LLColor4 &color,
+		HAlign halign = LEFT, 
+		VAlign valign = BASELINE,
+		U8 style = NORMAL,
+		S32 max_chars = S32_MAX,
+		S32 max_pixels = S32_MAX, 
+		F32* right_x=NULL,
+		BOOL use_embedded = FALSE,
+		BOOL use_ellipses = FALSE) const;
+
+	// Appends the geometry for text to batch without issuing any GL calls.
+	// Returns the number of characters laid out.
+	S32 layout(LLFontVertexBatch& batch,
+		const LLWString &text,
+		S32 begin_offset,
+		F32 x, F32 y,
+		const LLColor4 &color,
+		HAlign halign = LEFT, 
+		VAlign valign = BASELINE,
+		U8 style = NORMAL,
+		S32 max_chars = S32_MAX,
+		S32 max_pixels = S32_MAX, 
+		F32* right_x=NULL,
+		BOOL use_embedded = FALSE,
+		BOOL use_ellipses = FALSE) const;
+
+	// Draws a batch built by layout() at the current font origin.
+	static void renderBatch(const LLFontVertexBatch& batch);
+
 	// font metrics - override for LLFont that returns units of virtual pixels
 	/*virtual*/ F32 getLineHeight() const		{ return (F32)llround(mLineHeight / sScaleY); }
 	/*virtual*/ F32 getAscenderHeight() const	{ return (F32)llround(mAscender / sScaleY); }
@@ -221,8 +322,7 @@ protected:
 	const embedded_data_t* getEmbeddedCharData(const llwchar wch) const;
 	F32 getEmbeddedCharAdvance(const embedded_data_t* ext_data) const;
 	void clearEmbeddedChars();
-	void renderQuad(const LLRectf& screen_rect, const LLRectf& uv_rect, F32 slant_amt) const;
-	void drawGlyph(const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_fade) const;
+	void appendGlyph(LLFontVertexBatch& batch, LLImageGL* image, const LLRectf& screen_rect, const LLRectf& uv_rect, const LLColor4& color, U8 style, F32 drop_shadow_fade) const;
 
 public:
 	static F32 sVertDPI;
@@ -285,6 +285,7 @@ LLGLManager::LLGLManager() :
 	mHasBlendFuncSeparate(FALSE),
 
 	mHasVertexBufferObject(FALSE),
+	mHasPixelBufferObject(FALSE),
 	mHasPBuffer(FALSE),
 	mHasShaderObjects(FALSE),
 	mHasVertexShader(FALSE),
@@ -593,6 +594,11 @@ void LLGLManager::initExtensions()
 # else
 	mHasVertexBufferObject = FALSE;
 # endif // GL_ARB_vertex_buffer_object
+# if defined(GL_ARB_vertex_buffer_object) && defined(GL_ARB_pixel_buffer_object)
+	mHasPixelBufferObject = TRUE;
+# else
+	mHasPixelBufferObject = FALSE;
+# endif // GL_ARB_pixel_buffer_object
 # ifdef GL_EXT_framebuffer_object
 	mHasFramebufferObject = TRUE;
 # else
@@ -637,6 +643,8 @@ void LLGLManager::initExtensions()
 	mHasOcclusionQuery = ExtensionExists("GL_ARB_occlusion_query", gGLHExts.mSysExts);
 	mHasOcclusionQuery2 = ExtensionExists("GL_ARB_occlusion_query2", gGLHExts.mSysExts);
 	mHasVertexBufferObject = ExtensionExists("GL_ARB_vertex_buffer_object", gGLHExts.mSysExts);
+	// pixel buffers use the vertex buffer object entry points
+	mHasPixelBufferObject = mHasVertexBufferObject && ExtensionExists("GL_ARB_pixel_buffer_object", gGLHExts.mSysExts);
 	mHasDepthClamp = ExtensionExists("GL_ARB_depth_clamp", gGLHExts.mSysExts) || ExtensionExists("GL_NV_depth_clamp", gGLHExts.mSysExts);
 	// mask out FBO support when packed_depth_stencil isn't there 'cause we need it for LLRenderTarget -Brad
 #ifdef GL_ARB_framebuffer_object
@@ -671,6 +679,7 @@ void LLGLManager::initExtensions()
 		mHasARBEnvCombine = FALSE;
 		mHasCompressedTextures = FALSE;
 		mHasVertexBufferObject = FALSE;
+		mHasPixelBufferObject = FALSE;
 		mHasFramebufferObject = FALSE;
 		mHasDrawBuffers = FALSE;
 		mHasBlendFuncSeparate = FALSE;
@@ -710,7 +719,7 @@ void LLGLManager::initExtensions()
 		LL_WARNS("RenderInit") << "GL extension support partially disabled via LL_GL_BLACKLIST: " << blacklist << LL_ENDL;
 		if (strchr(blacklist,'a')) mHasARBEnvCombine = FALSE;
 		if (strchr(blacklist,'b')) mHasCompressedTextures = FALSE;
-		if (strchr(blacklist,'c')) mHasVertexBufferObject = FALSE;
+		if (strchr(blacklist,'c')) mHasVertexBufferObject = mHasPixelBufferObject = FALSE;
 		if (strchr(blacklist,'d')) mHasMipMapGeneration = FALSE;//S
 // 		if (strchr(blacklist,'f')) mHasNVVertexArrayRange = FALSE;//S
 // 		if (strchr(blacklist,'g')) mHasNVFence = FALSE;//S
@@ -728,6 +737,7 @@ void LLGLManager::initExtensions()
 		if (strchr(blacklist,'s')) mHasTextureRectangle = FALSE;
 		if (strchr(blacklist,'t')) mHasBlendFuncSeparate = FALSE;//S
 		if (strchr(blacklist,'u')) mHasDepthClamp = FALSE;
+		if (strchr(blacklist,'v')) mHasPixelBufferObject = FALSE;
 
 	}
 #endif // LL_LINUX || LL_SOLARIS
@@ -829,6 +839,7 @@ void LLGLManager::initExtensions()
 		else
 		{
 			mHasVertexBufferObject = FALSE;
+			mHasPixelBufferObject = FALSE;
 		}
 	}
 	if (mHasFramebufferObject)
@@ -85,6 +85,7 @@ public:
 	
 	// ARB Extensions
 	BOOL mHasVertexBufferObject;
+	BOOL mHasPixelBufferObject;
 	BOOL mHasPBuffer;
 	BOOL mHasShaderObjects;
 	BOOL mHasVertexShader;
@@ -450,6 +450,7 @@ void LLImageGL::init(BOOL usemipmaps)
 	mUseMipMaps = usemipmaps;
 	mHasExplicitFormat = FALSE;
 	mAutoGenMips = FALSE;
+	mAllowCompression = FALSE;
 
 	mIsMask = FALSE;
 	mNeedsAlphaAndPickMask = TRUE;
@@ -956,6 +957,65 @@ BOOL LLImageGL::setSubImage(const LLImageRaw* imageraw, S32 x_pos, S32 y_pos, S3
 	return setSubImage(imageraw->getData(), imageraw->getWidth(), imageraw->getHeight(), x_pos, y_pos, width, height, force_fast_update);
 }
 
+// Copy sub image from the bound pixel unpack buffer
+BOOL LLImageGL::setSubImageFromBuffer(U32 buffer_offset, S32 x_pos, S32 y_pos, S32 width, S32 height)
+{
+	if (!width || !height)
+	{
+		return TRUE;
+	}
+	if (mTexName == 0)
+	{
+		return FALSE;
+	}
+	if (mUseMipMaps)
+	{
+		dump();
+		llerrs << "setSubImageFromBuffer called with mipmapped image (not supported)" << llendl;
+	}
+	llassert_always(mCurrentDiscardLevel == 0);
+	llassert_always(x_pos >= 0 && y_pos >= 0);
+	
+	if (((x_pos + width) > getWidth()) || 
+		(y_pos + height) > getHeight())
+	{
+		dump();
+		llerrs << "Subimage not wholly in target image!" 
+			   << " x_pos " << x_pos
+			   << " y_pos " << y_pos
+			   << " width " << width
+			   << " height " << height
+			   << " getWidth() " << getWidth()
+			   << " getHeight() " << getHeight()
+			   << llendl;
+	}
+
+	if(mFormatSwapBytes)
+	{
+		glPixelStorei(GL_UNPACK_SWAP_BYTES, 1);
+		stop_glerror();
+	}
+
+	BOOL res = gGL.getTexUnit(0)->bindManual(mBindTarget, mTexName);
+	if (!res) llerrs << "LLImageGL::setSubImageFromBuffer(): bindTexture failed" << llendl;
+	stop_glerror();
+
+	// With a pixel unpack buffer bound, the data pointer is an offset into the buffer.
+	glTexSubImage2D(mTarget, 0, x_pos, y_pos, 
+					width, height, mFormatPrimary, mFormatType, (GLvoid*)((U8*)NULL + buffer_offset));
+	gGL.getTexUnit(0)->disable();
+	stop_glerror();
+
+	if(mFormatSwapBytes)
+	{
+		glPixelStorei(GL_UNPACK_SWAP_BYTES, 0);
+		stop_glerror();
+	}
+
+	mGLTextureCreated = true;
+	return TRUE;
+}
+
 // Copy sub image from frame buffer
 BOOL LLImageGL::setSubImageFromFrameBuffer(S32 fb_x, S32 fb_y, S32 x_pos, S32 y_pos, S32 width, S32 height)
 {
@@ -1074,11 +1134,20 @@ BOOL LLImageGL::createGLTexture(S32 discard_level, const LLImageRaw* imageraw, S
 			mFormatInternal = GL_RGB8;
 			mFormatPrimary = GL_RGB;
 			mFormatType = GL_UNSIGNED_BYTE;
+			if (mAllowCompression && gGLManager.mHasCompressedTextures)
+			{
+				// The driver compresses on upload
+				mFormatInternal = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+			}
 			break;
 		  case 4:
 			mFormatInternal = GL_RGBA8;
 			mFormatPrimary = GL_RGBA;
 			mFormatType = GL_UNSIGNED_BYTE;
+			if (mAllowCompression && gGLManager.mHasCompressedTextures)
+			{
+				mFormatInternal = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			}
 			break;
 		  default:
 			LL_DEBUGS("Openjpeg") << "Bad number of components for texture: " << (U32)getComponents() << LL_ENDL;
@@ -1440,14 +1509,22 @@ S32 LLImageGL::getMipBytes(S32 discard_level) const
 	}
 	S32 w = mWidth>>discard_level;
 	S32 h = mHeight>>discard_level;
-	S32 res = dataFormatBytes(mFormatPrimary, w, h);
+	// Count what the driver keeps, which is less than what was uploaded for
+	// textures it compressed.
+	S32 format = mFormatPrimary;
+	if (mFormatInternal >= GL_COMPRESSED_RGB_S3TC_DXT1_EXT &&
+		mFormatInternal <= GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+	{
+		format = mFormatInternal;
+	}
+	S32 res = dataFormatBytes(format, w, h);
 	if (mUseMipMaps)
 	{
 		while (w > 1 && h > 1)
 		{
 			w >>= 1; if (w == 0) w = 1;
 			h >>= 1; if (h == 0) h = 1;
-			res += dataFormatBytes(mFormatPrimary, w, h);
+			res += dataFormatBytes(format, w, h);
 		}
 	}
 	return res;
@@ -116,6 +116,9 @@ public:
 	BOOL setSubImage(const LLImageRaw* imageraw, S32 x_pos, S32 y_pos, S32 width, S32 height, BOOL force_fast_update = FALSE);
 	BOOL setSubImage(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, BOOL force_fast_update = FALSE);
 	BOOL setSubImageFromFrameBuffer(S32 fb_x, S32 fb_y, S32 x_pos, S32 y_pos, S32 width, S32 height);
+	// Like setSubImage(), but the pixels come from the currently bound GL_PIXEL_UNPACK_BUFFER_ARB,
+	// starting at buffer_offset and tightly packed (rows of width pixels).
+	BOOL setSubImageFromBuffer(U32 buffer_offset, S32 x_pos, S32 y_pos, S32 width, S32 height);
 	
 	// Read back a raw image for this discard level, if it exists
 	BOOL readBackRaw(S32 discard_level, LLImageRaw* imageraw, bool compressed_ok) const;
@@ -123,6 +126,9 @@ public:
 
 	void setExplicitFormat(LLGLint internal_format, LLGLenum primary_format, LLGLenum type_format = 0, BOOL swap_bytes = FALSE);
 	void setComponents(S8 ncomponents) { mComponents = ncomponents; }
+	// Lets the driver store RGB and RGBA images S3TC compressed, when it can.
+	// Note: must be called before createTexture()
+	void setAllowCompression(BOOL allow) { mAllowCompression = allow; }
 
 	S32	 getDiscardLevel() const		{ return mCurrentDiscardLevel; }
 	S32	 getMaxDiscardLevel() const		{ return mMaxDiscardLevel; }
@@ -192,6 +198,7 @@ private:
 	S8 mUseMipMaps;
 	S8 mHasExplicitFormat; // If false (default), GL format is f(mComponents)
 	S8 mAutoGenMips;
+	BOOL mAllowCompression;
 
 	BOOL mIsMask;
 	BOOL mNeedsAlphaAndPickMask;
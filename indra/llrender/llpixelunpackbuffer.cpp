@@ -0,0 +1,167 @@
+/** 
+ * @file llpixelunpackbuffer.cpp
+ * @brief Double buffered pixel buffer objects for streaming sub-image uploads
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llpixelunpackbuffer.h"
+
+#include "llgl.h"
+#include "llglheaders.h"
+#include "llimagegl.h"
+
+// Buffer storage is allocated in steps of this size so small changes in the
+// dirty area don't reallocate every frame.
+static const U32 PIXEL_BUFFER_GRANULARITY = 64 * 1024;
+
+std::set<LLPixelUnpackBuffer*> LLPixelUnpackBuffer::sInstances;
+
+LLPixelUnpackBuffer::LLPixelUnpackBuffer()
+:	mCurrentBuffer(0)
+{
+	mBuffers[0] = mBuffers[1] = 0;
+	mBufferSizes[0] = mBufferSizes[1] = 0;
+	sInstances.insert(this);
+}
+
+LLPixelUnpackBuffer::~LLPixelUnpackBuffer()
+{
+	destroyGL();
+	sInstances.erase(this);
+}
+
+void LLPixelUnpackBuffer::destroyGL()
+{
+	if (mBuffers[0])
+	{
+		glDeleteBuffersARB(2, (GLuint*)mBuffers);
+		mBuffers[0] = mBuffers[1] = 0;
+	}
+	mBufferSizes[0] = mBufferSizes[1] = 0;
+}
+
+//static
+void LLPixelUnpackBuffer::destroyAllGL()
+{
+	for (std::set<LLPixelUnpackBuffer*>::iterator iter = sInstances.begin(); iter != sInstances.end(); ++iter)
+	{
+		(*iter)->destroyGL();
+	}
+}
+
+U32 LLPixelUnpackBuffer::upload(LLImageGL* image, const U8* datap, S32 data_width, S32 data_height, const std::vector<LLRect>& rects)
+{
+	if (!image || !datap || rects.empty())
+	{
+		return 0;
+	}
+
+	if (!gGLManager.mHasPixelBufferObject)
+	{
+		return uploadImmediate(image, datap, data_width, data_height, rects);
+	}
+
+	const U32 components = image->getComponents();
+	U32 size = 0;
+	for (std::vector<LLRect>::const_iterator iter = rects.begin(); iter != rects.end(); ++iter)
+	{
+		size += iter->getWidth() * iter->getHeight() * components;
+	}
+
+	if (!mBuffers[0])
+	{
+		glGenBuffersARB(2, (GLuint*)mBuffers);
+	}
+
+	// Alternate buffers, so the one we write into was last used two uploads
+	// ago and the driver is done reading from it.
+	mCurrentBuffer = 1 - mCurrentBuffer;
+	glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, mBuffers[mCurrentBuffer]);
+	if (size > mBufferSizes[mCurrentBuffer])
+	{
+		mBufferSizes[mCurrentBuffer] = (size + PIXEL_BUFFER_GRANULARITY - 1) / PIXEL_BUFFER_GRANULARITY * PIXEL_BUFFER_GRANULARITY;
+		glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, mBufferSizes[mCurrentBuffer], NULL, GL_STREAM_DRAW_ARB);
+	}
+
+	U8* dst = (U8*)glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+	if (!dst)
+	{
+		llwarns << "Failed to map pixel unpack buffer, uploading directly" << llendl;
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+		return uploadImmediate(image, datap, data_width, data_height, rects);
+	}
+
+	// Pack the rects one after another, row by row.
+	U8* out = dst;
+	for (std::vector<LLRect>::const_iterator iter = rects.begin(); iter != rects.end(); ++iter)
+	{
+		const U32 row_bytes = iter->getWidth() * components;
+		const U8* in = datap + (iter->mBottom * data_width + iter->mLeft) * components;
+		for (S32 y = iter->mBottom; y < iter->mTop; ++y)
+		{
+			memcpy(out, in, row_bytes);
+			out += row_bytes;
+			in += data_width * components;
+		}
+	}
+
+	if (!glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB))
+	{
+		// Buffer contents were lost (e.g. a mode switch); just send this frame directly.
+		glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+		return uploadImmediate(image, datap, data_width, data_height, rects);
+	}
+
+	U32 offset = 0;
+	for (std::vector<LLRect>::const_iterator iter = rects.begin(); iter != rects.end(); ++iter)
+	{
+		image->setSubImageFromBuffer(offset, iter->mLeft, iter->mBottom, iter->getWidth(), iter->getHeight());
+		offset += iter->getWidth() * iter->getHeight() * components;
+	}
+
+	glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+	stop_glerror();
+
+	return size;
+}
+
+U32 LLPixelUnpackBuffer::uploadImmediate(LLImageGL* image, const U8* datap, S32 data_width, S32 data_height, const std::vector<LLRect>& rects)
+{
+	U32 size = 0;
+	for (std::vector<LLRect>::const_iterator iter = rects.begin(); iter != rects.end(); ++iter)
+	{
+		image->setSubImage(datap, data_width, data_height,
+						   iter->mLeft, iter->mBottom, iter->getWidth(), iter->getHeight(),
+						   TRUE);	// force a fast update (i.e. don't call analyzeAlpha, etc.)
+		size += iter->getWidth() * iter->getHeight() * image->getComponents();
+	}
+	return size;
+}
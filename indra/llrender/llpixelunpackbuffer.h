@@ -0,0 +1,73 @@
+/** 
+ * @file llpixelunpackbuffer.h
+ * @brief Double buffered pixel buffer objects for streaming sub-image uploads
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLPIXELUNPACKBUFFER_H
+#define LL_LLPIXELUNPACKBUFFER_H
+
+#include "llrect.h"
+#include <set>
+#include <vector>
+
+class LLImageGL;
+
+// Streams rectangles of a client-side image (typically a plugin's shared
+// memory) into an LLImageGL through a pair of pixel buffer objects.  Each
+// upload packs the rects into one buffer and alternates buffers between
+// calls, so filling this frame's buffer doesn't wait on the driver still
+// reading last frame's.  Falls back to LLImageGL::setSubImage() per rect
+// when GL_ARB_pixel_buffer_object isn't available.
+class LLPixelUnpackBuffer
+{
+public:
+	LLPixelUnpackBuffer();
+	~LLPixelUnpackBuffer();
+
+	// Copies each rect of datap (data_width x data_height pixels, in the
+	// image's format) to the same place in image.  Rects must lie inside
+	// both.  Returns the number of bytes uploaded.
+	U32 upload(LLImageGL* image, const U8* datap, S32 data_width, S32 data_height, const std::vector<LLRect>& rects);
+
+	// Releases the buffers; they're recreated on the next upload.
+	void destroyGL();
+	static void destroyAllGL();
+
+private:
+	U32 uploadImmediate(LLImageGL* image, const U8* datap, S32 data_width, S32 data_height, const std::vector<LLRect>& rects);
+
+	U32		mBuffers[2];
+	U32		mBufferSizes[2];
+	S32		mCurrentBuffer;
+
+	static std::set<LLPixelUnpackBuffer*> sInstances;
+};
+
+#endif // LL_LLPIXELUNPACKBUFFER_H
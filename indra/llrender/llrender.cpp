@@ -38,6 +38,7 @@
 #include "llcubemap.h"
 #include "llimagegl.h"
 #include "llrendertarget.h"
+#include "llretainedgeometry.h"
 #include "lltexture.h"
 
 LLRender gGL;
@@ -232,7 +233,10 @@ bool LLTexUnit::bind(LLTexture* texture, bool for_rendering, bool forceBind)
 		texture->forceImmediateUpdate();
 
 		gl_tex->forceUpdateBindStats();
-		return texture->bindDefaultImage(mIndex);
+		bool res = texture->bindDefaultImage(mIndex);
+		// a placeholder, don't let it be retained in place of the real image
+		mCurrImage = NULL;
+		return res;
 	}
 
 	//in audit, replace the selected texture by the default one.
@@ -250,6 +254,7 @@ bool LLTexUnit::bind(LLTexture* texture, bool for_rendering, bool forceBind)
 		activate();
 		enable(gl_tex->getTarget());
 		mCurrTexture = gl_tex->getTexName();
+		mCurrImage = gl_tex;
 		glBindTexture(sGLTextureType[gl_tex->getTarget()], mCurrTexture);
 		if (gl_tex->updateBindStats(gl_tex->mTextureMemory))
 		{
@@ -293,6 +298,7 @@ bool LLTexUnit::bind(LLImageGL* texture, bool for_rendering, bool forceBind)
 		activate();
 		enable(texture->getTarget());
 		mCurrTexture = texture->getTexName();
+		mCurrImage = texture;
 		glBindTexture(sGLTextureType[texture->getTarget()], mCurrTexture);
 		texture->updateBindStats(texture->mTextureMemory);		
 		mHasMipMaps = texture->mHasMipMaps;
@@ -326,6 +332,7 @@ bool LLTexUnit::bind(LLCubeMap* cubeMap)
 			activate();
 			enable(LLTexUnit::TT_CUBE_MAP);
 			mCurrTexture = cubeMap->mImages[0]->getTexName();
+			mCurrImage = NULL;
 			glBindTexture(GL_TEXTURE_CUBE_MAP_ARB, mCurrTexture);
 			mHasMipMaps = cubeMap->mImages[0]->mHasMipMaps;
 			cubeMap->mImages[0]->updateBindStats(cubeMap->mImages[0]->mTextureMemory);
@@ -386,6 +393,7 @@ bool LLTexUnit::bindManual(eTextureType type, U32 texture, bool hasMips)
 		activate();
 		enable(type);
 		mCurrTexture = texture;
+		mCurrImage = NULL;
 		glBindTexture(sGLTextureType[type], texture);
 		mHasMipMaps = hasMips;
 	}
@@ -405,6 +413,7 @@ void LLTexUnit::unbind(eTextureType type)
 
 		activate();
 		mCurrTexture = 0;
+		mCurrImage = NULL;
 		glBindTexture(sGLTextureType[type], 0);
 	}
 }
@@ -907,7 +916,8 @@ LLRender::LLRender()
 	mCount(0),
 	mMode(LLRender::TRIANGLES),
     mCurrTextureUnitIndex(0),
-	mMaxAnisotropy(0.f) 
+	mMaxAnisotropy(0.f),
+	mRecording(NULL)
 {
 	mTexUnits.reserve(LL_NUM_TEXTURE_LAYERS);
 	for (U32 i = 0; i < LL_NUM_TEXTURE_LAYERS; i++)
@@ -993,24 +1003,160 @@ void LLRender::translatef(const GLfloat& x, const GLfloat& y, const GLfloat& z)
 {
 	flush();
 	glTranslatef(x,y,z);
+	if (mRecording)
+	{
+		mRecordOffset += LLVector3(x * mRecordScale.mV[VX], y * mRecordScale.mV[VY], z * mRecordScale.mV[VZ]);
+	}
 }
 
 void LLRender::scalef(const GLfloat& x, const GLfloat& y, const GLfloat& z)
 {
 	flush();
 	glScalef(x,y,z);
+	if (mRecording)
+	{
+		mRecordScale.mV[VX] *= x;
+		mRecordScale.mV[VY] *= y;
+		mRecordScale.mV[VZ] *= z;
+	}
+}
+
+void LLRender::rotatef(const GLfloat& a, const GLfloat& x, const GLfloat& y, const GLfloat& z)
+{
+	flush();
+	abortRecording();
+	glRotatef(a,x,y,z);
+}
+
+void LLRender::loadIdentity()
+{
+	flush();
+	glLoadIdentity();
+	if (mRecording)
+	{
+		mRecordScale.setVec(1.f, 1.f, 1.f);
+		mRecordOffset.clearVec();
+	}
 }
 
 void LLRender::pushMatrix()
 {
 	flush();
 	glPushMatrix();
+	if (mRecording)
+	{
+		mRecordStack.push_back(std::make_pair(mRecordScale, mRecordOffset));
+	}
 }
 
 void LLRender::popMatrix()
 {
 	flush();
 	glPopMatrix();
+	if (mRecording)
+	{
+		if (mRecordStack.empty())
+		{
+			// popping past the matrix we started recording with
+			abortRecording();
+		}
+		else
+		{
+			mRecordScale = mRecordStack.back().first;
+			mRecordOffset = mRecordStack.back().second;
+			mRecordStack.pop_back();
+		}
+	}
+}
+
+bool LLRender::beginRecording(LLRetainedGeometry* geometry)
+{
+	llassert(geometry);
+	if (mRecording)
+	{
+		return false;
+	}
+
+	flush();
+
+	// Only axis aligned scale and translation can be tracked.
+	GLfloat modelview[16];
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+	if (modelview[1] != 0.f || modelview[2] != 0.f ||
+		modelview[4] != 0.f || modelview[6] != 0.f ||
+		modelview[8] != 0.f || modelview[9] != 0.f ||
+		modelview[3] != 0.f || modelview[7] != 0.f || modelview[11] != 0.f)
+	{
+		return false;
+	}
+
+	geometry->clear();
+	mRecording = geometry;
+	mRecordScale.setVec(modelview[0], modelview[5], modelview[10]);
+	mRecordOffset.setVec(modelview[12], modelview[13], modelview[14]);
+	mRecordStack.clear();
+	geometry->setTransform(mRecordScale, mRecordOffset);
+	return true;
+}
+
+bool LLRender::endRecording()
+{
+	flush();
+	if (!mRecording)
+	{
+		return false;
+	}
+
+	mRecording->finish(getCurrentColor());
+	mRecording = NULL;
+	mRecordStack.clear();
+	return true;
+}
+
+void LLRender::abortRecording()
+{
+	// Vertices already in the immediate buffer are still drawn by the next
+	// flush(), just no longer recorded.
+	if (mRecording)
+	{
+		mRecording->clear();
+		mRecording = NULL;
+		mRecordStack.clear();
+	}
+}
+
+void LLRender::recordFlush()
+{
+	// Geometry is replayed with only texture unit 0 rebound, so anything
+	// relying on other units or on texture environment state can't be kept.
+	LLTexUnit* unit = mTexUnits[0];
+	LLImageGL* image = NULL;
+	if (unit->mCurrTexType != LLTexUnit::TT_NONE && unit->mCurrTexture != 0)
+	{
+		if (unit->mCurrTexType != LLTexUnit::TT_TEXTURE ||
+			unit->mCurrImage.isNull() ||
+			unit->mCurrImage->getTexName() != unit->mCurrTexture)
+		{
+			abortRecording();
+			return;
+		}
+		image = unit->mCurrImage;
+	}
+	if (unit->mCurrBlendType != LLTexUnit::TB_MULT)
+	{
+		abortRecording();
+		return;
+	}
+	for (U32 i = 1; i < mTexUnits.size(); i++)
+	{
+		if (mTexUnits[i]->mCurrTexType != LLTexUnit::TT_NONE && mTexUnits[i]->mCurrTexture != 0)
+		{
+			abortRecording();
+			return;
+		}
+	}
+
+	mRecording->append(mMode, image, mVerticesp, mTexcoordsp, mColorsp, mCount, mRecordScale, mRecordOffset);
 }
 
 void LLRender::setColorMask(bool writeColor, bool writeAlpha)
@@ -1027,6 +1173,7 @@ void LLRender::setColorMask(bool writeColorR, bool writeColorG, bool writeColorB
 		mCurrColorMask[2] != writeColorB ||
 		mCurrColorMask[3] != writeAlpha)
 	{
+		abortRecording();
 		mCurrColorMask[0] = writeColorR;
 		mCurrColorMask[1] = writeColorG;
 		mCurrColorMask[2] = writeColorB;
@@ -1078,6 +1225,7 @@ void LLRender::setAlphaRejectSettings(eCompareFunc func, F32 value)
 	{
 		mCurrAlphaFunc = func;
 		mCurrAlphaFuncVal = value;
+		abortRecording();
 		if (func == CF_DEFAULT)
 		{
 			glAlphaFunc(GL_GREATER, 0.01f);
@@ -1101,6 +1249,7 @@ void LLRender::blendFunc(eBlendFactor sfactor, eBlendFactor dfactor)
 		mCurrBlendColorDFactor = dfactor;
 		mCurrBlendAlphaDFactor = dfactor;
 		flush();
+		abortRecording();
 		glBlendFunc(sGLBlendFactor[sfactor], sGLBlendFactor[dfactor]);
 	}
 }
@@ -1126,6 +1275,7 @@ void LLRender::blendFunc(eBlendFactor color_sfactor, eBlendFactor color_dfactor,
 		mCurrBlendColorDFactor = color_dfactor;
 		mCurrBlendAlphaDFactor = alpha_dfactor;
 		flush();
+		abortRecording();
 		glBlendFuncSeparateEXT(sGLBlendFactor[color_sfactor], sGLBlendFactor[color_dfactor],
 							   sGLBlendFactor[alpha_sfactor], sGLBlendFactor[alpha_dfactor]);
 	}
@@ -1286,8 +1436,15 @@ void LLRender::flush()
 			}
 		}
 
+		if (mRecording)
+		{
+			recordFlush();
+		}
+
 		mBuffer->setBuffer(immediate_mask);
 		mBuffer->drawArrays(mMode, 0, mCount);
+		mDrawStats.mFlushes++;
+		mDrawStats.mVertices += mCount;
 		
 		mVerticesp[0] = mVerticesp[mCount];
 		mTexcoordsp[0] = mTexcoordsp[mCount];
@@ -1415,6 +1572,12 @@ void LLRender::color4ub(const GLubyte& r, const GLubyte& g, const GLubyte& b, co
 	mColorsp[mCount] = LLColor4U(r,g,b,a);
 }
 
+LLColor4U LLRender::getCurrentColor() const
+{
+	LLStrider<LLColor4U> colors = mColorsp;
+	return colors[mCount];
+}
+
 void LLRender::color4ubv(const GLubyte* c)
 {
 	color4ub(c[0], c[1], c[2], c[3]);
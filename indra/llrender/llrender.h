@@ -52,6 +52,7 @@ class LLVertexBuffer;
 class LLCubeMap;
 class LLImageGL;
 class LLRenderTarget;
+class LLRetainedGeometry;
 class LLTexture;
 
 class LLTexUnit
@@ -199,6 +200,7 @@ public:
 protected:
 	S32					mIndex;
 	U32					mCurrTexture;
+	LLPointer<LLImageGL> mCurrImage;	// image behind mCurrTexture, if bound through an LLImageGL
 	eTextureType		mCurrTexType;
 	eTextureBlendType	mCurrBlendType;
 	eTextureBlendOp		mCurrColorOp;
@@ -322,11 +324,36 @@ public:
 
 	void translatef(const GLfloat& x, const GLfloat& y, const GLfloat& z);
 	void scalef(const GLfloat& x, const GLfloat& y, const GLfloat& z);
+	void rotatef(const GLfloat& a, const GLfloat& x, const GLfloat& y, const GLfloat& z);
+	void loadIdentity();
 	void pushMatrix();
 	void popMatrix();
 
 	void flush();
 
+	// Retained drawing: between beginRecording() and endRecording() every
+	// batch flushed is also copied into the given LLRetainedGeometry, which
+	// can then replay the whole sequence as a single vertex buffer.  Drawing
+	// still happens normally while recording.  State the retained geometry
+	// can't represent (rotation, blend or color mask changes, multitexturing,
+	// textures bound by name only) aborts the recording.
+	bool beginRecording(LLRetainedGeometry* geometry);
+	bool endRecording();		// returns false if the recording was aborted
+	void abortRecording();
+	bool isRecording() const	{ return mRecording != NULL; }
+
+	struct DrawStats
+	{
+		DrawStats() : mFlushes(0), mVertices(0), mRetainedDraws(0), mRetainedVertices(0) {}
+		U32 mFlushes;			// immediate mode draw calls
+		U32 mVertices;			// vertices sent through immediate mode
+		U32 mRetainedDraws;		// draw calls replayed from retained geometry
+		U32 mRetainedVertices;	// vertices replayed from retained geometry
+	};
+
+	// Running totals since startup; callers take deltas.
+	const DrawStats& getDrawStats() const	{ return mDrawStats; }
+
 	void begin(const GLuint& mode);
 	void end();
 	void vertex2i(const GLint& x, const GLint& y);
@@ -374,6 +401,9 @@ public:
 
 	void clearErrors();
 
+	// Current immediate mode color, as the next vertex would get it.
+	LLColor4U getCurrentColor() const;
+
 	struct Vertex
 	{
 		GLfloat v[3];
@@ -406,6 +436,20 @@ private:
 	eBlendFactor mCurrBlendAlphaDFactor;
 
 	F32				mMaxAnisotropy;
+
+	DrawStats		mDrawStats;
+
+	// Recording state.  While recording we track the modelview as a
+	// scale and translation so flushed vertices can be stored in window
+	// coordinates.
+	void recordFlush();
+
+	LLRetainedGeometry*	mRecording;
+	LLVector3		mRecordScale;
+	LLVector3		mRecordOffset;
+	std::vector<std::pair<LLVector3, LLVector3> > mRecordStack;
+
+	friend class LLRetainedGeometry;
 };
 
 extern F64 gGLModelView[16];
@@ -0,0 +1,223 @@
+/** 
+ * @file llretainedgeometry.cpp
+ * @brief Immediate mode geometry recorded once and replayed from a vertex buffer
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llretainedgeometry.h"
+
+#include "llimagegl.h"
+#include "llrender.h"
+#include "llvertexbuffer.h"
+
+static const U32 RETAINED_GEOMETRY_MASK = LLVertexBuffer::MAP_VERTEX | LLVertexBuffer::MAP_COLOR | LLVertexBuffer::MAP_TEXCOORD0;
+
+// Replay snaps to whole pixels like LLFontGL does; anything further off
+// than this is treated as a fractional translation.
+static const F32 RETAINED_GEOMETRY_EPSILON = 0.001f;
+
+LLRetainedGeometry::LLRetainedGeometry()
+:	mValid(FALSE),
+	mVertexCount(0),
+	mScale(1.f, 1.f, 1.f)
+{
+}
+
+LLRetainedGeometry::~LLRetainedGeometry()
+{
+	if (gGL.mRecording == this)
+	{
+		gGL.abortRecording();
+	}
+}
+
+void LLRetainedGeometry::clear()
+{
+	mValid = FALSE;
+	mVertexCount = 0;
+	mBatches.clear();
+	mBuffer = NULL;
+	mVertices.clear();
+	mTexCoords.clear();
+	mColors.clear();
+}
+
+void LLRetainedGeometry::setTransform(const LLVector3& scale, const LLVector3& offset)
+{
+	mScale = scale;
+	mOffset = offset;
+}
+
+void LLRetainedGeometry::append(U32 mode, LLImageGL* image,
+								LLStrider<LLVector3> vertices, LLStrider<LLVector2> tex_coords, LLStrider<LLColor4U> colors,
+								U32 count, const LLVector3& scale, const LLVector3& offset)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	S32 start = (S32)mVertices.size();
+	for (U32 i = 0; i < count; i++)
+	{
+		const LLVector3& v = vertices[i];
+		mVertices.push_back(LLVector3(v.mV[VX] * scale.mV[VX] + offset.mV[VX],
+									  v.mV[VY] * scale.mV[VY] + offset.mV[VY],
+									  v.mV[VZ] * scale.mV[VZ] + offset.mV[VZ]));
+		mTexCoords.push_back(tex_coords[i]);
+		mColors.push_back(colors[i]);
+	}
+
+	// Independent primitives can share a draw call with the previous batch;
+	// strips, fans and loops can't.
+	bool mergeable = mode == LLRender::QUADS || mode == LLRender::TRIANGLES ||
+					 mode == LLRender::LINES || mode == LLRender::POINTS;
+	if (mergeable && !mBatches.empty())
+	{
+		Batch& last = mBatches.back();
+		if (last.mMode == mode && last.mImage.get() == image)
+		{
+			last.mCount += count;
+			return;
+		}
+	}
+
+	Batch batch;
+	batch.mMode = mode;
+	batch.mStart = start;
+	batch.mCount = count;
+	batch.mImage = image;
+	mBatches.push_back(batch);
+}
+
+void LLRetainedGeometry::finish(const LLColor4U& final_color)
+{
+	mFinalColor = final_color;
+	mVertexCount = (S32)mVertices.size();
+	if (mVertexCount == 0)
+	{
+		// nothing drawn is still a valid recording
+		mValid = TRUE;
+		return;
+	}
+
+	mBuffer = new LLVertexBuffer(RETAINED_GEOMETRY_MASK, GL_STATIC_DRAW_ARB);
+	mBuffer->allocateBuffer(mVertexCount, 0, TRUE);
+
+	LLStrider<LLVector3> vertices;
+	LLStrider<LLVector2> tex_coords;
+	LLStrider<LLColor4U> colors;
+	if (!mBuffer->getVertexStrider(vertices) ||
+		!mBuffer->getTexCoord0Strider(tex_coords) ||
+		!mBuffer->getColorStrider(colors))
+	{
+		clear();
+		return;
+	}
+
+	for (S32 i = 0; i < mVertexCount; i++)
+	{
+		*(vertices++) = mVertices[i];
+		*(tex_coords++) = mTexCoords[i];
+		*(colors++) = mColors[i];
+	}
+	mBuffer->setBuffer(0);
+
+	// the buffer owns the data from here on
+	std::vector<LLVector3>().swap(mVertices);
+	std::vector<LLVector2>().swap(mTexCoords);
+	std::vector<LLColor4U>().swap(mColors);
+
+	mValid = TRUE;
+}
+
+BOOL LLRetainedGeometry::replay()
+{
+	if (!mValid || gGL.isRecording())
+	{
+		return FALSE;
+	}
+
+	GLfloat modelview[16];
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+	if (modelview[1] != 0.f || modelview[2] != 0.f ||
+		modelview[4] != 0.f || modelview[6] != 0.f ||
+		modelview[8] != 0.f || modelview[9] != 0.f ||
+		llabs(modelview[0] - mScale.mV[VX]) > RETAINED_GEOMETRY_EPSILON ||
+		llabs(modelview[5] - mScale.mV[VY]) > RETAINED_GEOMETRY_EPSILON ||
+		llabs(modelview[10] - mScale.mV[VZ]) > RETAINED_GEOMETRY_EPSILON)
+	{
+		return FALSE;
+	}
+
+	F32 delta_x = modelview[12] - mOffset.mV[VX];
+	F32 delta_y = modelview[13] - mOffset.mV[VY];
+	F32 delta_z = modelview[14] - mOffset.mV[VZ];
+	if (llabs(delta_x - llround(delta_x)) > RETAINED_GEOMETRY_EPSILON ||
+		llabs(delta_y - llround(delta_y)) > RETAINED_GEOMETRY_EPSILON)
+	{
+		// text was snapped to the pixel grid when recorded
+		return FALSE;
+	}
+
+	if (mBatches.empty())
+	{
+		return TRUE;
+	}
+
+	gGL.flush();
+	gGL.pushMatrix();
+	gGL.loadIdentity();
+	gGL.translatef((F32)llround(delta_x), (F32)llround(delta_y), delta_z);
+
+	LLTexUnit* unit = gGL.getTexUnit(0);
+	mBuffer->setBuffer(RETAINED_GEOMETRY_MASK);
+	for (std::vector<Batch>::iterator iter = mBatches.begin(); iter != mBatches.end(); ++iter)
+	{
+		Batch& batch = *iter;
+		if (batch.mImage.notNull())
+		{
+			unit->bind(batch.mImage.get());
+		}
+		else
+		{
+			unit->unbind(LLTexUnit::TT_TEXTURE);
+		}
+		mBuffer->drawArrays(batch.mMode, batch.mStart, batch.mCount);
+	}
+
+	gGL.mDrawStats.mRetainedDraws += mBatches.size();
+	gGL.mDrawStats.mRetainedVertices += mVertexCount;
+
+	gGL.popMatrix();
+	gGL.color4ubv(mFinalColor.mV);
+	return TRUE;
+}
@@ -0,0 +1,99 @@
+/** 
+ * @file llretainedgeometry.h
+ * @brief Immediate mode geometry recorded once and replayed from a vertex buffer
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLRETAINEDGEOMETRY_H
+#define LL_LLRETAINEDGEOMETRY_H
+
+#include "v2math.h"
+#include "v3math.h"
+#include "v4coloru.h"
+#include "llstrider.h"
+#include "llpointer.h"
+
+class LLImageGL;
+class LLVertexBuffer;
+
+// Holds everything LLRender flushed between beginRecording() and
+// endRecording(), in window coordinates, as one static vertex buffer plus a
+// list of (mode, texture, range) batches.  Replaying it draws the same
+// pixels as the original immediate mode calls as long as the modelview has
+// the same scale and an integer pixel translation; otherwise replay() fails
+// and the owner should draw (and record) again.
+class LLRetainedGeometry
+{
+public:
+	LLRetainedGeometry();
+	~LLRetainedGeometry();
+
+	BOOL isValid() const			{ return mValid; }
+	void invalidate()				{ clear(); }
+
+	// Draws the recorded geometry at the current modelview.  Returns FALSE
+	// if nothing is recorded or the transform isn't compatible.
+	BOOL replay();
+
+	S32 getVertexCount() const		{ return mVertexCount; }
+	S32 getBatchCount() const		{ return (S32)mBatches.size(); }
+
+private:
+	friend class LLRender;
+
+	void clear();
+	void setTransform(const LLVector3& scale, const LLVector3& offset);
+	void append(U32 mode, LLImageGL* image,
+				LLStrider<LLVector3> vertices, LLStrider<LLVector2> tex_coords, LLStrider<LLColor4U> colors,
+				U32 count, const LLVector3& scale, const LLVector3& offset);
+	void finish(const LLColor4U& final_color);
+
+	struct Batch
+	{
+		U32		mMode;
+		S32		mStart;
+		S32		mCount;
+		LLPointer<LLImageGL> mImage;
+	};
+
+	BOOL					mValid;
+	S32						mVertexCount;
+	std::vector<Batch>		mBatches;
+	LLPointer<LLVertexBuffer> mBuffer;
+	LLVector3				mScale;
+	LLVector3				mOffset;
+	LLColor4U				mFinalColor;	// immediate mode color left behind by the recorded draw
+
+	// only used while recording
+	std::vector<LLVector3>	mVertices;
+	std::vector<LLVector2>	mTexCoords;
+	std::vector<LLColor4U>	mColors;
+};
+
+#endif // LL_LLRETAINEDGEOMETRY_H
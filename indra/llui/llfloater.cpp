@@ -50,6 +50,7 @@
 #include "llmenugl.h"	// MENU_BAR_HEIGHT
 #include "lltextbox.h"
 #include "llresmgr.h"
+#include "llrender.h"
 #include "llui.h"
 #include "llwindow.h"
 #include "llstl.h"
@@ -2331,7 +2332,47 @@ void LLFloaterView::draw()
 	}
 	else
 	{
-		LLView::draw();
+		static LLCachedControl<bool> sShowDrawCost(*LLUI::sConfigGroup, "DebugShowUIDrawCost");
+		if (sShowDrawCost)
+		{
+			drawWithCosts();
+		}
+		else
+		{
+			LLView::draw();
+		}
+	}
+}
+
+void LLFloaterView::drawWithCosts()
+{
+	const LLFontGL* font = LLFontGL::getFontMonospace();
+	const LLRect& root_rect = getRootView()->getRect();
+
+	for (child_list_const_reverse_iter_t child_it = getChildList()->rbegin(); child_it != getChildList()->rend(); ++child_it)
+	{
+		LLView* viewp = *child_it;
+		LLRect screen_rect;
+		localRectToScreen(viewp->getRect(), &screen_rect);
+		if (!viewp->getVisible() || !viewp->getRect().isValid() || !root_rect.overlaps(screen_rect))
+		{
+			continue;
+		}
+
+		// flush so each floater's vertices are counted against it
+		gGL.flush();
+		LLRender::DrawStats before = gGL.getDrawStats();
+		drawChild(viewp);
+		gGL.flush();
+		const LLRender::DrawStats& after = gGL.getDrawStats();
+
+		std::string cost = llformat("%u draws %u verts, %u retained draws %u verts",
+									after.mFlushes - before.mFlushes,
+									after.mVertices - before.mVertices,
+									after.mRetainedDraws - before.mRetainedDraws,
+									after.mRetainedVertices - before.mRetainedVertices);
+		font->renderUTF8(cost, 0, viewp->getRect().mLeft, viewp->getRect().mTop + 2, LLColor4::yellow,
+						 LLFontGL::LEFT, LLFontGL::BOTTOM, LLFontGL::DROP_SHADOW);
 	}
 }
 
@@ -386,6 +386,9 @@ public:
 	void setSnapOffsetBottom(S32 offset) { mSnapOffsetBottom = offset; }
 
 private:
+	// LLView::draw() for the floaters, also printing what each one costs
+	void			drawWithCosts();
+
 	S32				mColumn;
 	S32				mNextLeft;
 	S32				mNextTop;
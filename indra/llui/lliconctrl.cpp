@@ -91,6 +91,7 @@ void LLIconCtrl::setImage(const std::string& image_name)
 		mImageName = image_name;
 		mImagep = LLUI::getUIImage(image_name);
 		mImageID.setNull();
+		dirtyRetainedDrawing();
 	}
 }
 
@@ -99,6 +100,7 @@ void LLIconCtrl::setImage(const LLUUID& image_id)
 	mImageName.clear();
 	mImagep = LLUI::getUIImageByID(image_id);
 	mImageID = image_id;
+	dirtyRetainedDrawing();
 }
 
 
@@ -116,6 +118,7 @@ void LLIconCtrl::draw()
 void LLIconCtrl::setAlpha(F32 alpha)
 {
 	mColor.setAlpha(alpha);
+	dirtyRetainedDrawing();
 }
 
 // virtual
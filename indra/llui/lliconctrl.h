@@ -55,6 +55,7 @@ public:
 
 	// llview overrides
 	virtual void	draw();
+	virtual BOOL	isStaticDrawing() const	{ return TRUE; }
 
 	void			setImage(const std::string& image_name);
 	void			setImage(const LLUUID& image_name);
@@ -67,7 +68,7 @@ public:
 
 	/*virtual*/ void	setAlpha(F32 alpha);
 
-	void			setColor(const LLColor4& color) { mColor = color; }
+	void			setColor(const LLColor4& color) { mColor = color; dirtyRetainedDrawing(); }
 
 	virtual LLXMLNodePtr getXML(bool save_children = true) const;
 	static LLView* fromXML(LLXMLNodePtr node, LLView *parent, LLUICtrlFactory *factory);
@@ -171,7 +171,8 @@ LLLineEditor::LLLineEditor(const std::string& name, const LLRect& rect,
 		mHaveHistory(FALSE),
 		mImage( sImage ),
 		mReplaceNewlinesWithSpaces( TRUE ),
-		mOverRideAndShowMisspellings( FALSE )
+		mOverRideAndShowMisspellings( FALSE ),
+		mSpellGeneration( 0 )
 {
 	llassert( max_length_bytes > 0 );
 
@@ -585,10 +586,11 @@ std::vector<S32> LLLineEditor::getMisspelledWordsPositions()
 				wordEnd++;
 			}	
 			//got a word :D
-			std::string selectedWord(std::string(text.begin(), 
-				text.end()).substr(wordStart,wordEnd-wordStart));
+			std::string selectedWord(text.begin() + wordStart, text.begin() + wordEnd);
 			
-			if(!glggHunSpell->isSpelledRight(selectedWord))
+			// Words still being checked are picked up once the results
+			// come in, see drawMisspelled()
+			if(glggHunSpell->checkSpelling(selectedWord) == lggHunSpell_Wrapper::SPELLED_WRONG)
 			{	
 				//misspelled word here, and you have just right clicked on it!
 				//get the center of this word..
@@ -1903,10 +1905,13 @@ void LLLineEditor::drawMisspelled(LLRect background)
 		S32 newStopSpellHere = ( ((S32)mText.length())>cursorloc)?cursorloc:(S32)mText.length();
 
 		F32 elapsed = mSpellTimer.getElapsedTimeF32();
-		if(S32(elapsed / 1) & 1) 
+		U32 spell_generation = glggHunSpell->getSpellGeneration();
+		if((S32(elapsed / 1) & 1) || (spell_generation != mSpellGeneration))
 		{
-			if(isSpellDirty()||(newStartSpellHere!=mStartSpellHere)||(newStopSpellHere!=mEndSpellHere))
+			if(isSpellDirty()||(newStartSpellHere!=mStartSpellHere)||(newStopSpellHere!=mEndSpellHere)
+				|| (spell_generation != mSpellGeneration))
 			{
+				mSpellGeneration = spell_generation;
 				mStartSpellHere=newStartSpellHere;
 				mEndSpellHere= newStopSpellHere;
 				resetSpellDirty();
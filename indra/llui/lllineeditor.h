@@ -294,6 +294,7 @@ protected:
 	S32				mStartSpellHere;		// the position of the first char on the screen, stored so we know when to update
 	S32				mEndSpellHere;			// the location of the last char on the screen
 	BOOL		mOverRideAndShowMisspellings;
+	U32			mSpellGeneration;			// spell checker results last looked at
 	LLFrameTimer mSpellTimer;
 	//to keep track of what we have to remove before showing menu
 	std::vector<SpellMenuBind* > suggestionMenuItems;
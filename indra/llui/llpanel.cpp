@@ -36,6 +36,8 @@
 
 #include "llpanel.h"
 
+#include <typeinfo>
+
 #include "llalertdialog.h"
 #include "llfocusmgr.h"
 #include "llfontgl.h"
@@ -206,10 +208,18 @@ void LLPanel::draw()
 	LLView::draw();
 }
 
+// virtual
+BOOL LLPanel::isStaticDrawing() const
+{
+	// subclasses may draw anything
+	return typeid(*this) == typeid(LLPanel);
+}
+
 /*virtual*/
 void LLPanel::setAlpha(F32 alpha)
 {
 	mBgColorOpaque.setAlpha(alpha);
+	dirtyRetainedDrawing();
 }
 
 void LLPanel::updateDefaultBtn()
@@ -75,6 +75,7 @@ public:
 	// LLView interface
 	/*virtual*/ BOOL 	isPanel() const;
 	/*virtual*/ void	draw();	
+	/*virtual*/ BOOL	isStaticDrawing() const;
 	/*virtual*/ BOOL	handleKeyHere( KEY key, MASK mask );
 	/*virtual*/ LLXMLNodePtr getXML(bool save_children = true) const;
 	// Override to set not found list:
@@ -114,13 +115,13 @@ public:
 	}
 	BOOL			checkRequirements();
 
-	void			setBackgroundColor( const LLColor4& color ) { mBgColorOpaque = color; }
+	void			setBackgroundColor( const LLColor4& color ) { mBgColorOpaque = color; dirtyRetainedDrawing(); }
 	const LLColor4&	getBackgroundColor() const { return mBgColorOpaque; }
-	void			setTransparentColor(const LLColor4& color) { mBgColorAlpha = color; }
+	void			setTransparentColor(const LLColor4& color) { mBgColorAlpha = color; dirtyRetainedDrawing(); }
 	const LLColor4& getTransparentColor() const { return mBgColorAlpha; }
-	void			setBackgroundVisible( BOOL b )	{ mBgVisible = b; }
+	void			setBackgroundVisible( BOOL b )	{ mBgVisible = b; dirtyRetainedDrawing(); }
 	BOOL			isBackgroundVisible() const { return mBgVisible; }
-	void			setBackgroundOpaque(BOOL b)		{ mBgOpaque = b; }
+	void			setBackgroundOpaque(BOOL b)		{ mBgOpaque = b; dirtyRetainedDrawing(); }
 	BOOL			isBackgroundOpaque() const { return mBgOpaque; }
 	void			setDefaultBtn(LLButton* btn = NULL);
 	void			setDefaultBtn(const std::string& id);
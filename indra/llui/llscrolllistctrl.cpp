@@ -76,12 +76,13 @@ struct SortScrollListItem
 			S32 col_idx = it->first;
 			BOOL sort_ascending = it->second;
 
-			const LLScrollListCell *cell1 = i1->getColumn(col_idx);
-			const LLScrollListCell *cell2 = i2->getColumn(col_idx);
+			// compare cell values without building the cells of rows that haven't been drawn yet
+			const LLSD value1 = i1->getCellValue(col_idx);
+			const LLSD value2 = i2->getCellValue(col_idx);
 			S32 order = sort_ascending ? 1 : -1; // ascending or descending sort for this column?
-			if (cell1 && cell2)
+			if (value1.isDefined() && value2.isDefined())
 			{
-				sort_result = order * LLStringUtil::compareDict(cell1->getValue().asString(), cell2->getValue().asString());
+				sort_result = order * LLStringUtil::compareDict(value1.asString(), value2.asString());
 				if (sort_result != 0)
 				{
 					break; // we have a sort order!
@@ -442,6 +443,42 @@ void LLScrollListItem::setNumColumns(S32 columns)
 	}
 }
 
+void LLScrollListItem::setPendingCells(LLScrollListCtrl* factory, const LLSD& cells)
+{
+	std::for_each(mColumns.begin(), mColumns.end(), DeletePointer());
+	mColumns.clear();
+
+	mPendingCells = cells;
+	mCellFactory = factory;
+}
+
+void LLScrollListItem::buildPendingCells() const
+{
+	LLScrollListCtrl* factory = mCellFactory;
+	LLSD cells = mPendingCells;
+	mCellFactory = NULL;
+	mPendingCells.clear();
+
+	factory->buildCells(const_cast<LLScrollListItem*>(this), cells);
+}
+
+LLSD LLScrollListItem::getCellValue(S32 column) const
+{
+	if (mCellFactory)
+	{
+		if (column < 0)
+		{
+			return LLSD();
+		}
+		const LLSD& cells = mPendingCells;
+		// columns without a description get an empty text cell
+		return cells[column].isDefined() ? cells[column]["value"] : LLSD(LLStringUtil::null);
+	}
+
+	const LLScrollListCell* cell = getColumn(column);
+	return cell ? cell->getValue() : LLSD();
+}
+
 void LLScrollListItem::setColumn( S32 column, LLScrollListCell *cell )
 {
 	if (column < (S32)mColumns.size())
@@ -623,6 +660,7 @@ LLScrollListCtrl::LLScrollListCtrl(const std::string& name, const LLRect& rect,
 	mTotalStaticColumnWidth(0),
 	mTotalColumnPadding(0),
 	mSorted(TRUE),
+	mRescanContentWidths(TRUE),
 	mDirty(FALSE),
 	mOriginalSelection(-1),
 	mDrewSelected(FALSE)
@@ -728,6 +766,9 @@ void LLScrollListCtrl::clearRows()
 {
 	std::for_each(mItemList.begin(), mItemList.end(), DeletePointer());
 	mItemList.clear();
+	mItemIndex.clear();
+	mUnmeasuredItems.clear();
+	mRescanContentWidths = TRUE;
 	//mItemCount = 0;
 
 	// Scroll the bar back up to the top.
@@ -831,14 +872,26 @@ std::vector<LLScrollListItem*> LLScrollListCtrl::getAllData() const
 // returns first matching item
 LLScrollListItem* LLScrollListCtrl::getItem(const LLSD& sd) const
 {
-	std::string string_val = sd.asString();
+	// assumes string representation is good enough for comparison
+	return findItem(sd.asString(), FALSE);
+}
+
+// Finds the first item whose value has this string form, searching the list
+// only when several items share it.
+LLScrollListItem* LLScrollListCtrl::findItem(const std::string& key, BOOL enabled_only) const
+{
+	BOOL ambiguous = FALSE;
+	LLScrollListItem* found = mItemIndex.findItem(key, &ambiguous);
+	if (!ambiguous)
+	{
+		return (found && (found->getEnabled() || !enabled_only)) ? found : NULL;
+	}
 
 	item_list::const_iterator iter;
 	for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
 	{
 		LLScrollListItem* item  = *iter;
-		// assumes string representation is good enough for comparison
-		if (item->getValue().asString() == string_val)
+		if ((item->getEnabled() || !enabled_only) && item->getValue().asString() == key)
 		{
 			return item;
 		}
@@ -913,7 +966,8 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 		{
 		case ADD_TOP:
 			mItemList.push_front(item);
-			setSorted(FALSE);
+			mItemIndex.invalidateOrder();
+			mSorted = FALSE;
 			break;
 	
 		case ADD_SORTED:
@@ -930,20 +984,28 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 				
 				// ADD_SORTED just sorts by first column...
 				// this might not match user sort criteria, so flag list as being in unsorted state
-				setSorted(FALSE);
+				mItemIndex.invalidateOrder();
+				mSorted = FALSE;
 				break;
 			}	
 		case ADD_BOTTOM:
+			// rows already sorted stay that way, only the new tail needs sorting
 			mItemList.push_back(item);
-			setSorted(FALSE);
+			mSorted = FALSE;
 			break;
 	
 		default:
 			llassert(0);
 			mItemList.push_back(item);
-			setSorted(FALSE);
+			mSorted = FALSE;
 			break;
 		}
+
+		mItemIndex.addItem(item->getValue().asString(), item);
+		if (!mRescanContentWidths)
+		{
+			mUnmeasuredItems.push_back(item);
+		}
 	
 		// create new column on demand
 		if (mColumns.empty() && requires_column)
@@ -955,7 +1017,11 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 			addColumn(new_column);
 		}
 
-		updateLineHeightInsert(item);
+		// rows without cells yet update the line height when drawn
+		if (item->isMaterialized())
+		{
+			updateLineHeightInsert(item);
+		}
 
 		updateLayout();
 	}
@@ -963,14 +1029,13 @@ BOOL LLScrollListCtrl::addItem( LLScrollListItem* item, EAddPosition pos, BOOL r
 	return not_too_big;
 }
 
-// NOTE: This is *very* expensive for large lists, especially when we are dirtying the list every frame
-//  while receiving a long list of names.
-// *TODO: Use bookkeeping to make this an incramental cost with item additions
+const S32 HEADING_TEXT_PADDING = 25;
+const S32 COLUMN_TEXT_PADDING = 10;
+
+// Content widths only grow as items are added, so only new items are measured
+// unless something (deletion, in place edits, column changes) forces a rescan.
 void LLScrollListCtrl::calcColumnWidths()
 {
-	const S32 HEADING_TEXT_PADDING = 25;
-	const S32 COLUMN_TEXT_PADDING = 10;
-
 	mMaxContentWidth = 0;
 
 	S32 max_item_width = 0;
@@ -994,23 +1059,58 @@ void LLScrollListCtrl::calcColumnWidths()
 
 		column->setWidth(new_width);
 
-		// update max content width for this column, by looking at all items
-		column->mMaxContentWidth = column->mHeader ? LLFontGL::getFontSansSerifSmall()->getWidth(column->mLabel) + mColumnPadding + HEADING_TEXT_PADDING : 0;
+		if (mRescanContentWidths)
+		{
+			column->mMaxContentWidth = column->mHeader ? LLFontGL::getFontSansSerifSmall()->getWidth(column->mLabel) + mColumnPadding + HEADING_TEXT_PADDING : 0;
+		}
+	}
+
+	// update max content width for each column, by looking at all or only the new items
+	if (mRescanContentWidths)
+	{
 		item_list::iterator iter;
 		for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
 		{
-			LLScrollListCell* cellp = (*iter)->getColumn(column->mIndex);
-			if (!cellp) continue;
-
-			column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(cellp->getValue().asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
+			measureItem(*iter);
+		}
+		mRescanContentWidths = FALSE;
+	}
+	else
+	{
+		std::vector<LLScrollListItem*>::iterator iter;
+		for (iter = mUnmeasuredItems.begin(); iter != mUnmeasuredItems.end(); iter++)
+		{
+			measureItem(*iter);
 		}
+	}
+	mUnmeasuredItems.clear();
 
-		max_item_width += column->mMaxContentWidth;
+	for (column_itor = mColumnsIndexed.begin(); column_itor != mColumnsIndexed.end(); ++column_itor)
+	{
+		if (*column_itor)
+		{
+			max_item_width += (*column_itor)->mMaxContentWidth;
+		}
 	}
 
 	mMaxContentWidth = max_item_width;
 }
 
+void LLScrollListCtrl::measureItem(LLScrollListItem* item)
+{
+	ordered_columns_t::iterator column_itor;
+	for (column_itor = mColumnsIndexed.begin(); column_itor != mColumnsIndexed.end(); ++column_itor)
+	{
+		LLScrollListColumn* column = *column_itor;
+		if (!column) continue;
+
+		LLSD value = item->getCellValue(column->mIndex);
+		if (value.isUndefined()) continue;
+
+		column->mMaxContentWidth = llmax(LLFontGL::getFontSansSerifSmall()->getWidth(value.asString()) + mColumnPadding + COLUMN_TEXT_PADDING, column->mMaxContentWidth);
+	}
+}
+
 const S32 SCROLL_LIST_ROW_PAD = 2;
 
 // Line height is the max height of all the cells in all the items.
@@ -1092,21 +1192,7 @@ void LLScrollListCtrl::updateColumns()
 		last_header->getColumn()->setWidth(new_width);
 	}
 
-	// propagate column widths to individual cells
-	item_list::iterator iter;
-	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
-	{
-		LLScrollListItem *itemp = *iter;
-		S32 num_cols = itemp->getNumColumns();
-		S32 i = 0;
-		for (LLScrollListCell* cell = itemp->getColumn(i); i < num_cols; cell = itemp->getColumn(++i))
-		{
-			if (i >= (S32)mColumnsIndexed.size()) break;
-
-			cell->setWidth(mColumnsIndexed[i]->getWidth());
-		}
-	}
-
+	// column widths are propagated to the cells of visible items in drawItems()
 }
 
 void LLScrollListCtrl::setDisplayHeading(BOOL display)
@@ -1228,6 +1314,7 @@ void LLScrollListCtrl::swapWithNext(S32 index)
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index + 1];
 	mItemList[index + 1] = cur_itemp;
+	mItemIndex.invalidateOrder();
 }
 
 
@@ -1241,9 +1328,25 @@ void LLScrollListCtrl::swapWithPrevious(S32 index)
 	LLScrollListItem *cur_itemp = mItemList[index];
 	mItemList[index] = mItemList[index - 1];
 	mItemList[index - 1] = cur_itemp;
+	mItemIndex.invalidateOrder();
 }
 
 
+// Deletes the item at iter, keeping the item index up to date, and returns
+// the iterator following it.
+LLScrollListCtrl::item_list::iterator LLScrollListCtrl::removeItemAt(item_list::iterator iter)
+{
+	LLScrollListItem* itemp = *iter;
+	if (itemp == mLastSelected)
+	{
+		mLastSelected = NULL;
+	}
+	mItemIndex.removeItem(itemp->getValue().asString(), itemp, iter - mItemList.begin());
+	mRescanContentWidths = TRUE;
+	delete itemp;
+	return mItemList.erase(iter);
+}
+
 void LLScrollListCtrl::deleteSingleItem(S32 target_index)
 {
 	if (target_index < 0 || target_index >= (S32)mItemList.size())
@@ -1251,36 +1354,34 @@ void LLScrollListCtrl::deleteSingleItem(S32 target_index)
 		return;
 	}
 
-	LLScrollListItem *itemp;
-	itemp = mItemList[target_index];
-	if (itemp == mLastSelected)
-	{
-		mLastSelected = NULL;
-	}
-	delete itemp;
-	mItemList.erase(mItemList.begin() + target_index);
+	removeItemAt(mItemList.begin() + target_index);
 	dirtyColumns();
 }
 
-//FIXME: refactor item deletion
 void LLScrollListCtrl::deleteItems(const LLSD& sd)
 {
-	item_list::iterator iter;
-	for (iter = mItemList.begin(); iter < mItemList.end(); )
+	std::string key = sd.asString();
+
+	BOOL ambiguous = FALSE;
+	LLScrollListItem* itemp = mItemIndex.findItem(key, &ambiguous);
+	if (itemp)
 	{
-		LLScrollListItem* itemp = *iter;
-		if (itemp->getValue().asString() == sd.asString())
+		// the only item with this value
+		removeItemAt(mItemList.begin() + getItemIndex(itemp));
+	}
+	else if (ambiguous)
+	{
+		item_list::iterator iter;
+		for (iter = mItemList.begin(); iter < mItemList.end(); )
 		{
-			if (itemp == mLastSelected)
+			if ((*iter)->getValue().asString() == key)
 			{
-				mLastSelected = NULL;
+				iter = removeItemAt(iter);
+			}
+			else
+			{
+				iter++;
 			}
-			delete itemp;
-			iter = mItemList.erase(iter);
-		}
-		else
-		{
-			iter++;
 		}
 	}
 
@@ -1295,8 +1396,7 @@ void LLScrollListCtrl::deleteSelectedItems()
 		LLScrollListItem* itemp = *iter;
 		if (itemp->getSelected())
 		{
-			delete itemp;
-			iter = mItemList.erase(iter);
+			iter = removeItemAt(iter);
 		}
 		else
 		{
@@ -1317,22 +1417,16 @@ void LLScrollListCtrl::highlightNthItem(S32 target_index)
 
 S32	LLScrollListCtrl::selectMultiple( LLDynamicArray<LLUUID> ids )
 {
-	item_list::iterator iter;
 	S32 count = 0;
-	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
+	LLDynamicArray<LLUUID>::iterator iditr;
+	for(iditr = ids.begin(); iditr != ids.end(); ++iditr)
 	{
-		LLScrollListItem* item = *iter;
-		LLDynamicArray<LLUUID>::iterator iditr;
-		for(iditr = ids.begin(); iditr != ids.end(); ++iditr)
+		LLScrollListItem* item = findItem(iditr->asString(), TRUE);
+		if (item)
 		{
-			if (item->getEnabled() && (item->getUUID() == (*iditr)))
-			{
-				selectItem(item,FALSE);
-				++count;
-				break;
-			}
+			selectItem(item,FALSE);
+			++count;
 		}
-		if(ids.end() != iditr) ids.erase(iditr);
 	}
 
 	if (mCommitOnSelectionChange)
@@ -1668,23 +1762,18 @@ BOOL LLScrollListCtrl::setSelectedByValue(const LLSD& value, BOOL selected)
 
 	if (selected && !mAllowMultipleSelection) deselectAllItems(TRUE);
 
-	item_list::iterator iter;
-	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
+	LLScrollListItem* item = findItem(value.asString(), TRUE);
+	if (item)
 	{
-		LLScrollListItem* item = *iter;
-		if (item->getEnabled() && (item->getValue().asString() == value.asString()))
+		if (selected)
 		{
-			if (selected)
-			{
-				selectItem(item);
-			}
-			else
-			{
-				deselectItem(item);
-			}
-			found = TRUE;
-			break;
+			selectItem(item);
+		}
+		else
+		{
+			deselectItem(item);
 		}
+		found = TRUE;
 	}
 
 	if (mCommitOnSelectionChange)
@@ -1697,16 +1786,8 @@ BOOL LLScrollListCtrl::setSelectedByValue(const LLSD& value, BOOL selected)
 
 BOOL LLScrollListCtrl::isSelected(const LLSD& value) const 
 {
-	item_list::const_iterator iter;
-	for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
-	{
-		LLScrollListItem* item = *iter;
-		if (item->getValue().asString() == value.asString())
-		{
-			return item->getSelected();
-		}
-	}
-	return FALSE;
+	LLScrollListItem* item = findItem(value.asString(), FALSE);
+	return item ? item->getSelected() : FALSE;
 }
 
 LLUUID LLScrollListCtrl::getStringUUIDSelectedItem() const
@@ -1754,9 +1835,6 @@ void LLScrollListCtrl::drawItems()
 		
 		mDrewSelected = FALSE;
 
-		S32 line = 0;
-		S32 max_columns = 0;
-
 		LLColor4 highlight_color = LLColor4::white;
 
 		static LLCachedControl<F32> sTypeAheadTimeout((*LLUI::sConfigGroup), "TypeAheadTimeout");
@@ -1764,10 +1842,11 @@ void LLScrollListCtrl::drawItems()
 		F32 type_ahead_timeout = sTypeAheadTimeout;
 		highlight_color.mV[VALPHA] = clamp_rescale(mSearchTimer.getElapsedTimeF32(), type_ahead_timeout * 0.7f, type_ahead_timeout, 0.4f, 0.f);
 
-		item_list::iterator iter;
-		for (iter = mItemList.begin(); iter != mItemList.end(); iter++)
+		// only visit the rows on screen
+		S32 last_line = llmin((S32)mItemList.size(), mScrollLines + num_page_lines);
+		for (S32 line = llmax(0, mScrollLines); line < last_line; line++)
 		{
-			LLScrollListItem* item = *iter;
+			LLScrollListItem* item = mItemList[line];
 			
 			item_rect.setOriginAndSize( 
 				x, 
@@ -1782,42 +1861,53 @@ void LLScrollListCtrl::drawItems()
 				mDrewSelected = TRUE;
 			}
 
-			max_columns = llmax(max_columns, item->getNumColumns());
+			if (!item->isMaterialized())
+			{
+				item->materialize();
+				updateLineHeightInsert(item);
+			}
+
+			// propagate column widths to the cells being drawn
+			S32 num_cols = llmin(item->getNumColumns(), (S32)mColumnsIndexed.size());
+			for (S32 i = 0; i < num_cols; i++)
+			{
+				LLScrollListCell* cell = item->getColumn(i);
+				if (cell && mColumnsIndexed[i])
+				{
+					cell->setWidth(mColumnsIndexed[i]->getWidth());
+				}
+			}
 
 			LLColor4 fg_color;
 			LLColor4 bg_color(LLColor4::transparent);
 
-			if( mScrollLines <= line && line < mScrollLines + num_page_lines )
+			fg_color = (item->getEnabled() ? mFgUnselectedColor : mFgDisabledColor);
+			if( item->getSelected() && mCanSelect)
 			{
-				fg_color = (item->getEnabled() ? mFgUnselectedColor : mFgDisabledColor);
-				if( item->getSelected() && mCanSelect)
-				{
-					bg_color = mBgSelectedColor;
-					fg_color = (item->getEnabled() ? mFgSelectedColor : mFgDisabledColor);
-				}
-				else if (mHighlightedItem == line && mCanSelect)
-				{
-					bg_color = mHighlightedColor;
-				}
-				else 
+				bg_color = mBgSelectedColor;
+				fg_color = (item->getEnabled() ? mFgSelectedColor : mFgDisabledColor);
+			}
+			else if (mHighlightedItem == line && mCanSelect)
+			{
+				bg_color = mHighlightedColor;
+			}
+			else 
+			{
+				// Stripes drawing are now only controlled by the XML definitions, via the draw_stripes parameter
+				if (mDrawStripes && (line % 2 == 0) /*&& (max_columns > 1)*/)
 				{
-					// Stripes drawing are now only controlled by the XML definitions, via the draw_stripes parameter
-					if (mDrawStripes && (line % 2 == 0) /*&& (max_columns > 1)*/)
-					{
-						bg_color = mBgStripeColor;
-					}
+					bg_color = mBgStripeColor;
 				}
+			}
 
-				if (!item->getEnabled())
-				{
-					bg_color = mBgReadOnlyColor;
-				}
+			if (!item->getEnabled())
+			{
+				bg_color = mBgReadOnlyColor;
+			}
 
-				item->draw(item_rect, fg_color, bg_color, highlight_color, mColumnPadding);
+			item->draw(item_rect, fg_color, bg_color, highlight_color, mColumnPadding);
 
-				cur_y -= mLineHeight;
-			}
-			line++;
+			cur_y -= mLineHeight;
 		}
 	}
 }
@@ -1830,7 +1920,7 @@ void LLScrollListCtrl::draw()
 	// if user specifies sort, make sure it is maintained
 	if (needsSorting() && !isSorted())
 	{
-		sortItems();
+		updateSort();
 	}
 
 	if (mNeedsScroll)
@@ -2207,22 +2297,17 @@ LLScrollListItem* LLScrollListCtrl::hitItem( S32 x, S32 y )
 	// allow for partial line at bottom
 	S32 num_page_lines = mPageLines + 1;
 
-	S32 line = 0;
-	item_list::iterator iter;
-	for(iter = mItemList.begin(); iter != mItemList.end(); iter++)
+	S32 last_line = llmin((S32)mItemList.size(), mScrollLines + num_page_lines);
+	for (S32 line = llmax(0, mScrollLines); line < last_line; line++)
 	{
-		LLScrollListItem* item  = *iter;
-		if( mScrollLines <= line && line < mScrollLines + num_page_lines )
+		LLScrollListItem* item  = mItemList[line];
+		if( item->getEnabled() && item_rect.pointInRect( x, y ) )
 		{
-			if( item->getEnabled() && item_rect.pointInRect( x, y ) )
-			{
-				hit_item = item;
-				break;
-			}
-
-			item_rect.translate(0, -mLineHeight);
+			hit_item = item;
+			break;
 		}
-		line++;
+
+		item_rect.translate(0, -mLineHeight);
 	}
 
 	return hit_item;
@@ -2643,6 +2728,7 @@ BOOL LLScrollListCtrl::setSort(S32 column_idx, BOOL ascending)
 	if (mSortColumns.empty())
 	{
 		mSortColumns.push_back(new_sort_column);
+		mItemIndex.invalidateOrder();
 		return TRUE;
 	}
 	else
@@ -2656,7 +2742,12 @@ BOOL LLScrollListCtrl::setSort(S32 column_idx, BOOL ascending)
 		mSortColumns.push_back(new_sort_column);
 
 		// did the sort criteria change?
-		return (cur_sort_column != new_sort_column);
+		if (cur_sort_column != new_sort_column)
+		{
+			mItemIndex.invalidateOrder();
+			return TRUE;
+		}
+		return FALSE;
 	}
 }
 
@@ -2689,15 +2780,30 @@ void  LLScrollListCtrl::sortByColumnIndex(U32 column, BOOL ascending)
 
 void LLScrollListCtrl::sortItems()
 {
-	// do stable sort to preserve any previous sorts
-	std::stable_sort(
-		mItemList.begin(), 
-		mItemList.end(), 
-		SortScrollListItem(mSortColumns));
+	// cells may have been edited in place without telling the index
+	mItemIndex.invalidateOrder();
+	updateSort();
+}
+
+void LLScrollListCtrl::updateSort()
+{
+	// stable, and only sorts the items added or changed since the last sort
+	mItemIndex.sort(mItemList, SortScrollListItem(mSortColumns));
 
 	setSorted(TRUE);
 }
 
+void LLScrollListCtrl::setSorted(BOOL sorted)
+{
+	mSorted = sorted;
+	if (!sorted)
+	{
+		// items may have been edited in place, so nothing is known to be in order
+		mItemIndex.invalidateOrder();
+		mRescanContentWidths = TRUE;
+	}
+}
+
 // for one-shot sorts, does not save sort column/order
 void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 {
@@ -2709,6 +2815,7 @@ void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 		mItemList.begin(), 
 		mItemList.end(), 
 		SortScrollListItem(sort_column));
+	mItemIndex.invalidateOrder();
 }
 
 void LLScrollListCtrl::dirtyColumns() 
@@ -3223,6 +3330,7 @@ void LLScrollListCtrl::addColumn(const LLSD& column, EAddPosition pos)
 		}
 	}
 
+	mRescanContentWidths = TRUE;
 	dirtyColumns();
 }
 
@@ -3288,6 +3396,8 @@ void LLScrollListCtrl::clearColumns()
 	}
 	mColumns.clear();
 	mSortColumns.clear();
+	mItemIndex.invalidateOrder();
+	mRescanContentWidths = TRUE;
 	mTotalStaticColumnWidth = 0;
 	mTotalColumnPadding = 0;
 }
@@ -3302,6 +3412,7 @@ void LLScrollListCtrl::setColumnLabel(const std::string& column, const std::stri
 		{
 			itor->second.mHeader->setLabel(label);
 		}
+		mRescanContentWidths = TRUE;
 	}
 }
 
@@ -3335,10 +3446,56 @@ LLScrollListItem* LLScrollListCtrl::addElement(const LLSD& value, EAddPosition p
 		new_item->setEnabled( value["enabled"].asBoolean() );
 	}
 
-	new_item->setNumColumns(mColumns.size());
+	setItemCells(new_item, value["columns"]);
+
+	addItem(new_item, pos);
+
+	return new_item;
+}
+
+LLScrollListItem* LLScrollListCtrl::updateElement(const LLSD& value, void* userdata)
+{
+	LLSD id = value["id"];
+
+	LLScrollListItem* item = id.isDefined() ? getItem(id) : NULL;
+	if (!item)
+	{
+		return addElement(value, ADD_BOTTOM, userdata);
+	}
+
+	if (value.has("enabled"))
+	{
+		item->setEnabled( value["enabled"].asBoolean() );
+	}
+	if (userdata)
+	{
+		item->setUserdata(userdata);
+	}
+
+	setItemCells(item, value["columns"]);
+	if (item->isMaterialized())
+	{
+		updateLineHeightInsert(item);
+	}
+
+	// only this item needs to find its new place
+	mItemIndex.itemChanged(item);
+	mSorted = FALSE;
+	mRescanContentWidths = TRUE;
+	dirtyColumns();
+
+	return item;
+}
+
+// Resolves the columns of an element, creating any we don't already have,
+// and gives the item its cells.  Plain text and date cells are only built
+// once the item is drawn (or someone asks for one), which is most of the
+// cost of filling a list with thousands of rows.
+void LLScrollListCtrl::setItemCells(LLScrollListItem* item, const LLSD& columns)
+{
+	LLSD cells = LLSD::emptyArray();
+	BOOL defer = TRUE;
 
-	// Add any columns we don't already have
-	LLSD columns = value["columns"];
 	LLSD::array_const_iterator itor;
 	S32 col_index = 0 ;
 	for (itor = columns.beginArray(); itor != columns.endArray(); ++itor)
@@ -3385,28 +3542,76 @@ LLScrollListItem* LLScrollListCtrl::addElement(const LLSD& value, EAddPosition p
 			}
 			addColumn(new_column);
 			columnp = &mColumns[column];
-			new_item->setNumColumns(mColumns.size());
 		}
 
+		LLSD cell = *itor;
+		std::string type = cell["type"].asString();
+		if (type == "icon" || type == "checkbox" || type == "separator")
+		{
+			defer = FALSE;
+		}
+		else
+		{
+			// store the value the cell will report, so that rows can be
+			// sorted and measured before their cells exist
+			cell["value"] = (type == "date") ? LLSD(cell["value"].asDate()) : LLSD(cell["value"].asString());
+			if (columnp->mHeader && !cell["value"].asString().empty())
+			{
+				columnp->mHeader->setHasResizableElement(TRUE);
+			}
+		}
+		cells[columnp->mIndex] = cell;
+
+		col_index++;
+	}
+
+	// the first rows are built right away so that the line height is known
+	if (defer && mLineHeight > 0)
+	{
+		item->setPendingCells(this, cells);
+	}
+	else
+	{
+		buildCells(item, cells);
+	}
+}
+
+void LLScrollListCtrl::buildCells(LLScrollListItem* item, const LLSD& cells)
+{
+	item->setNumColumns(0);
+	item->setNumColumns(mColumns.size());
+
+	for (column_map_t::iterator column_it = mColumns.begin(); column_it != mColumns.end(); ++column_it)
+	{
+		LLScrollListColumn* columnp = &column_it->second;
 		S32 index = columnp->mIndex;
 		S32 width = columnp->getWidth();
+
+		if (cells[index].isUndefined())
+		{
+			// add dummy cells for missing columns
+			item->setColumn(index, new LLScrollListText(LLStringUtil::null, LLResMgr::getInstance()->getRes( LLFONT_SANSSERIF_SMALL ), width, LLFontGL::NORMAL));
+			continue;
+		}
+		const LLSD& cell_sd = cells[index];
+
 		LLFontGL::HAlign font_alignment = columnp->mFontAlignment;
 		LLColor4 fcolor = LLColor4::black;
 		
-		LLSD value = (*itor)["value"];
-		std::string fontname = (*itor)["font"].asString();
-		std::string fontstyle = (*itor)["font-style"].asString();
-		std::string type = (*itor)["type"].asString();
+		LLSD value = cell_sd["value"];
+		std::string fontname = cell_sd["font"].asString();
+		std::string fontstyle = cell_sd["font-style"].asString();
+		std::string type = cell_sd["type"].asString();
 		
-		if ((*itor).has("font-color"))
+		if (cell_sd.has("font-color"))
 		{
-			LLSD sd_color = (*itor)["font-color"];
+			LLSD sd_color = cell_sd["font-color"];
 			fcolor.setValue(sd_color);
 		}
 		
-		BOOL has_color = (*itor).has("color");
-		LLColor4 color = LLColor4((*itor)["color"]);
-		BOOL enabled = !(*itor).has("enabled") || (*itor)["enabled"].asBoolean() == true;
+		BOOL has_color = cell_sd.has("color");
+		LLColor4 color = LLColor4(cell_sd["color"]);
+		BOOL enabled = !cell_sd.has("enabled") || cell_sd["enabled"].asBoolean() == true;
 
 		const LLFontGL *font = LLResMgr::getInstance()->getRes(fontname);
 		if (!font)
@@ -3422,7 +3627,7 @@ LLScrollListItem* LLScrollListCtrl::addElement(const LLSD& value, EAddPosition p
 			{
 				cell->setColor(color);
 			}
-			new_item->setColumn(index, cell);
+			item->setColumn(index, cell);
 		}
 		else if (type == "checkbox")
 		{
@@ -3435,7 +3640,7 @@ LLScrollListItem* LLScrollListCtrl::addElement(const LLSD& value, EAddPosition p
 			{
 				cell->setColor(color);
 			}
-			new_item->setColumn(index, cell);
+			item->setColumn(index, cell);
 		}
 		else if (type == "separator")
 		{
@@ -3444,7 +3649,7 @@ LLScrollListItem* LLScrollListCtrl::addElement(const LLSD& value, EAddPosition p
 			{
 				cell->setColor(color);
 			}
-			new_item->setColumn(index, cell);
+			item->setColumn(index, cell);
 		}
 		else if (type == "date")
 		{
@@ -3453,11 +3658,7 @@ LLScrollListItem* LLScrollListCtrl::addElement(const LLSD& value, EAddPosition p
 			{
 				cell->setColor(color);
 			}
-			new_item->setColumn(index, cell);
-			if (columnp->mHeader && !value.asString().empty())
-			{
-				columnp->mHeader->setHasResizableElement(TRUE);
-			}
+			item->setColumn(index, cell);
 		}
 		else
 		{
@@ -3470,30 +3671,9 @@ LLScrollListItem* LLScrollListCtrl::addElement(const LLSD& value, EAddPosition p
 			{
 				cell->setColor(mDefaultListTextColor);
 			}
-			new_item->setColumn(index, cell);
-			if (columnp->mHeader && !value.asString().empty())
-			{
-				columnp->mHeader->setHasResizableElement(TRUE);
-			}
-		}
-
-		col_index++;
-	}
-
-	// add dummy cells for missing columns
-	for (column_map_t::iterator column_it = mColumns.begin(); column_it != mColumns.end(); ++column_it)
-	{
-		S32 column_idx = column_it->second.mIndex;
-		if (new_item->getColumn(column_idx) == NULL)
-		{
-			LLScrollListColumn* column_ptr = &column_it->second;
-			new_item->setColumn(column_idx, new LLScrollListText(LLStringUtil::null, LLResMgr::getInstance()->getRes( LLFONT_SANSSERIF_SMALL ), column_ptr->getWidth(), LLFontGL::NORMAL));
+			item->setColumn(index, cell);
 		}
 	}
-
-	addItem(new_item, pos);
-
-	return new_item;
 }
 
 LLScrollListItem* LLScrollListCtrl::addSimpleElement(const std::string& value, EAddPosition pos, const LLSD& id)
@@ -49,6 +49,7 @@
 #include "llscrollbar.h"
 #include "llresizebar.h"
 #include "lldate.h"
+#include "llscrolllistindex.h"
 
 /*
  * Represents a cell in a scrollable table.
@@ -273,9 +274,9 @@ class LLScrollListItem
 {
 public:
 	LLScrollListItem( BOOL enabled = TRUE, void* userdata = NULL, const LLUUID& uuid = LLUUID::null )
-		: mSelected(FALSE), mEnabled( enabled ), mUserdata( userdata ), mItemValue( uuid ), mColumns() {}
+		: mSelected(FALSE), mEnabled( enabled ), mUserdata( userdata ), mItemValue( uuid ), mColumns(), mCellFactory(NULL) {}
 	LLScrollListItem( LLSD item_value, void* userdata = NULL )
-		: mSelected(FALSE), mEnabled( TRUE ), mUserdata( userdata ), mItemValue( item_value ), mColumns() {}
+		: mSelected(FALSE), mEnabled( TRUE ), mUserdata( userdata ), mItemValue( item_value ), mColumns(), mCellFactory(NULL) {}
 
 	virtual ~LLScrollListItem();
 
@@ -309,9 +310,19 @@ public:
 
 	void	setColumn( S32 column, LLScrollListCell *cell );
 	
-	S32		getNumColumns() const			{ return mColumns.size(); }
+	S32		getNumColumns() const			{ materialize(); return mColumns.size(); }
 
-	LLScrollListCell *getColumn(const S32 i) const	{ if (0 <= i && i < (S32)mColumns.size()) { return mColumns[i]; } return NULL; }
+	LLScrollListCell *getColumn(const S32 i) const	{ materialize(); if (0 <= i && i < (S32)mColumns.size()) { return mColumns[i]; } return NULL; }
+
+	// Rows added with LLScrollListCtrl::addElement() keep their column
+	// description and only build cells when first drawn or asked for one.
+	void	setPendingCells(LLScrollListCtrl* factory, const LLSD& cells);
+	BOOL	isMaterialized() const			{ return mCellFactory == NULL; }
+	void	materialize() const				{ if (mCellFactory) buildPendingCells(); }
+
+	// Value of a cell for sorting and measuring, without building the cell.
+	// Undefined if the item has no such column.
+	LLSD	getCellValue(S32 column) const;
 
 	std::string getContentsCSV() const;
 
@@ -324,6 +335,12 @@ private:
 	LLSD	mItemValue;
 	std::string mToolTip;
 	std::vector<LLScrollListCell *> mColumns;
+
+	void	buildPendingCells() const;
+
+	// cell descriptions indexed by column, until materialize()
+	mutable LLSD				mPendingCells;
+	mutable LLScrollListCtrl*	mCellFactory;
 };
 
 /*
@@ -389,6 +406,10 @@ public:
 	// "columns" => [ "column" => column name, "value" => value, "type" => type, "font" => font, "font-style" => style ], "id" => uuid
 	// Creates missing columns automatically.
 	virtual LLScrollListItem* addElement(const LLSD& value, EAddPosition pos = ADD_BOTTOM, void* userdata = NULL);
+	// Replaces the cells of the row whose value matches value["id"] in place,
+	// keeping its selection, or adds the element if there is no such row.
+	// Only the changed row is re-sorted.
+	LLScrollListItem* updateElement(const LLSD& value, void* userdata = NULL);
 	// Simple add element. Takes a single array of:
 	// [ "value" => value, "font" => font, "font-style" => style ]
 	virtual void clearRows(); // clears all elements
@@ -582,12 +603,13 @@ public:
 	BOOL			needsSorting();
 
 	S32		selectMultiple( LLDynamicArray<LLUUID> ids );
+	// full stable sort, for callers that edited cells in place
 	void			sortItems();
 	// sorts a list without affecting the permanent sort order (so further list insertions can be unsorted, for example)
 	void			sortOnce(S32 column, BOOL ascending);
 
 	// manually call this whenever editing list items in place to flag need for resorting
-	void			setSorted(BOOL sorted) { mSorted = sorted; }
+	void			setSorted(BOOL sorted);
 	void			dirtyColumns(); // some operation has potentially affected column layout or ordering
 
 protected:
@@ -615,7 +637,14 @@ public:
 	void			selectPrevItem(BOOL extend_selection);
 	void			selectNextItem(BOOL extend_selection);
 private:
+	friend class LLScrollListItem;
+
 	void			drawItems();
+	void			setItemCells(LLScrollListItem* item, const LLSD& columns);
+	void			buildCells(LLScrollListItem* item, const LLSD& cells);
+	LLScrollListItem* findItem(const std::string& key, BOOL enabled_only) const;
+	item_list::iterator removeItemAt(item_list::iterator iter);
+	void			measureItem(LLScrollListItem* item);
 	void			updateLineHeight();
 	void            updateLineHeightInsert(LLScrollListItem* item);
 	void			reportInvalidInput();
@@ -624,6 +653,8 @@ private:
 	void			deselectItem(LLScrollListItem* itemp);
 	void			commitIfChanged();
 	BOOL			setSort(S32 column, BOOL ascending);
+	// sorts only the rows appended or updated since the last sort
+	void			updateSort();
 
 
 	S32				mCurIndex;			// For get[First/Next]Data
@@ -646,6 +677,11 @@ private:
 	BOOL			mColumnsDirty;
 
 	item_list		mItemList;
+	LLScrollListIndex mItemIndex;
+
+	// items added since the last calcColumnWidths(), unless all items need measuring
+	std::vector<LLScrollListItem*> mUnmeasuredItems;
+	BOOL			mRescanContentWidths;
 
 	LLScrollListItem *mLastSelected;
 
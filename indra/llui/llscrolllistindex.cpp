@@ -0,0 +1,97 @@
+/** 
+ * @file llscrolllistindex.cpp
+ * @brief Key lookup and incremental sort bookkeeping for LLScrollListCtrl
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llscrolllistindex.h"
+
+LLScrollListIndex::LLScrollListIndex()
+:	mSortedCount(0)
+{
+}
+
+void LLScrollListIndex::addItem(const std::string& key, LLScrollListItem* item)
+{
+	key_entry_t& entry = mKeys[key];
+	entry.mItem = entry.mCount ? NULL : item;
+	entry.mCount++;
+}
+
+void LLScrollListIndex::removeItem(const std::string& key, LLScrollListItem* item, S32 index)
+{
+	key_map_t::iterator iter = mKeys.find(key);
+	if (iter != mKeys.end())
+	{
+		// once ambiguous, a key stays that way until its last row is gone
+		if (--iter->second.mCount <= 0)
+		{
+			mKeys.erase(iter);
+		}
+	}
+
+	if (index < mSortedCount)
+	{
+		// removing a row leaves the rest of the prefix in order
+		mSortedCount--;
+	}
+	mChangedItems.erase(item);
+}
+
+void LLScrollListIndex::clear()
+{
+	mKeys.clear();
+	mChangedItems.clear();
+	mSortedCount = 0;
+}
+
+LLScrollListItem* LLScrollListIndex::findItem(const std::string& key, BOOL* ambiguous) const
+{
+	*ambiguous = FALSE;
+	key_map_t::const_iterator iter = mKeys.find(key);
+	if (iter == mKeys.end())
+	{
+		return NULL;
+	}
+	if (!iter->second.mItem)
+	{
+		*ambiguous = TRUE;
+	}
+	return iter->second.mItem;
+}
+
+void LLScrollListIndex::itemChanged(LLScrollListItem* item)
+{
+	if (mSortedCount > 0)
+	{
+		mChangedItems.insert(item);
+	}
+}
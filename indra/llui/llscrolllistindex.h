@@ -0,0 +1,160 @@
+/** 
+ * @file llscrolllistindex.h
+ * @brief Key lookup and incremental sort bookkeeping for LLScrollListCtrl
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSCROLLLISTINDEX_H
+#define LL_LLSCROLLLISTINDEX_H
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+class LLScrollListItem;
+
+// Bookkeeping that lets a scroll list with tens of thousands of rows find a
+// row by its value and stay sorted without touching every row on each change.
+//
+// Rows are looked up by the string form of their value (the item UUID for
+// most lists), which is how LLScrollListCtrl has always compared them.  Keys
+// shared by several rows are remembered as ambiguous and the caller falls
+// back to a linear search, so "first matching item" semantics are kept.
+//
+// For sorting, the list is treated as a sorted prefix followed by rows that
+// were appended or changed since the last sort.  sort() only sorts that tail
+// and merges it into the prefix.  Anything that reorders rows behind the
+// index's back must call invalidateOrder().
+class LLScrollListIndex
+{
+public:
+	typedef std::deque<LLScrollListItem*> item_list;
+
+	LLScrollListIndex();
+
+	void addItem(const std::string& key, LLScrollListItem* item);
+	// index is the row's position in the list before it is erased
+	void removeItem(const std::string& key, LLScrollListItem* item, S32 index);
+	void clear();
+
+	// Returns the only row with this key, or NULL.  *ambiguous is set when
+	// several rows share the key and the caller has to search for the first.
+	LLScrollListItem* findItem(const std::string& key, BOOL* ambiguous) const;
+
+	// Rows in [0, getSortedCount()) are known to be in sort order.
+	S32 getSortedCount() const			{ return mSortedCount; }
+	void invalidateOrder()				{ mSortedCount = 0; mChangedItems.clear(); }
+	// the sort key of an item changed in place
+	void itemChanged(LLScrollListItem* item);
+
+	// Stable with respect to the order rows were sorted and appended in.
+	template <class COMPARE>
+	void sort(item_list& items, COMPARE comp)
+	{
+		S32 sorted_count = llmin(mSortedCount, (S32)items.size());
+		if (!mChangedItems.empty())
+		{
+			// move changed rows out of the sorted prefix onto the tail,
+			// keeping everything else in order
+			std::vector<LLScrollListItem*> changed;
+			S32 moved = 0;
+			item_list::iterator out = items.begin();
+			for (item_list::iterator iter = items.begin(); iter != items.end(); ++iter)
+			{
+				if (mChangedItems.count(*iter))
+				{
+					if (iter - items.begin() < sorted_count)
+					{
+						++moved;
+					}
+					changed.push_back(*iter);
+				}
+				else
+				{
+					*out++ = *iter;
+				}
+			}
+			std::copy(changed.begin(), changed.end(), out);
+			sorted_count -= moved;
+			mChangedItems.clear();
+		}
+
+		item_list::iterator middle = items.begin() + sorted_count;
+		if (middle != items.end())
+		{
+			std::stable_sort(middle, items.end(), comp);
+
+			S32 tail_count = items.size() - sorted_count;
+			if (tail_count * BINARY_INSERT_RATIO < sorted_count)
+			{
+				// a few rows: binary search for each one's place instead of
+				// comparing against the whole list
+				std::vector<LLScrollListItem*> tail(middle, items.end());
+				items.erase(middle, items.end());
+				item_list::iterator lower = items.begin();
+				for (std::vector<LLScrollListItem*>::iterator iter = tail.begin(); iter != tail.end(); ++iter)
+				{
+					// upper_bound keeps rows with equal keys in order, and the
+					// tail is sorted so each row goes after the previous one
+					lower = std::upper_bound(lower, items.end(), *iter, comp);
+					lower = items.insert(lower, *iter) + 1;
+				}
+			}
+			else
+			{
+				std::inplace_merge(items.begin(), middle, items.end(), comp);
+			}
+		}
+		mSortedCount = items.size();
+	}
+
+private:
+	// below this many sorted rows per new row, inserting beats merging
+	enum { BINARY_INSERT_RATIO = 64 };
+
+	typedef boost::unordered_set<LLScrollListItem*> item_set_t;
+
+	struct key_entry_t
+	{
+		key_entry_t() : mItem(NULL), mCount(0) {}
+		// NULL once more than one row has used the key
+		LLScrollListItem* mItem;
+		S32 mCount;
+	};
+	typedef boost::unordered_map<std::string, key_entry_t> key_map_t;
+
+	key_map_t	mKeys;
+	item_set_t	mChangedItems;
+	S32			mSortedCount;
+};
+
+#endif // LL_LLSCROLLLISTINDEX_H
@@ -167,8 +167,14 @@ BOOL LLTextBox::handleHover(S32 x, S32 y, MASK mask)
 
 void LLTextBox::setText(const LLStringExplicit& text)
 {
+	// many panels set the same text every frame
+	std::string old_text = mText.getString();
 	mText.assign(text);
 	setLineLengths();
+	if (mText.getString() != old_text)
+	{
+		dirtyRetainedDrawing();
+	}
 }
 
 void LLTextBox::setLineLengths()
@@ -282,8 +288,13 @@ S32 LLTextBox::getTextPixelHeight()
 
 BOOL LLTextBox::setTextArg( const std::string& key, const LLStringExplicit& text )
 {
+	std::string old_text = mText.getString();
 	mText.setArg(key, text);
 	setLineLengths();
+	if (mText.getString() != old_text)
+	{
+		dirtyRetainedDrawing();
+	}
 	return TRUE;
 }
 
@@ -349,6 +360,13 @@ void LLTextBox::draw()
 	mHasHover = FALSE; // This is reset every frame.
 }
 
+// virtual
+BOOL LLTextBox::isStaticDrawing() const
+{
+	// hover highlighting is per frame state
+	return !mHoverActive;
+}
+
 void LLTextBox::reshape(S32 width, S32 height, BOOL called_from_parent)
 {
 	// reparse line lengths
@@ -360,19 +378,22 @@ void LLTextBox::drawText( S32 x, S32 y, const LLColor4& color )
 {
 	if( mLineLengthList.empty() )
 	{
-		mFontGL->render(mText.getWString(), 0, (F32)x, (F32)y, color,
+		mLineBatches.resize(1);
+		mFontGL->renderCached(mLineBatches[0], mText.getWString(), 0, (F32)x, (F32)y, color,
 						mHAlign, mVAlign, 
 						mFontStyle,
 						S32_MAX, getRect().getWidth(), NULL, TRUE, mUseEllipses);
 	}
 	else
 	{
+		mLineBatches.resize(mLineLengthList.size());
 		S32 cur_pos = 0;
+		S32 line = 0;
 		for (std::vector<S32>::iterator iter = mLineLengthList.begin();
-			iter != mLineLengthList.end(); ++iter)
+			iter != mLineLengthList.end(); ++iter, ++line)
 		{
 			S32 line_length = *iter;
-			mFontGL->render(mText.getWString(), cur_pos, (F32)x, (F32)y, color,
+			mFontGL->renderCached(mLineBatches[line], mText.getWString(), cur_pos, (F32)x, (F32)y, color,
 							mHAlign, mVAlign,
 							mFontStyle,
 							line_length, getRect().getWidth(), NULL, TRUE, mUseEllipses );
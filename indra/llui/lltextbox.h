@@ -66,32 +66,33 @@ public:
 	static LLView* fromXML(LLXMLNodePtr node, LLView *parent, class LLUICtrlFactory *factory);
 
 	virtual void	draw();
+	virtual BOOL	isStaticDrawing() const;
 	virtual void	reshape(S32 width, S32 height, BOOL called_from_parent = TRUE);
 
 	virtual BOOL	handleMouseDown(S32 x, S32 y, MASK mask);
 	virtual BOOL	handleMouseUp(S32 x, S32 y, MASK mask);
 	virtual BOOL	handleHover(S32 x, S32 y, MASK mask);
 
-	void			setColor( const LLColor4& c )			{ mTextColor = c; }
-	void			setDisabledColor( const LLColor4& c)	{ mDisabledColor = c; }
-	void			setBackgroundColor( const LLColor4& c)	{ mBackgroundColor = c; }	
-	void			setBorderColor( const LLColor4& c)		{ mBorderColor = c; }	
+	void			setColor( const LLColor4& c )			{ mTextColor = c; dirtyRetainedDrawing(); }
+	void			setDisabledColor( const LLColor4& c)	{ mDisabledColor = c; dirtyRetainedDrawing(); }
+	void			setBackgroundColor( const LLColor4& c)	{ mBackgroundColor = c; dirtyRetainedDrawing(); }	
+	void			setBorderColor( const LLColor4& c)		{ mBorderColor = c; dirtyRetainedDrawing(); }	
 
-	void			setHoverColor( const LLColor4& c )		{ mHoverColor = c; }
-	void			setHoverActive( BOOL active )			{ mHoverActive = active; }
+	void			setHoverColor( const LLColor4& c )		{ mHoverColor = c; dirtyRetainedDrawing(); }
+	void			setHoverActive( BOOL active )			{ mHoverActive = active; dirtyRetainedDrawing(); }
 
 	void			setText( const LLStringExplicit& text );
 	void			setWrappedText(const LLStringExplicit& text, F32 max_width = -1.0); // -1 means use existing control width
-	void			setUseEllipses( BOOL use_ellipses )		{ mUseEllipses = use_ellipses; }
+	void			setUseEllipses( BOOL use_ellipses )		{ mUseEllipses = use_ellipses; dirtyRetainedDrawing(); }
 	
-	void			setBackgroundVisible(BOOL visible)		{ mBackgroundVisible = visible; }
-	void			setBorderVisible(BOOL visible)			{ mBorderVisible = visible; }
-	void			setFontStyle(U8 style)					{ mFontStyle = style; }
-	void			setBorderDropshadowVisible(BOOL visible){ mBorderDropShadowVisible = visible; }
-	void			setHPad(S32 pixels)						{ mHPad = pixels; }
-	void			setVPad(S32 pixels)						{ mVPad = pixels; }
-	void			setRightAlign()							{ mHAlign = LLFontGL::RIGHT; }
-	void			setHAlign( LLFontGL::HAlign align )		{ mHAlign = align; }
+	void			setBackgroundVisible(BOOL visible)		{ mBackgroundVisible = visible; dirtyRetainedDrawing(); }
+	void			setBorderVisible(BOOL visible)			{ mBorderVisible = visible; dirtyRetainedDrawing(); }
+	void			setFontStyle(U8 style)					{ mFontStyle = style; dirtyRetainedDrawing(); }
+	void			setBorderDropshadowVisible(BOOL visible){ mBorderDropShadowVisible = visible; dirtyRetainedDrawing(); }
+	void			setHPad(S32 pixels)						{ mHPad = pixels; dirtyRetainedDrawing(); }
+	void			setVPad(S32 pixels)						{ mVPad = pixels; dirtyRetainedDrawing(); }
+	void			setRightAlign()							{ mHAlign = LLFontGL::RIGHT; dirtyRetainedDrawing(); }
+	void			setHAlign( LLFontGL::HAlign align )		{ mHAlign = align; dirtyRetainedDrawing(); }
 	void			setClickedCallback( void (*cb)(void *data), void* data = NULL ){ mClickedCallback = cb; mCallbackUserData = data; }		// mouse down and up within button
 
 	const LLFontGL* getFont() const							{ return mFontGL; }
@@ -135,6 +136,7 @@ private:
 	LLFontGL::VAlign mVAlign;
 
 	std::vector<S32> mLineLengthList;
+	std::vector<LLFontVertexBatch> mLineBatches;	// cached glyph geometry, one per drawn line
 	void			(*mClickedCallback)(void* data );
 	void*			mCallbackUserData;
 };
@@ -323,9 +323,16 @@ LLTextEditor::LLTextEditor(
 	mMouseDownY(0),
 	mLastSelectionX(-1),
 	mLastSelectionY(-1),
+	spellStart(-1),
+	spellEnd(-1),
+	mSpellDirtyStart(-1),
+	mSpellDirtyEnd(-1),
+	mSpellGeneration(0),
+	mSpellDictionarySerial(0),
+	mOverRideAndShowMisspellings(FALSE),
 	mReflowNeeded(FALSE),
-	mScrollNeeded(FALSE),
-	mOverRideAndShowMisspellings(FALSE)
+	mReflowStartPos(0),
+	mScrollNeeded(FALSE)
 {
 	mSourceID.generate();
 
@@ -504,10 +511,17 @@ std::vector<S32> LLTextEditor::getMisspelledWordsPositions()
 {
 	resetSpellDirty();
 	std::vector<S32> thePosesOfBadWords;
-	LLWString& text = mWText;
+	findMisspelledWords(spellStart, spellEnd, thePosesOfBadWords);
+	return thePosesOfBadWords;
+}
+void LLTextEditor::findMisspelledWords(S32 start, S32 end, std::vector<S32>& positions)
+{
+	const LLWString& text = mWText;
+	const S32 text_len = (S32)text.length();
 	S32 wordStart=0;
-	S32 wordEnd=spellStart;//start at the scroll start
-	while(wordEnd < spellEnd)
+	S32 wordEnd=llmax(start, 0);
+	end = llmin(end, text_len);
+	while(wordEnd < end)
 	{
 		//go through all the chars... XD	
 		if( LLTextEditor::isPartOfWord( text[wordEnd] ) ) 
@@ -518,26 +532,131 @@ std::vector<S32> LLTextEditor::getMisspelledWordsPositions()
 				wordEnd--;
 			}
 			wordStart=wordEnd;
-			while ((wordEnd < (S32)text.length()) && LLTextEditor::isPartOfWord( text[wordEnd] ) )
+			while ((wordEnd < text_len) && LLTextEditor::isPartOfWord( text[wordEnd] ) )
 			{
 				wordEnd++;
 			}	
 			//got a word :D
 
-			std::string regText(text.begin(),text.end());
-			std::string selectedWord(regText.substr(wordStart,wordEnd-wordStart));
+			std::string selectedWord(text.begin() + wordStart, text.begin() + wordEnd);
 			
-			if(!glggHunSpell->isSpelledRight(selectedWord))
-			{	
-				//misspelled word here, and you have just right clicked on it
-
-				thePosesOfBadWords.push_back(wordStart);
-				thePosesOfBadWords.push_back(wordEnd);
+			switch(glggHunSpell->checkSpelling(selectedWord))
+			{
+			case lggHunSpell_Wrapper::SPELLED_WRONG:
+				positions.push_back(wordStart);
+				positions.push_back(wordEnd);
+				break;
+			case lggHunSpell_Wrapper::SPELLING_PENDING:
+				markSpellDirty(wordStart, wordEnd);
+				break;
+			default:
+				break;
 			}
 		}
 		wordEnd++;
 	}
-	return thePosesOfBadWords;
+}
+void LLTextEditor::checkSpellDirtyRange()
+{
+	const LLWString& text = mWText;
+	const S32 text_len = (S32)text.length();
+	S32 start = llmax(mSpellDirtyStart, spellStart);
+	S32 end = llmin(mSpellDirtyEnd, spellEnd, text_len);
+	mSpellDirtyStart = mSpellDirtyEnd = -1;
+	if (start > end)
+	{
+		return;
+	}
+
+	// Take in the whole of the words at either end
+	while ((start > spellStart) && LLTextEditor::isPartOfWord(text[start-1]))
+	{
+		start--;
+	}
+	while ((end < llmin(spellEnd, text_len)) && LLTextEditor::isPartOfWord(text[end]))
+	{
+		end++;
+	}
+
+	S32 scan_end = llmax(end, start + 1);
+	std::vector<S32> found;
+	findMisspelledWords(start, scan_end, found);
+
+	// Replace the words the scan covered
+	S32 first = 0;
+	while ((first < (S32)misspellLocations.size()) && (misspellLocations[first + 1] <= start))
+	{
+		first += 2;
+	}
+	S32 last = first;
+	while ((last < (S32)misspellLocations.size()) && (misspellLocations[last] < scan_end))
+	{
+		last += 2;
+	}
+	misspellLocations.erase(misspellLocations.begin() + first, misspellLocations.begin() + last);
+	misspellLocations.insert(misspellLocations.begin() + first, found.begin(), found.end());
+}
+void LLTextEditor::markSpellDirty(S32 start, S32 end)
+{
+	if (mSpellDirtyStart < 0)
+	{
+		mSpellDirtyStart = start;
+		mSpellDirtyEnd = end;
+	}
+	else
+	{
+		mSpellDirtyStart = llmin(mSpellDirtyStart, start);
+		mSpellDirtyEnd = llmax(mSpellDirtyEnd, end);
+	}
+}
+// Where a position before an edit ends up after it
+static S32 spell_pos_after_edit(S32 old_pos, S32 pos, S32 length, S32 inserted)
+{
+	if (old_pos <= pos)
+	{
+		return old_pos;
+	}
+	if (old_pos >= pos + length)
+	{
+		return old_pos + inserted - length;
+	}
+	return pos;
+}
+void LLTextEditor::spellTextChanged(S32 pos, S32 length, S32 inserted)
+{
+	// Words the edit touched go, the ones after it move along
+	S32 kept = 0;
+	for (S32 i = 0; i + 1 < (S32)misspellLocations.size(); i += 2)
+	{
+		S32 wstart = misspellLocations[i];
+		S32 wend = misspellLocations[i + 1];
+		if ((wend >= pos) && (wstart <= pos + length))
+		{
+			continue;
+		}
+		misspellLocations[kept++] = spell_pos_after_edit(wstart, pos, length, inserted);
+		misspellLocations[kept++] = spell_pos_after_edit(wend, pos, length, inserted);
+	}
+	misspellLocations.resize(kept);
+
+	if (spellStart >= 0)
+	{
+		spellStart = spell_pos_after_edit(spellStart, pos, length, inserted);
+		spellEnd = spell_pos_after_edit(spellEnd, pos, length, inserted);
+	}
+	if (mSpellDirtyStart >= 0)
+	{
+		mSpellDirtyStart = spell_pos_after_edit(mSpellDirtyStart, pos, length, inserted);
+		mSpellDirtyEnd = spell_pos_after_edit(mSpellDirtyEnd, pos, length, inserted);
+	}
+	markSpellDirty(pos, pos + inserted);
+}
+void LLTextEditor::spellTextReset()
+{
+	// Forces a full check on the next draw
+	misspellLocations.clear();
+	spellStart = spellEnd = -1;
+	mSpellDirtyStart = mSpellDirtyEnd = -1;
 }
 void LLTextEditor::spell_add(void* data)
 {
@@ -584,87 +703,48 @@ void LLTextEditor::setShadowColor( const LLColor4& color )
 	mScrollbar->setShadowColor(color); 
 }
 
+// Feeds the editor's text, segments and font to LLTextLayout.
+class LLTextEditor::LayoutSource : public LLTextLayout::Source
+{
+public:
+	LayoutSource(const LLTextEditor& editor) : mEditor(editor) {}
+
+	/*virtual*/ const LLWString& getLayoutText() const	{ return mEditor.mWText; }
+	/*virtual*/ S32 getSegmentCount() const				{ return mEditor.mSegments.size(); }
+	/*virtual*/ S32 getSegmentStart(S32 seg_idx) const	{ return mEditor.mSegments[seg_idx]->getStart(); }
+	/*virtual*/ S32 getSegmentEnd(S32 seg_idx) const		{ return mEditor.mSegments[seg_idx]->getEnd(); }
+	/*virtual*/ void getSegmentAndOffset(S32 pos, S32* seg_idxp, S32* offsetp) const
+	{
+		mEditor.getSegmentAndOffset(pos, seg_idxp, offsetp);
+	}
+	/*virtual*/ S32 maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_chars) const
+	{
+		return mEditor.mGLFont->maxDrawableChars(wchars, max_pixels, max_chars, mEditor.mWordWrap, mEditor.mAllowEmbeddedItems);
+	}
+	/*virtual*/ S32 getWidth(const llwchar* wchars, S32 count) const
+	{
+		return mEditor.mGLFont->getWidth(wchars, 0, count, mEditor.mAllowEmbeddedItems);
+	}
+
+private:
+	const LLTextEditor& mEditor;
+};
+
 void LLTextEditor::updateLineStartList(S32 startpos)
 {
 	updateSegments();
 	
 	bindEmbeddedChars(mGLFont);
 
-	S32 seg_num = mSegments.size();
-	S32 seg_idx = 0;
-	S32 seg_offset = 0;
-
-	if (!mLineStartList.empty())
+	// Keyword and embedded item editors rebuild their segments from scratch
+	// in updateSegments(), so old line entries can't be trusted.
+	if (mKeywords.isLoaded() || mAllowEmbeddedItems)
 	{
-		getSegmentAndOffset(startpos, &seg_idx, &seg_offset);
-		line_info t(seg_idx, seg_offset);
-		line_list_t::iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), t, line_info_compare());
-		if (iter != mLineStartList.begin()) --iter;
-		seg_idx = iter->mSegment;
-		seg_offset = iter->mOffset;
-		mLineStartList.erase(iter, mLineStartList.end());
-	}
-	
-	while( seg_idx < seg_num )
-	{
-		mLineStartList.push_back(line_info(seg_idx,seg_offset));
-		BOOL line_ended = FALSE;
-		S32 start_x = mShowLineNumbers ? UI_TEXTEDITOR_LINE_NUMBER_MARGIN : 0;
-		S32 line_width = start_x;
-		while(!line_ended && seg_idx < seg_num)
-		{
-			LLTextSegment* segment = mSegments[seg_idx];
-			S32 start_idx = segment->getStart() + seg_offset;
-			S32 end_idx = start_idx;
-			while (end_idx < segment->getEnd() && mWText[end_idx] != '\n')
-			{
-				end_idx++;
-			}
-			if (start_idx == end_idx)
-			{
-				if (end_idx >= segment->getEnd())
-				{
-					// empty segment
-					seg_idx++;
-					seg_offset = 0;
-				}
-				else
-				{
-					// empty line
-					line_ended = TRUE;
-					seg_offset++;
-				}
-			}
-			else
-			{ 
-				const llwchar* str = mWText.c_str() + start_idx;
-				S32 drawn = mGLFont->maxDrawableChars(str, (F32)abs(mTextRect.getWidth()) - line_width,
-													  end_idx - start_idx, mWordWrap, mAllowEmbeddedItems );
-				if( 0 == drawn && line_width == start_x)
-				{
-					// If at the beginning of a line, draw at least one character, even if it doesn't all fit.
-					drawn = 1;
-				}
-				seg_offset += drawn;
-				line_width += mGLFont->getWidth(str, 0, drawn, mAllowEmbeddedItems);
-				end_idx = segment->getStart() + seg_offset;
-				if (end_idx < segment->getEnd())
-				{
-					line_ended = TRUE;
-					if (mWText[end_idx] == '\n')
-					{
-						seg_offset++; // skip newline
-					}
-				}
-				else
-				{
-					// finished with segment
-					seg_idx++;
-					seg_offset = 0;
-				}
-			}
-		}
+		startpos = 0;
 	}
+
+	S32 start_x = mShowLineNumbers ? UI_TEXTEDITOR_LINE_NUMBER_MARGIN : 0;
+	mLineLayout.reflow(LayoutSource(*this), startpos, (F32)abs(mTextRect.getWidth()), start_x);
 	
 	unbindEmbeddedChars(mGLFont);
 
@@ -719,6 +799,7 @@ void LLTextEditor::setText(const LLStringExplicit &utf8str)
 	// mUTF8Text = utf8str;
 	mWText = utf8str_to_wstring(mUTF8Text);
 	mTextIsUpToDate = TRUE;
+	spellTextReset();
 
 	truncate();
 	blockUndo();
@@ -736,6 +817,7 @@ void LLTextEditor::setWText(const LLWString &wtext)
 	mWText = wtext;
 	mUTF8Text.clear();
 	mTextIsUpToDate = FALSE;
+	spellTextReset();
 
 	truncate();
 	blockUndo();
@@ -949,8 +1031,8 @@ S32 LLTextEditor::getLineStart( S32 line ) const
     }
 
 	line = llclamp(line, 0, num_lines-1);
-	S32 segidx = mLineStartList[line].mSegment;
-	S32 segoffset = mLineStartList[line].mOffset;
+	S32 segidx = mLineLayout.getLine(line).mSegment;
+	S32 segoffset = mLineLayout.getLine(line).mOffset;
 	LLTextSegment* seg = mSegments[segidx];
 	S32 res = seg->getStart() + segoffset;
     //KC- instead of crashing, just clamp the value. (Might not be the right solution)
@@ -962,7 +1044,7 @@ S32 LLTextEditor::getLineStart( S32 line ) const
 // Given an offset into text (pos), find the corresponding line (from the start of the doc) and an offset into the line.
 void LLTextEditor::getLineAndOffset( S32 startpos, S32* linep, S32* offsetp ) const
 {
-	if (mLineStartList.empty())
+	if (mLineLayout.isEmpty())
 	{
 		*linep = 0;
 		*offsetp = startpos;
@@ -972,11 +1054,10 @@ void LLTextEditor::getLineAndOffset( S32 startpos, S32* linep, S32* offsetp ) co
 		S32 seg_idx, seg_offset;
 		getSegmentAndOffset( startpos, &seg_idx, &seg_offset );
 
-		line_info tline(seg_idx, seg_offset);
-		line_list_t::const_iterator iter = std::upper_bound(mLineStartList.begin(), mLineStartList.end(), tline, line_info_compare());
-		if (iter != mLineStartList.begin()) --iter;
-		*linep = iter - mLineStartList.begin();
-		S32 line_start = mSegments[iter->mSegment]->getStart() + iter->mOffset;
+		S32 line = mLineLayout.findLine(seg_idx, seg_offset);
+		const LLTextLayout::line_info& info = mLineLayout.getLine(line);
+		*linep = line;
+		S32 line_start = mSegments[info.mSegment]->getStart() + info.mOffset;
 		*offsetp = startpos - line_start;
 	}
 }
@@ -2686,6 +2767,9 @@ BOOL LLTextEditor::handleUnicodeCharHere(llwchar uni_char)
 
 	BOOL	handled = FALSE;
 
+	// Everything before the cursor (or selection) is left alone.
+	S32 edit_pos = hasSelection() ? llmin(mSelectionStart, mSelectionEnd, mCursorPos) : mCursorPos;
+
 	if ( gFocusMgr.getKeyboardFocus() == this )
 	{
 		// Handle most keys only if the text editor is writeable.
@@ -2712,7 +2796,7 @@ BOOL LLTextEditor::handleUnicodeCharHere(llwchar uni_char)
 			// Most keystrokes will make the selection box go away, but not all will.
 			deselect();
 
-			needsReflow();
+			needsReflow(edit_pos);
 		}
 	}
 
@@ -3104,6 +3188,7 @@ void LLTextEditor::autoCorrectText()
 				int dif = correctedWord.length()-lastTypedWord.length();
 				regText.replace(wordStart,lastTypedWord.length(),correctedWord);
 				mWText=utf8str_to_wstring(regText);
+				spellTextReset();
 				mCursorPos+=dif;
 				needsReflow();
 			}
@@ -3115,12 +3200,18 @@ void LLTextEditor::drawMisspelled()
 	if(mReadOnly)return;
 	if(glggHunSpell->highlightInRed || mOverRideAndShowMisspellings)
 	{
+		// Words the spell check thread has got back to are shown straight
+		// away, edits wait for a pause in typing.
+		U32 spell_generation = glggHunSpell->getSpellGeneration();
 		if(
 			( ((getLength()<400)||(false))	&&(  (S32(mSpellTimer.getElapsedTimeF32() / 1) & 1) ))
 			||
 			(S32(mKeystrokeTimer.getElapsedTimeF32() / 1) & 1) 
+			||
+			(spell_generation != mSpellGeneration)
 			)
 		{
+			mSpellGeneration = spell_generation;
 			S32 newSpellStart = getLineStart(mScrollbar->getDocPos());//start at the scroll start
 			S32 newSpellEnd = getLineStart(mScrollbar->getDocPos() + 1 + mScrollbar->getDocSize()-mScrollbar->getDocPosMax());//end at the end o.o
 
@@ -3128,12 +3219,19 @@ void LLTextEditor::drawMisspelled()
 			{
 				newSpellEnd=(S32)mWText.length();
 			}
-			if((isSpellDirty())||(newSpellEnd!=spellEnd || newSpellStart!=spellStart))
+			if((newSpellEnd!=spellEnd || newSpellStart!=spellStart)
+				|| (glggHunSpell->getDictionarySerial() != mSpellDictionarySerial))
 			{
 				spellEnd = newSpellEnd;
 				spellStart = newSpellStart;
+				mSpellDictionarySerial = glggHunSpell->getDictionarySerial();
+				mSpellDirtyStart = mSpellDirtyEnd = -1;
 				misspellLocations=getMisspelledWordsPositions();
 			}
+			else if(mSpellDirtyStart >= 0)
+			{
+				checkSpellDirtyRange();
+			}
 		}
 		//draw
 		for(int i =0;i<(int)misspellLocations.size();i++)
@@ -3665,7 +3763,7 @@ void LLTextEditor::draw()
 	// do on-demand reflow 
 	if (mReflowNeeded)
 	{
-		updateLineStartList();
+		updateLineStartList(mReflowStartPos);
 		mReflowNeeded = FALSE;
 	}
 
@@ -4244,7 +4342,8 @@ void LLTextEditor::appendText(const std::string &new_text, bool allow_undo, bool
 		mSegments.push_back(segment);
 	}
 	
-	needsReflow();
+	// only the appended text needs wrapping
+	needsReflow(old_length);
 	
 	// Set the cursor and scroll position
 	// Maintain the scroll position unless the scroll was at the end of the doc (in which 
@@ -4298,7 +4397,7 @@ void LLTextEditor::removeTextFromEnd(S32 num_chars)
 
 	pruneSegments();
 	
-	// pruneSegments will invalidate mLineStartList.
+	// pruneSegments will invalidate mLineLayout.
 	updateLineStartList();
 	needsScroll();
 }
@@ -4319,6 +4418,11 @@ S32 LLTextEditor::insertStringNoUndo(const S32 pos, const LLWString &wstr)
 		// The user's not getting everything he's hoping for
 		make_ui_sound("UISndBadKeystroke");
 		insert_len = mWText.length() - old_len;
+		spellTextReset();
+	}
+	else
+	{
+		spellTextChanged(pos, 0, insert_len);
 	}
 
 	return insert_len;
@@ -4328,6 +4432,7 @@ S32 LLTextEditor::removeStringNoUndo(S32 pos, S32 length)
 {
 	mWText.erase(pos, length);
 	mTextIsUpToDate = FALSE;
+	spellTextChanged(pos, length, 0);
 	return -length;	// This will be wrong if someone calls removeStringNoUndo with an excessive length
 }
 
@@ -4339,6 +4444,7 @@ S32 LLTextEditor::overwriteCharNoUndo(S32 pos, llwchar wc)
 	}
 	mWText[pos] = wc;
 	mTextIsUpToDate = FALSE;
+	spellTextChanged(pos, 1, 1);
 	return 1;
 }
 
@@ -4472,7 +4578,7 @@ void LLTextEditor::updateSegments()
 }
 
 // Only effective if text was removed from the end of the editor
-// *NOTE: Using this will invalidate references to mSegments from mLineStartList.
+// *NOTE: Using this will invalidate references to mSegments from mLineLayout.
 void LLTextEditor::pruneSegments()
 {
 	S32 len = mWText.length();
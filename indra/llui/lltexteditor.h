@@ -46,6 +46,7 @@
 
 #include "llpreeditor.h"
 #include "llmenugl.h"
+#include "lltextlayout.h"
 
 class LLFontGL;
 class LLScrollbar;
@@ -356,7 +357,7 @@ public:
 	S32				prevWordPos(S32 cursorPos) const;
 	S32				nextWordPos(S32 cursorPos) const;
 
-	S32 			getLineCount() const { return mLineStartList.size(); }
+	S32 			getLineCount() const { return mLineLayout.getLineCount(); }
 	S32 			getLineStart( S32 line ) const;
 	void			getLineAndOffset(S32 pos, S32* linep, S32* offsetp) const;
 	S32				getPos(S32 line, S32 offset);
@@ -495,11 +496,26 @@ private:
 	void			drawCursor();
 	void			autoCorrectText();
 	void			drawMisspelled();
+	// Appends the misspelled words overlapping [start, end) to positions as
+	// start and end pairs.  Words still waiting on the spell checker are
+	// marked dirty, so that they are looked at again.
+	void			findMisspelledWords(S32 start, S32 end, std::vector<S32>& positions);
+	// Checks the words in the spell dirty range again, keeping the results
+	// for the rest of the text.
+	void			checkSpellDirtyRange();
+	void			markSpellDirty(S32 start, S32 end);
+	// Called when length characters at pos were replaced by inserted ones
+	void			spellTextChanged(S32 pos, S32 length, S32 inserted);
+	// Called when the whole text was replaced
+	void			spellTextReset();
 	void			drawText();
 	void			drawClippedSegment(const LLWString &wtext, S32 seg_start, S32 seg_end, F32 x, F32 y, S32 selection_left, S32 selection_right, const LLStyleSP& color, F32* right_x);
 
-	void			needsReflow() 
+	// startpos is the first character that changed; lines before the
+	// paragraph containing it are kept on the next reflow.
+	void			needsReflow(S32 startpos = 0) 
 	{ 
+		mReflowStartPos = mReflowNeeded ? llmin(mReflowStartPos, startpos) : startpos;
 		mReflowNeeded = TRUE; 
 		// cursor might have moved, need to scroll
 		mScrollNeeded = TRUE;
@@ -529,6 +545,10 @@ private:
 	S32 spellStart;
 	S32 spellEnd;
 	std::vector<S32> misspellLocations;     // where all the mispelled words are
+	S32				mSpellDirtyStart;		// text changed since the last spell check, or -1
+	S32				mSpellDirtyEnd;
+	U32				mSpellGeneration;		// spell checker results last looked at
+	U32				mSpellDictionarySerial;
 	BOOL		mOverRideAndShowMisspellings;
 	
 	S32				mMaxTextByteLength;		// Maximum length mText is allowed to be in bytes
@@ -547,32 +567,15 @@ private:
 
 	S32				mDesiredXPixel;			// X pixel position where the user wants the cursor to be
 	LLRect			mTextRect;				// The rect in which text is drawn.  Excludes borders.
-	// List of offsets and segment index of the start of each line.  Always has at least one node (0).
-	struct line_info
-	{
-		line_info(S32 segment, S32 offset) : mSegment(segment), mOffset(offset) {}
-		S32 mSegment;
-		S32 mOffset;
-	};
-	struct line_info_compare
-	{
-		bool operator()(const line_info& a, const line_info& b) const
-		{
-			if (a.mSegment < b.mSegment)
-				return true;
-			else if (a.mSegment > b.mSegment)
-				return false;
-			else
-				return a.mOffset < b.mOffset;
-		}
-	};
-	typedef std::vector<line_info> line_list_t;
-
 	//to keep track of what we have to remove before showing menu
 	std::vector<SpellMenuBind* > suggestionMenuItems;
 
-	line_list_t mLineStartList;
+	// Offsets and segment index of the start of each line.  Always has at least one node (0).
+	LLTextLayout	mLineLayout;
+	class LayoutSource;
+	friend class LayoutSource;
 	BOOL			mReflowNeeded;
+	S32				mReflowStartPos;		// first changed character since the last reflow
 	BOOL			mScrollNeeded;
 
 	LLFrameTimer	mKeystrokeTimer;
@@ -0,0 +1,143 @@
+/** 
+ * @file lltextlayout.cpp
+ * @brief Incremental line wrapping for LLTextEditor
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltextlayout.h"
+
+#include <algorithm>
+
+LLTextLayout::LLTextLayout()
+{
+}
+
+S32 LLTextLayout::findLine(S32 seg_idx, S32 seg_offset) const
+{
+	line_list_t::const_iterator iter = std::upper_bound(mLines.begin(), mLines.end(), line_info(seg_idx, seg_offset), line_info_compare());
+	if (iter != mLines.begin()) --iter;
+	return iter - mLines.begin();
+}
+
+S32 LLTextLayout::reflow(const Source& source, S32 startpos, F32 width, S32 start_x)
+{
+	const LLWString& text = source.getLayoutText();
+	S32 seg_num = source.getSegmentCount();
+	S32 seg_idx = 0;
+	S32 seg_offset = 0;
+
+	startpos = llclamp(startpos, 0, (S32)text.length());
+
+	// Where a paragraph wraps only depends on the paragraph itself, so back
+	// up to the start of the one containing startpos and keep every line
+	// before it.
+	while (startpos > 0 && text[startpos - 1] != '\n')
+	{
+		--startpos;
+	}
+
+	if (startpos > 0 && !mLines.empty() && seg_num > 0)
+	{
+		source.getSegmentAndOffset(startpos, &seg_idx, &seg_offset);
+		S32 line = findLine(seg_idx, seg_offset);
+		seg_idx = mLines[line].mSegment;
+		seg_offset = mLines[line].mOffset;
+		mLines.erase(mLines.begin() + line, mLines.end());
+	}
+	else
+	{
+		mLines.clear();
+	}
+
+	S32 first_line = (S32)mLines.size();
+
+	while( seg_idx < seg_num )
+	{
+		mLines.push_back(line_info(seg_idx,seg_offset));
+		BOOL line_ended = FALSE;
+		S32 line_width = start_x;
+		while(!line_ended && seg_idx < seg_num)
+		{
+			S32 seg_start = source.getSegmentStart(seg_idx);
+			S32 seg_end = source.getSegmentEnd(seg_idx);
+			S32 start_idx = seg_start + seg_offset;
+			S32 end_idx = start_idx;
+			while (end_idx < seg_end && text[end_idx] != '\n')
+			{
+				end_idx++;
+			}
+			if (start_idx == end_idx)
+			{
+				if (end_idx >= seg_end)
+				{
+					// empty segment
+					seg_idx++;
+					seg_offset = 0;
+				}
+				else
+				{
+					// empty line
+					line_ended = TRUE;
+					seg_offset++;
+				}
+			}
+			else
+			{ 
+				const llwchar* str = text.c_str() + start_idx;
+				S32 drawn = source.maxDrawableChars(str, width - line_width, end_idx - start_idx);
+				if( 0 == drawn && line_width == start_x)
+				{
+					// If at the beginning of a line, draw at least one character, even if it doesn't all fit.
+					drawn = 1;
+				}
+				seg_offset += drawn;
+				line_width += source.getWidth(str, drawn);
+				end_idx = seg_start + seg_offset;
+				if (end_idx < seg_end)
+				{
+					line_ended = TRUE;
+					if (text[end_idx] == '\n')
+					{
+						seg_offset++; // skip newline
+					}
+				}
+				else
+				{
+					// finished with segment
+					seg_idx++;
+					seg_offset = 0;
+				}
+			}
+		}
+	}
+
+	return first_line;
+}
@@ -0,0 +1,113 @@
+/** 
+ * @file lltextlayout.h
+ * @brief Incremental line wrapping for LLTextEditor
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXTLAYOUT_H
+#define LL_LLTEXTLAYOUT_H
+
+#include <vector>
+
+#include "llstring.h"
+
+// List of the line starts of a wrapped document, kept as (segment, offset)
+// pairs in document order so that a position can be mapped to its line with
+// a binary search.  reflow() only rewraps from the paragraph containing the
+// first changed character, which makes appending to a long document (chat
+// history) cost about as much as wrapping the appended text.
+//
+// The text, its segments and the font metrics come from a Source, so the
+// layout itself has no UI or rendering dependencies.
+class LLTextLayout
+{
+public:
+	class Source
+	{
+	public:
+		virtual ~Source() {}
+
+		virtual const LLWString& getLayoutText() const = 0;
+
+		// Segments are contiguous, in document order, and cover the text.
+		virtual S32 getSegmentCount() const = 0;
+		virtual S32 getSegmentStart(S32 seg_idx) const = 0;
+		virtual S32 getSegmentEnd(S32 seg_idx) const = 0;
+		virtual void getSegmentAndOffset(S32 pos, S32* seg_idxp, S32* offsetp) const = 0;
+
+		// Same contract as LLFontGL::maxDrawableChars() and LLFontGL::getWidth().
+		virtual S32 maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_chars) const = 0;
+		virtual S32 getWidth(const llwchar* wchars, S32 count) const = 0;
+	};
+
+	struct line_info
+	{
+		line_info(S32 segment, S32 offset) : mSegment(segment), mOffset(offset) {}
+		S32 mSegment;
+		S32 mOffset;
+	};
+
+	struct line_info_compare
+	{
+		bool operator()(const line_info& a, const line_info& b) const
+		{
+			if (a.mSegment < b.mSegment)
+				return true;
+			else if (a.mSegment > b.mSegment)
+				return false;
+			else
+				return a.mOffset < b.mOffset;
+		}
+	};
+
+	typedef std::vector<line_info> line_list_t;
+
+	LLTextLayout();
+
+	void clear()								{ mLines.clear(); }
+
+	// Rewraps the document from the paragraph containing startpos to the end.
+	// Everything before startpos must be unchanged since the last reflow, and
+	// segment indices before it must still be valid.  Pass 0 to rewrap it all.
+	// Returns the index of the first line that was rewrapped.
+	S32 reflow(const Source& source, S32 startpos, F32 width, S32 start_x);
+
+	bool isEmpty() const						{ return mLines.empty(); }
+	S32 getLineCount() const					{ return (S32)mLines.size(); }
+	const line_info& getLine(S32 line) const	{ return mLines[line]; }
+
+	// Index of the line containing the character at seg_offset into segment
+	// seg_idx, in O(log lines).
+	S32 findLine(S32 seg_idx, S32 seg_offset) const;
+
+private:
+	line_list_t mLines;		// Always has at least one entry once reflowed.
+};
+
+#endif // LL_LLTEXTLAYOUT_H
@@ -169,7 +169,7 @@ void gl_rect_2d_offset_local( S32 left, S32 top, S32 right, S32 bottom, S32 pixe
 	bottom += LLFontGL::sCurOrigin.mY;
 	top += LLFontGL::sCurOrigin.mY;
 
-	glLoadIdentity();
+	gGL.loadIdentity();
 	gl_rect_2d(llfloor((F32)left * LLUI::sGLScaleFactor.mV[VX]) - pixel_offset,
 				llfloor((F32)top * LLUI::sGLScaleFactor.mV[VY]) + pixel_offset,
 				llfloor((F32)right * LLUI::sGLScaleFactor.mV[VX]) + pixel_offset,
@@ -651,7 +651,7 @@ void gl_draw_scaled_rotated_image(S32 x, S32 y, S32 width, S32 height, F32 degre
 			F32 offset_x = F32(width/2);
 			F32 offset_y = F32(height/2);
 			gGL.translatef( offset_x, offset_y, 0.f);
-			glRotatef( degrees, 0.f, 0.f, 1.f );
+			gGL.rotatef( degrees, 0.f, 0.f, 1.f );
 			gGL.translatef( -offset_x, -offset_y, 0.f );
 		}
 
@@ -1615,7 +1615,7 @@ void LLUI::popMatrix()
 //static 
 void LLUI::loadIdentity()
 {
-	glLoadIdentity();
+	gGL.loadIdentity();
 	LLFontGL::sCurOrigin.mX = 0;
 	LLFontGL::sCurOrigin.mY = 0;
 	LLFontGL::sCurOrigin.mZ = 0;
@@ -1805,6 +1805,8 @@ LLScreenClipRect::LLScreenClipRect(const LLRect& rect, BOOL enabled) : mScissorS
 {
 	if (mEnabled)
 	{
+		// scissoring isn't part of retained geometry
+		gGL.abortRecording();
 		pushClipRect(rect);
 	}
 	mScissorState.setEnabled(!sClipRectStack.empty());
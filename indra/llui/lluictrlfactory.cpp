@@ -40,6 +40,8 @@
 // other library includes
 #include "llcontrol.h"
 #include "lldir.h"
+#include "llmd5.h"
+#include "lltimer.h"
 #include "v4color.h"
 
 // this library includes
@@ -78,6 +80,11 @@ const S32 FLOATER_H_MARGIN = 15;
 const S32 MIN_WIDGET_HEIGHT = 10;
 
 std::vector<std::string> LLUICtrlFactory::sXUIPaths;
+std::string LLUICtrlFactory::sLayoutCacheDir;
+LLUICtrlFactory::LayoutStats LLUICtrlFactory::sLayoutStats;
+
+// Bump when the binary layout format changes.
+static const char LAYOUT_CACHE_MAGIC[] = "LLXUI001";
 
 // UI Ctrl class for padding
 class LLUICtrlLocate : public LLUICtrl
@@ -169,6 +176,8 @@ const std::vector<std::string>& LLUICtrlFactory::getXUIPaths()
 //-----------------------------------------------------------------------------
 bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNodePtr& root)
 {
+	LLTimer load_timer;
+
 	std::string full_filename = gDirUtilp->findSkinnedFilename(sXUIPaths.front(), xui_filename);
 	if (full_filename.empty())
 	{
@@ -184,31 +193,60 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 		}
 	}
 
-	if (!LLXMLNode::parseFile(full_filename, root, NULL))
-	{
-		llwarns << "Problem reading UI description file: " << full_filename << llendl;
-		return false;
-	}
-
-	LLXMLNodePtr updateRoot;
+	// The base file, then each localized version to merge over it.
+	std::vector<std::string> layer_filenames;
+	layer_filenames.push_back(full_filename);
 
 	std::vector<std::string>::const_iterator itor;
 
 	for (itor = sXUIPaths.begin(), ++itor; itor != sXUIPaths.end(); ++itor)
 	{
-		std::string nodeName;
-		std::string updateName;
-
 		std::string layer_filename = gDirUtilp->findSkinnedFilename((*itor), xui_filename);
 		if(layer_filename.empty())
 		{
 			// no localized version of this file, that's ok, keep looking
 			continue;
 		}
+		layer_filenames.push_back(layer_filename);
+	}
 
-		if (!LLXMLNode::parseFile(layer_filename, updateRoot, NULL))
+	std::string cache_key;
+	std::string cache_filename;
+	if (!sLayoutCacheDir.empty())
+	{
+		cache_key = getLayoutCacheKey(layer_filenames);
+		if (!cache_key.empty())
 		{
-			llwarns << "Problem reading localized UI description file: " << (*itor) + gDirUtilp->getDirDelimiter() + xui_filename << llendl;
+			char digest[MD5HEX_STR_SIZE];		/*Flawfinder: ignore*/
+			LLMD5 md5((const unsigned char*)cache_key.c_str());
+			md5.hex_digest(digest);
+			cache_filename = sLayoutCacheDir + gDirUtilp->getDirDelimiter() + digest + ".xui";
+
+			if (readLayoutCache(cache_filename, cache_key, root))
+			{
+				sLayoutStats.mCacheHits++;
+				sLayoutStats.mCacheTime += load_timer.getElapsedTimeF32();
+				return true;
+			}
+		}
+	}
+
+	if (!LLXMLNode::parseFile(full_filename, root, NULL))
+	{
+		llwarns << "Problem reading UI description file: " << full_filename << llendl;
+		return false;
+	}
+
+	LLXMLNodePtr updateRoot;
+
+	for (itor = layer_filenames.begin(), ++itor; itor != layer_filenames.end(); ++itor)
+	{
+		std::string nodeName;
+		std::string updateName;
+
+		if (!LLXMLNode::parseFile((*itor), updateRoot, NULL))
+		{
+			llwarns << "Problem reading localized UI description file: " << (*itor) << llendl;
 			return false;
 		}
 
@@ -221,9 +259,114 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 		}
 	}
 
+	sLayoutStats.mParsed++;
+	sLayoutStats.mParseTime += load_timer.getElapsedTimeF32();
+
+	if (!cache_filename.empty())
+	{
+		writeLayoutCache(cache_filename, cache_key, root);
+	}
+
+	return true;
+}
+
+//static
+void LLUICtrlFactory::setLayoutCacheDir(const std::string& dir)
+{
+	sLayoutCacheDir = dir;
+	if (!dir.empty() && !LLFile::isdir(dir))
+	{
+		LLFile::mkdir(dir);
+	}
+}
+
+// The key names every file a layout is merged from, with its size and
+// modification time, so editing or replacing any of them misses the cache.
+//static
+std::string LLUICtrlFactory::getLayoutCacheKey(const std::vector<std::string>& filenames)
+{
+	std::ostringstream key;
+	for (std::vector<std::string>::const_iterator iter = filenames.begin();
+		 iter != filenames.end(); ++iter)
+	{
+		llstat stat_data;
+		if (LLFile::stat(*iter, &stat_data))
+		{
+			return std::string();
+		}
+		key << *iter << '|' << (U64)stat_data.st_size << '|' << (U64)stat_data.st_mtime << '\n';
+	}
+	return key.str();
+}
+
+//static
+bool LLUICtrlFactory::readLayoutCache(const std::string& cache_filename, const std::string& key, LLXMLNodePtr& root)
+{
+	llifstream input(cache_filename, std::ios::in | std::ios::binary);
+	if (!input.is_open())
+	{
+		return false;
+	}
+
+	char magic[sizeof(LAYOUT_CACHE_MAGIC)];		/*Flawfinder: ignore*/
+	input.read(magic, sizeof(magic));
+	if (!input.good() || memcmp(magic, LAYOUT_CACHE_MAGIC, sizeof(magic)))
+	{
+		return false;
+	}
+
+	U32 key_length = 0;
+	input.read((char*)&key_length, sizeof(key_length));
+	if (!input.good() || key_length != key.size())
+	{
+		return false;
+	}
+	std::string cached_key(key_length, '\0');
+	input.read(&cached_key[0], key_length);
+	if (!input.good() || cached_key != key)
+	{
+		return false;
+	}
+
+	LLXMLNodePtr cached_root;
+	if (!LLXMLNode::readBinary(input, cached_root))
+	{
+		llwarns << "Corrupt UI layout cache file " << cache_filename << llendl;
+		input.close();
+		LLFile::remove(cache_filename);
+		return false;
+	}
+	root = cached_root;
 	return true;
 }
 
+//static
+void LLUICtrlFactory::writeLayoutCache(const std::string& cache_filename, const std::string& key, LLXMLNodePtr root)
+{
+	// Write to a temporary file first so a partial write is never read back.
+	std::string temp_filename = cache_filename + ".tmp";
+	{
+		llofstream output(temp_filename, std::ios::out | std::ios::binary);
+		if (!output.is_open())
+		{
+			return;
+		}
+		output.write(LAYOUT_CACHE_MAGIC, sizeof(LAYOUT_CACHE_MAGIC));
+		U32 key_length = key.size();
+		output.write((const char*)&key_length, sizeof(key_length));
+		output.write(key.data(), key_length);
+		root->writeBinary(output);
+		if (!output.good())
+		{
+			output.close();
+			LLFile::remove(temp_filename);
+			return;
+		}
+	}
+	LLFile::remove(cache_filename);
+	LLFile::rename(temp_filename, cache_filename);
+}
+
 
 //-----------------------------------------------------------------------------
 // buildFloater()
@@ -231,6 +374,7 @@ bool LLUICtrlFactory::getLayeredXMLNode(const std::string &xui_filename, LLXMLNo
 void LLUICtrlFactory::buildFloater(LLFloater* floaterp, const std::string& filename, 
 									const LLCallbackMap::map_t* factory_map, BOOL open) /* Flawfinder: ignore */
 {
+	LLTimer build_timer;
 	LLXMLNodePtr root;
 
 	if (!LLUICtrlFactory::getLayeredXMLNode(filename, root))
@@ -264,6 +408,9 @@ void LLUICtrlFactory::buildFloater(LLFloater* floaterp, const std::string& filen
 
 	LLHandle<LLFloater> handle = floaterp->getHandle();
 	mBuiltFloaters[handle] = filename;
+
+	LL_DEBUGS("XUITiming") << "Built floater " << filename << " in "
+						   << build_timer.getElapsedTimeF32() * 1000.f << " ms" << LL_ENDL;
 }
 
 //-----------------------------------------------------------------------------
@@ -294,6 +441,7 @@ S32 LLUICtrlFactory::saveToXML(LLView* viewp, const std::string& filename)
 BOOL LLUICtrlFactory::buildPanel(LLPanel* panelp, const std::string& filename,
 									const LLCallbackMap::map_t* factory_map)
 {
+	LLTimer build_timer;
 	BOOL didPost = FALSE;
 	LLXMLNodePtr root;
 
@@ -329,6 +477,9 @@ BOOL LLUICtrlFactory::buildPanel(LLPanel* panelp, const std::string& filename,
 		mFactoryStack.pop_front();
 	}
 
+	LL_DEBUGS("XUITiming") << "Built panel " << filename << " in "
+						   << build_timer.getElapsedTimeF32() * 1000.f << " ms" << LL_ENDL;
+
 	return didPost;
 }
 
@@ -80,9 +80,29 @@ public:
 
 	static const std::vector<std::string>& getXUIPaths();
 
+	// Merged layouts are cached in binary form in dir, keyed by the skin
+	// and language files they were built from.  An empty dir disables the
+	// cache.
+	static void setLayoutCacheDir(const std::string& dir);
+
+	struct LayoutStats
+	{
+		LayoutStats() : mParsed(0), mParseTime(0.f), mCacheHits(0), mCacheTime(0.f) {}
+
+		U32 mParsed;		// layouts parsed from XML
+		F32 mParseTime;		// seconds
+		U32 mCacheHits;		// layouts read from the cache
+		F32 mCacheTime;		// seconds
+	};
+	static const LayoutStats& getLayoutStats() { return sLayoutStats; }
+
 private:
 	bool getLayeredXMLNodeImpl(const std::string &filename, LLXMLNodePtr& root);
 
+	static std::string getLayoutCacheKey(const std::vector<std::string>& filenames);
+	static bool readLayoutCache(const std::string& cache_filename, const std::string& key, LLXMLNodePtr& root);
+	static void writeLayoutCache(const std::string& cache_filename, const std::string& key, LLXMLNodePtr root);
+
 	typedef std::map<LLHandle<LLPanel>, std::string> built_panel_t;
 	built_panel_t mBuiltPanels;
 
@@ -93,6 +113,9 @@ private:
 
 	static std::vector<std::string> sXUIPaths;
 
+	static std::string sLayoutCacheDir;
+	static LayoutStats sLayoutStats;
+
 	LLPanel* mDummyPanel;
 };
 
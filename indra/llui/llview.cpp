@@ -39,9 +39,11 @@
 #include <boost/tokenizer.hpp>
 
 #include "llrender.h"
+#include "llretainedgeometry.h"
 #include "llevent.h"
 #include "llfontgl.h"
 #include "llfocusmgr.h"
+#include "llframetimer.h"
 #include "llrect.h"
 #include "llstl.h"
 #include "llui.h"
@@ -74,6 +76,12 @@ S32		LLView::sLastBottomXML = S32_MIN;
 BOOL LLView::sIsDrawing = FALSE;
 #endif
 
+// A recording thrown away within this many frames is considered churn...
+const U32 RETAINED_DRAWING_MIN_FRAMES = 4;
+// ...and so is one that had to be aborted; either way, wait this long
+// before recording that view again.
+const U32 RETAINED_DRAWING_RETRY_FRAMES = 64;
+
 LLView::LLView() :
 	mParentView(NULL),
 	mReshapeFlags(FOLLOWS_NONE),
@@ -87,7 +95,11 @@ LLView::LLView() :
 	mUseBoundingRect(FALSE),
 	mVisible(TRUE),
 	mNextInsertionOrdinal(0),
-	mHoverCursor(UI_CURSOR_ARROW)
+	mHoverCursor(UI_CURSOR_ARROW),
+	mRetainDrawing(TRUE),
+	mRetainedGeometry(NULL),
+	mRetainedFrame(0),
+	mRetainRetryFrame(0)
 {
 }
 
@@ -105,7 +117,11 @@ LLView::LLView(const std::string& name, BOOL mouse_opaque) :
 	mUseBoundingRect(FALSE),
 	mVisible(TRUE),
 	mNextInsertionOrdinal(0),
-	mHoverCursor(UI_CURSOR_ARROW)
+	mHoverCursor(UI_CURSOR_ARROW),
+	mRetainDrawing(TRUE),
+	mRetainedGeometry(NULL),
+	mRetainedFrame(0),
+	mRetainRetryFrame(0)
 {
 }
 
@@ -127,7 +143,11 @@ LLView::LLView(
 	mUseBoundingRect(FALSE),
 	mVisible(TRUE),
 	mNextInsertionOrdinal(0),
-	mHoverCursor(UI_CURSOR_ARROW)
+	mHoverCursor(UI_CURSOR_ARROW),
+	mRetainDrawing(TRUE),
+	mRetainedGeometry(NULL),
+	mRetainedFrame(0),
+	mRetainRetryFrame(0)
 {
 }
 
@@ -160,6 +180,9 @@ LLView::~LLView()
 				  DeletePairedPointer());
 	std::for_each(mDummyWidgets.begin(), mDummyWidgets.end(),
 				  DeletePairedPointer());
+
+	delete mRetainedGeometry;
+	mRetainedGeometry = NULL;
 }
 
 // virtual
@@ -202,6 +225,7 @@ void LLView::setRect(const LLRect& rect)
 {
 	mRect = rect;
 	updateBoundingRect();
+	dirtyRetainedDrawing();
 }
 
 void LLView::setUseBoundingRect( BOOL use_bounding_rect ) 
@@ -230,6 +254,7 @@ void LLView::sendChildToFront(LLView* child)
 	{
 		mChildList.remove( child );
 		mChildList.push_front(child);
+		dirtyRetainedDrawing();
 	}
 }
 
@@ -239,6 +264,7 @@ void LLView::sendChildToBack(LLView* child)
 	{
 		mChildList.remove( child );
 		mChildList.push_back(child);
+		dirtyRetainedDrawing();
 	}
 }
 
@@ -282,6 +308,7 @@ void LLView::addChild(LLView* child, S32 tab_group)
 
 	child->mParentView = this;
 	updateBoundingRect();
+	dirtyRetainedDrawing();
 }
 
 
@@ -309,6 +336,7 @@ void LLView::addChildAtEnd(LLView* child, S32 tab_group)
 	
 	child->mParentView = this;
 	updateBoundingRect();
+	dirtyRetainedDrawing();
 }
 
 // remove the specified child from the view, and set it's parent to NULL.
@@ -332,6 +360,7 @@ void LLView::removeChild(LLView* child, BOOL deleteIt)
 		llerrs << "LLView::removeChild called with non-child" << llendl;
 	}
 	updateBoundingRect();
+	dirtyRetainedDrawing();
 }
 
 void LLView::addCtrlAtEnd(LLUICtrl* ctrl, S32 tab_group)
@@ -453,7 +482,11 @@ BOOL LLView::getTentative() const
 //virtual
 void LLView::setEnabled(BOOL enabled)
 {
-	mEnabled = enabled;
+	if (mEnabled != enabled)
+	{
+		mEnabled = enabled;
+		dirtyRetainedDrawing();
+	}
 }
 
 //virtual
@@ -614,6 +647,7 @@ void LLView::setVisible(BOOL visible)
 			onVisibilityChange( visible );
 		}
 		updateBoundingRect();
+		dirtyRetainedDrawing();
 	}
 }
 
@@ -636,6 +670,7 @@ void LLView::translate(S32 x, S32 y)
 {
 	mRect.translate(x, y);
 	updateBoundingRect();
+	dirtyRetainedDrawing();
 }
 
 // virtual
@@ -1342,7 +1377,7 @@ void LLView::draw()
 				LLUI::pushMatrix();
 				{
 					LLUI::translate((F32)viewp->getRect().mLeft, (F32)viewp->getRect().mBottom, 0.f);
-					viewp->draw();
+					viewp->drawRetained();
 				}
 				LLUI::popMatrix();
 			}
@@ -1436,7 +1471,7 @@ void LLView::drawChild(LLView* childp, S32 x_offset, S32 y_offset, BOOL force_dr
 			LLUI::pushMatrix();
 			{
 				LLUI::translate((F32)childp->getRect().mLeft + x_offset, (F32)childp->getRect().mBottom + y_offset, 0.f);
-				childp->draw();
+				childp->drawRetained();
 			}
 			LLUI::popMatrix();
 		}
@@ -1446,6 +1481,92 @@ void LLView::drawChild(LLView* childp, S32 x_offset, S32 y_offset, BOOL force_dr
 }
 
 
+void LLView::drawRetained()
+{
+	static LLCachedControl<bool> sRetainDrawing(*LLUI::sConfigGroup, "UIRetainStaticViews");
+
+	BOOL is_static = isStaticDrawing();
+	if (gGL.isRecording())
+	{
+		// An ancestor is recording; we're either part of it or spoil it.
+		if (!is_static)
+		{
+			gGL.abortRecording();
+		}
+		draw();
+		return;
+	}
+
+	// Leaves gain nothing over their own immediate mode batches.
+	if (!is_static || !mRetainDrawing || !sRetainDrawing || sDebugRects
+		|| mChildList.empty()
+		|| LLFrameTimer::getFrameCount() < mRetainRetryFrame)
+	{
+		draw();
+		return;
+	}
+
+	// Children outside the root view are culled while drawing, so only
+	// views entirely on screen can be replayed as recorded.
+	LLRect screen_rect;
+	localRectToScreen(getLocalRect(), &screen_rect);
+	if (!getRootView()->getRect().contains(screen_rect))
+	{
+		draw();
+		return;
+	}
+
+	if (!mRetainedGeometry)
+	{
+		mRetainedGeometry = new LLRetainedGeometry();
+	}
+	if (mRetainedGeometry->replay())
+	{
+		return;
+	}
+
+	if (!gGL.beginRecording(mRetainedGeometry))
+	{
+		draw();
+		return;
+	}
+	draw();
+	if (gGL.endRecording())
+	{
+		mRetainedFrame = LLFrameTimer::getFrameCount();
+	}
+	else
+	{
+		mRetainRetryFrame = LLFrameTimer::getFrameCount() + RETAINED_DRAWING_RETRY_FRAMES;
+	}
+}
+
+void LLView::dirtyRetainedDrawing()
+{
+	for (LLView* viewp = this; viewp; viewp = viewp->mParentView)
+	{
+		LLRetainedGeometry* geometry = viewp->mRetainedGeometry;
+		if (geometry && geometry->isValid())
+		{
+			geometry->invalidate();
+			if (LLFrameTimer::getFrameCount() - viewp->mRetainedFrame < RETAINED_DRAWING_MIN_FRAMES)
+			{
+				// changes every few frames, not worth recording
+				viewp->mRetainRetryFrame = LLFrameTimer::getFrameCount() + RETAINED_DRAWING_RETRY_FRAMES;
+			}
+		}
+	}
+}
+
+void LLView::setRetainDrawing(BOOL retain)
+{
+	mRetainDrawing = retain;
+	if (!retain && mRetainedGeometry)
+	{
+		mRetainedGeometry->invalidate();
+	}
+}
+
 void LLView::reshape(S32 width, S32 height, BOOL called_from_parent)
 {
 	// compute how much things changed and apply reshape logic to children
@@ -1457,6 +1578,7 @@ void LLView::reshape(S32 width, S32 height, BOOL called_from_parent)
 		// adjust our rectangle
 		mRect.mRight = getRect().mLeft + width;
 		mRect.mTop = getRect().mBottom + height;
+		dirtyRetainedDrawing();
 
 		// move child views according to reshape flags
 		for ( child_list_iter_t child_it = mChildList.begin(); child_it != mChildList.end(); ++child_it)
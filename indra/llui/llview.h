@@ -124,6 +124,8 @@ virtual BOOL	handleDragAndDrop(S32 x, S32 y, MASK mask, BOOL drop,EDragAndDropTy
 		*
 virtual void	draw();
 		*
+virtual BOOL	isStaticDrawing() const;
+		LLPanel, LLTextBox, LLIconCtrl, LLViewBorder
 
 		*
 virtual LLXMLNodePtr getXML(bool save_children = true) const;
@@ -152,6 +154,7 @@ virtual BOOL	handleUnicodeCharHere(llwchar uni_char);
 		*
 */
 
+class LLRetainedGeometry;
 class LLUICtrlFactory;
 
 // maps xml strings to widget classes
@@ -380,7 +383,7 @@ public:
 	LLView*		findPrevSibling(LLView* child);
 	LLView*		findNextSibling(LLView* child);
 	S32			getChildCount()	const			{ return (S32)mChildList.size(); }
-	template<class _Pr3> void sortChildren(_Pr3 _Pred) { mChildList.sort(_Pred); }
+	template<class _Pr3> void sortChildren(_Pr3 _Pred) { mChildList.sort(_Pred); dirtyRetainedDrawing(); }
 	BOOL		hasAncestor(const LLView* parentp) const;
 	BOOL		hasChild(const std::string& childname, BOOL recurse = FALSE) const;
 	BOOL 		childHasKeyboardFocus( const std::string& childname ) const;
@@ -393,7 +396,7 @@ public:
 	// Default behavior is to use reshape flags to resize child views
 	virtual void	reshape(S32 width, S32 height, BOOL called_from_parent = TRUE);
 	virtual void	translate( S32 x, S32 y );
-	void			setOrigin( S32 x, S32 y )	{ mRect.translate( x - mRect.mLeft, y - mRect.mBottom ); }
+	void			setOrigin( S32 x, S32 y )	{ mRect.translate( x - mRect.mLeft, y - mRect.mBottom ); dirtyRetainedDrawing(); }
 	BOOL			translateIntoRect( const LLRect& constraint, BOOL allow_partial_outside );
 	void			centerWithin(const LLRect& bounds);
 
@@ -419,6 +422,16 @@ public:
 
 	virtual void	draw();
 
+	// Retained drawing: the outermost view whose subtree is entirely static
+	// records what the subtree draws into an LLRetainedGeometry and replays
+	// it on later frames instead of calling draw().  Any change that affects
+	// how a static view draws must call dirtyRetainedDrawing().
+	// TRUE if draw() depends only on state whose setters dirty the view.
+	virtual BOOL	isStaticDrawing() const			{ return FALSE; }
+	void			dirtyRetainedDrawing();
+	void			setRetainDrawing(BOOL retain);	// allowed by default
+	BOOL			getRetainDrawing() const		{ return mRetainDrawing; }
+
 	virtual LLXMLNodePtr getXML(bool save_children = true) const;
 	//FIXME: make LLView non-instantiable from XML
 	static LLView* fromXML(LLXMLNodePtr node, LLView *parent, class LLUICtrlFactory *factory);
@@ -604,6 +617,8 @@ protected:
 
 	void			drawDebugRect();
 	void			drawChild(LLView* childp, S32 x_offset = 0, S32 y_offset = 0, BOOL force_draw = FALSE);
+	// draw(), or replay what it drew last time if nothing changed since
+	void			drawRetained();
 
 	LLView*	childrenHandleKey(KEY key, MASK mask);
 	LLView* childrenHandleUnicodeChar(llwchar uni_char);
@@ -674,6 +689,11 @@ private:
 	boost::signals2::connection mControlConnection;
 
 	ECursorType mHoverCursor;
+
+	BOOL		mRetainDrawing;
+	LLRetainedGeometry* mRetainedGeometry;
+	U32			mRetainedFrame;		// frame the geometry was recorded
+	U32			mRetainRetryFrame;	// don't try to record again before this frame
 	
 public:
 	static BOOL	sDebugRects;	// Draw debug rects behind everything.
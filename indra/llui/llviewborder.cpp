@@ -56,6 +56,7 @@ void LLViewBorder::setColors( const LLColor4& shadow_dark, const LLColor4& highl
 {
 	mShadowDark = shadow_dark;
 	mHighlightLight = highlight_light;
+	dirtyRetainedDrawing();
 }
 
 void LLViewBorder::setColorsExtended( const LLColor4& shadow_light, const LLColor4& shadow_dark,
@@ -65,11 +66,13 @@ void LLViewBorder::setColorsExtended( const LLColor4& shadow_light, const LLColo
 	mShadowLight = shadow_light;
 	mHighlightLight = highlight_light;
 	mHighlightDark = highlight_dark;
+	dirtyRetainedDrawing();
 }
 
 void LLViewBorder::setTexture( const LLUUID &image_id )
 {
 	mTexture = LLUI::getUIImageByID(image_id);
+	dirtyRetainedDrawing();
 }
 
 
@@ -246,7 +249,7 @@ void LLViewBorder::drawTextureTrapezoid( F32 degrees, S32 width, S32 length, F32
 	gGL.pushMatrix();
 	{
 		gGL.translatef(start_x, start_y, 0.f);
-		glRotatef( degrees, 0, 0, 1 );
+		gGL.rotatef( degrees, 0, 0, 1 );
 
 		gGL.begin(LLRender::QUADS);
 		{
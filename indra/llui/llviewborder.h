@@ -50,14 +50,16 @@ public:
 
 	// llview functionality
 	virtual void draw();
+	// the keyboard focus highlight flashes
+	virtual BOOL isStaticDrawing() const		{ return !mHasKeyboardFocus; }
 	
 	virtual LLXMLNodePtr getXML(bool save_children = true) const;
 	static  LLView* fromXML(LLXMLNodePtr node, LLView *parent, class LLUICtrlFactory *factory);
 	static BOOL getBevelFromAttribute(LLXMLNodePtr node, LLViewBorder::EBevel& bevel_style);
 
-	void		setBorderWidth(S32 width)			{ mBorderWidth = width; }
+	void		setBorderWidth(S32 width)			{ mBorderWidth = width; dirtyRetainedDrawing(); }
 	S32			getBorderWidth() const				{ return mBorderWidth; }
-	void		setBevel(EBevel bevel)				{ mBevel = bevel; }
+	void		setBevel(EBevel bevel)				{ mBevel = bevel; dirtyRetainedDrawing(); }
 	EBevel		getBevel() const					{ return mBevel; }
 	void		setColors( const LLColor4& shadow_dark, const LLColor4& highlight_light );
 	void		setColorsExtended( const LLColor4& shadow_light, const LLColor4& shadow_dark,
@@ -69,7 +71,7 @@ public:
 
 	EStyle		getStyle() const { return mStyle; }
 
-	void		setKeyboardFocusHighlight( BOOL b )	{ mHasKeyboardFocus = b; }
+	void		setKeyboardFocusHighlight( BOOL b )	{ mHasKeyboardFocus = b; dirtyRetainedDrawing(); }
 
 private:
 	void		drawOnePixelLines();
@@ -0,0 +1,258 @@
+/** 
+ * @file llscrolllistindex_test.cpp
+ * @brief LLScrollListIndex tests, including a 50k row stress test
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+// Class to test
+#include "../llscrolllistindex.h"
+// Dependencies
+#include "llsd.h"
+#include "lluuid.h"
+#include "lltimer.h"
+// Tut header
+#include "../test/lltut.h"
+
+// -------------------------------------------------------------------------------------------
+// Stubbing: the index only handles pointers, so a row with a value and one
+// sortable column is enough.
+// -------------------------------------------------------------------------------------------
+class LLScrollListItem
+{
+public:
+	LLScrollListItem(const LLUUID& id, const std::string& name) : mValue(id), mName(name) {}
+	LLSD getValue() const { return mValue; }
+
+	LLSD mValue;
+	std::string mName;
+};
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+	// Compares rows by name the way SortScrollListItem compares cells, and
+	// counts the comparisons so the tests can tell how much work a sort did.
+	struct CompareName
+	{
+		CompareName(S32* count) : mCount(count) {}
+		bool operator()(const LLScrollListItem* a, const LLScrollListItem* b) const
+		{
+			(*mCount)++;
+			return LLStringUtil::compareDict(a->mName, b->mName) < 0;
+		}
+		S32* mCount;
+	};
+
+	// deterministic names with plenty of duplicates, so stability matters
+	static std::string row_name(U32& seed)
+	{
+		seed = seed * 1103515245 + 12345;
+		return llformat("Object %d", (seed >> 8) % 20000);
+	}
+
+	typedef LLScrollListIndex::item_list item_list;
+
+	// The order a full stable sort of the rows in their current order gives.
+	static bool is_sorted_like_full_sort(const item_list& items)
+	{
+		S32 count = 0;
+		item_list sorted = items;
+		std::stable_sort(sorted.begin(), sorted.end(), CompareName(&count));
+		for (U32 i = 0; i < items.size(); ++i)
+		{
+			if (items[i]->mName != sorted[i]->mName)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static LLScrollListItem* add_row(LLScrollListIndex& index, item_list& items, const std::string& name)
+	{
+		LLUUID id;
+		id.generate();
+		LLScrollListItem* item = new LLScrollListItem(id, name);
+		items.push_back(item);
+		index.addItem(item->getValue().asString(), item);
+		return item;
+	}
+
+	struct scrolllistindex_test
+	{
+		~scrolllistindex_test()
+		{
+			std::for_each(mItems.begin(), mItems.end(), DeletePointer());
+		}
+
+		item_list mItems;
+	};
+	typedef test_group<scrolllistindex_test> scrolllistindex_t;
+	typedef scrolllistindex_t::object scrolllistindex_object_t;
+	tut::scrolllistindex_t tut_scrolllistindex("scrolllistindex");
+
+	template<> template<>
+	void scrolllistindex_object_t::test<1>()
+	{
+		// Unique keys are found directly, shared keys are reported as
+		// ambiguous until the last row using them is gone.
+		LLScrollListIndex index;
+		LLScrollListItem* first = add_row(index, mItems, "first");
+		add_row(index, mItems, "second");
+
+		BOOL ambiguous = TRUE;
+		ensure("LLScrollListIndex: finds unique key", index.findItem(first->getValue().asString(), &ambiguous) == first);
+		ensure("LLScrollListIndex: unique key is not ambiguous", !ambiguous);
+		ensure("LLScrollListIndex: unknown key", index.findItem("nonexistent", &ambiguous) == NULL && !ambiguous);
+
+		LLScrollListItem* twin = new LLScrollListItem(first->getValue().asUUID(), "twin");
+		mItems.push_back(twin);
+		index.addItem(twin->getValue().asString(), twin);
+		ensure("LLScrollListIndex: shared key", index.findItem(first->getValue().asString(), &ambiguous) == NULL && ambiguous);
+
+		index.removeItem(twin->getValue().asString(), twin, 2);
+		index.removeItem(first->getValue().asString(), first, 0);
+		ensure("LLScrollListIndex: removed key", index.findItem(first->getValue().asString(), &ambiguous) == NULL && !ambiguous);
+	}
+
+	template<> template<>
+	void scrolllistindex_object_t::test<2>()
+	{
+		// Appending, changing and removing rows between sorts always leaves
+		// the same order as a full stable sort.
+		LLScrollListIndex index;
+		S32 comparisons = 0;
+		U32 seed = 1;
+
+		for (S32 i = 0; i < 200; ++i)
+		{
+			add_row(index, mItems, row_name(seed));
+		}
+		index.sort(mItems, CompareName(&comparisons));
+		ensure("LLScrollListIndex: initial sort", is_sorted_like_full_sort(mItems));
+		ensure_equals("LLScrollListIndex: all rows sorted", index.getSortedCount(), (S32)mItems.size());
+
+		for (S32 pass = 0; pass < 20; ++pass)
+		{
+			for (S32 i = 0; i < 10; ++i)
+			{
+				add_row(index, mItems, row_name(seed));
+			}
+			for (S32 i = 0; i < 5; ++i)
+			{
+				LLScrollListItem* item = mItems[(seed = seed * 69069 + 1) % mItems.size()];
+				item->mName = row_name(seed);
+				index.itemChanged(item);
+			}
+			S32 victim = (seed >> 4) % mItems.size();
+			LLScrollListItem* item = mItems[victim];
+			index.removeItem(item->getValue().asString(), item, victim);
+			mItems.erase(mItems.begin() + victim);
+			delete item;
+
+			index.sort(mItems, CompareName(&comparisons));
+			ensure("LLScrollListIndex: incremental sort matches full sort", is_sorted_like_full_sort(mItems));
+		}
+
+		// reordering behind the index's back forces a full sort
+		std::reverse(mItems.begin(), mItems.end());
+		index.invalidateOrder();
+		ensure_equals("LLScrollListIndex: invalidated", index.getSortedCount(), 0);
+		index.sort(mItems, CompareName(&comparisons));
+		ensure("LLScrollListIndex: sort after invalidateOrder()", is_sorted_like_full_sort(mItems));
+	}
+
+	template<> template<>
+	void scrolllistindex_object_t::test<3>()
+	{
+		// Stress test: a 50k row list filled a frame at a time, then updated
+		// in place by key, sorting after every frame like
+		// LLScrollListCtrl::draw() does.  Each sort should cost about a merge
+		// of the list, not a full re-sort.
+		const S32 NUM_ROWS = 50000;
+		const S32 ROWS_PER_FRAME = 500;
+		const S32 UPDATE_FRAMES = 100;
+		const S32 UPDATES_PER_FRAME = 50;
+
+		LLScrollListIndex index;
+		S32 comparisons = 0;
+		U32 seed = 12345;
+		std::vector<LLUUID> ids;
+		LLTimer timer;
+
+		S32 frames = 0;
+		while ((S32)mItems.size() < NUM_ROWS)
+		{
+			for (S32 i = 0; i < ROWS_PER_FRAME; ++i)
+			{
+				ids.push_back(add_row(index, mItems, row_name(seed))->getValue().asUUID());
+			}
+			index.sort(mItems, CompareName(&comparisons));
+			frames++;
+		}
+		F32 fill_time = timer.getElapsedTimeF32();
+
+		timer.reset();
+		for (S32 frame = 0; frame < UPDATE_FRAMES; ++frame)
+		{
+			for (S32 i = 0; i < UPDATES_PER_FRAME; ++i)
+			{
+				seed = seed * 69069 + 1;
+				BOOL ambiguous = FALSE;
+				LLScrollListItem* item = index.findItem(ids[(seed >> 8) % ids.size()].asString(), &ambiguous);
+				ensure("LLScrollListIndex: row found by key", item && !ambiguous);
+				item->mName = row_name(seed);
+				index.itemChanged(item);
+			}
+			index.sort(mItems, CompareName(&comparisons));
+		}
+		frames += UPDATE_FRAMES;
+		F32 update_time = timer.getElapsedTimeF32();
+
+		ensure_equals("LLScrollListIndex: row count", (S32)mItems.size(), NUM_ROWS);
+		ensure("LLScrollListIndex: 50k rows sorted", is_sorted_like_full_sort(mItems));
+
+		S32 full_sort_comparisons = 0;
+		item_list shuffled = mItems;
+		std::reverse(shuffled.begin(), shuffled.end());
+		std::stable_sort(shuffled.begin(), shuffled.end(), CompareName(&full_sort_comparisons));
+
+		llinfos << "LLScrollListIndex: " << NUM_ROWS << " rows filled in " << fill_time << " s, "
+				<< UPDATE_FRAMES * UPDATES_PER_FRAME << " keyed updates in " << update_time << " s, "
+				<< comparisons << " comparisons over " << frames << " sorts vs "
+				<< full_sort_comparisons << " for one full sort" << llendl;
+
+		ensure("LLScrollListIndex: sorting is incremental",
+			   comparisons < frames * full_sort_comparisons / 4);
+	}
+}
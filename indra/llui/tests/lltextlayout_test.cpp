@@ -0,0 +1,224 @@
+/** 
+ * @file lltextlayout_test.cpp
+ * @brief LLTextLayout tests, including a 100k line chat append benchmark
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+// Class to test
+#include "../lltextlayout.h"
+// For timer class
+#include "lltimer.h"
+// Tut header
+#include "../test/lltut.h"
+
+#include <algorithm>
+
+// -------------------------------------------------------------------------------------------
+// TUT
+// -------------------------------------------------------------------------------------------
+
+namespace tut
+{
+	// Fixed pitch "font" over an appendable document, split into one segment
+	// per append the way LLTextEditor::appendText() does for styled chat.
+	// Counts the characters it is asked to measure so the tests can tell how
+	// much of the document each reflow touched.
+	class TestSource : public LLTextLayout::Source
+	{
+	public:
+		enum { CHAR_WIDTH = 7 };
+
+		TestSource() : mMeasured(0) {}
+
+		void append(const std::string& text)
+		{
+			S32 start = mText.length();
+			mText += utf8str_to_wstring(text);
+			mStarts.push_back(start);
+			mEnds.push_back(mText.length());
+		}
+
+		/*virtual*/ const LLWString& getLayoutText() const		{ return mText; }
+		/*virtual*/ S32 getSegmentCount() const					{ return mStarts.size(); }
+		/*virtual*/ S32 getSegmentStart(S32 seg_idx) const		{ return mStarts[seg_idx]; }
+		/*virtual*/ S32 getSegmentEnd(S32 seg_idx) const			{ return mEnds[seg_idx]; }
+		/*virtual*/ void getSegmentAndOffset(S32 pos, S32* seg_idxp, S32* offsetp) const
+		{
+			std::vector<S32>::const_iterator iter = std::upper_bound(mStarts.begin(), mStarts.end(), pos);
+			if (iter != mStarts.begin()) --iter;
+			*seg_idxp = iter - mStarts.begin();
+			*offsetp = pos - *iter;
+		}
+		/*virtual*/ S32 maxDrawableChars(const llwchar* wchars, F32 max_pixels, S32 max_chars) const
+		{
+			mMeasured += max_chars;
+			S32 fit = llmin(max_chars, llmax(0, (S32)(max_pixels / CHAR_WIDTH)));
+			if (fit < max_chars)
+			{
+				// word wrap: break after the last space that fits
+				for (S32 i = fit; i > 0; --i)
+				{
+					if (wchars[i - 1] == ' ')
+					{
+						return i;
+					}
+				}
+			}
+			return fit;
+		}
+		/*virtual*/ S32 getWidth(const llwchar* wchars, S32 count) const
+		{
+			return count * CHAR_WIDTH;
+		}
+
+		LLWString mText;
+		std::vector<S32> mStarts;
+		std::vector<S32> mEnds;
+		mutable S32 mMeasured;
+	};
+
+	static std::string chat_line(S32 n)
+	{
+		// Vary the length so that some lines wrap and some don't.
+		std::string line = llformat("[12:%02d] Resident %d: ", n % 60, n);
+		for (S32 i = 0; i < n % 9; ++i)
+		{
+			line += "hello there ";
+		}
+		return line;
+	}
+
+	static bool same_lines(const LLTextLayout& a, const LLTextLayout& b)
+	{
+		if (a.getLineCount() != b.getLineCount())
+		{
+			return false;
+		}
+		for (S32 i = 0; i < a.getLineCount(); ++i)
+		{
+			if (a.getLine(i).mSegment != b.getLine(i).mSegment
+				|| a.getLine(i).mOffset != b.getLine(i).mOffset)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	const F32 WIDTH = 300.f;
+
+	struct textlayout_test
+	{
+	};
+	typedef test_group<textlayout_test> textlayout_t;
+	typedef textlayout_t::object textlayout_object_t;
+	tut::textlayout_t tut_textlayout("textlayout");
+
+	template<> template<>
+	void textlayout_object_t::test<1>()
+	{
+		// Appending and reflowing from the old end gives the same lines as
+		// wrapping the whole document.
+		TestSource source;
+		LLTextLayout incremental;
+		for (S32 n = 0; n < 200; ++n)
+		{
+			S32 old_length = source.mText.length();
+			source.append(n ? "\n" + chat_line(n) : chat_line(n));
+			incremental.reflow(source, old_length, WIDTH, 0);
+		}
+
+		LLTextLayout full;
+		full.reflow(source, 0, WIDTH, 0);
+
+		ensure("LLTextLayout: wrapped some lines", full.getLineCount() > 200);
+		ensure("LLTextLayout: incremental layout matches full layout", same_lines(incremental, full));
+	}
+
+	template<> template<>
+	void textlayout_object_t::test<2>()
+	{
+		// findLine() maps every line start back to its own line.
+		TestSource source;
+		for (S32 n = 0; n < 50; ++n)
+		{
+			source.append(n ? "\n" + chat_line(n) : chat_line(n));
+		}
+		LLTextLayout layout;
+		layout.reflow(source, 0, WIDTH, 0);
+
+		for (S32 line = 0; line < layout.getLineCount(); ++line)
+		{
+			const LLTextLayout::line_info& info = layout.getLine(line);
+			ensure_equals("LLTextLayout: findLine() of a line start", layout.findLine(info.mSegment, info.mOffset), line);
+		}
+	}
+
+	template<> template<>
+	void textlayout_object_t::test<3>()
+	{
+		// Benchmark: 100k chat lines appended one at a time, reflowing after
+		// each like LLTextEditor::draw() does.  The work per append must not
+		// grow with the size of the history.
+		const S32 NUM_LINES = 100000;
+
+		TestSource source;
+		LLTextLayout layout;
+		LLTimer timer;
+		F32 slowest_append = 0.f;
+		for (S32 n = 0; n < NUM_LINES; ++n)
+		{
+			S32 old_length = source.mText.length();
+			source.append(n ? "\n" + chat_line(n) : chat_line(n));
+
+			F32 start = timer.getElapsedTimeF32();
+			layout.reflow(source, old_length, WIDTH, 0);
+			slowest_append = llmax(slowest_append, timer.getElapsedTimeF32() - start);
+		}
+		F32 elapsed = timer.getElapsedTimeF32();
+		S32 incremental_measured = source.mMeasured;
+
+		source.mMeasured = 0;
+		LLTextLayout full;
+		full.reflow(source, 0, WIDTH, 0);
+		S32 full_measured = source.mMeasured;
+
+		llinfos << "LLTextLayout: appended " << NUM_LINES << " lines (" << layout.getLineCount()
+				<< " wrapped) in " << elapsed << " s, slowest append " << slowest_append * 1000.f
+				<< " ms, measured " << incremental_measured << " chars vs " << full_measured
+				<< " for one full layout" << llendl;
+
+		ensure("LLTextLayout: 100k line incremental layout matches full layout", same_lines(layout, full));
+		// Each append rewraps the previous paragraph and the new one, so the
+		// whole history costs about two full layouts rather than one per line.
+		ensure("LLTextLayout: reflow work proportional to appended text",
+			   incremental_measured <= 3 * full_measured);
+	}
+}
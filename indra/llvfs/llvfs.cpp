@@ -55,6 +55,15 @@ const S32 BLOCK_LENGTH_INVALID = -1;	// mLength for invalid LLVFSFileBlocks
 
 LLVFS *gVFS = NULL;
 
+static void vfs_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	if (gVFS)
+	{
+		gVFS->getMemoryUsage(usage);
+	}
+}
+static LLMemoryAccount sVFSAccount("VFS index", vfs_memory_usage);
+
 // internal class definitions
 class LLVFSBlock
 {
@@ -1870,6 +1879,21 @@ void LLVFS::dumpLockCounts()
 	}
 }
 
+void LLVFS::getMemoryUsage(LLMemoryAccount::Usage& usage)
+{
+	lockData();
+
+	S32 file_count = (S32)mFileBlocks.size();
+	S32 free_count = (S32)mFreeBlocksByLength.size();
+	usage.mBytes += LLMemoryAccount::nodeBytes(file_count, sizeof(fileblock_map::value_type)) + file_count * sizeof(LLVFSFileBlock);
+	usage.mBytes += LLMemoryAccount::nodeBytes(free_count, sizeof(blocks_length_map_t::value_type)) + free_count * sizeof(LLVFSBlock);
+	usage.mBytes += LLMemoryAccount::nodeBytes(mFreeBlocksByLocation.size(), sizeof(blocks_location_map_t::value_type));
+	usage.mBytes += mIndexHoles.size() * sizeof(S32);
+	usage.mCount += file_count;
+
+	unlockData();
+}
+
 void LLVFS::dumpStatistics()
 {
 	lockData();
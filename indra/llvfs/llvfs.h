@@ -38,6 +38,7 @@
 #include "linked_lists.h"
 #include "llassettype.h"
 #include "llthread.h"
+#include "llmemoryaccount.h"
 
 enum EVFSValid 
 {
@@ -122,6 +123,9 @@ public:
 	void listFiles();
 	void dumpFiles();
 
+	// Memory held by the in-memory index, one count per file
+	void getMemoryUsage(LLMemoryAccount::Usage& usage);
+
 protected:
 	void removeFileBlock(LLVFSFileBlock *fileblock);
 	
@@ -41,6 +41,7 @@
 #include "llstl.h"
 
 #include "llstring.h"
+#include "llthread.h"
 #include "v3math.h"
 #include "v3dmath.h"
 #include "v4coloru.h"
@@ -146,7 +147,8 @@ LLControlVariable::LLControlVariable(const std::string& name, eControlType type,
 	  mComment(comment),
 	  mType(type),
 	  mPersist(persist),
-	  mHideFromSettingsEditor(hidefromsettingseditor)
+	  mHideFromSettingsEditor(hidefromsettingseditor),
+	  mRevision(1)
 {
 	if (mPersist && mComment.empty())
 	{
@@ -246,6 +248,9 @@ void LLControlVariable::setValue(const LLSD& new_value, bool saved_value)
 
 	if(value_changed)
 	{
+		// Unsaved values never go through resetToDefault(), and cached
+		// handles must not see the value from before the push either
+		++mRevision;
 		mCommitSignal(this, storable_value);
 	}
 }
@@ -261,6 +266,7 @@ void LLControlVariable::setDefaultValue(const LLSD& value)
 	bool value_changed = (llsd_compare(getValue(), comparable_value) == FALSE);
 	resetToDefault(false);
 	mValues[0] = comparable_value;
+	++mRevision;
 	if(value_changed)
 	{
 		firePropertyChanged();
@@ -290,6 +296,7 @@ void LLControlVariable::resetToDefault(bool fire_signal)
 	{
 		mValues.pop_back();
 	}
+	++mRevision;
 	
 	if(fire_signal) 
 	{
@@ -313,11 +320,100 @@ LLSD LLControlVariable::getSaveValue() const
 
 LLControlVariablePtr LLControlGroup::getControl(const std::string& name)
 {
+	if (sTrackLookups)
+	{
+		countLookup(name);
+	}
 	ctrl_name_table_t::iterator iter = mNameTable.find(name);
 	return iter == mNameTable.end() ? LLControlVariablePtr() : iter->second;
 }
 
 
+////////////////////////////////////////////////////////////////////////////
+
+bool LLControlGroup::sTrackLookups = false;
+U32 LLControlGroup::sLookupFrames = 0;
+std::map<std::string, U32> LLControlGroup::sLookupCounts;
+LLMutex* LLControlGroup::sLookupMutex = NULL;
+
+//static
+void LLControlGroup::setLookupTracking(bool enable)
+{
+	if (enable == sTrackLookups)
+	{
+		return;
+	}
+	if (!sLookupMutex)
+	{
+		sLookupMutex = new LLMutex;
+	}
+	LLMutexLock lock(sLookupMutex);
+	sTrackLookups = enable;
+	sLookupCounts.clear();
+	sLookupFrames = 0;
+}
+
+//static
+void LLControlGroup::countLookup(const std::string& name)
+{
+	// Settings are read from worker threads too.
+	LLMutexLock lock(sLookupMutex);
+	++sLookupCounts[name];
+}
+
+//static
+void LLControlGroup::tickLookupFrame()
+{
+	if (sTrackLookups)
+	{
+		LLMutexLock lock(sLookupMutex);
+		++sLookupFrames;
+	}
+}
+
+static bool more_lookups(const std::pair<std::string, F32>& a, const std::pair<std::string, F32>& b)
+{
+	return a.second > b.second;
+}
+
+//static
+void LLControlGroup::getLookupReport(lookup_report_t& report, U32 max_entries)
+{
+	report.clear();
+	if (!sTrackLookups)
+	{
+		return;
+	}
+
+	{
+		LLMutexLock lock(sLookupMutex);
+		F32 frames = (F32)llmax(sLookupFrames, (U32)1);
+		for (std::map<std::string, U32>::iterator iter = sLookupCounts.begin();
+			 iter != sLookupCounts.end(); ++iter)
+		{
+			report.push_back(std::make_pair(iter->first, (F32)iter->second / frames));
+		}
+	}
+
+	std::sort(report.begin(), report.end(), more_lookups);
+	if (report.size() > max_entries)
+	{
+		report.resize(max_entries);
+	}
+}
+
+//static
+void LLControlGroup::dumpLookupReport()
+{
+	lookup_report_t report;
+	getLookupReport(report, U32_MAX);
+	llinfos << "Settings looked up by name over " << sLookupFrames << " frames:" << llendl;
+	for (lookup_report_t::iterator iter = report.begin(); iter != report.end(); ++iter)
+	{
+		llinfos << llformat("%10.2f per frame  ", iter->second) << iter->first << llendl;
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////
 
 LLControlGroup::LLControlGroup(const std::string& name)
@@ -44,6 +44,7 @@
 
 #include "llcontrolgroupreader.h"
 
+#include <map>
 #include <vector>
 
 // *NOTE: boost::visit_each<> generates warning 4675 on .net 2003
@@ -78,6 +79,7 @@ class LLVector3d;
 class LLColor4;
 class LLColor3;
 class LLColor4U;
+class LLMutex;
 
 const BOOL NO_PERSIST = FALSE;
 
@@ -113,6 +115,7 @@ private:
 	bool			mPersist;
 	bool			mHideFromSettingsEditor;
 	std::vector<LLSD> mValues;
+	U32				mRevision;	// bumped whenever the value may have changed
 	
 	commit_signal_t mCommitSignal;
 	validate_signal_t mValidateSignal;
@@ -127,7 +130,7 @@ public:
 	const std::string& getName() const { return mName; }
 	const std::string& getComment() const { return mComment; }
 
-	eControlType type()		{ return mType; }
+	eControlType type() const	{ return mType; }
 	bool isType(eControlType tp) { return tp == mType; }
 
 	void resetToDefault(bool fire_signal = false);
@@ -145,6 +148,7 @@ public:
 	LLSD getValue()		const	{ return mValues.back(); }
 	LLSD getDefault()	const	{ return mValues.front(); }
 	LLSD getSaveValue() const;
+	U32 getRevision()	const	{ return mRevision; }
 
 	void set(const LLSD& val)	{ setValue(val); }
 	void setValue(const LLSD& value, bool saved_value = TRUE);
@@ -155,6 +159,7 @@ public:
 
 	void firePropertyChanged()
 	{
+		++mRevision;
 		mCommitSignal(this, mValues.back());
 	}
 private:
@@ -209,6 +214,18 @@ public:
 
 	LLControlVariablePtr getControl(const std::string& name);
 
+	// Lookup tracking counts getControl() calls by name, to find hot code
+	// that should use an LLControlHandle or LLCachedControl instead.
+	// tickLookupFrame() is called once per frame so the counts can be
+	// reported per frame.
+	typedef std::vector<std::pair<std::string, F32> > lookup_report_t;
+	static void setLookupTracking(bool enable);
+	static bool getLookupTracking() { return sTrackLookups; }
+	static void tickLookupFrame();
+	// Fills report with the most looked up names and their lookups per frame.
+	static void getLookupReport(lookup_report_t& report, U32 max_entries);
+	static void dumpLookupReport();
+
 	struct ApplyFunctor
 	{
 		virtual ~ApplyFunctor() {};
@@ -316,6 +333,14 @@ public:
 
 	// Resets all ignorables
 	void resetWarnings();
+
+private:
+	static void countLookup(const std::string& name);
+
+	static bool sTrackLookups;
+	static U32 sLookupFrames;
+	static std::map<std::string, U32> sLookupCounts;
+	static LLMutex* sLookupMutex;
 };
 
 //! Publish/Subscribe object to interact with LLControlGroups.
@@ -437,6 +462,50 @@ private:
 	LLPointer<LLControlCache<T> > mCachedControlPtr;
 };
 
+//! Typed access to a control without a name lookup.
+
+//! Resolve it once, typically as a function-local static, and read it as
+//! often as needed.  Unlike LLCachedControl no listener is connected: the
+//! value is converted again only when the control's revision has changed
+//! since the last read.
+template <class T>
+class LLControlHandle
+{
+public:
+	LLControlHandle(LLControlGroup& group, const std::string& name)
+	:	mControl(group.getControl(name)),
+		mRevision(0)
+	{
+		if (mControl.isNull())
+		{
+			llerrs << "Control named " << name << " not found." << llendl;
+		}
+		mValue = convert_from_llsd<T>(mControl->getValue(), mControl->type(), name);
+		mRevision = mControl->getRevision();
+	}
+
+	const T& get() const
+	{
+		U32 revision = mControl->getRevision();
+		if (revision != mRevision)
+		{
+			mValue = convert_from_llsd<T>(mControl->getValue(), mControl->type(), mControl->getName());
+			mRevision = revision;
+		}
+		return mValue;
+	}
+
+	operator const T&() const { return get(); }
+	const T& operator()() const { return get(); }
+
+	LLControlVariable* getControl() const { return mControl; }
+
+private:
+	LLControlVariablePtr	mControl;
+	mutable T				mValue;
+	mutable U32				mRevision;
+};
+
 template <> eControlType get_control_type<U32>();
 template <> eControlType get_control_type<S32>();
 template <> eControlType get_control_type<F32>();
@@ -863,6 +863,155 @@ BOOL LLXMLNode::isFullyDefault()
 	return FALSE;
 }
 
+// Binary tree format, per node:
+//   name, is_attribute, version major/minor, length, precision, type,
+//   encoding, line number, id, value, attribute count, attributes,
+//   child count, children
+// Strings are a U32 length followed by the bytes.  Integers are written
+// in host byte order, the format is only used for local caches.
+
+static const U32 MAX_BINARY_XML_DEPTH = 256;
+
+static void write_binary_u32(std::ostream& output_stream, U32 value)
+{
+	output_stream.write((const char*)&value, sizeof(U32));
+}
+
+static void write_binary_string(std::ostream& output_stream, const std::string& value)
+{
+	write_binary_u32(output_stream, value.size());
+	output_stream.write(value.data(), value.size());
+}
+
+static bool read_binary_u32(std::istream& input_stream, U32& value)
+{
+	input_stream.read((char*)&value, sizeof(U32));
+	return input_stream.good();
+}
+
+static bool read_binary_string(std::istream& input_stream, std::string& value)
+{
+	U32 length;
+	if (!read_binary_u32(input_stream, length) || length > 16 * 1024 * 1024)
+	{
+		return false;
+	}
+	value.resize(length);
+	if (length)
+	{
+		input_stream.read(&value[0], length);
+	}
+	return input_stream.good();
+}
+
+void LLXMLNode::writeBinary(std::ostream& output_stream)
+{
+	write_binary_string(output_stream, mName ? std::string(mName->mString) : std::string());
+	write_binary_u32(output_stream, mIsAttribute ? 1 : 0);
+	write_binary_u32(output_stream, mVersionMajor);
+	write_binary_u32(output_stream, mVersionMinor);
+	write_binary_u32(output_stream, mLength);
+	write_binary_u32(output_stream, mPrecision);
+	write_binary_u32(output_stream, (U32)mType);
+	write_binary_u32(output_stream, (U32)mEncoding);
+	write_binary_u32(output_stream, (U32)mLineNumber);
+	write_binary_string(output_stream, mID);
+	write_binary_string(output_stream, mValue);
+
+	write_binary_u32(output_stream, mAttributes.size());
+	for (LLXMLAttribList::iterator iter = mAttributes.begin(); iter != mAttributes.end(); ++iter)
+	{
+		iter->second->writeBinary(output_stream);
+	}
+
+	U32 child_count = 0;
+	for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
+	{
+		++child_count;
+	}
+	write_binary_u32(output_stream, child_count);
+	for (LLXMLNodePtr child = getFirstChild(); child.notNull(); child = child->getNextSibling())
+	{
+		child->writeBinary(output_stream);
+	}
+}
+
+static bool read_binary_node(std::istream& input_stream, LLXMLNodePtr& node, U32 depth)
+{
+	if (depth > MAX_BINARY_XML_DEPTH)
+	{
+		return false;
+	}
+
+	std::string name;
+	U32 is_attribute, version_major, version_minor, length, precision, type, encoding, line_number;
+	if (!read_binary_string(input_stream, name)
+		|| !read_binary_u32(input_stream, is_attribute)
+		|| !read_binary_u32(input_stream, version_major)
+		|| !read_binary_u32(input_stream, version_minor)
+		|| !read_binary_u32(input_stream, length)
+		|| !read_binary_u32(input_stream, precision)
+		|| !read_binary_u32(input_stream, type)
+		|| !read_binary_u32(input_stream, encoding)
+		|| !read_binary_u32(input_stream, line_number)
+		|| type > LLXMLNode::TYPE_NODEREF
+		|| encoding > LLXMLNode::ENCODING_HEX)
+	{
+		return false;
+	}
+
+	node = new LLXMLNode(name.c_str(), is_attribute ? TRUE : FALSE);
+	node->mVersionMajor = version_major;
+	node->mVersionMinor = version_minor;
+	node->mLength = length;
+	node->mPrecision = precision;
+	node->mEncoding = (LLXMLNode::Encoding)encoding;
+	node->mLineNumber = (S32)line_number;
+
+	std::string value;
+	if (!read_binary_string(input_stream, node->mID)
+		|| !read_binary_string(input_stream, value))
+	{
+		return false;
+	}
+	node->setValue(value);
+	// setValue() changes containers to TYPE_UNKNOWN, keep the stored type
+	node->mType = (LLXMLNode::ValueType)type;
+
+	for (S32 pass = 0; pass < 2; ++pass)
+	{
+		// attributes, then children
+		U32 count;
+		if (!read_binary_u32(input_stream, count))
+		{
+			return false;
+		}
+		for (U32 i = 0; i < count; ++i)
+		{
+			LLXMLNodePtr child;
+			if (!read_binary_node(input_stream, child, depth + 1)
+				|| (child->mIsAttribute ? pass != 0 : pass != 1))
+			{
+				return false;
+			}
+			node->addChild(child);
+		}
+	}
+	return true;
+}
+
+// static
+bool LLXMLNode::readBinary(std::istream& input_stream, LLXMLNodePtr& node)
+{
+	LLXMLNodePtr root;
+	if (!read_binary_node(input_stream, root, 0))
+	{
+		return false;
+	}
+	node = root;
+	return true;
+}
+
 // static
 bool LLXMLNode::getLayeredXMLNode(LLXMLNodePtr& root,
 								  const std::vector<std::string>& paths)
@@ -157,6 +157,11 @@ public:
 
 	static bool getLayeredXMLNode(LLXMLNodePtr& root, const std::vector<std::string>& paths);
 
+	// Compact binary form of a parsed tree, so it can be cached and read
+	// back without going through the XML parser.
+	void writeBinary(std::ostream& output_stream);
+	static bool readBinary(std::istream& input_stream, LLXMLNodePtr& node);
+
 	// Write standard XML file header:
 	// <?xml version="1.0" encoding="utf-8" standalone="yes" ?>
 	static void writeHeaderToFile(LLFILE *out_file);
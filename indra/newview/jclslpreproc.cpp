@@ -41,6 +41,7 @@
 #include "llinventorymodel.h"
 #include "llviewercontrol.h"
 #include "llversionviewer.h"
+#include "llmd5.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -90,6 +91,7 @@ LLUUID JCLSLPreprocessor::findInventoryByName(std::string name)
 void cmdline_printchat(std::string message);
 
 std::map<std::string,LLUUID> JCLSLPreprocessor::cached_assetids;
+std::map<std::string,std::string> JCLSLPreprocessor::cached_hashes;
 
 #if !defined(LL_DARWIN) || defined(DARWINPREPROC)
 
@@ -126,7 +128,8 @@ std::string JCLSLPreprocessor::encode(std::string script)
 	
 	BOOL mono = mono_directive(script);
 	
-	otext = boost::regex_replace(otext, boost::regex("([/*])(?=[/*|])",boost::regex::perl), "$1|");
+	static const boost::regex escape_comments("([/*])(?=[/*|])",boost::regex::perl);
+	otext = boost::regex_replace(otext, escape_comments, "$1|");
 	
 	//otext = curl_escape(otext.c_str(), otext.size());
 	
@@ -179,7 +182,8 @@ std::string JCLSLPreprocessor::decode(std::string script)
 
 	
 
-	otext = boost::regex_replace(otext, boost::regex("([/*])\\|",boost::regex::perl), "$1");
+	static const boost::regex unescape_comments("([/*])\\|",boost::regex::perl);
+	otext = boost::regex_replace(otext, unescape_comments, "$1");
 
 	
 	//otext = curl_unescape(otext.c_str(),otext.length());
@@ -280,6 +284,34 @@ void shredder(std::string& text)
 	}while(cursor < int(text.length()));
 }
 
+inline bool is_identifier_char(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+//adds every identifier in text that has another character before it and, if
+//calls_only, a ( straight after it, or otherwise any other character after it.
+//does what searching for [^a-zA-Z0-9_]name\( or [^a-zA-Z0-9_]+name[^a-zA-Z0-9_]+
+//did for each name in turn, in one pass.
+void collect_identifiers(const std::string& text, bool calls_only, std::set<std::string>& found)
+{
+	int length = int(text.length());
+	int cursor = 0;
+	while(cursor < length)
+	{
+		if(!is_identifier_char(text[cursor]))
+		{
+			++cursor;
+			continue;
+		}
+		int start = cursor;
+		while(cursor < length && is_identifier_char(text[cursor]))++cursor;
+		if(start == 0 || cursor == length)continue;
+		if(calls_only && text[cursor] != '(')continue;
+		found.insert(text.substr(start, cursor - start));
+	}
+}
+
 std::string JCLSLPreprocessor::lslopt(std::string script)
 {
 	
@@ -293,14 +325,15 @@ std::string JCLSLPreprocessor::lslopt(std::string script)
 	try
 	{
 		boost::smatch result;
-		if (boost::regex_search(script, result, boost::regex("([\\S\\s]*?)(\\s*default\\s*\\{)([\\S\\s]*)")))
+		static const boost::regex findstates("([\\S\\s]*?)(\\s*default\\s*\\{)([\\S\\s]*)");
+		if (boost::regex_search(script, result, findstates))
 		{
 			
 			std::string top = result[1];
 			std::string bottom = result[2];
 			bottom += result[3];
 
-			boost::regex findfuncts("(integer|float|string|key|vector|rotation|list){0,1}[\\}\\s]+([a-zA-Z0-9_]+)\\(");
+			static const boost::regex findfuncts("(integer|float|string|key|vector|rotation|list){0,1}[\\}\\s]+([a-zA-Z0-9_]+)\\(");
 			//there is a minor problem with this regex, it will 
 			//grab extra wnhitespace/newlines in front of functions that do not return a value
 			//however this seems unimportant as it is only a couple chars and 
@@ -323,6 +356,10 @@ std::string JCLSLPreprocessor::lslopt(std::string script)
 				top.erase(pos,funcb.size());
 			}
 			
+			//everything called from bottom, kept up to date as functions are added to it
+			std::set<std::string> calls;
+			collect_identifiers(bottom, true, calls);
+
 			bool repass = false;
 			do
 			{
@@ -336,20 +373,13 @@ std::string JCLSLPreprocessor::lslopt(std::string script)
 					
 					if(kept_functions.find(funcname) == kept_functions.end())
 					{
-						
-						boost::smatch calls;
-												//funcname has to be [a-zA-Z0-9_]+, so we know its safe
-						boost::regex findcalls(std::string("[^a-zA-Z0-9_]")+funcname+std::string("\\("));
-						
-						std::string::const_iterator bstart = bottom.begin();
-						std::string::const_iterator bend = bottom.end();
-
-						if(boost::regex_search(bstart, bend, calls, findcalls, boost::match_default))
+						if(calls.find(funcname) != calls.end())
 						{
 							
 							std::string function = func_it->second;
 							kept_functions.insert(funcname);
 							bottom = function+"\n"+bottom;
+							collect_identifiers(function+"\n", true, calls);
 							repass = true;
 						}
 					}
@@ -357,7 +387,7 @@ std::string JCLSLPreprocessor::lslopt(std::string script)
 			}while(repass);
 
 			std::map<std::string, std::string> gvars;
-			boost::regex findvars("(integer|float|string|key|vector|rotation|list)\\s+([a-zA-Z0-9_]+)([^\\(\\);]*;)");
+			static const boost::regex findvars("(integer|float|string|key|vector|rotation|list)\\s+([a-zA-Z0-9_]+)([^\\(\\);]*;)");
 			boost::smatch TOPvmatch;
 			
 			while(boost::regex_search(std::string::const_iterator(top.begin()), std::string::const_iterator(top.end()), TOPvmatch, findvars, boost::match_default))
@@ -371,19 +401,19 @@ std::string JCLSLPreprocessor::lslopt(std::string script)
 				top.erase(start,fullref.length());
 			}
 			
+			//everything bottom refers to, kept up to date as globals are added to it
+			std::set<std::string> references;
+			collect_identifiers(bottom, false, references);
+
 			std::map<std::string, std::string>::iterator var_it;
 			for(var_it = gvars.begin(); var_it != gvars.end(); var_it++)
 			{
 				
 				std::string varname = var_it->first;
-				boost::regex findvcalls(std::string("[^a-zA-Z0-9_]+")+varname+std::string("[^a-zA-Z0-9_]+"));
-				boost::smatch vcalls;
-				std::string::const_iterator bstart = bottom.begin();
-				std::string::const_iterator bend = bottom.end();
-				
-				if(boost::regex_search(bstart, bend, vcalls, findvcalls, boost::match_default))
+				if(references.find(varname) != references.end())
 				{
 					bottom = var_it->second + "\n" + bottom;
+					collect_identifiers(var_it->second + "\n", false, references);
 				}
 			}
 			
@@ -410,7 +440,8 @@ std::string JCLSLPreprocessor::lslcomp(std::string script)
 	try
 	{
 		shredder(script);
-		script = boost::regex_replace(script, boost::regex("(\\s+)",boost::regex::perl), "\n");
+		static const boost::regex findspace("(\\s+)",boost::regex::perl);
+		script = boost::regex_replace(script, findspace, "\n");
 	}
 	catch (boost::regex_error& e)
 	{
@@ -514,6 +545,7 @@ public:
 		ContextT& usefulctx = const_cast<ContextT&>(ctx);
 		std::string id;
 		std::string filename = shortfile(relname);//boost::filesystem::path(std::string(relname)).filename();
+		mProc->included_files.push_back(std::make_pair(filename, std::string(absname)));
 		std::map<std::string,LLUUID>::iterator it = mProc->cached_assetids.find(filename);
 		if(it != mProc->cached_assetids.end())
 		{
@@ -566,16 +598,42 @@ std::string cachepath(std::string name)
 	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE,"lslpreproc",name);
 }
 
+std::string content_hash(const std::string& content)
+{
+	LLMD5 md5;
+	md5.update(content);
+	md5.finalize();
+	char digest[33];
+	md5.hex_digest(digest);
+	return std::string(digest);
+}
+
+bool read_file(const std::string& path, std::string& content)
+{
+	llifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	if(!file.is_open())return false;
+	content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	return true;
+}
+
 void cache_script(std::string name, std::string content)
 {
 	
 	content += "\n";/*hack!*/
 	//cmdline_printchat("writing "+name+" to cache");
 	std::string path = gDirUtilp->getExpandedFilename(LL_PATH_CACHE,"lslpreproc",name);
+	//leave it alone if it already holds this text
+	std::string hash = content_hash(content);
+	std::map<std::string,std::string>::iterator it = JCLSLPreprocessor::cached_hashes.find(name);
+	if(it != JCLSLPreprocessor::cached_hashes.end() && it->second == hash && LLFile::isfile(path))
+	{
+		return;
+	}
 	LLAPRFile infile(path.c_str(), LL_APR_WB);
 	apr_file_t *fp = infile.getFileHandle();
 	if(fp)infile.write(content.c_str(), content.length());
 	infile.close();
+	JCLSLPreprocessor::cached_hashes[name] = hash;
 }
 
 void JCLSLPreprocessor::JCProcCacheCallback(LLVFS *vfs, const LLUUID& iuuid, LLAssetType::EType type, void *userdata, S32 result, LLExtStat extstat)
@@ -698,7 +756,8 @@ std::string reformat_lazy_lists(std::string script)
 {
 	BOOL add_set = FALSE;
 	std::string nscript = script;
-	nscript = boost::regex_replace(nscript, boost::regex("([a-zA-Z0-9_]+)\\[([a-zA-Z0-9_()\"]+)]\\s*=\\s*([a-zA-Z0-9_()\"\\+\\-\\*/]+)([;)])",boost::regex::perl), "$1=lazy_list_set($1,$2,[$3])$4");
+	static const boost::regex findlazysets("([a-zA-Z0-9_]+)\\[([a-zA-Z0-9_()\"]+)]\\s*=\\s*([a-zA-Z0-9_()\"\\+\\-\\*/]+)([;)])",boost::regex::perl);
+	nscript = boost::regex_replace(nscript, findlazysets, "$1=lazy_list_set($1,$2,[$3])$4");
 	if(nscript != script)
 	{
 		add_set = TRUE;
@@ -735,7 +794,8 @@ inline std::string quicklabel()
 
 std::string minimalize_whitespace(std::string in)
 {
-	return boost::regex_replace(in, boost::regex("\\s*",boost::regex::perl), "\n");		
+	static const boost::regex findspace("\\s*",boost::regex::perl);
+	return boost::regex_replace(in, findspace, "\n");		
 }
 
 std::string reformat_switch_statements(std::string script)
@@ -744,7 +804,7 @@ std::string reformat_switch_statements(std::string script)
 	{
 		try
 		{
-			boost::regex findswitches("\\sswitch\\(");//nasty
+			static const boost::regex findswitches("\\sswitch\\(");//nasty
 
 			boost::smatch matches;
 
@@ -783,7 +843,7 @@ std::string reformat_switch_statements(std::string script)
 
 
 
-				boost::regex findcases("\\scase\\s");
+				static const boost::regex findcases("\\scase\\s");
 
 				boost::smatch statematches;
 
@@ -824,8 +884,10 @@ std::string reformat_switch_statements(std::string script)
 				std::string deflt = quicklabel();
 				bool isdflt = false;
 				std::string defstate;
-				defstate = boost::regex_replace(rstate, boost::regex("(\\s)(default\\s*?):",boost::regex::perl), "$1\\@"+deflt+";");
-				defstate = boost::regex_replace(defstate, boost::regex("(\\s)(default\\s*?)\\{",boost::regex::perl), "$1\\@"+deflt+"; \\{");
+				static const boost::regex finddefault("(\\s)(default\\s*?):",boost::regex::perl);
+				static const boost::regex finddefaultscope("(\\s)(default\\s*?)\\{",boost::regex::perl);
+				defstate = boost::regex_replace(rstate, finddefault, "$1\\@"+deflt+";");
+				defstate = boost::regex_replace(defstate, finddefaultscope, "$1\\@"+deflt+"; \\{");
 				if(defstate != rstate)
 				{
 					isdflt = true;
@@ -854,7 +916,8 @@ std::string reformat_switch_statements(std::string script)
 				rstate = jumptable + rstate + "\n";
 			
 				std::string brk = quicklabel();
-				defstate = boost::regex_replace(rstate, boost::regex("(\\s)break\\s*;",boost::regex::perl), "$1jump "+brk+";");
+				static const boost::regex findbreaks("(\\s)break\\s*;",boost::regex::perl);
+				defstate = boost::regex_replace(rstate, findbreaks, "$1jump "+brk+";");
 				if(defstate != rstate)
 				{
 					rstate = defstate;
@@ -926,6 +989,82 @@ std::string JCLSLPreprocessor::uncollide_string_literals(std::string script)
 }
 */
 
+//a file a script pulled in, and the hash of what it held at the time
+struct JCPreprocInclude
+{
+	std::string mName;
+	std::string mPath;
+	std::string mHash;
+};
+
+//the last preprocessing of each script, reused while the script, the
+//settings and everything it included stay the same
+struct JCPreprocResult
+{
+	std::string mInput;
+	std::string mSettings;
+	std::vector<JCPreprocInclude> mIncludes;
+	std::string mOutput;
+};
+static std::map<std::string, JCPreprocResult> sPreprocResults;
+
+//the last run of the output transforms for each script, so that edits wave
+//throws away (comments, inactive #if blocks) do not run them again
+struct JCTransformResult
+{
+	std::string mInput;
+	std::string mSettings;
+	std::string mOutput;
+};
+static std::map<std::string, JCTransformResult> sTransformResults;
+
+//wave expands these differently on every run, so output using them is never reused
+bool uses_build_time(const std::string& text)
+{
+	return text.find("__DATE__") != std::string::npos || text.find("__TIME__") != std::string::npos;
+}
+
+bool preproc_result_current(const JCPreprocResult& result, const std::string& input, const std::string& settings)
+{
+	if(result.mInput != input || result.mSettings != settings)
+	{
+		return false;
+	}
+	for(std::vector<JCPreprocInclude>::const_iterator it = result.mIncludes.begin(); it != result.mIncludes.end(); ++it)
+	{
+		//an inventory include saved since it was cached has to be fetched again
+		std::map<std::string,LLUUID>::iterator asset_it = JCLSLPreprocessor::cached_assetids.find(it->mName);
+		if(asset_it != JCLSLPreprocessor::cached_assetids.end())
+		{
+			LLViewerInventoryItem* item = gInventory.getItem(JCLSLPreprocessor::findInventoryByName(it->mName));
+			if(item && item->getAssetUUID() != asset_it->second)
+			{
+				return false;
+			}
+		}
+		std::string content;
+		if(!read_file(it->mPath, content) || content_hash(content) != it->mHash)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void JCLSLPreprocessor::finish_process(std::string output, const std::string& input)
+{
+	output = encode(input)+"\n\n"+output;
+
+
+	LLTextEditor* outfield = mCore->mPostEditor;//getChild<LLViewerTextEditor>("post_process");
+	if(outfield)
+	{
+		outfield->setText(LLStringExplicit(output));
+	}
+	mCore->mPostScript = output;
+	mCore->doSaveComplete((void*)mCore,mClose);
+}
+
 void JCLSLPreprocessor::start_process()
 {
 	if(waving)
@@ -970,6 +1109,26 @@ void JCLSLPreprocessor::start_process()
 	 mCore->mErrorList->addCommentText(std::string(settings));
 	 
 	 cmdline_printchat(settings);
+
+	LLTimer timer;
+	std::string settings_key = settings;
+	if(gSavedSettings.getBOOL("PhoenixEnableHDDInclude"))
+	{
+		settings_key += "\n" + gSavedSettings.getString("PhoenixHDDIncludeLocation");
+	}
+	if(!mDefinitionCaching)
+	{
+		std::map<std::string, JCPreprocResult>::iterator cached = sPreprocResults.find(name);
+		if(cached != sPreprocResults.end() && preproc_result_current(cached->second, rinput, settings_key))
+		{
+			mCore->mErrorList->addCommentText(llformat("Script and includes unchanged, preprocessed in %.1f ms", timer.getElapsedTimeF32() * 1000.f));
+			finish_process(cached->second.mOutput, rinput);
+			waving = FALSE;
+			return;
+		}
+	}
+	included_files.clear();
+
 	BOOL errored = FALSE;
 	std::string err;
 	try
@@ -1081,7 +1240,22 @@ void JCLSLPreprocessor::start_process()
 		mCore->mErrorList->addCommentText(err);
 	}
 
-	if(!errored)
+	std::string wave_output = output;
+	std::string transform_key = llformat("%d %d %d %d", (S32)lazy_lists, (S32)use_switch,
+		(S32)gSavedSettings.getBOOL("PhoenixLSLOptimizer"), (S32)gSavedSettings.getBOOL("PhoenixLSLTextCompress"));
+	BOOL transformed = FALSE;
+	if(!errored && !mDefinitionCaching)
+	{
+		std::map<std::string, JCTransformResult>::iterator cached = sTransformResults.find(name);
+		if(cached != sTransformResults.end() && cached->second.mInput == output && cached->second.mSettings == transform_key)
+		{
+			mCore->mErrorList->addCommentText("Preprocessed output unchanged, reusing transforms");
+			output = cached->second.mOutput;
+			transformed = TRUE;
+		}
+	}
+
+	if(!errored && !transformed)
 	{
 		FAILDEBUG
 		if(lazy_lists == TRUE)
@@ -1115,7 +1289,7 @@ void JCLSLPreprocessor::start_process()
 
 	if(!mDefinitionCaching)
 	{
-		if(!errored)
+		if(!errored && !transformed)
 		{
 			if(gSavedSettings.getBOOL("PhoenixLSLOptimizer"))
 			{
@@ -1131,7 +1305,7 @@ void JCLSLPreprocessor::start_process()
 				}
 			}
 		}
-		if(!errored)
+		if(!errored && !transformed)
 		{
 			if(gSavedSettings.getBOOL("PhoenixLSLTextCompress"))
 			{
@@ -1147,16 +1321,42 @@ void JCLSLPreprocessor::start_process()
 				}
 			}
 		}
-		output = encode(rinput)+"\n\n"+output;
-
-
-		LLTextEditor* outfield = mCore->mPostEditor;//getChild<LLViewerTextEditor>("post_process");
-		if(outfield)
+		if(!errored)
+		{
+			JCTransformResult& transform = sTransformResults[name];
+			transform.mInput = wave_output;
+			transform.mSettings = transform_key;
+			transform.mOutput = output;
+
+			JCPreprocResult& result = sPreprocResults[name];
+			result.mInput = rinput;
+			result.mSettings = settings_key;
+			result.mOutput = output;
+			result.mIncludes.clear();
+			bool reusable = !uses_build_time(rinput);
+			for(std::vector<std::pair<std::string,std::string> >::iterator it = included_files.begin(); it != included_files.end(); ++it)
+			{
+				JCPreprocInclude include;
+				include.mName = it->first;
+				include.mPath = it->second;
+				std::string content;
+				read_file(include.mPath, content);
+				include.mHash = content_hash(content);
+				result.mIncludes.push_back(include);
+				reusable = reusable && !uses_build_time(content);
+			}
+			if(!reusable)
+			{
+				sPreprocResults.erase(name);
+			}
+		}
+		else
 		{
-			outfield->setText(LLStringExplicit(output));
+			sPreprocResults.erase(name);
 		}
-		mCore->mPostScript = output;
-		mCore->doSaveComplete((void*)mCore,mClose);
+		mCore->mErrorList->addCommentText(llformat("Preprocessed in %.1f ms", timer.getElapsedTimeF32() * 1000.f));
+
+		finish_process(output, rinput);
 	}
 	waving = FALSE;
 }
@@ -55,6 +55,8 @@ public:
 									void *userdata, S32 result, LLExtStat extstat);
 	void preprocess_script(BOOL close = FALSE, BOOL defcache = FALSE);
 	void start_process();
+	// Hands the preprocessed script to the editor and saves it
+	void finish_process(std::string output, const std::string& input);
 	void display_error(std::string err);
 
 	std::string uncollide_string_literals(std::string script);
@@ -73,7 +75,12 @@ public:
 
 	static std::map<std::string,std::string> decollided_literals;
 
+	//content hashes of the scripts written to the preprocessor cache this session, so unchanged ones are not written again
+	static std::map<std::string,std::string> cached_hashes;
+
 	std::set<std::string> caching_files;
+	//short and full names of the files wave opened in the current pass
+	std::vector<std::pair<std::string,std::string> > included_files;
 	std::set<std::string> defcached_files;
 	bool mDefinitionCaching;
 
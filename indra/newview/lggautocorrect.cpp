@@ -23,9 +23,290 @@
 #include "llviewercontrol.h"
 #include "llnotifications.h"
 
+#include <boost/unordered_map.hpp>
+
+// The enabled lists flattened into the order replaceWord() applies them:
+// priority 10 down to 0, then by list name.  Consecutive whole word lists
+// are merged into one hash table, where the first list to have a word keeps
+// it, and consecutive partial lists into one Aho-Corasick automaton, so a
+// typed word is scanned once per run of lists instead of once per entry.
+class LGGAutoCorrectMatcher
+{
+public:
+	LGGAutoCorrectMatcher(const LLSD& lists);
+
+	// Applies the partial lists to word in place.  Returns TRUE if a whole
+	// word list has a replacement for it, which is then returned along
+	// with the list it came from.
+	BOOL match(std::string& word, std::string& replacement, std::string& list, BOOL& announce) const;
+
+private:
+	struct WholeWord
+	{
+		std::string mReplacement;
+		std::string mList;
+		BOOL mAnnounce;
+	};
+	typedef boost::unordered_map<std::string, WholeWord> whole_word_map_t;
+
+	struct Partial
+	{
+		std::string mWrong;
+		std::string mRight;
+		// Next pattern with the same text, from a later list
+		S32 mNextSame;
+	};
+
+	struct Node
+	{
+		S32 mFail;
+		// First pattern ending here, or -1
+		S32 mOutput;
+		// Nearest node down the fail chain with an output, or -1
+		S32 mDictLink;
+	};
+
+	struct Stage
+	{
+		bool mWholeWords;
+		whole_word_map_t mWords;
+
+		std::vector<Partial> mPatterns;
+		std::vector<Node> mNodes;
+		// Trie edges, keyed by (node << 8) | byte
+		boost::unordered_map<U32, S32> mEdges;
+		// Only used while building
+		std::vector<S32> mParents;
+		std::vector<U8> mBytes;
+		std::vector<S32> mDepths;
+
+		void addPattern(const std::string& wrong, const std::string& right);
+		void linkPatterns();
+		S32 next(S32 node, U8 c) const;
+		// Returns the lowest numbered pattern above after that occurs in
+		// word, or -1.
+		S32 firstMatchAfter(const std::string& word, S32 after) const;
+	};
+
+	Stage& getStage(bool whole_words);
+
+	std::vector<Stage> mStages;
+};
+
+LGGAutoCorrectMatcher::LGGAutoCorrectMatcher(const LLSD& lists)
+{
+	for (S32 priority = 10; priority >= 0; --priority)
+	{
+		for (LLSD::map_const_iterator list_it = lists.beginMap(); list_it != lists.endMap(); ++list_it)
+		{
+			const LLSD& list = list_it->second;
+			if (list["priority"].asInteger() != priority || !list["enabled"].asBoolean())
+			{
+				continue;
+			}
+
+			const LLSD& data = list["data"];
+			if (list["wordStyle"].asBoolean())
+			{
+				Stage& stage = getStage(true);
+				BOOL announce = list["announce"].asBoolean();
+				for (LLSD::map_const_iterator it = data.beginMap(); it != data.endMap(); ++it)
+				{
+					if (stage.mWords.find(it->first) == stage.mWords.end())
+					{
+						WholeWord& word = stage.mWords[it->first];
+						word.mReplacement = it->second.asString();
+						word.mList = list_it->first;
+						word.mAnnounce = announce;
+					}
+				}
+			}
+			else
+			{
+				Stage& stage = getStage(false);
+				for (LLSD::map_const_iterator it = data.beginMap(); it != data.endMap(); ++it)
+				{
+					stage.addPattern(it->first, it->second.asString());
+				}
+			}
+		}
+	}
+
+	for (std::vector<Stage>::iterator it = mStages.begin(); it != mStages.end(); ++it)
+	{
+		if (!it->mWholeWords)
+		{
+			it->linkPatterns();
+		}
+	}
+}
+
+LGGAutoCorrectMatcher::Stage& LGGAutoCorrectMatcher::getStage(bool whole_words)
+{
+	if (mStages.empty() || mStages.back().mWholeWords != whole_words)
+	{
+		mStages.push_back(Stage());
+		Stage& stage = mStages.back();
+		stage.mWholeWords = whole_words;
+		if (!whole_words)
+		{
+			Node root = { 0, -1, -1 };
+			stage.mNodes.push_back(root);
+			stage.mParents.push_back(-1);
+			stage.mBytes.push_back(0);
+			stage.mDepths.push_back(0);
+		}
+	}
+	return mStages.back();
+}
+
+void LGGAutoCorrectMatcher::Stage::addPattern(const std::string& wrong, const std::string& right)
+{
+	// An empty entry would match at the start of every word
+	if (wrong.empty())
+	{
+		return;
+	}
+
+	S32 node = 0;
+	for (std::string::const_iterator it = wrong.begin(); it != wrong.end(); ++it)
+	{
+		U32 key = ((U32)node << 8) | (U8)*it;
+		boost::unordered_map<U32, S32>::const_iterator edge = mEdges.find(key);
+		if (edge != mEdges.end())
+		{
+			node = edge->second;
+			continue;
+		}
+		Node child = { 0, -1, -1 };
+		mNodes.push_back(child);
+		mParents.push_back(node);
+		mBytes.push_back((U8)*it);
+		mDepths.push_back(mDepths[node] + 1);
+		node = (S32)mNodes.size() - 1;
+		mEdges[key] = node;
+	}
+
+	Partial pattern;
+	pattern.mWrong = wrong;
+	pattern.mRight = right;
+	pattern.mNextSame = -1;
+	S32 index = (S32)mPatterns.size();
+	mPatterns.push_back(pattern);
+
+	S32* last = &mNodes[node].mOutput;
+	while (*last >= 0)
+	{
+		last = &mPatterns[*last].mNextSame;
+	}
+	*last = index;
+}
+
+void LGGAutoCorrectMatcher::Stage::linkPatterns()
+{
+	// Fail links point at shallower nodes, so resolve them by depth
+	std::vector<std::vector<S32> > by_depth;
+	for (S32 node = 1; node < (S32)mNodes.size(); ++node)
+	{
+		if ((S32)by_depth.size() <= mDepths[node])
+		{
+			by_depth.resize(mDepths[node] + 1);
+		}
+		by_depth[mDepths[node]].push_back(node);
+	}
+
+	for (S32 depth = 1; depth < (S32)by_depth.size(); ++depth)
+	{
+		for (std::vector<S32>::iterator it = by_depth[depth].begin(); it != by_depth[depth].end(); ++it)
+		{
+			Node& node = mNodes[*it];
+			S32 parent = mParents[*it];
+			node.mFail = (parent == 0) ? 0 : next(mNodes[parent].mFail, mBytes[*it]);
+			const Node& fail = mNodes[node.mFail];
+			node.mDictLink = (fail.mOutput >= 0) ? node.mFail : fail.mDictLink;
+		}
+	}
+
+	mParents.clear();
+	mBytes.clear();
+	mDepths.clear();
+}
+
+S32 LGGAutoCorrectMatcher::Stage::next(S32 node, U8 c) const
+{
+	while (true)
+	{
+		boost::unordered_map<U32, S32>::const_iterator edge = mEdges.find(((U32)node << 8) | c);
+		if (edge != mEdges.end())
+		{
+			return edge->second;
+		}
+		if (node == 0)
+		{
+			return 0;
+		}
+		node = mNodes[node].mFail;
+	}
+}
+
+S32 LGGAutoCorrectMatcher::Stage::firstMatchAfter(const std::string& word, S32 after) const
+{
+	S32 best = -1;
+	S32 node = 0;
+	for (std::string::const_iterator it = word.begin(); it != word.end(); ++it)
+	{
+		node = next(node, (U8)*it);
+		S32 out = (mNodes[node].mOutput >= 0) ? node : mNodes[node].mDictLink;
+		for ( ; out >= 0; out = mNodes[out].mDictLink)
+		{
+			for (S32 index = mNodes[out].mOutput; index >= 0; index = mPatterns[index].mNextSame)
+			{
+				if (index > after && (best < 0 || index < best))
+				{
+					best = index;
+				}
+			}
+		}
+	}
+	return best;
+}
+
+BOOL LGGAutoCorrectMatcher::match(std::string& word, std::string& replacement, std::string& list, BOOL& announce) const
+{
+	for (std::vector<Stage>::const_iterator it = mStages.begin(); it != mStages.end(); ++it)
+	{
+		const Stage& stage = *it;
+		if (stage.mWholeWords)
+		{
+			whole_word_map_t::const_iterator found = stage.mWords.find(word);
+			if (found != stage.mWords.end())
+			{
+				replacement = found->second.mReplacement;
+				list = found->second.mList;
+				announce = found->second.mAnnounce;
+				return TRUE;
+			}
+		}
+		else
+		{
+			// Entries are applied in order, each replacing its first
+			// occurrence in the word as it stands, so after a replacement
+			// only the entries that follow need looking for.
+			S32 index = -1;
+			while ((index = stage.firstMatchAfter(word, index)) >= 0)
+			{
+				const Partial& pattern = stage.mPatterns[index];
+				word.replace(word.find(pattern.mWrong), pattern.mWrong.length(), pattern.mRight);
+			}
+		}
+	}
+	return FALSE;
+}
+
 LGGAutoCorrect* LGGAutoCorrect::sInstance;
 
 LGGAutoCorrect::LGGAutoCorrect()
+:	mMatcher(NULL)
 {
 	sInstance = this;
 	sInstance->loadFromDisk();
@@ -33,9 +314,16 @@ LGGAutoCorrect::LGGAutoCorrect()
 
 LGGAutoCorrect::~LGGAutoCorrect()
 {
+	delete mMatcher;
 	sInstance = NULL;
 }
 
+void LGGAutoCorrect::listsChanged()
+{
+	delete mMatcher;
+	mMatcher = NULL;
+}
+
 LGGAutoCorrect* LGGAutoCorrect::getInstance()
 {
 	if(sInstance)return sInstance;
@@ -97,6 +385,7 @@ BOOL LGGAutoCorrect::addCorrectionList(LLSD newList)
 		newPart["priority"]=newList["priority"].asInteger();
 		llinfos << "adding new list with settings priority "<<newPart["priority"].asInteger() <<llendl;
 		mAutoCorrects[name]=newPart;
+		listsChanged();
 
 		return TRUE;
 
@@ -108,6 +397,7 @@ BOOL LGGAutoCorrect::removeCorrectionList(std::string listName)
 	if(mAutoCorrects.has(listName))
 	{
 		mAutoCorrects.erase(listName);
+		listsChanged();
 		return TRUE;
 	}
 	return FALSE;
@@ -117,6 +407,7 @@ BOOL LGGAutoCorrect::setListEnabled(std::string listName, BOOL enabled)
 	if(mAutoCorrects.has(listName))
 	{
 		mAutoCorrects[listName]["enabled"]=enabled;
+		listsChanged();
 		return TRUE;
 	}
 	
@@ -129,6 +420,7 @@ BOOL LGGAutoCorrect::setListAnnounceeState(std::string listName, BOOL announce)
 	if(mAutoCorrects.has(listName))
 	{
 		mAutoCorrects[listName]["announce"]=announce;
+		listsChanged();
 		return TRUE;
 	}
 	return FALSE;
@@ -138,6 +430,7 @@ BOOL LGGAutoCorrect::setListStyle(std::string listName, BOOL announce)
 	if(mAutoCorrects.has(listName))
 	{
 		mAutoCorrects[listName]["wordStyle"]=announce;
+		listsChanged();
 		return TRUE;
 	}
 	return FALSE;
@@ -147,6 +440,7 @@ BOOL LGGAutoCorrect::setListPriority(std::string listName, int priority)
 	if(mAutoCorrects.has(listName))
 	{
 		mAutoCorrects[listName]["priority"]=priority;
+		listsChanged();
 		return TRUE;
 	}
 	return FALSE;
@@ -191,11 +485,13 @@ void LGGAutoCorrect::loadFromDisk()
 			LLSDSerialize::fromXML(mAutoCorrects, file);
 		}
 		file.close();
+		listsChanged();
 	}	
 }
 void LGGAutoCorrect::saveToDisk(LLSD newSettings)
 {
 	mAutoCorrects=newSettings;
+	listsChanged();
 	std::string filename=getFileName();
 	llofstream file;
 	file.open(filename.c_str());
@@ -236,57 +532,29 @@ std::string LGGAutoCorrect::replaceWord(std::string currentWord)
 	static LLCachedControl<bool> doAnything(gSavedSettings, "PhoenixEnableAutoCorrect");
 	if(!doAnything)return currentWord;
 
-	//loop through priorities
-	for(int currentPriority = 10;currentPriority>=0;currentPriority--)
+	if(!mMatcher)
 	{
-		LLSD::map_const_iterator loc_it = mAutoCorrects.beginMap();
-		LLSD::map_const_iterator loc_end = mAutoCorrects.endMap();
-		for ( ; loc_it != loc_end; ++loc_it)
-		{
-			const std::string& location = (*loc_it).first;
-			//llinfos << "location is "<<location.c_str() << " word is "<<currentWord.c_str()<<llendl;
-			const LLSD& loc_map = (*loc_it).second;
-			if(loc_map["priority"].asInteger()==currentPriority)
-			{
-				if(!loc_map["wordStyle"].asBoolean())
-				{
-					//this means look for partial matches instead of a full word
-					if(loc_map["enabled"].asBoolean())
-					{
-						LLSD::map_const_iterator inner_it = loc_map["data"].beginMap();
-						LLSD::map_const_iterator inner_end = loc_map["data"].endMap();
-						for ( ; inner_it != inner_end; ++inner_it)
-						{
-							const std::string& wrong = (*inner_it).first;
-							const std::string& right = (*inner_it).second;
-							int location = currentWord.find(wrong);
-							if(location!=std::string::npos)
-							{
-								currentWord=currentWord.replace(location,wrong.length(),right);
-							}
-						}
-					}
+		mMatcher = new LGGAutoCorrectMatcher(mAutoCorrects);
+	}
 
-				}else
-				if((loc_map["data"].has(currentWord))&&(loc_map["enabled"].asBoolean()))
-				{
-					std::string replacement = loc_map["data"][currentWord];
-					if(loc_map["announce"].asBoolean())
-					{
-						LLSD args; 
-						//"[Before]" has been auto replaced by "[Replacement]"
-						//	based on your [ListName] list.
-						args["BEFORE"] = currentWord;
-						args["LISTNAME"]=location;
-						args["REPLACEMENT"]=replacement;
-						LLNotifications::getInstance()->add("PhoenixAutoReplace",args);
-					}
-					gSavedSettings.setS32("PhoenixAutoCorrectCount",gSavedSettings.getS32("PhoenixAutoCorrectCount")+1);
-					llinfos << "found a word in list " << location.c_str() << " and it will replace  " << currentWord.c_str() << " => " << replacement.c_str() << llendl;
-					return replacement;
-				}
-			}
+	std::string replacement;
+	std::string location;
+	BOOL announce;
+	if(mMatcher->match(currentWord, replacement, location, announce))
+	{
+		if(announce)
+		{
+			LLSD args; 
+			//"[Before]" has been auto replaced by "[Replacement]"
+			//	based on your [ListName] list.
+			args["BEFORE"] = currentWord;
+			args["LISTNAME"]=location;
+			args["REPLACEMENT"]=replacement;
+			LLNotifications::getInstance()->add("PhoenixAutoReplace",args);
 		}
+		gSavedSettings.setS32("PhoenixAutoCorrectCount",gSavedSettings.getS32("PhoenixAutoCorrectCount")+1);
+		llinfos << "found a word in list " << location.c_str() << " and it will replace  " << currentWord.c_str() << " => " << replacement.c_str() << llendl;
+		return replacement;
 	}
 	return currentWord;
 }
@@ -338,6 +606,7 @@ BOOL LGGAutoCorrect::addEntryToList(std::string wrong, std::string right, std::s
 	if(mAutoCorrects.has(listName))
 	{
 		mAutoCorrects[listName]["data"][wrong]=right;
+		listsChanged();
 		return TRUE;
 	}
 	else if(listName == "Custom")
@@ -348,6 +617,7 @@ BOOL LGGAutoCorrect::addEntryToList(std::string wrong, std::string right, std::s
 		mAutoCorrects[listName]["enabled"] = 1;
 		mAutoCorrects[listName]["priority"] = 10;
 		mAutoCorrects[listName]["wordStyle"] = 1;
+		listsChanged();
 		return TRUE;
 	}
 		
@@ -360,6 +630,7 @@ BOOL LGGAutoCorrect::removeEntryFromList(std::string wrong, std::string listName
 		if(mAutoCorrects[listName]["data"].has(wrong))
 		{
 			mAutoCorrects[listName]["data"].erase(wrong);
+			listsChanged();
 			return TRUE;
 		}
 	}
@@ -399,3 +670,141 @@ LLSD LGGAutoCorrect::getExampleLLSD()
 	return toReturn;
 }
 
+
+// replaceWord() as it was before the lists were compiled, without the
+// notifications, for debugBenchmarkReplace() to compare against.
+static std::string replace_word_uncompiled(const LLSD& lists, std::string currentWord)
+{
+	for(int currentPriority = 10;currentPriority>=0;currentPriority--)
+	{
+		LLSD::map_const_iterator loc_it = lists.beginMap();
+		LLSD::map_const_iterator loc_end = lists.endMap();
+		for ( ; loc_it != loc_end; ++loc_it)
+		{
+			const LLSD& loc_map = (*loc_it).second;
+			if(loc_map["priority"].asInteger()==currentPriority)
+			{
+				if(!loc_map["wordStyle"].asBoolean())
+				{
+					if(loc_map["enabled"].asBoolean())
+					{
+						LLSD::map_const_iterator inner_it = loc_map["data"].beginMap();
+						LLSD::map_const_iterator inner_end = loc_map["data"].endMap();
+						for ( ; inner_it != inner_end; ++inner_it)
+						{
+							const std::string& wrong = (*inner_it).first;
+							const std::string& right = (*inner_it).second;
+							std::string::size_type location = currentWord.find(wrong);
+							if(!wrong.empty() && location!=std::string::npos)
+							{
+								currentWord=currentWord.replace(location,wrong.length(),right);
+							}
+						}
+					}
+				}else
+				if((loc_map["data"].has(currentWord))&&(loc_map["enabled"].asBoolean()))
+				{
+					return loc_map["data"][currentWord].asString();
+				}
+			}
+		}
+	}
+	return currentWord;
+}
+
+static void benchmark_replace(const std::string& label, const LLSD& lists, const std::vector<std::string>& corpus)
+{
+	LLTimer timer;
+	std::vector<std::string> expected;
+	expected.reserve(corpus.size());
+	for (std::vector<std::string>::const_iterator it = corpus.begin(); it != corpus.end(); ++it)
+	{
+		expected.push_back(replace_word_uncompiled(lists, *it));
+	}
+	F32 uncompiled_ms = timer.getElapsedTimeF32() * 1000.f;
+
+	timer.reset();
+	LGGAutoCorrectMatcher matcher(lists);
+	F32 compile_ms = timer.getElapsedTimeF32() * 1000.f;
+
+	timer.reset();
+	S32 replaced = 0;
+	S32 mismatches = 0;
+	std::string replacement, list;
+	BOOL announce;
+	for (S32 i = 0; i < (S32)corpus.size(); ++i)
+	{
+		std::string word = corpus[i];
+		if (matcher.match(word, replacement, list, announce))
+		{
+			word = replacement;
+		}
+		if (word != corpus[i])
+		{
+			++replaced;
+		}
+		if (word != expected[i])
+		{
+			++mismatches;
+		}
+	}
+	F32 compiled_ms = timer.getElapsedTimeF32() * 1000.f;
+
+	llinfos << label << ", " << corpus.size() << " words: uncompiled " << uncompiled_ms
+			<< "ms, compile " << compile_ms << "ms, compiled " << compiled_ms << "ms, "
+			<< replaced << " replaced, " << mismatches << " mismatches" << llendl;
+}
+
+//static
+void LGGAutoCorrect::debugBenchmarkReplace(void*)
+{
+	const S32 CORPUS_WORDS = 10000;
+	static const char* common_words[] =
+	{
+		"the", "and", "you", "that", "was", "for", "are", "with", "his", "they",
+		"this", "have", "from", "one", "had", "word", "but", "not", "what", "all",
+		"were", "when", "your", "can", "said", "there", "use", "each", "which", "she",
+		"how", "their", "will", "other", "about", "out", "many", "then", "them", "these",
+		"some", "would", "make", "like", "him", "into", "time", "has", "look", "two",
+		"more", "write", "see", "number", "way", "could", "people", "than", "first", "water"
+	};
+	const S32 common_count = sizeof(common_words) / sizeof(common_words[0]);
+
+	LLSD lists = getInstance()->getAutoCorrects();
+
+	// Mostly common words, with one in ten taken from the lists so that
+	// replacements happen at a typing-like rate
+	std::vector<std::string> wrongs;
+	for (LLSD::map_const_iterator list_it = lists.beginMap(); list_it != lists.endMap(); ++list_it)
+	{
+		const LLSD& data = list_it->second["data"];
+		for (LLSD::map_const_iterator it = data.beginMap(); it != data.endMap(); ++it)
+		{
+			wrongs.push_back(it->first);
+		}
+	}
+	std::vector<std::string> corpus;
+	corpus.reserve(CORPUS_WORDS);
+	for (S32 i = 0; i < CORPUS_WORDS; ++i)
+	{
+		if (!wrongs.empty() && i % 10 == 0)
+		{
+			corpus.push_back(wrongs[(i * 7919) % wrongs.size()]);
+		}
+		else
+		{
+			corpus.push_back(common_words[(i * 31) % common_count]);
+		}
+	}
+
+	benchmark_replace("Auto correct lists as configured", lists, corpus);
+
+	// The same lists matching partial words, which the uncompiled lists
+	// scan entry by entry
+	LLSD partial_lists = lists;
+	for (LLSD::map_iterator it = partial_lists.beginMap(); it != partial_lists.endMap(); ++it)
+	{
+		it->second["wordStyle"] = FALSE;
+	}
+	benchmark_replace("Auto correct lists as partial matches", partial_lists, corpus);
+}
@@ -18,6 +18,7 @@
 
 #ifndef LGG_AUTO_CORRECT
 #define LGG_AUTO_CORRECT
+class LGGAutoCorrectMatcher;
 class LGGAutoCorrect
 {
 	LGGAutoCorrect();
@@ -44,13 +45,21 @@ public:
 
 	void loadFromDisk();
 
+	// Times replaceWord() over a 10k word corpus against the loaded lists,
+	// with and without the compiled matcher, and logs the results.
+	static void debugBenchmarkReplace(void*);
+
 private:
+	// Drops the compiled matcher so it is rebuilt on the next word.
+	void listsChanged();
+
 	void saveToDisk(LLSD newSettings);
 	LLSD getExampleLLSD();	
 	std::string getFileName();
 	std::string getDefaultFileName();
 
 	LLSD mAutoCorrects;
+	LGGAutoCorrectMatcher* mMatcher;
 
 };
 
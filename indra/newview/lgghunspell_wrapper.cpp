@@ -24,6 +24,7 @@
 #include "llfile.h"
 #include "llhttpclient.h"
 #include "lggdicdownload.h"
+#include "llthread.h"
 
 lggHunSpell_Wrapper *glggHunSpell = 0;
 Hunspell* lggHunSpell_Wrapper::myHunspell = 0;
@@ -468,12 +469,140 @@ static char * languageCodesraw[]={
 };
 //#define LANGUAGE_CODES_RAW_SIZE ((__LINE__ - 1 - LANGUAGE_CODES_RAW_START_LINE) * 2)
 #define LANGUAGE_CODES_RAW_SIZE 368
+
+// Most words kept in the spelling results cache
+const S32 SPELL_RESULTS_MAX = 20000;
+
+// Checks the words editors are waiting on against the dictionaries, so that
+// long texts do not stall drawing.
+class lggSpellCheckThread : public LLThread
+{
+public:
+	lggSpellCheckThread(LLMutex* hunspell_mutex);
+	~lggSpellCheckThread();
+
+	struct Word
+	{
+		std::string mWord;
+		BOOL mSpelledRight;
+		// The dictionaries the word was queued for
+		U32 mDictionarySerial;
+	};
+
+	// Called from the main thread.
+	void queueWord(const std::string& word, U32 dictionary_serial);
+	bool hasResults() { return mHasResults != 0; }
+	void getResults(std::vector<Word>& results);
+
+protected:
+	/*virtual*/ void run();
+	/*virtual*/ bool runCondition();
+
+private:
+	LLMutex* mHunspellMutex;
+
+	// Protected by mRunCondition
+	std::deque<Word> mWords;
+	std::vector<Word> mResults;
+	LLAtomic32<S32> mHasResults;
+};
+
+lggSpellCheckThread::lggSpellCheckThread(LLMutex* hunspell_mutex)
+	: LLThread("spell checker"),
+	  mHunspellMutex(hunspell_mutex),
+	  mHasResults(0)
+{
+}
+
+lggSpellCheckThread::~lggSpellCheckThread()
+{
+	shutdown();
+}
+
+void lggSpellCheckThread::queueWord(const std::string& word, U32 dictionary_serial)
+{
+	Word queued;
+	queued.mWord = word;
+	queued.mSpelledRight = TRUE;
+	queued.mDictionarySerial = dictionary_serial;
+	lockData();
+	mWords.push_back(queued);
+	unlockData();
+	wake();
+}
+
+void lggSpellCheckThread::getResults(std::vector<Word>& results)
+{
+	lockData();
+	results.swap(mResults);
+	mHasResults = 0;
+	unlockData();
+}
+
+//virtual
+bool lggSpellCheckThread::runCondition()
+{
+	// mRunCondition is locked
+	return !mWords.empty();
+}
+
+//virtual
+void lggSpellCheckThread::run()
+{
+	while (1)
+	{
+		// Sleeps until there are words in mWords or we are quitting.
+		checkPause();
+
+		if (isQuitting())
+		{
+			break;
+		}
+
+		while (!isQuitting())
+		{
+			lockData();
+			if (mWords.empty())
+			{
+				unlockData();
+				break;
+			}
+			Word word = mWords.front();
+			mWords.pop_front();
+			unlockData();
+
+			mHunspellMutex->lock();
+			Hunspell* hunspell = lggHunSpell_Wrapper::myHunspell;
+			word.mSpelledRight = !hunspell || hunspell->spell(word.mWord.c_str());
+			mHunspellMutex->unlock();
+
+			lockData();
+			mResults.push_back(word);
+			mHasResults = 1;
+			unlockData();
+		}
+	}
+}
+
 lggHunSpell_Wrapper::lggHunSpell_Wrapper()
+:	mSpellGeneration(0),
+	mDictionarySerial(0)
 {
 	highlightInRed=false;
 	//languageCodes(begin(languageCodesraw), end(languageCodesraw));    
+	mHunspellMutex = new LLMutex();
+	mThread = new lggSpellCheckThread(mHunspellMutex);
+	mThread->start();
+}
+lggHunSpell_Wrapper::~lggHunSpell_Wrapper()
+{
+	delete mThread;
+	mThread = NULL;
+	delete myHunspell;
+	myHunspell = NULL;
+	delete mHunspellMutex;
+	mHunspellMutex = NULL;
 }
-lggHunSpell_Wrapper::~lggHunSpell_Wrapper(){}
 std::string lggHunSpell_Wrapper::getCorrectPath(std::string file)
 {
 	//finds out if it is in user dir, if not, takes it from app dir
@@ -493,6 +622,7 @@ void lggHunSpell_Wrapper::setNewDictionary(std::string newDict)
 	//expecting a full name comming in
 	newDict = fullName2DictName(newDict);
 
+	LLMutexLock lock(mHunspellMutex);
 	if(myHunspell)delete myHunspell;
 
 	std::string dicaffpath=getCorrectPath(newDict+".aff");
@@ -501,6 +631,7 @@ void lggHunSpell_Wrapper::setNewDictionary(std::string newDict)
 	llinfos << "Setting new base dictionary -> " << dicaffpath.c_str() << llendl;
 
 	myHunspell = new Hunspell(dicaffpath.c_str(),dicdicpath.c_str());
+	clearResults();
 	llinfos << "Adding custom dictionary " << llendl;
 	createCustomDic();
 	addDictionary("phoenix_custom");
@@ -525,8 +656,12 @@ void lggHunSpell_Wrapper::createCustomDic()
 }
 void lggHunSpell_Wrapper::addWordToCustomDictionary(std::string wordToAdd)
 {
-	if(!myHunspell)return;
-	myHunspell->add(wordToAdd.c_str());
+	{
+		LLMutexLock lock(mHunspellMutex);
+		if(!myHunspell)return;
+		myHunspell->add(wordToAdd.c_str());
+	}
+	clearResults();
 	std::string filename(gDirUtilp->getExpandedFilename(LL_PATH_USER_SETTINGS, "dictionaries", "phoenix_custom.dic"));
 	std::vector<std::string> lines;
 	if(gDirUtilp->fileExists(filename))
@@ -554,13 +689,96 @@ void lggHunSpell_Wrapper::addWordToCustomDictionary(std::string wordToAdd)
 }
 BOOL lggHunSpell_Wrapper::isSpelledRight(std::string wordToCheck)
 {
-	if(!myHunspell)return TRUE;
 	if(wordToCheck.length()<3)return TRUE;
-	return myHunspell->spell(wordToCheck.c_str());
+	result_cache_t::iterator found = mResults.find(wordToCheck);
+	if(found != mResults.end())
+	{
+		mResultUse.splice(mResultUse.begin(), mResultUse, found->second.mUse);
+		return found->second.mSpelledRight;
+	}
+
+	BOOL spelled_right;
+	{
+		LLMutexLock lock(mHunspellMutex);
+		if(!myHunspell)return TRUE;
+		spelled_right = myHunspell->spell(wordToCheck.c_str());
+	}
+	cacheResult(wordToCheck, spelled_right);
+	return spelled_right;
+}
+lggHunSpell_Wrapper::ESpelling lggHunSpell_Wrapper::checkSpelling(const std::string& wordToCheck)
+{
+	if(wordToCheck.length()<3)return SPELLED_RIGHT;
+	applyResults();
+
+	result_cache_t::iterator found = mResults.find(wordToCheck);
+	if(found != mResults.end())
+	{
+		// Move it to the front of the use list
+		mResultUse.splice(mResultUse.begin(), mResultUse, found->second.mUse);
+		return found->second.mSpelledRight ? SPELLED_RIGHT : SPELLED_WRONG;
+	}
+
+	if(mQueued.insert(wordToCheck).second)
+	{
+		mThread->queueWord(wordToCheck, mDictionarySerial);
+	}
+	return SPELLING_PENDING;
+}
+U32 lggHunSpell_Wrapper::getSpellGeneration()
+{
+	applyResults();
+	return mSpellGeneration;
+}
+void lggHunSpell_Wrapper::cacheResult(const std::string& word, BOOL spelled_right)
+{
+	result_cache_t::iterator found = mResults.find(word);
+	if(found != mResults.end())
+	{
+		found->second.mSpelledRight = spelled_right;
+		return;
+	}
+
+	if((S32)mResults.size() >= SPELL_RESULTS_MAX)
+	{
+		mResults.erase(mResultUse.back());
+		mResultUse.pop_back();
+	}
+	mResultUse.push_front(word);
+	CachedResult& result = mResults[word];
+	result.mSpelledRight = spelled_right;
+	result.mUse = mResultUse.begin();
+}
+void lggHunSpell_Wrapper::applyResults()
+{
+	if(!mThread->hasResults())return;
+
+	std::vector<lggSpellCheckThread::Word> results;
+	mThread->getResults(results);
+	for(std::vector<lggSpellCheckThread::Word>::iterator it = results.begin(); it != results.end(); ++it)
+	{
+		// Words checked against dictionaries that have since changed are
+		// dropped; editors still waiting on them queue them again.
+		if(it->mDictionarySerial == mDictionarySerial)
+		{
+			mQueued.erase(it->mWord);
+			cacheResult(it->mWord, it->mSpelledRight);
+		}
+	}
+	++mSpellGeneration;
+}
+void lggHunSpell_Wrapper::clearResults()
+{
+	mResults.clear();
+	mResultUse.clear();
+	mQueued.clear();
+	++mDictionarySerial;
+	++mSpellGeneration;
 }
 std::vector<std::string> lggHunSpell_Wrapper::getSuggestionList(std::string badWord)
 {
 	std::vector<std::string> toReturn;
+	LLMutexLock lock(mHunspellMutex);
 	if(!myHunspell)return toReturn;
 	char ** suggestionList;	
 	int numberOfSuggestions = myHunspell->suggest(&suggestionList, badWord.c_str());	
@@ -602,6 +820,12 @@ void lggHunSpell_Wrapper::initSettings()
 	glggHunSpell = new lggHunSpell_Wrapper();
 	glggHunSpell->processSettings();
 }
+void lggHunSpell_Wrapper::cleanupClass()
+{
+	// Stops the spell check thread
+	delete glggHunSpell;
+	glggHunSpell = NULL;
+}
 void lggHunSpell_Wrapper::processSettings()
 {
 	//expects everything to already be in saved settings
@@ -612,6 +836,7 @@ void lggHunSpell_Wrapper::processSettings()
 }
 void lggHunSpell_Wrapper::addDictionary(std::string additionalDictionary)
 {
+	LLMutexLock lock(mHunspellMutex);
 	if(!myHunspell)return;
 	if(additionalDictionary=="")return;
 	//expecting a full name here
@@ -620,6 +845,7 @@ void lggHunSpell_Wrapper::addDictionary(std::string additionalDictionary)
 	{
 		llinfos << "Adding additional dictionary -> " << dicpath.c_str() << llendl;
 		myHunspell->add_dic(dicpath.c_str());
+		clearResults();
 	}
 }
 std::string lggHunSpell_Wrapper::dictName2FullName(std::string dictName)
@@ -24,6 +24,13 @@
 #include "hunspell/hunspell.hxx"
 #endif
 
+#include <list>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+class LLMutex;
+class lggSpellCheckThread;
+
 class lggHunSpell_Wrapper
 {
 	LOG_CLASS(lggHunSpell_Wrapper);
@@ -33,6 +40,7 @@ public:
 	BOOL highlightInRed;
 
 	static void initSettings();
+	static void cleanupClass();
 	void processSettings();
 
 	std::vector<std::string> getAvailDicts();
@@ -51,6 +59,22 @@ public:
 	void setNewDictionary(std::string newDict);
 	void setNewHighlightSetting(BOOL highlight);
 	BOOL isSpelledRight(std::string wordToCheck);
+
+	enum ESpelling
+	{
+		SPELLED_RIGHT,
+		SPELLED_WRONG,
+		SPELLING_PENDING
+	};
+	// Looks wordToCheck up in the results shared by all editors.  Words that
+	// have not been checked yet are queued for the spell check thread and
+	// come back as SPELLING_PENDING.  Main thread only.
+	ESpelling checkSpelling(const std::string& wordToCheck);
+	// Changes whenever queued words have been checked or the dictionaries
+	// have changed, so that editors know to look their words up again.
+	U32 getSpellGeneration();
+	// Changes whenever the dictionaries do, invalidating every result
+	U32 getDictionarySerial() const { return mDictionarySerial; }
 	std::vector<std::string> getSuggestionList(std::string badWord);
 	S32 findNextError(std::string haystack, int startAt);
 
@@ -64,6 +88,29 @@ private:
 	~lggHunSpell_Wrapper();
 
 	void debugTest(std::string testWord);//prints out debug about testing the word
+
+	void cacheResult(const std::string& word, BOOL spelled_right);
+	void applyResults();
+	// Forgets every result, for when the dictionaries change
+	void clearResults();
+
+	struct CachedResult
+	{
+		BOOL mSpelledRight;
+		std::list<std::string>::iterator mUse;
+	};
+	typedef boost::unordered_map<std::string, CachedResult> result_cache_t;
+	result_cache_t mResults;
+	// Cached words, most recently used first
+	std::list<std::string> mResultUse;
+	// Words waiting on the spell check thread
+	boost::unordered_set<std::string> mQueued;
+	U32 mSpellGeneration;
+	U32 mDictionarySerial;
+
+	lggSpellCheckThread* mThread;
+	// Held for every call into myHunspell, from either thread
+	LLMutex* mHunspellMutex;
 	std::string currentBaseDic;
 	//std::vector<std::string> languageCodes;
 	//std::vector<std::string> countryCodes;
@@ -60,8 +60,10 @@
 #include "llfirstuse.h"
 #include "llfloaterjoystick.h"
 #include "llfloatersnapshot.h"
+#include "lgghunspell_wrapper.h"
 #include "llgroupmgr.h"
 #include "llimpanel.h"
+#include "lllogchat.h"
 #include "llmimetypes.h"
 #include "llmutelist.h"
 #include "llstartup.h"
@@ -128,6 +130,7 @@
 #include "llfloaterstats.h"
 #include "llhoverview.h"
 #include "llfloatermemleak.h"
+#include "llfloatermemoryaccounts.h"
 
 #include "llsdserialize.h"
 
@@ -164,6 +167,7 @@
 #include "llgesturemgr.h"
 #include "llsky.h"
 #include "llvlmanager.h"
+#include "llvlcompositionthread.h"
 #include "llviewercamera.h"
 #include "lldrawpoolbump.h"
 #include "llvieweraudio.h"
@@ -173,6 +177,7 @@
 #include "llmeshrepository.h"
 
 #include "llavatarnamecache.h"
+#include "llinventorysearchindex.h"
 #include "llinventoryview.h"
 
 #include "llcommandlineparser.h"
@@ -1249,6 +1254,7 @@ bool LLAppViewer::mainLoop()
 						LLFastTimer t3(LLFastTimer::FTM_LFS);
 						io_pending += LLLFSThread::updateClass(1);
 					}
+					work_pending += LLVLCompositionThread::updateClass(1); // unpauses the terrain composition thread
 					if (io_pending > 1000)
 					{
 						ms_sleep(llmin(io_pending / 100, 100)); // give the fs some time to catch up
@@ -1282,6 +1288,10 @@ bool LLAppViewer::mainLoop()
 						LLVFSThread::sLocal->pause(); 
 						LLLFSThread::sLocal->pause(); 
 					}
+					if(!total_work_pending)
+					{
+						LLVLCompositionThread::sLocal->pause();
+					}
 				}					
 
 				if ((LLStartUp::getStartupState() >= STATE_CLEANUP) &&
@@ -1492,6 +1502,9 @@ bool LLAppViewer::cleanup()
 
 	llinfos << "Cleaning up Inventory" << llendflush;
 	
+	// Stops the search thread and removes its inventory observer
+	LLInventorySearchIndex::cleanupClass();
+
 	// Cleanup Inventory after the UI since it will delete any remaining observers
 	// (Deleted observers should have already removed themselves)
 	gInventory.cleanupInventory();
@@ -1652,6 +1665,7 @@ bool LLAppViewer::cleanup()
 		pending += LLAppViewer::getTextureFetch()->update(1); // unpauses the texture fetch thread
 		pending += LLVFSThread::updateClass(0);
 		pending += LLLFSThread::updateClass(0);
+		pending += LLVLCompositionThread::updateClass(0);
 		if (pending == 0)
 		{
 			break;
@@ -1674,6 +1688,8 @@ bool LLAppViewer::cleanup()
 	
 	LLFilePickerThread::cleanupClass();
 	LLDirPickerThread::cleanupClass();
+	LLLogChat::cleanupClass();
+	lggHunSpell_Wrapper::cleanupClass();
 
 	delete sTextureCache;
     sTextureCache = NULL;
@@ -1695,6 +1711,7 @@ bool LLAppViewer::cleanup()
 	LLImage::cleanupClass();
 	LLVFSThread::cleanupClass();
 	LLLFSThread::cleanupClass();
+	LLVLCompositionThread::cleanupClass();
 
 	llinfos << "VFS Thread finished" << llendflush;
 
@@ -1795,6 +1812,9 @@ bool LLAppViewer::initThreads()
 	LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(), sImageDecodeThread, enable_threads && true);
 	LLImage::initClass();
 
+	// Terrain texture composition
+	LLVLCompositionThread::initClass(enable_threads && true);
+
 	// Mesh streaming and caching
 	gMeshRepo.init();
 
@@ -3240,6 +3260,11 @@ bool LLAppViewer::initCache()
 		purgeCache();
 	}
 
+	if (gSavedSettings.getBOOL("XUILayoutCache"))
+	{
+		LLUICtrlFactory::setLayoutCacheDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "xui"));
+	}
+
 	LLSplashScreen::update("Initializing Texture Cache...");
 
 	// Init the texture cache
@@ -3408,6 +3433,7 @@ void LLAppViewer::purgeCache()
 	LLAppViewer::getTextureCache()->purgeCache(LL_PATH_CACHE);
 	std::string mask = gDirUtilp->getDirDelimiter() + "*.*";
 	gDirUtilp->deleteFilesInDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE,""),mask);
+	gDirUtilp->deleteFilesInDir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE,"xui"),mask);
 }
 
 void LLAppViewer::addOnIdleCallback(const boost::function<void()>& cb)
@@ -3547,6 +3573,25 @@ void LLAppViewer::saveFinalSnapshot()
 
 void LLAppViewer::loadNameCache()
 {
+	// Legacy and display names share one binary file, legacy section first.
+	// Fall back to the older XML caches if it is missing or unreadable.
+	if (gCacheName)
+	{
+		LLTimer load_timer;
+		std::string filename =
+			gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "names.bin");
+		llifstream names_stream(filename, std::ios::in | std::ios::binary);
+		if (names_stream.is_open()
+			&& gCacheName->importBinary(names_stream)
+			&& LLAvatarNameCache::importBinary(names_stream))
+		{
+			llinfos << "Loaded name cache in "
+					<< load_timer.getElapsedTimeF32() * 1000.f << " ms" << llendl;
+			return;
+		}
+		llinfos << "No usable names.bin, loading XML name caches" << llendl;
+	}
+
 	// Phoenix: Wolfspirit: Loads the Display Name Cache. And set if we are using Display Names.
 	std::string filename =
 		gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml");
@@ -3580,6 +3625,27 @@ void LLAppViewer::loadNameCache()
 
 void LLAppViewer::saveNameCache()
 {
+	if (gCacheName)
+	{
+		std::string filename =
+			gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "names.bin");
+		llofstream names_stream(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (names_stream.is_open())
+		{
+			gCacheName->exportBinary(names_stream);
+			LLAvatarNameCache::exportBinary(names_stream);
+			names_stream.close();
+			if (!names_stream.fail())
+			{
+				// The XML caches are only read as a fallback now, don't
+				// let stale copies of them linger
+				LLFile::remove(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "avatar_name_cache.xml"));
+				LLFile::remove(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "name.cache"));
+				return;
+			}
+		}
+	}
+
 	// Phoenix: Wolfspirit: Saves the Display Name Cache.
 // display names cache
 	std::string filename =
@@ -3637,6 +3703,18 @@ void LLAppViewer::idle()
 	LLMortician::updateClass();
 	LLFilePickerThread::clearDead();	// calls LLFilePickerThread::notify()
 	LLDirPickerThread::clearDead();		// calls LLDirPickerThread::notify()
+	LLLogChat::idle();
+
+	static LLCachedControl<bool> debug_settings_lookups(gSavedSettings, "DebugSettingsLookups");
+	if (debug_settings_lookups != LLControlGroup::getLookupTracking())
+	{
+		if (!debug_settings_lookups)
+		{
+			LLControlGroup::dumpLookupReport();
+		}
+		LLControlGroup::setLookupTracking(debug_settings_lookups);
+	}
+	LLControlGroup::tickLookupFrame();
 
 	F32 dt_raw = idle_timer.getElapsedTimeAndResetF32();
 
@@ -3883,6 +3961,7 @@ void LLAppViewer::idle()
 
 	{
 		gFrameStats.start(LLFrameStats::UPDATE_EFFECTS);
+		LLSelectMgr::getInstance()->sendPendingSelects();
 		LLSelectMgr::getInstance()->updateEffects();
 		LLHUDManager::getInstance()->cleanupEffects();
 		LLHUDManager::getInstance()->sendEffects();
@@ -4003,6 +4082,9 @@ void LLAppViewer::idle()
 		}
 	}
 
+	// Sample the memory held by caches
+	LLFloaterMemoryAccounts::idle();
+
 	// Execute deferred tasks.
 	LLDeferredTaskList::instance().run();
 
@@ -4091,14 +4173,22 @@ void LLAppViewer::idleNameCache()
 	LLViewerRegion* region = gAgent.getRegion();
 	if (!region) return;
 
-	// deal with any queued name requests and replies.
-	gCacheName->processPending();
-
 	// Can't run the new cache until we have the list of capabilities
 	// for the agent region, and can therefore decide whether to use
 	// display names or fall back to the old name system.
-	if (!region->capabilitiesReceived()) return;
+	if (region->capabilitiesReceived())
+	{
+		idleAvatarNameCache(region);
+	}
 
+	// deal with any queued name requests and replies.  Runs after the
+	// display name cache so that legacy requests queued this frame are
+	// either folded into its capability batch or sent out right away.
+	gCacheName->processPending();
+}
+
+void LLAppViewer::idleAvatarNameCache(LLViewerRegion* region)
+{
 	// Agent may have moved to a different region, so need to update cap URL
 	// for name lookups.  Can't do this in the cap grant code, as caps are
 	// granted to neighbor regions before the main agent gets there.  Can't
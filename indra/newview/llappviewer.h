@@ -38,6 +38,7 @@ class LLTextureCache;
 class LLImageDecodeThread;
 class LLTextureFetch;
 class LLWatchdogTimeout;
+class LLViewerRegion;
 class LLCommandLineParser;
 
 class LLAppViewer : public LLApp
@@ -202,6 +203,7 @@ private:
     void idleShutdown();
     void idleNetwork();
     void idleNameCache();
+    void idleAvatarNameCache(LLViewerRegion* region);
 
     void sendLogoutRequest();
     void disconnectViewer();
@@ -203,6 +203,7 @@ void LLDrawable::cleanupReferences()
 	
 	{
 		LLFastTimer t2(LLFastTimer::FTM_DELETE_FACES);
+		gObjectList.reclaimVertexBuffers(this);
 		std::for_each(mFaces.begin(), mFaces.end(), DeletePointer());
 		mFaces.clear();
 	}
@@ -0,0 +1,217 @@
+/**
+ * @file llfloatermemoryaccounts.cpp
+ * @brief Shows the memory reported by the viewer's caches
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ *
+ * Copyright (c) 2010, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llfloatermemoryaccounts.h"
+
+#include "lldate.h"
+#include "lldir.h"
+#include "llfile.h"
+#include "llnotifications.h"
+#include "llscrolllistctrl.h"
+#include "lluictrlfactory.h"
+#include "llviewercontrol.h"
+
+#include "jsoncpp/writer.h"
+
+// Seconds between logged samples when MemoryAccountsSampleInterval is 0
+const F32 DEFAULT_LOG_SAMPLE_INTERVAL = 10.f;
+
+LLMemoryAccount::sample_list_t LLFloaterMemoryAccounts::sSamples;
+LLFrameTimer LLFloaterMemoryAccounts::sSampleTimer;
+LLDate LLFloaterMemoryAccounts::sSampleDate;
+
+static std::string format_kb(S64 bytes)
+{
+	return llformat("%.1f", (F64)bytes / 1024.0);
+}
+
+static Json::Value samples_to_json(const LLDate& date, const LLMemoryAccount::sample_list_t& samples)
+{
+	// Values go out as doubles, the JSON library has no 64 bit integers
+	Json::Value root;
+	root["time"] = date.asString();
+	Json::Value& accounts = root["accounts"];
+	for (LLMemoryAccount::sample_list_t::const_iterator iter = samples.begin(); iter != samples.end(); ++iter)
+	{
+		Json::Value account;
+		account["name"] = iter->mName;
+		account["bytes"] = (F64)iter->mUsage.mBytes;
+		account["count"] = (F64)iter->mUsage.mCount;
+		account["peak_bytes"] = (F64)iter->mPeak.mBytes;
+		account["peak_count"] = (F64)iter->mPeak.mCount;
+		accounts.append(account);
+	}
+	return root;
+}
+
+LLFloaterMemoryAccounts::LLFloaterMemoryAccounts(const LLSD& key)
+:	LLFloater(std::string("floater_memory_accounts")),
+	mAccountList(NULL)
+{
+	LLUICtrlFactory::getInstance()->buildFloater(this, "floater_memory_accounts.xml");
+}
+
+LLFloaterMemoryAccounts::~LLFloaterMemoryAccounts()
+{
+}
+
+BOOL LLFloaterMemoryAccounts::postBuild()
+{
+	mAccountList = getChild<LLScrollListCtrl>("account_list");
+	childSetAction("dump_btn", onClickDump, this);
+
+	sample();
+	refreshList();
+	return TRUE;
+}
+
+void LLFloaterMemoryAccounts::refreshList()
+{
+	S64 total_bytes = 0;
+	for (LLMemoryAccount::sample_list_t::const_iterator iter = sSamples.begin(); iter != sSamples.end(); ++iter)
+	{
+		LLSD element;
+		element["id"] = iter->mName;
+		element["columns"][0]["column"] = "name";
+		element["columns"][0]["value"] = iter->mName;
+		element["columns"][1]["column"] = "kb";
+		element["columns"][1]["value"] = format_kb(iter->mUsage.mBytes);
+		element["columns"][2]["column"] = "count";
+		element["columns"][2]["value"] = llformat("%lld", (long long)iter->mUsage.mCount);
+		element["columns"][3]["column"] = "peak_kb";
+		element["columns"][3]["value"] = format_kb(iter->mPeak.mBytes);
+		element["columns"][4]["column"] = "peak_count";
+		element["columns"][4]["value"] = llformat("%lld", (long long)iter->mPeak.mCount);
+		mAccountList->updateElement(element);
+
+		total_bytes += iter->mUsage.mBytes;
+	}
+
+	childSetTextArg("total_text", "[TOTAL]", format_kb(total_bytes));
+}
+
+//static
+void LLFloaterMemoryAccounts::sample()
+{
+	sSampleTimer.reset();
+	sSampleDate = LLDate::now();
+	LLMemoryAccount::sampleAll(sSamples);
+
+	static LLCachedControl<bool> log_samples(gSavedSettings, "MemoryAccountsLog");
+	if (log_samples)
+	{
+		std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "memory_accounts.log");
+		llofstream file(filename, std::ios_base::out | std::ios_base::app);
+		if (file.is_open())
+		{
+			// One sample per line
+			Json::FastWriter writer;
+			file << writer.write(samples_to_json(sSampleDate, sSamples));
+		}
+	}
+}
+
+//static
+void LLFloaterMemoryAccounts::idle()
+{
+	static LLCachedControl<F32> sample_interval(gSavedSettings, "MemoryAccountsSampleInterval");
+	static LLCachedControl<bool> log_samples(gSavedSettings, "MemoryAccountsLog");
+
+	// Polling every account walks some large caches, so nothing is sampled
+	// unless the samples are shown or logged.
+	bool visible = instanceVisible();
+	if (!visible && !log_samples)
+	{
+		return;
+	}
+
+	F32 interval = sample_interval > 0.f ? (F32)sample_interval : DEFAULT_LOG_SAMPLE_INTERVAL;
+	if (visible)
+	{
+		interval = llmin(interval, 1.f);
+	}
+	if (sSampleTimer.getElapsedTimeF32() < interval)
+	{
+		return;
+	}
+
+	sample();
+	if (visible)
+	{
+		findInstance()->refreshList();
+	}
+}
+
+//static
+BOOL LLFloaterMemoryAccounts::dumpJSON()
+{
+	if (sSamples.empty())
+	{
+		sample();
+	}
+
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "memory_accounts.json");
+	llofstream file(filename);
+	if (!file.is_open())
+	{
+		llwarns << "Unable to write " << filename << llendl;
+		return FALSE;
+	}
+
+	Json::StyledWriter writer;
+	file << writer.write(samples_to_json(sSampleDate, sSamples));
+	llinfos << "Wrote memory accounts to " << filename << llendl;
+	return TRUE;
+}
+
+//static
+void LLFloaterMemoryAccounts::show(void*)
+{
+	showInstance();
+}
+
+//static
+void LLFloaterMemoryAccounts::onClickDump(void* data)
+{
+	LLSD args;
+	if (dumpJSON())
+	{
+		args["MESSAGE"] = "Memory accounts written to " + gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "memory_accounts.json");
+	}
+	else
+	{
+		args["MESSAGE"] = "Unable to write the memory accounts file.";
+	}
+	LLNotifications::instance().add("SystemMessageTip", args);
+}
@@ -0,0 +1,76 @@
+/**
+ * @file llfloatermemoryaccounts.h
+ * @brief Shows the memory reported by the viewer's caches
+ *
+ * $LicenseInfo:firstyear=2010&license=viewergpl$
+ *
+ * Copyright (c) 2010, Linden Research, Inc.
+ *
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ *
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ *
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ *
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLFLOATERMEMORYACCOUNTS_H
+#define LL_LLFLOATERMEMORYACCOUNTS_H
+
+#include "lldate.h"
+#include "llfloater.h"
+#include "llframetimer.h"
+#include "llmemoryaccount.h"
+
+class LLScrollListCtrl;
+
+class LLFloaterMemoryAccounts : public LLFloater, public LLFloaterSingleton<LLFloaterMemoryAccounts>
+{
+	friend class LLUISingleton<LLFloaterMemoryAccounts, VisibilityPolicy<LLFloater> >;
+
+public:
+	/*virtual*/ BOOL postBuild();
+
+	// Samples the accounts every second while the floater is open, and every
+	// MemoryAccountsSampleInterval seconds while MemoryAccountsLog is set,
+	// appending each sample to memory_accounts.log.  Does nothing otherwise.
+	static void idle();
+
+	// Writes the latest sample to memory_accounts.json in the log directory
+	static BOOL dumpJSON();
+
+	static void show(void*);
+
+private:
+	LLFloaterMemoryAccounts(const LLSD& key);
+	/*virtual*/ ~LLFloaterMemoryAccounts();
+
+	void refreshList();
+
+	static void sample();
+	static void onClickDump(void* data);
+
+	LLScrollListCtrl* mAccountList;
+
+	static LLMemoryAccount::sample_list_t sSamples;
+	static LLFrameTimer sSampleTimer;
+	static LLDate sSampleDate;
+};
+
+#endif // LL_LLFLOATERMEMORYACCOUNTS_H
@@ -29,8 +29,8 @@ LLNetListItem::LLNetListItem(LLUUID id)
 ////////////////////////////////
 #define MAX_PACKET_LEN (0x2000)
 LLTemplateMessageReader* LLFloaterMessageLogItem::sTemplateMessageReader = NULL;
-LLFloaterMessageLogItem::LLFloaterMessageLogItem(LLMessageLogEntry entry)
-:	LLMessageLogEntry(entry.mType, entry.mFromHost, entry.mToHost, entry.mData, entry.mDataSize)
+LLFloaterMessageLogItem::LLFloaterMessageLogItem(const LLMessageLogEntry& entry)
+:	LLMessageLogEntry(entry)
 {
 	if(!sTemplateMessageReader)
 	{
@@ -493,7 +493,8 @@ LLFloaterMessageLog::LLFloaterMessageLog()
 {
 	sInstance = this;
 	LLMessageLog::setCallback(onLog);
-	sMessageLogEntries = LLMessageLog::getDeque();
+	sMessageLogEntries.clear();
+	LLMessageLog::getEntries(sMessageLogEntries);
 	LLUICtrlFactory::getInstance()->buildFloater(this, "floater_message_log.xml");
 }
 LLFloaterMessageLog::~LLFloaterMessageLog()
@@ -700,7 +701,7 @@ void LLFloaterMessageLog::setNetInfoMode(ENetInfoMode mode)
 	childSetEnabled("send_to_message_builder_btn", mNetInfoMode == NI_LOG);
 }
 // static
-void LLFloaterMessageLog::onLog(LLMessageLogEntry entry)
+void LLFloaterMessageLog::onLog(const LLMessageLogEntry& entry)
 {
 	//don't mess with the queue while a filter's being applied, or face invalid iterators
 	if(!sBusyApplyingFilter)
@@ -17,7 +17,7 @@ public:
 class LLFloaterMessageLogItem : public LLMessageLogEntry
 {
 public:
-	LLFloaterMessageLogItem(LLMessageLogEntry entry);
+	LLFloaterMessageLogItem(const LLMessageLogEntry& entry);
 	~LLFloaterMessageLogItem();
 	LLUUID mID;
 	U32 mSequenceID;
@@ -66,7 +66,7 @@ public:
 	void refreshNetInfo(BOOL force);
 	enum ENetInfoMode { NI_NET, NI_LOG };
 	void setNetInfoMode(ENetInfoMode mode);
-	static void onLog(LLMessageLogEntry entry);
+	static void onLog(const LLMessageLogEntry& entry);
 	static void conditionalLog(LLFloaterMessageLogItem item);
 	static void onCommitNetList(LLUICtrl* ctrl, void* user_data);
 	static void onCommitMessageLog(LLUICtrl* ctrl, void* user_data);
@@ -48,6 +48,7 @@
 #include "llcallbacklist.h"
 #include "llinventoryclipboard.h"	// *TODO: remove this once hack below gone.
 #include "llinventorymodelbackgroundfetch.h"
+#include "llinventorysearchindex.h"
 #include "llinventoryview.h"		// hacked in for the bonus context menu items.
 #include "llkeyboard.h"
 #include "lllineeditor.h"
@@ -1123,7 +1124,8 @@ LLFolderViewFolder::LLFolderViewFolder( const std::string& name, LLUIImagePtr ic
 	mLastArrangeGeneration( -1 ),
 	mLastCalculatedWidth(0),
 	mCompletedFilterGeneration(-1),
-	mMostFilteredDescendantGeneration(-1)
+	mMostFilteredDescendantGeneration(-1),
+	mItemsDeferred(FALSE)
 {
 	mType = std::string("(folder)");
 }
@@ -1409,6 +1411,22 @@ void LLFolderViewFolder::filter( LLInventoryFilter& filter)
 		}
 	}
 
+	if (mItemsDeferred && mListener)
+	{
+		if (!filter.isNotDefault())
+		{
+			// items without a view yet would all pass
+			if (mListener->hasChildren())
+			{
+				mMostFilteredDescendantGeneration = filter_generation;
+			}
+		}
+		else if (filter.mayHaveMatchesIn(mListener->getUUID()))
+		{
+			mListener->buildItemViews();
+		}
+	}
+
 	for (items_t::iterator iter = mItems.begin();
 		 iter != mItems.end();)
 	{
@@ -1841,6 +1859,28 @@ void LLFolderViewFolder::extractItem( LLFolderViewItem* item )
 	removeChild(item);
 }
 
+void LLFolderViewFolder::recycleItemViews()
+{
+	if (mItemsDeferred || mIsOpen || numSelected())
+	{
+		return;
+	}
+
+	LLFolderView* root = getRoot();
+	for (items_t::iterator iter = mItems.begin(); iter != mItems.end(); ++iter)
+	{
+		LLFolderViewItem* item = *iter;
+		root->removeItemID(item->getListener()->getUUID());
+		removeChild(item);
+	}
+	std::for_each(mItems.begin(), mItems.end(), DeletePointer());
+	mItems.clear();
+
+	mItemsDeferred = TRUE;
+	dirtyFilter();
+	requestArrange();
+}
+
 // This function is called by a child that needs to be resorted.
 // This is only called for renaming an object because it won't work for date
 void LLFolderViewFolder::resort(LLFolderViewItem* item)
@@ -2084,8 +2124,16 @@ void LLFolderViewFolder::setOpenArrangeRecursively(BOOL openitem, ERecurseType r
 		if(mListener)
 		{
 			mListener->openItem();
+			if (mItemsDeferred)
+			{
+				mListener->buildItemViews();
+			}
 		}
 	}
+	else if (was_open && !openitem && mListener && !mItemsDeferred && getRoot()->getLazyItemViews())
+	{
+		getRoot()->addRecycleCandidate(this);
+	}
 
 	if (recurse == RECURSE_DOWN || recurse == RECURSE_UP_DOWN)
 	{
@@ -2673,7 +2721,8 @@ LLFolderView::LLFolderView( const std::string& name, LLUIImagePtr root_folder_ic
 	mSelectCallback(NULL),
 	mSignalSelectCallback(0),
 	mMinWidth(0),
-	mDragAndDropThisFrame(FALSE)
+	mDragAndDropThisFrame(FALSE),
+	mLazyItemViews(FALSE)
 {
 	
 	LLRect new_rect(rect.mLeft, rect.mBottom + getRect().getHeight(), rect.mLeft + getRect().getWidth(), rect.mBottom);
@@ -2940,11 +2989,26 @@ void LLFolderView::filter( LLInventoryFilter& filter )
 {
 	LLFastTimer t2(LLFastTimer::FTM_FILTER);
 	static LLCachedControl<S32> sFilterItemsPerFrame(gSavedSettings, "FilterItemsPerFrame");
-
-	filter.setFilterCount(llclamp(S32(sFilterItemsPerFrame), 1, 5000));
+	static LLCachedControl<S32> sFilterIndexedItemsPerFrame(gSavedSettings, "FilterIndexedItemsPerFrame");
 
 	if (getCompletedFilterGeneration() < filter.getCurrentGeneration())
 	{
+		// Rather than checking every label here, wait for the search thread
+		if (!filter.updateIndexedSearch())
+		{
+			return;
+		}
+
+		if (filter.isIndexedSearch())
+		{
+			// Most items are now rejected without being looked at
+			filter.setFilterCount(llclamp(S32(sFilterIndexedItemsPerFrame), 1, 50000));
+		}
+		else
+		{
+			filter.setFilterCount(llclamp(S32(sFilterItemsPerFrame), 1, 5000));
+		}
+
 		mFiltered = FALSE;
 		mMinWidth = 0;
 		LLFolderViewFolder::filter(filter);
@@ -4369,6 +4433,43 @@ void LLFolderView::removeItemID(const LLUUID& id)
 	mItemMap.erase(id);
 }
 
+void LLFolderView::addRecycleCandidate(LLFolderViewFolder* folder)
+{
+	if (folder && folder->getListener())
+	{
+		mRecycleQueue.push_back(std::make_pair(folder->getListener()->getUUID(), LLFrameTimer::getElapsedSeconds()));
+	}
+}
+
+void LLFolderView::recycleClosedFolders()
+{
+	static LLCachedControl<F32> sRecycleDelay(gSavedSettings, "InventoryRecycleItemViewsDelay");
+
+	if (mRecycleQueue.empty())
+	{
+		return;
+	}
+	if (sRecycleDelay <= 0.f || mFilter.isNotDefault())
+	{
+		// Filtering would only build them again
+		return;
+	}
+
+	F64 cutoff = LLFrameTimer::getElapsedSeconds() - (F64)sRecycleDelay;
+	while (!mRecycleQueue.empty() && mRecycleQueue.front().second <= cutoff)
+	{
+		LLFolderViewItem* itemp = getItemByID(mRecycleQueue.front().first);
+		mRecycleQueue.pop_front();
+		// Items are never queued, so this is a folder if it still exists
+		LLFolderViewFolder* folderp = dynamic_cast<LLFolderViewFolder*>(itemp);
+		if (folderp)
+		{
+			// Does nothing if it was opened again or has a selection
+			folderp->recycleItemViews();
+		}
+	}
+}
+
 LLFolderViewItem* LLFolderView::getItemByID(const LLUUID& id)
 {
 	if (id.isNull())
@@ -4401,6 +4502,11 @@ void LLFolderView::doIdle()
 	}
 
 	mFilter.clearModified();
+	if (mLazyItemViews)
+	{
+		recycleClosedFolders();
+	}
+
 	BOOL filter_modified_and_active = mCompletedFilterGeneration < mFilter.getCurrentGeneration() && 
 										mFilter.isNotDefault();
 	mNeedsAutoSelect = filter_modified_and_active &&
@@ -4483,6 +4589,150 @@ void LLFolderView::dumpSelectionInformation()
 	llinfos << "****************************************" << llendl;
 }
 
+// Stands in for an inventory bridge in debugBenchmarkViews(), so that view
+// construction can be timed without a real inventory behind it.
+class LLBenchmarkListener : public LLFolderViewEventListener
+{
+public:
+	LLBenchmarkListener(const std::string& name, S32 item_count)
+	:	mName(name),
+		mItemCount(item_count),
+		mFolder(NULL)
+	{
+		mUUID.generate();
+	}
+
+	void setFolder(LLFolderViewFolder* folder) { mFolder = folder; }
+
+	/*virtual*/ void buildItemViews()
+	{
+		if (!mFolder || !mFolder->getItemsDeferred())
+		{
+			return;
+		}
+		mFolder->setItemsDeferred(FALSE);
+		LLFolderView* root = mFolder->getRoot();
+		for (S32 i = 0; i < mItemCount; ++i)
+		{
+			std::string name = llformat("%s item %d", mName.c_str(), i);
+			LLFolderViewItem* itemp = new LLFolderViewItem(name, NULL, 0, root, new LLBenchmarkListener(name, 0));
+			itemp->addToFolder(mFolder, root);
+		}
+	}
+
+	/*virtual*/ const std::string& getName() const { return mName; }
+	/*virtual*/ const std::string& getDisplayName() const { return mName; }
+	/*virtual*/ const LLUUID& getUUID() const { return mUUID; }
+	/*virtual*/ time_t getCreationDate() const { return 0; }
+	/*virtual*/ PermissionMask getPermissionMask() const { return PERM_ALL; }
+	/*virtual*/ LLUIImagePtr getIcon() const { return NULL; }
+	/*virtual*/ LLFontGL::StyleFlags getLabelStyle() const { return LLFontGL::NORMAL; }
+	/*virtual*/ std::string getLabelSuffix() const { return LLStringUtil::null; }
+	/*virtual*/ void openItem() {}
+	/*virtual*/ void previewItem() {}
+	/*virtual*/ void selectItem() {}
+	/*virtual*/ void showProperties() {}
+	/*virtual*/ BOOL isItemRenameable() const { return FALSE; }
+	/*virtual*/ BOOL renameItem(const std::string& new_name) { return FALSE; }
+	/*virtual*/ BOOL isItemMovable() { return FALSE; }
+	/*virtual*/ BOOL isItemRemovable() { return FALSE; }
+	/*virtual*/ BOOL removeItem() { return FALSE; }
+	/*virtual*/ void removeBatch(LLDynamicArray<LLFolderViewEventListener*>& batch) {}
+	/*virtual*/ void move(LLFolderViewEventListener* parent_listener) {}
+	/*virtual*/ BOOL isItemCopyable() const { return FALSE; }
+	/*virtual*/ BOOL copyToClipboard() const { return FALSE; }
+	/*virtual*/ void cutToClipboard() {}
+	/*virtual*/ BOOL isClipboardPasteable() const { return FALSE; }
+	/*virtual*/ void pasteFromClipboard() {}
+	/*virtual*/ void pasteLinkFromClipboard() {}
+	/*virtual*/ void buildContextMenu(LLMenuGL& menu, U32 flags) {}
+	/*virtual*/ BOOL isUpToDate() const { return TRUE; }
+	/*virtual*/ BOOL hasChildren() const { return mItemCount > 0; }
+	/*virtual*/ LLInventoryType::EType getInventoryType() const { return mFolder ? LLInventoryType::IT_CATEGORY : LLInventoryType::IT_NOTECARD; }
+	/*virtual*/ BOOL startDrag(EDragAndDropType* type, LLUUID* id) const { return FALSE; }
+	/*virtual*/ BOOL dragOrDrop(MASK mask, BOOL drop, EDragAndDropType cargo_type, void* cargo_data) { return FALSE; }
+
+private:
+	std::string mName;
+	LLUUID mUUID;
+	S32 mItemCount;
+	LLFolderViewFolder* mFolder;
+};
+
+// Builds a synthetic 200k item inventory, first with every view created up
+// front and then with lazy item views, and logs the time and memory taken
+// to build it, open a few folders, close them and tear it down.
+//static
+void LLFolderView::debugBenchmarkViews(void*)
+{
+	const S32 FOLDER_COUNT = 2000;
+	const S32 ITEMS_PER_FOLDER = 100;
+	const S32 OPENED_FOLDERS = 20;
+
+	for (S32 lazy = 0; lazy < 2; ++lazy)
+	{
+		U64 start_rss = LLMemory::getCurrentRSS();
+		LLFolderView* root = new LLFolderView(std::string("benchmark"), NULL, LLRect(0, 0, 300, 0), LLUUID::null, gMenuHolder);
+		root->setLazyItemViews(lazy);
+
+		LLTimer timer;
+		std::vector<LLFolderViewFolder*> folders;
+		folders.reserve(FOLDER_COUNT);
+		for (S32 i = 0; i < FOLDER_COUNT; ++i)
+		{
+			std::string name = llformat("Folder %d", i);
+			LLBenchmarkListener* listener = new LLBenchmarkListener(name, ITEMS_PER_FOLDER);
+			LLFolderViewFolder* folderp = new LLFolderViewFolder(name, NULL, root, listener);
+			listener->setFolder(folderp);
+			folderp->addToFolder(root, root);
+			folderp->setItemsDeferred(TRUE);
+			if (!lazy)
+			{
+				listener->buildItemViews();
+			}
+			folders.push_back(folderp);
+		}
+		F32 build_time = timer.getElapsedTimeF32();
+		S32 build_views = (S32)root->mItemMap.size();
+		S64 build_kb = ((S64)LLMemory::getCurrentRSS() - (S64)start_rss) / 1024;
+
+		timer.reset();
+		for (S32 i = 0; i < OPENED_FOLDERS; ++i)
+		{
+			folders[i * (FOLDER_COUNT / OPENED_FOLDERS)]->setOpen(TRUE);
+		}
+		F32 open_time = timer.getElapsedTimeF32();
+		S32 open_views = (S32)root->mItemMap.size();
+
+		timer.reset();
+		for (S32 i = 0; i < OPENED_FOLDERS; ++i)
+		{
+			folders[i * (FOLDER_COUNT / OPENED_FOLDERS)]->setOpen(FALSE);
+		}
+		if (lazy)
+		{
+			// What recycleClosedFolders() does once the delay has passed
+			for (S32 i = 0; i < FOLDER_COUNT; ++i)
+			{
+				folders[i]->recycleItemViews();
+			}
+			root->mRecycleQueue.clear();
+		}
+		F32 close_time = timer.getElapsedTimeF32();
+		S32 close_views = (S32)root->mItemMap.size();
+
+		timer.reset();
+		delete root;
+		F32 destroy_time = timer.getElapsedTimeF32();
+
+		llinfos << (lazy ? "Lazy" : "Eager") << " views for " << FOLDER_COUNT * ITEMS_PER_FOLDER << " items in "
+				<< FOLDER_COUNT << " folders: build " << build_views << " views in " << build_time << "s (~"
+				<< build_kb << " KB), open " << OPENED_FOLDERS << " folders to " << open_views << " views in "
+				<< open_time << "s, close to " << close_views << " views in " << close_time << "s, destroy in "
+				<< destroy_time << "s" << llendl;
+	}
+}
+
 ///----------------------------------------------------------------------------
 /// Local function definitions
 ///----------------------------------------------------------------------------
@@ -4658,6 +4908,10 @@ LLInventoryFilter::LLInventoryFilter(const std::string& name) :
 	mFilterCount = 0;
 	mNextFilterGeneration = mFilterGeneration + 1;
 
+	mSearchQueryGeneration = -1;
+	mSearchQueryType = 0;
+	mSearchQueryPartial = false;
+
 	mLastLogoff = gSavedPerAccountSettings.getU32("LastLogoff");
 	mFilterBehavior = FILTER_NONE;
 
@@ -4667,6 +4921,90 @@ LLInventoryFilter::LLInventoryFilter(const std::string& name) :
 
 LLInventoryFilter::~LLInventoryFilter()
 {
+	if (mSearchQuery.notNull())
+	{
+		mSearchQuery->cancel();
+	}
+}
+
+time_t LLInventoryFilter::getEarliestDate() const
+{
+	time_t earliest = time_corrected() - mFilterOps.mHoursAgo * 3600;
+	if (mFilterOps.mMinDate > time_min() && mFilterOps.mMinDate < earliest)
+	{
+		earliest = mFilterOps.mMinDate;
+	}
+	else if (!mFilterOps.mHoursAgo)
+	{
+		earliest = 0;
+	}
+	return earliest;
+}
+
+BOOL LLInventoryFilter::isIndexedSearch() const
+{
+	return mSearchQuery.notNull()
+		&& mSearchQueryGeneration == mFilterGeneration
+		&& mSearchQueryType == mSearchType
+		&& mSearchQueryPartial == mPartialSearch;
+}
+
+BOOL LLInventoryFilter::mayHaveMatchesIn(const LLUUID& cat_id)
+{
+	if (!isIndexedSearch())
+	{
+		return TRUE;
+	}
+	return LLInventorySearchIndex::getInstance()->hasCandidatesIn(mSearchQuery, cat_id);
+}
+
+BOOL LLInventoryFilter::updateIndexedSearch()
+{
+	static LLCachedControl<bool> sInventorySearchIndex(gSavedSettings, "InventorySearchIndex");
+
+	if (!sInventorySearchIndex || !isActive())
+	{
+		if (mSearchQuery.notNull())
+		{
+			mSearchQuery->cancel();
+			mSearchQuery = NULL;
+		}
+		return TRUE;
+	}
+
+	LLInventorySearchIndex* index = LLInventorySearchIndex::getInstance();
+	if (!isIndexedSearch() || index->isStale(mSearchQuery))
+	{
+		LLInventorySearchQuery::Params params;
+		if (mSearchType == 3 || mPartialSearch)
+		{
+			params.mTokens = mFilterTokens;
+		}
+		else if (mFilterSubString.size())
+		{
+			params.mTokens.push_back(mFilterSubString);
+		}
+		params.mSearchType = mSearchType;
+		params.mFilterTypes = mFilterOps.mFilterTypes;
+		params.mPermissions = mFilterOps.mPermissions;
+		params.mMinDate = getEarliestDate();
+		params.mMaxDate = mFilterOps.mMaxDate;
+		// When filtering is active, omit links.
+		params.mSkipLinks = true;
+
+		// The previous search is only reused if it completed and the new
+		// one is known to be more restrictive.
+		if (mSearchQuery.notNull())
+		{
+			mSearchQuery->cancel();
+		}
+		mSearchQuery = index->search(params, mSearchQuery);
+		mSearchQueryGeneration = mFilterGeneration;
+		mSearchQueryType = mSearchType;
+		mSearchQueryPartial = mPartialSearch;
+	}
+	// Without a query, the index is still being built and this pass goes without it
+	return mSearchQuery.isNull() || mSearchQuery->isDone();
 }
 
 BOOL LLInventoryFilter::check(LLFolderViewItem* item) 
@@ -4680,17 +5018,14 @@ BOOL LLInventoryFilter::check(LLFolderViewItem* item)
 		return FALSE;
 	}
 
-	time_t earliest;
-
-	earliest = time_corrected() - mFilterOps.mHoursAgo * 3600;
-	if (mFilterOps.mMinDate > time_min() && mFilterOps.mMinDate < earliest)
-	{
-		earliest = mFilterOps.mMinDate;
-	}
-	else if (!mFilterOps.mHoursAgo)
+	// Items the search thread already rejected need no further looking at.
+	if (isIndexedSearch() && !LLInventorySearchIndex::getInstance()->isCandidate(mSearchQuery, item_id))
 	{
-		earliest = 0;
+		mSubStringMatchOffset = std::string::npos;
+		return FALSE;
 	}
+
+	time_t earliest = getEarliestDate();
 	
 	//When searching for all labels, we need to explode the filter string
 	//Into an array, and then compare each string to the label seperately
@@ -4701,21 +5036,11 @@ BOOL LLInventoryFilter::check(LLFolderViewItem* item)
 	//Added ability to toggle this type of searching for all labels cause it's convienient - RKeast
 	if(mSearchType == 3 || mPartialSearch)
 	{
-		std::istringstream i(mFilterSubString);
-		std::string blah;
-		
-		LLDynamicArray<std::string> search_array;
-
-		while(i >> blah)
-		{
-			search_array.put(blah);
-		}
-		
 		BOOL subStringMatch = true;
-		for(int i = 0; i < search_array.getLength(); i++)
+		for(int i = 0; i < (int)mFilterTokens.size(); i++)
 		{
-			mSubStringMatchOffset = (search_array.get(i)).size() ? item->getSearchableLabel().find(search_array.get(i)) : std::string::npos;
-			subStringMatch = subStringMatch && ((search_array.get(i)).size() == 0 || mSubStringMatchOffset != std::string::npos);
+			mSubStringMatchOffset = mFilterTokens[i].size() ? item->getSearchableLabel().find(mFilterTokens[i]) : std::string::npos;
+			subStringMatch = subStringMatch && (mFilterTokens[i].size() == 0 || mSubStringMatchOffset != std::string::npos);
 		}
 
 		passed = (0x1 << listener->getInventoryType() & mFilterOps.mFilterTypes || listener->getInventoryType() == LLInventoryType::IT_NONE)
@@ -4848,6 +5173,14 @@ void LLInventoryFilter::setFilterSubString(const std::string& string)
 		LLStringUtil::toUpper(mFilterSubString);
 		LLStringUtil::trimHead(mFilterSubString);
 
+		mFilterTokens.clear();
+		std::istringstream i(mFilterSubString);
+		std::string token;
+		while (i >> token)
+		{
+			mFilterTokens.push_back(token);
+		}
+
 		if (less_restrictive)
 		{
 			setModified(FILTER_LESS_RESTRICTIVE);
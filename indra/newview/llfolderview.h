@@ -55,6 +55,7 @@
 #include "llviewertexture.h"
 #include "lldepthstack.h"
 #include "lltooldraganddrop.h"
+#include "llinventorysearchindex.h"
 
 class LLMenuGL;
 
@@ -107,6 +108,10 @@ public:
 	virtual LLInventoryType::EType getInventoryType() const = 0;
 	virtual void performAction(LLFolderView* folder, LLInventoryModel* model, std::string action) {}
 
+	// Called on folders whose item views were deferred, when they are
+	// opened or a filter may match their contents.
+	virtual void buildItemViews() {}
+
 	// This method should be called when a drag begins. returns TRUE
 	// if the drag can begin, otherwise FALSE.
 	virtual BOOL startDrag(EDragAndDropType* type, LLUUID* id) const = 0;
@@ -224,6 +229,16 @@ public:
 
 	BOOL check(LLFolderViewItem* item);
 	std::string::size_type getStringMatchOffset() const;
+
+	// Runs this filter over the inventory search index on the search thread,
+	// so that check() can reject most items without looking at their labels.
+	// Returns FALSE while that search is still running for the current
+	// generation.
+	BOOL updateIndexedSearch();
+	BOOL isIndexedSearch() const;
+	// Returns FALSE if the indexed search proves no item directly in
+	// cat_id can pass, so its item views need not be built.
+	BOOL mayHaveMatchesIn(const LLUUID& cat_id);
 	BOOL isActive();
 	BOOL isNotDefault();
 	BOOL isModified();
@@ -280,6 +295,16 @@ protected:
 	S32				mNextFilterGeneration;
 	EFilterBehavior mFilterBehavior;
 
+	// mFilterSubString split on white space, for partial and combined searches
+	std::vector<std::string> mFilterTokens;
+
+	LLPointer<LLInventorySearchQuery> mSearchQuery;
+	S32				mSearchQueryGeneration;
+	U32				mSearchQueryType;
+	bool			mSearchQueryPartial;
+
+	time_t getEarliestDate() const;
+
 private:
 	U32 mLastLogoff;
 	BOOL mModified;
@@ -600,6 +625,7 @@ protected:
 	S32			mLastCalculatedWidth;
 	S32			mCompletedFilterGeneration;
 	S32			mMostFilteredDescendantGeneration;
+	BOOL		mItemsDeferred;
 public:
 	typedef enum e_recurse_type
 	{
@@ -687,6 +713,15 @@ public:
 	// doesn't delete it.
 	void extractItem( LLFolderViewItem* item );
 
+	// In folder views with lazy item views, folders start out without
+	// views for their items; the listener builds them on demand.
+	void setItemsDeferred(BOOL deferred) { mItemsDeferred = deferred; }
+	BOOL getItemsDeferred() const { return mItemsDeferred; }
+
+	// Destroys the views of this folder's items (but not of its sub
+	// folders) so they can be built again when next needed.
+	void recycleItemViews();
+
 	// This function is called by a child that needs to be resorted.
 	void resort(LLFolderViewItem* item);
 
@@ -914,8 +949,16 @@ public:
 
 	BOOL getDebugFilters() { return mDebugFilters; }
 
+	// When set, folders are created without item views, see
+	// LLFolderViewFolder::setItemsDeferred().  The views of folders that
+	// stay closed are recycled after InventoryRecycleItemViewsDelay.
+	void setLazyItemViews(BOOL lazy) { mLazyItemViews = lazy; }
+	BOOL getLazyItemViews() const { return mLazyItemViews; }
+	void addRecycleCandidate(LLFolderViewFolder* folder);
+
 	// DEBUG only
 	void dumpSelectionInformation();
+	static void debugBenchmarkViews(void*);
 
 protected:
 	LLScrollableContainerView* mScrollContainer;  // NULL if this is not a child of a scroll container.
@@ -926,6 +969,8 @@ protected:
 	void finishRenamingItem( void );
 	void closeRenamer( void );
 
+	void recycleClosedFolders();
+
 protected:
 	LLHandle<LLView>					mPopupMenuHandle;
 	
@@ -967,6 +1012,11 @@ protected:
 	std::map<LLUUID, LLFolderViewItem*> mItemMap;
 	BOOL							mDragAndDropThisFrame;
 
+	BOOL							mLazyItemViews;
+	// Folders closed since, by listener id, with the time they were closed
+	typedef std::deque<std::pair<LLUUID, F64> > recycle_queue_t;
+	recycle_queue_t					mRecycleQueue;
+
 };
 
 bool sort_item_name(LLFolderViewItem* a, LLFolderViewItem* b);
@@ -78,8 +78,8 @@ LLRoleActionSet::~LLRoleActionSet()
 LLGroupMemberData::LLGroupMemberData(const LLUUID& id, 
 										S32 contribution,
 										U64 agent_powers,
-										const std::string& title,
-										const std::string& online_status,
+										const std::string* title,
+										const std::string* online_status,
 										BOOL is_owner) : 
 	mID(id), 
 	mContribution(contribution), 
@@ -227,10 +227,60 @@ LLGroupMgrGroupData::LLGroupMgrGroupData(const LLUUID& id) :
 	mRoleDataComplete(FALSE),
 	mRoleMemberDataComplete(FALSE),
 	mGroupPropertiesDataComplete(FALSE),
-	mPendingRoleMemberRequest(FALSE)
+	mPendingRoleMemberRequest(FALSE),
+	mMemberGeneration(0)
 {
 }
 
+const std::string* LLGroupMgrGroupData::internString(const std::string& str)
+{
+	return &(*mStringPool.insert(str).first);
+}
+
+U32 LLGroupMgrGroupData::getMemoryUsage() const
+{
+	// Red-black tree node header: color plus parent, left and right links
+	const U32 MAP_NODE_OVERHEAD = 4 * sizeof(void*);
+
+	U32 bytes = sizeof(LLGroupMgrGroupData);
+
+	bytes += mMembers.size() * (MAP_NODE_OVERHEAD + sizeof(member_list_t::value_type)
+								+ sizeof(LLGroupMemberData));
+	bytes += mMemberOrder.capacity() * sizeof(LLGroupMemberData*);
+	for (member_list_t::const_iterator mi = mMembers.begin(); mi != mMembers.end(); ++mi)
+	{
+		if (mi->second)
+		{
+			bytes += mi->second->mRolesList.size()
+					 * (MAP_NODE_OVERHEAD + sizeof(LLGroupMemberData::role_list_t::value_type));
+		}
+	}
+
+	for (role_list_t::const_iterator ri = mRoles.begin(); ri != mRoles.end(); ++ri)
+	{
+		bytes += MAP_NODE_OVERHEAD + sizeof(role_list_t::value_type);
+		const LLGroupRoleData* rd = ri->second;
+		if (rd)
+		{
+			bytes += sizeof(LLGroupRoleData)
+					 + rd->mRoleData.mRoleName.capacity()
+					 + rd->mRoleData.mRoleTitle.capacity()
+					 + rd->mRoleData.mRoleDescription.capacity()
+					 + rd->mMemberIDs.capacity() * sizeof(LLUUID);
+		}
+	}
+
+	for (string_pool_t::const_iterator si = mStringPool.begin(); si != mStringPool.end(); ++si)
+	{
+		bytes += MAP_NODE_OVERHEAD + sizeof(std::string) + si->capacity();
+	}
+
+	bytes += mRoleMemberChanges.size() * (MAP_NODE_OVERHEAD + sizeof(change_map_t::value_type));
+	bytes += mRoleChanges.size() * (MAP_NODE_OVERHEAD + sizeof(role_data_map_t::value_type));
+	bytes += mName.capacity() + mCharter.capacity();
+	return bytes;
+}
+
 BOOL LLGroupMgrGroupData::getRoleData(const LLUUID& role_id, LLRoleData& role_data)
 {
 	role_data_map_t::const_iterator it;
@@ -409,7 +459,10 @@ void LLGroupMgrGroupData::removeMemberData()
 		delete mi->second;
 	}
 	mMembers.clear();
+	mMemberOrder.clear();
+	mStringPool.clear();
 	mMemberDataComplete = FALSE;
+	++mMemberGeneration;
 }
 
 void LLGroupMgrGroupData::removeRoleData()
@@ -836,6 +889,11 @@ void LLGroupMgr::processGroupMembersReply(LLMessageSystem* msg, void** data)
 
 	if (group_datap->mMemberCount > 0)
 	{
+		if (group_datap->mMemberOrder.empty())
+		{
+			group_datap->mMemberOrder.reserve(group_datap->mMemberCount);
+		}
+
 		S32 contribution = 0;
 		std::string online_status;
 		std::string title;
@@ -859,20 +917,23 @@ void LLGroupMgr::processGroupMembersReply(LLMessageSystem* msg, void** data)
 				formatDateString(online_status); // reformat for sorting, e.g. 12/25/2008 -> 2008/12/25
 				
 				//llinfos << "Member " << member_id << " has powers " << std::hex << agent_powers << std::dec << llendl;
-				LLGroupMemberData* newdata = new LLGroupMemberData(member_id, 
-																	contribution, 
-																	agent_powers, 
-																	title,
-																	online_status,
-																	is_owner);
-#if LL_DEBUG
 				LLGroupMgrGroupData::member_list_t::iterator mit = group_datap->mMembers.find(member_id);
 				if (mit != group_datap->mMembers.end())
 				{
+#if LL_DEBUG
 					llinfos << " *** Received duplicate member data for agent " << member_id << llendl;
-				}
 #endif
+					continue;
+				}
+
+				LLGroupMemberData* newdata = new LLGroupMemberData(member_id, 
+																	contribution, 
+																	agent_powers, 
+																	group_datap->internString(title),
+																	group_datap->internString(online_status),
+																	is_owner);
 				group_datap->mMembers[member_id] = newdata;
+				group_datap->mMemberOrder.push_back(newdata);
 			}
 			else
 			{
@@ -1703,6 +1764,12 @@ void LLGroupMgr::sendGroupMemberEjects(const LLUUID& group_id,
 					(*rit).second->removeMember(*it);
 				}
 			}
+			LLGroupMgrGroupData::member_order_t::iterator oit =
+				std::find(group_datap->mMemberOrder.begin(), group_datap->mMemberOrder.end(), (*mit).second);
+			if (oit != group_datap->mMemberOrder.end())
+			{
+				*oit = NULL;
+			}
 			delete (*mit).second;
 			group_datap->mMembers.erase(*it);
 		}
@@ -1857,4 +1924,30 @@ void LLGroupMgr::debugClearAllGroups(void*)
 	LLGroupMgr::parseRoleActions("role_actions.xml");
 }
 
+// static
+void LLGroupMgr::debugDumpGroupMemory(void*)
+{
+	LLGroupMgr::getInstance()->dumpMemoryUsage();
+}
+
+void LLGroupMgr::dumpMemoryUsage()
+{
+	U32 total_bytes = 0;
+	for (group_map_t::iterator gi = mGroups.begin(); gi != mGroups.end(); ++gi)
+	{
+		LLGroupMgrGroupData* group_datap = gi->second;
+		if (!group_datap) continue;
+
+		U32 bytes = group_datap->getMemoryUsage();
+		total_bytes += bytes;
+		llinfos << "Group " << group_datap->mName << " (" << gi->first << "): "
+				<< group_datap->mMembers.size() << "/" << group_datap->mMemberCount << " members, "
+				<< group_datap->mRoles.size() << "/" << group_datap->mRoleCount << " roles, "
+				<< group_datap->mReceivedRoleMemberPairs << " role-member pairs, "
+				<< group_datap->mStringPool.size() << " pooled strings, "
+				<< bytes / 1024 << " KB" << llendl;
+	}
+	llinfos << mGroups.size() << " groups, " << total_bytes / 1024 << " KB total" << llendl;
+}
+
 
@@ -38,6 +38,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 
 class LLMessageSystem;
 
@@ -61,11 +62,13 @@ friend class LLGroupMgrGroupData;
 public:
 	typedef std::map<LLUUID,LLGroupRoleData*> role_list_t;
 	
+	// title and online_status point into the owning group's string pool,
+	// see LLGroupMgrGroupData::internString()
 	LLGroupMemberData(const LLUUID& id, 
 						S32 contribution,
 						U64 agent_powers,
-						const std::string& title,
-						const std::string& online_status,
+						const std::string* title,
+						const std::string* online_status,
 						BOOL is_owner);
 
 	~LLGroupMemberData();
@@ -74,8 +77,8 @@ public:
 	S32 getContribution() const { return mContribution; }
 	U64	getAgentPowers() const { return mAgentPowers; }
 	BOOL isOwner() const { return mIsOwner; }
-	const std::string& getTitle() const { return mTitle; }
-	const std::string& getOnlineStatus() const { return mOnlineStatus; }
+	const std::string& getTitle() const { return *mTitle; }
+	const std::string& getOnlineStatus() const { return *mOnlineStatus; }
 	void addRole(const LLUUID& role, LLGroupRoleData* rd);
 	bool removeRole(const LLUUID& role);
 	void clearRoles() { mRolesList.clear(); };
@@ -88,8 +91,8 @@ protected:
 	LLUUID	mID;
 	S32		mContribution;
 	U64		mAgentPowers;
-	std::string	mTitle;
-	std::string	mOnlineStatus;
+	const std::string* mTitle;
+	const std::string* mOnlineStatus;
 	BOOL	mIsOwner;
 	role_list_t mRolesList;
 };
@@ -230,15 +233,31 @@ public:
 	BOOL isRoleDataComplete() { return mRoleDataComplete; }
 	BOOL isRoleMemberDataComplete() { return mRoleMemberDataComplete; }
 	BOOL isGroupPropertiesDataComplete() { return mGroupPropertiesDataComplete; }
+	// Changes whenever the member data is thrown away for a new request,
+	// so lists built from mMemberOrder can tell the stream restarted.
+	U32 getMemberGeneration() const { return mMemberGeneration; }
+
+	// Returns the pooled copy of str.  Member titles and online status
+	// strings repeat heavily across large groups, so members share them.
+	const std::string* internString(const std::string& str);
+
+	// Approximate heap usage of the member, role and role-member data.
+	U32 getMemoryUsage() const;
 
 public:
 	typedef	std::map<LLUUID,LLGroupMemberData*> member_list_t;
+	typedef std::vector<LLGroupMemberData*> member_order_t;
 	typedef	std::map<LLUUID,LLGroupRoleData*> role_list_t;
 	typedef std::map<lluuid_pair,LLRoleMemberChange,lluuid_pair_less> change_map_t;
 	typedef std::map<LLUUID,LLRoleData> role_data_map_t;
 	member_list_t		mMembers;
 	role_list_t			mRoles;
 
+	// mMembers in the order they were received, so that lists can be
+	// filled in while the rest of a large group is still arriving.
+	// Ejected members are left as NULL entries to keep indices stable.
+	member_order_t		mMemberOrder;
+
 	
 	change_map_t		mRoleMemberChanges;
 	role_data_map_t		mRoleChanges;
@@ -278,6 +297,11 @@ private:
 	BOOL				mGroupPropertiesDataComplete;
 
 	BOOL				mPendingRoleMemberRequest;
+
+	U32					mMemberGeneration;
+
+	typedef std::set<std::string> string_pool_t;
+	string_pool_t		mStringPool;
 };
 
 struct LLRoleAction
@@ -349,6 +373,8 @@ public:
 	std::vector<LLRoleActionSet*> mRoleActionSets;
 
 	static void debugClearAllGroups(void*);
+	static void debugDumpGroupMemory(void*);
+	void dumpMemoryUsage();
 	void clearGroups();
 	void clearGroupData(const LLUUID& group_id);
 
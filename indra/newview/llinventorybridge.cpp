@@ -2021,6 +2021,14 @@ void LLFolderBridge::openItem()
 	model->fetchDescendentsOf(mUUID);
 }
 
+void LLFolderBridge::buildItemViews()
+{
+	if (mInventoryPanel)
+	{
+		mInventoryPanel->buildItemViews(mUUID);
+	}
+}
+
 BOOL LLFolderBridge::isItemRenameable() const
 {
 	LLViewerInventoryCategory* cat = (LLViewerInventoryCategory*)getCategory();
@@ -285,6 +285,7 @@ public:
 								BOOL drop);
 	virtual void performAction(LLFolderView* folder, LLInventoryModel* model, std::string action);
 	virtual void openItem();
+	virtual void buildItemViews();
 	virtual BOOL isItemRenameable() const;
 	virtual void selectItem();
 	virtual void restoreItem();
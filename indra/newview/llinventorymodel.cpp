@@ -131,6 +131,12 @@ bool LLCanCache::operator()(LLInventoryCategory* cat, LLInventoryItem* item)
 // global for the agent inventory.
 LLInventoryModel gInventory;
 
+static void inventory_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	gInventory.getMemoryUsage(usage);
+}
+static LLMemoryAccount sInventoryAccount("Inventory", inventory_memory_usage);
+
 // Default constructor
 LLInventoryModel::LLInventoryModel()
 :	mModifyMask(LLInventoryObserver::ALL),
@@ -2932,6 +2938,38 @@ void LLInventoryModel::dumpInventory()
 	LL_DEBUGS("Inventory") << "\n**********************\nEnd Inventory Dump" << LL_ENDL;
 }
 
+void LLInventoryModel::getMemoryUsage(LLMemoryAccount::Usage& usage) const
+{
+	for (cat_map_t::const_iterator cit = mCategoryMap.begin(); cit != mCategoryMap.end(); ++cit)
+	{
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(cat_map_t::value_type)) + sizeof(LLViewerInventoryCategory);
+		if (cit->second.notNull())
+		{
+			usage.mBytes += LLMemoryAccount::stringBytes(cit->second->getName());
+		}
+	}
+	for (item_map_t::const_iterator iit = mItemMap.begin(); iit != mItemMap.end(); ++iit)
+	{
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(item_map_t::value_type)) + sizeof(LLViewerInventoryItem);
+		if (iit->second.notNull())
+		{
+			usage.mBytes += LLMemoryAccount::stringBytes(iit->second->getName())
+				+ LLMemoryAccount::stringBytes(iit->second->getDescription());
+		}
+	}
+	for (parent_cat_map_t::const_iterator pit = mParentChildCategoryTree.begin(); pit != mParentChildCategoryTree.end(); ++pit)
+	{
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(parent_cat_map_t::value_type))
+			+ sizeof(cat_array_t) + pit->second->capacity() * sizeof(LLPointer<LLViewerInventoryCategory>);
+	}
+	for (parent_item_map_t::const_iterator pit = mParentChildItemTree.begin(); pit != mParentChildItemTree.end(); ++pit)
+	{
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(parent_item_map_t::value_type))
+			+ sizeof(item_array_t) + pit->second->capacity() * sizeof(LLPointer<LLViewerInventoryItem>);
+	}
+	usage.mCount += mCategoryMap.size() + mItemMap.size();
+}
+
 //----------------------------------------------------------------------------
 
 void LLInventoryModel::removeItem(const LLUUID& item_id)
@@ -36,6 +36,7 @@
 #include "llassettype.h"
 #include "llfoldertype.h"
 #include "lldarray.h"
+#include "llmemoryaccount.h"
 #include "lluuid.h"
 #include "llpermissionsflags.h"
 #include "llstring.h"
@@ -542,6 +543,8 @@ private:
 
 public:
 	void dumpInventory();
+	// Memory held by the item and category maps, one count per object
+	void getMemoryUsage(LLMemoryAccount::Usage& usage) const;
 	//--------------------------------------------------------------------
 	// Other
 	//--------------------------------------------------------------------
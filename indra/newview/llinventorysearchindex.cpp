@@ -0,0 +1,769 @@
+/** 
+ * @file llinventorysearchindex.cpp
+ * @brief Flat inventory search index and background filter queries
+ *
+ * $LicenseInfo:firstyear=2002&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llinventorysearchindex.h"
+
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+
+#include "llagent.h"
+#include "llcachename.h"
+#include "llcallbacklist.h"
+#include "llinventorymodel.h"
+#include "lltimer.h"
+#include "llviewerinventory.h"
+#include "llviewerjointattachment.h"
+#include "llvoavatar.h"
+
+// Entries searched between checks for cancellation
+const S32 SEARCH_CHUNK_SIZE = 1024;
+
+// The snapshot is rebuilt on the next search once more than this many items,
+// or this fraction of them, changed since it was taken.
+const S32 MIN_CHANGES_BEFORE_REBUILD = 256;
+const S32 CHANGED_FRACTION_BEFORE_REBUILD = 8;
+
+// Seconds per frame spent building a snapshot
+const F32 BUILD_TIME_PER_FRAME = 0.002f;
+
+//----------------------------------------------------------------------------
+
+// What LLFolderViewItem::refresh() builds for each item, minus the label
+// suffixes that depend on viewer state rather than on the item itself.
+// Built on the main thread a few categories per frame, read only once built;
+// mChanged is only touched from the main thread.
+class LLInventorySearchSnapshot : public LLThreadSafeRefCount
+{
+public:
+	enum EVocabulary
+	{
+		VOCAB_NONE,
+		VOCAB_CALLING_CARD,	// " (online)"
+		VOCAB_GESTURE,		// " (active)"
+		VOCAB_WEARABLE,		// " (worn)"
+		VOCAB_OBJECT,		// " (worn on <attachment point>)"
+		VOCAB_COUNT
+	};
+
+	struct Entry
+	{
+		LLUUID mID;
+		LLUUID mParentID;
+		LLInventoryType::EType mInvType;
+		PermissionMask mPermissions;
+		time_t mCreationDate;
+		bool mIsLink;
+		bool mCreatorPending;
+		U8 mVocabulary;
+		// All upper cased
+		std::string mName;
+		std::string mCreator;
+		std::string mDesc;
+		std::string mAsset;
+		std::string mSuffix;
+	};
+	typedef std::vector<Entry> entry_list_t;
+	typedef boost::unordered_map<LLUUID, S32> entry_map_t;
+
+	LLInventorySearchSnapshot();
+
+	void startBuild();
+	// Walks categories until max_time is up, returns true once all are done.
+	bool buildStep(F32 max_time);
+	void noteChanges(U32 mask);
+	const std::string& getLabel(const Entry& entry, U32 search_type, std::string& buffer) const;
+	bool mayMatchSuffix(const Entry& entry, const std::string& token) const;
+
+	entry_list_t mEntries;
+	entry_map_t mEntryMap;
+	// Categories whose direct items are all in mEntries
+	boost::unordered_set<LLUUID> mIndexedCats;
+
+	// Words each kind of dynamic suffix can contain, newline separated so
+	// that no search token can span two of them.
+	std::string mVocabulary[VOCAB_COUNT];
+	bool mAttachmentPointsKnown;
+
+	boost::unordered_set<LLUUID> mChanged;
+	// Where the changed items are now
+	boost::unordered_set<LLUUID> mChangedParents;
+	bool mNeedsRebuild;
+
+	// Total main thread time spent in buildStep()
+	F32 mBuildTime;
+
+private:
+	void addItem(LLViewerInventoryItem* item);
+
+	// Categories still to be walked
+	std::deque<LLUUID> mPendingCats;
+};
+
+LLInventorySearchSnapshot::LLInventorySearchSnapshot()
+:	mAttachmentPointsKnown(false),
+	mNeedsRebuild(false),
+	mBuildTime(0.f)
+{
+}
+
+void LLInventorySearchSnapshot::startBuild()
+{
+	mPendingCats.push_back(gInventory.getRootFolderID());
+	if (gInventory.getLibraryRootFolderID().notNull())
+	{
+		mPendingCats.push_back(gInventory.getLibraryRootFolderID());
+	}
+
+	mVocabulary[VOCAB_CALLING_CARD] = "ONLINE";
+	mVocabulary[VOCAB_GESTURE] = "ACTIVE";
+	mVocabulary[VOCAB_WEARABLE] = "WORN";
+	mVocabulary[VOCAB_OBJECT] = "WORN\nON";
+
+	LLVOAvatar* avatar = gAgent.getAvatarObject();
+	mAttachmentPointsKnown = (avatar != NULL);
+	if (avatar)
+	{
+		for (LLVOAvatar::attachment_map_t::iterator iter = avatar->mAttachmentPoints.begin();
+			 iter != avatar->mAttachmentPoints.end(); ++iter)
+		{
+			std::string name = iter->second->getName();
+			LLStringUtil::toUpper(name);
+			mVocabulary[VOCAB_OBJECT] += "\n" + name;
+		}
+	}
+}
+
+bool LLInventorySearchSnapshot::buildStep(F32 max_time)
+{
+	LLTimer timer;
+	while (!mPendingCats.empty())
+	{
+		LLUUID cat_id = mPendingCats.front();
+		mPendingCats.pop_front();
+
+		LLInventoryModel::cat_array_t* cats;
+		LLInventoryModel::item_array_t* items;
+		gInventory.getDirectDescendentsOf(cat_id, cats, items);
+		if (cats)
+		{
+			for (S32 i = 0; i < cats->count(); ++i)
+			{
+				mPendingCats.push_back(cats->get(i)->getUUID());
+			}
+		}
+		if (items)
+		{
+			for (S32 i = 0; i < items->count(); ++i)
+			{
+				addItem(items->get(i));
+			}
+		}
+		if (cats && items)
+		{
+			mIndexedCats.insert(cat_id);
+		}
+
+		if (timer.getElapsedTimeF32() > max_time)
+		{
+			break;
+		}
+	}
+	mBuildTime += timer.getElapsedTimeF32();
+	return mPendingCats.empty();
+}
+
+// Items changed while the walk was going on are treated like the ones that
+// changed after it, so whatever the walk saw of them is never trusted.
+void LLInventorySearchSnapshot::noteChanges(U32 mask)
+{
+	const LLInventoryModel::changed_items_t& changed = gInventory.getChangedIDs();
+	if (changed.empty())
+	{
+		// Calling card changes only affect the " (online)" suffix.
+		mNeedsRebuild |= ((mask & ~LLInventoryObserver::CALLING_CARD) != 0);
+		return;
+	}
+	if (changed.find(LLUUID::null) != changed.end())
+	{
+		mNeedsRebuild = true;
+	}
+	for (LLInventoryModel::changed_items_t::const_iterator iter = changed.begin();
+		 iter != changed.end(); ++iter)
+	{
+		mChanged.insert(*iter);
+		LLInventoryObject* obj = gInventory.getObject(*iter);
+		if (obj)
+		{
+			mChangedParents.insert(obj->getParentUUID());
+		}
+	}
+}
+
+void LLInventorySearchSnapshot::addItem(LLViewerInventoryItem* item)
+{
+	if (!item || mEntryMap.find(item->getUUID()) != mEntryMap.end())
+	{
+		return;
+	}
+
+	Entry entry;
+	entry.mID = item->getUUID();
+	entry.mParentID = item->getParentUUID();
+	entry.mInvType = item->getInventoryType();
+	entry.mCreationDate = item->getCreationDate();
+	entry.mIsLink = item->getIsLinkType();
+	entry.mCreatorPending = false;
+
+	// Same as LLItemBridge::getPermissionMask()
+	const LLPermissions& perm = item->getPermissions();
+	BOOL copy = perm.allowCopyBy(gAgent.getID());
+	BOOL mod = perm.allowModifyBy(gAgent.getID());
+	BOOL xfer = perm.allowOperationBy(PERM_TRANSFER, gAgent.getID());
+	entry.mPermissions = 0;
+	if (copy) entry.mPermissions |= PERM_COPY;
+	if (mod)  entry.mPermissions |= PERM_MODIFY;
+	if (xfer) entry.mPermissions |= PERM_TRANSFER;
+
+	entry.mName = item->getName();
+	if (item->getCreatorUUID().notNull())
+	{
+		entry.mCreatorPending = !gCacheName->getFullName(item->getCreatorUUID(), entry.mCreator);
+	}
+	entry.mDesc = item->getDescription();
+	if (item->getAssetUUID().notNull())
+	{
+		entry.mAsset = item->getAssetUUID().asString();
+	}
+
+	// Same as LLItemBridge::getLabelSuffix()
+	if (perm.getOwner() == gAgent.getID())
+	{
+		if (LLAssetType::lookupIsLinkType(item->getType()))
+		{
+			entry.mSuffix = " (broken link)";
+		}
+		else if (item->getIsLinkType())
+		{
+			entry.mSuffix = " (link)";
+		}
+		else
+		{
+			if (!copy) entry.mSuffix += " (no copy)";
+			if (!mod)  entry.mSuffix += " (no modify)";
+			if (!xfer) entry.mSuffix += " (no transfer)";
+			if (perm.getGroup() == gAgent.getID()) entry.mSuffix += " (temporary)";
+		}
+	}
+
+	// Bridges that append their own suffix, see LLInvFVBridge::createBridge()
+	switch (item->getType())
+	{
+	case LLAssetType::AT_CALLINGCARD:
+		entry.mVocabulary = VOCAB_CALLING_CARD;
+		break;
+	case LLAssetType::AT_GESTURE:
+		entry.mVocabulary = VOCAB_GESTURE;
+		break;
+	case LLAssetType::AT_CLOTHING:
+	case LLAssetType::AT_BODYPART:
+		entry.mVocabulary = VOCAB_WEARABLE;
+		break;
+	case LLAssetType::AT_OBJECT:
+		entry.mVocabulary = VOCAB_OBJECT;
+		break;
+	default:
+		entry.mVocabulary = VOCAB_NONE;
+		break;
+	}
+
+	LLStringUtil::toUpper(entry.mName);
+	LLStringUtil::toUpper(entry.mCreator);
+	LLStringUtil::toUpper(entry.mDesc);
+	LLStringUtil::toUpper(entry.mAsset);
+	LLStringUtil::toUpper(entry.mSuffix);
+
+	mEntryMap[entry.mID] = (S32)mEntries.size();
+	mEntries.push_back(entry);
+}
+
+// Same as LLFolderViewItem::getSearchableLabel()
+const std::string& LLInventorySearchSnapshot::getLabel(const Entry& entry, U32 search_type, std::string& buffer) const
+{
+	const std::string* field;
+	switch (search_type)
+	{
+	case 1:
+		field = &entry.mCreator;
+		break;
+	case 2:
+		field = &entry.mDesc;
+		break;
+	case 3:
+		buffer = entry.mName;
+		buffer += ' ';
+		buffer += entry.mCreator;
+		buffer += ' ';
+		buffer += entry.mDesc;
+		buffer += ' ';
+		buffer += entry.mAsset;
+		buffer += entry.mSuffix;
+		return buffer;
+	case 4:
+		field = &entry.mAsset;
+		break;
+	default:
+		field = &entry.mName;
+		break;
+	}
+
+	if (entry.mSuffix.empty())
+	{
+		return *field;
+	}
+	buffer = *field;
+	buffer += entry.mSuffix;
+	return buffer;
+}
+
+bool LLInventorySearchSnapshot::mayMatchSuffix(const Entry& entry, const std::string& token) const
+{
+	if (entry.mVocabulary == VOCAB_NONE)
+	{
+		return false;
+	}
+	// Dynamic suffixes always start with " (", so a token without spaces or
+	// brackets can only be found inside one of their words.
+	if (token.find_first_of(" ()") != std::string::npos)
+	{
+		return true;
+	}
+	if (entry.mVocabulary == VOCAB_OBJECT && !mAttachmentPointsKnown)
+	{
+		return true;
+	}
+	return mVocabulary[entry.mVocabulary].find(token) != std::string::npos;
+}
+
+//----------------------------------------------------------------------------
+
+class LLInventorySearchWorker : public LLThread
+{
+public:
+	LLInventorySearchWorker();
+	~LLInventorySearchWorker();
+
+	// Called from the main thread.
+	void queue(LLInventorySearchQuery* query);
+
+protected:
+	/*virtual*/ void run();
+	/*virtual*/ bool runCondition();
+
+private:
+	void processQueries();
+
+	// Protected by mRunCondition
+	std::deque<LLPointer<LLInventorySearchQuery> > mQueries;
+};
+
+LLInventorySearchWorker::LLInventorySearchWorker()
+	: LLThread("inventory search")
+{
+}
+
+LLInventorySearchWorker::~LLInventorySearchWorker()
+{
+	shutdown();
+}
+
+void LLInventorySearchWorker::queue(LLInventorySearchQuery* query)
+{
+	lockData();
+	mQueries.push_back(query);
+	unlockData();
+	wake();
+}
+
+//virtual
+bool LLInventorySearchWorker::runCondition()
+{
+	// mRunCondition is locked
+	return !mQueries.empty();
+}
+
+//virtual
+void LLInventorySearchWorker::run()
+{
+	while (1)
+	{
+		// Sleeps until there is something in mQueries or we are quitting.
+		checkPause();
+
+		if (isQuitting())
+		{
+			break;
+		}
+
+		processQueries();
+	}
+}
+
+void LLInventorySearchWorker::processQueries()
+{
+	while (!isQuitting())
+	{
+		LLPointer<LLInventorySearchQuery> query;
+		lockData();
+		if (!mQueries.empty())
+		{
+			query = mQueries.front();
+			mQueries.pop_front();
+		}
+		unlockData();
+
+		if (query.isNull())
+		{
+			break;
+		}
+
+		while (!query->isCancelled() && !isQuitting())
+		{
+			if (query->searchChunk(SEARCH_CHUNK_SIZE))
+			{
+				query->mDone = 1;
+				break;
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------------
+
+LLInventorySearchQuery::Params::Params()
+:	mSearchType(0),
+	mFilterTypes(0xffffffff),
+	mPermissions(PERM_NONE),
+	mMinDate(time_min()),
+	mMaxDate(time_max()),
+	mSkipLinks(true)
+{
+}
+
+LLInventorySearchQuery::LLInventorySearchQuery(const Params& params, LLInventorySearchSnapshot* snapshot, LLInventorySearchQuery* base)
+:	mParams(params),
+	mSnapshot(snapshot),
+	mBase(base),
+	mNextEntry(0),
+	mSearchTime(0.f),
+	mCancelled(0),
+	mDone(0)
+{
+	mMatched.resize(snapshot->mEntries.size(), false);
+}
+
+LLInventorySearchQuery::~LLInventorySearchQuery()
+{
+}
+
+bool LLInventorySearchQuery::canRefine(const Params& params) const
+{
+	if (params.mSearchType != mParams.mSearchType
+		|| (mParams.mSkipLinks && !params.mSkipLinks)
+		|| (params.mFilterTypes & ~mParams.mFilterTypes)
+		|| (mParams.mPermissions & ~params.mPermissions)
+		|| params.mMinDate < mParams.mMinDate
+		|| params.mMaxDate > mParams.mMaxDate)
+	{
+		return false;
+	}
+
+	// Every one of our tokens must be part of one of theirs.
+	for (std::vector<std::string>::const_iterator iter = mParams.mTokens.begin();
+		 iter != mParams.mTokens.end(); ++iter)
+	{
+		bool found = false;
+		for (std::vector<std::string>::const_iterator new_iter = params.mTokens.begin();
+			 new_iter != params.mTokens.end() && !found; ++new_iter)
+		{
+			found = (new_iter->find(*iter) != std::string::npos);
+		}
+		if (!found)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool LLInventorySearchQuery::matchEntry(S32 index)
+{
+	const LLInventorySearchSnapshot::Entry& entry = mSnapshot->mEntries[index];
+
+	// Same tests as LLInventoryFilter::check()
+	if (mParams.mSkipLinks && entry.mIsLink)
+	{
+		return false;
+	}
+	if (entry.mInvType != LLInventoryType::IT_NONE && !((0x1 << entry.mInvType) & mParams.mFilterTypes))
+	{
+		return false;
+	}
+	if ((entry.mPermissions & mParams.mPermissions) != mParams.mPermissions)
+	{
+		return false;
+	}
+	if (entry.mCreationDate < mParams.mMinDate || entry.mCreationDate > mParams.mMaxDate)
+	{
+		return false;
+	}
+	if (mParams.mTokens.empty())
+	{
+		return true;
+	}
+	if (entry.mCreatorPending && (mParams.mSearchType == 1 || mParams.mSearchType == 3))
+	{
+		// The folder view will show whatever the name cache returns later.
+		return true;
+	}
+
+	const std::string& label = mSnapshot->getLabel(entry, mParams.mSearchType, mLabel);
+	for (std::vector<std::string>::const_iterator iter = mParams.mTokens.begin();
+		 iter != mParams.mTokens.end(); ++iter)
+	{
+		if (label.find(*iter) == std::string::npos && !mSnapshot->mayMatchSuffix(entry, *iter))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool LLInventorySearchQuery::searchChunk(S32 count)
+{
+	LLTimer timer;
+	bool done;
+	if (mBase.notNull())
+	{
+		const std::vector<S32>& candidates = mBase->mMatches;
+		S32 end = llmin(mNextEntry + count, (S32)candidates.size());
+		for ( ; mNextEntry < end; ++mNextEntry)
+		{
+			S32 index = candidates[mNextEntry];
+			if (matchEntry(index))
+			{
+				mMatches.push_back(index);
+				mMatched[index] = true;
+				mMatchedParents.insert(mSnapshot->mEntries[index].mParentID);
+			}
+		}
+		done = (mNextEntry >= (S32)candidates.size());
+	}
+	else
+	{
+		S32 end = llmin(mNextEntry + count, (S32)mSnapshot->mEntries.size());
+		for ( ; mNextEntry < end; ++mNextEntry)
+		{
+			if (matchEntry(mNextEntry))
+			{
+				mMatches.push_back(mNextEntry);
+				mMatched[mNextEntry] = true;
+				mMatchedParents.insert(mSnapshot->mEntries[mNextEntry].mParentID);
+			}
+		}
+		done = (mNextEntry >= (S32)mSnapshot->mEntries.size());
+	}
+	mSearchTime += timer.getElapsedTimeF32();
+
+	if (done)
+	{
+		mBase = NULL;
+	}
+	return done;
+}
+
+//----------------------------------------------------------------------------
+
+class LLInventorySearchObserver : public LLInventoryObserver
+{
+public:
+	/*virtual*/ void changed(U32 mask)
+	{
+		LLInventorySearchIndex::getInstance()->itemsChanged(mask);
+	}
+};
+
+LLInventorySearchIndex::LLInventorySearchIndex()
+:	mWorker(NULL),
+	mObserver(new LLInventorySearchObserver)
+{
+	gInventory.addObserver(mObserver);
+}
+
+LLInventorySearchIndex::~LLInventorySearchIndex()
+{
+	if (mPendingSnapshot.notNull())
+	{
+		gIdleCallbacks.deleteFunction(onIdle, this);
+	}
+	gInventory.removeObserver(mObserver);
+	delete mObserver;
+	delete mWorker;
+}
+
+//static
+void LLInventorySearchIndex::cleanupClass()
+{
+	if (instanceExists())
+	{
+		deleteSingleton();
+	}
+}
+
+void LLInventorySearchIndex::itemsChanged(U32 mask)
+{
+	if (mSnapshot.notNull())
+	{
+		mSnapshot->noteChanges(mask);
+	}
+	if (mPendingSnapshot.notNull())
+	{
+		mPendingSnapshot->noteChanges(mask);
+	}
+}
+
+void LLInventorySearchIndex::rebuild()
+{
+	if (mPendingSnapshot.isNull())
+	{
+		gIdleCallbacks.addFunction(onIdle, this);
+	}
+	mPendingSnapshot = new LLInventorySearchSnapshot;
+	mPendingSnapshot->startBuild();
+}
+
+//static
+void LLInventorySearchIndex::onIdle(void* data)
+{
+	LLInventorySearchIndex* self = (LLInventorySearchIndex*)data;
+	if (self->mPendingSnapshot->mNeedsRebuild)
+	{
+		// Changed too much under the walk to be of any use, the next search starts over
+		self->mPendingSnapshot = NULL;
+		gIdleCallbacks.deleteFunction(onIdle, self);
+		return;
+	}
+	if (!self->mPendingSnapshot->buildStep(BUILD_TIME_PER_FRAME))
+	{
+		return;
+	}
+
+	// Searches on the previous snapshot are now stale and get run again
+	self->mSnapshot = self->mPendingSnapshot;
+	self->mPendingSnapshot = NULL;
+	gIdleCallbacks.deleteFunction(onIdle, self);
+	LL_DEBUGS("Inventory") << "Indexed " << self->mSnapshot->mEntries.size() << " items for search in "
+						   << self->mSnapshot->mBuildTime << " seconds" << LL_ENDL;
+}
+
+LLPointer<LLInventorySearchQuery> LLInventorySearchIndex::search(const LLInventorySearchQuery::Params& params, LLInventorySearchQuery* base)
+{
+	if (mPendingSnapshot.isNull()
+		&& (mSnapshot.isNull()
+			|| mSnapshot->mNeedsRebuild
+			|| (S32)mSnapshot->mChanged.size() > llmax(MIN_CHANGES_BEFORE_REBUILD, (S32)mSnapshot->mEntries.size() / CHANGED_FRACTION_BEFORE_REBUILD)))
+	{
+		rebuild();
+	}
+	if (mSnapshot.isNull() || mSnapshot->mNeedsRebuild)
+	{
+		// Nothing trustworthy to search until the new snapshot is built
+		return NULL;
+	}
+
+	if (base && (!base->isDone() || base->mSnapshot.get() != mSnapshot.get() || !base->canRefine(params)))
+	{
+		base = NULL;
+	}
+
+	LLPointer<LLInventorySearchQuery> query = new LLInventorySearchQuery(params, mSnapshot, base);
+	if (!mWorker)
+	{
+		mWorker = new LLInventorySearchWorker;
+		mWorker->start();
+	}
+	mWorker->queue(query);
+	return query;
+}
+
+bool LLInventorySearchIndex::isCandidate(LLInventorySearchQuery* query, const LLUUID& item_id)
+{
+	if (!query || !query->isDone() || query->mSnapshot.get() != mSnapshot.get())
+	{
+		return true;
+	}
+	if (mSnapshot->mChanged.find(item_id) != mSnapshot->mChanged.end())
+	{
+		return true;
+	}
+	LLInventorySearchSnapshot::entry_map_t::const_iterator iter = mSnapshot->mEntryMap.find(item_id);
+	if (iter == mSnapshot->mEntryMap.end())
+	{
+		return true;
+	}
+	return query->mMatched[iter->second];
+}
+
+bool LLInventorySearchIndex::hasCandidatesIn(LLInventorySearchQuery* query, const LLUUID& cat_id)
+{
+	if (!query || !query->isDone() || query->mSnapshot.get() != mSnapshot.get())
+	{
+		return true;
+	}
+	if (mSnapshot->mChangedParents.find(cat_id) != mSnapshot->mChangedParents.end()
+		|| mSnapshot->mIndexedCats.find(cat_id) == mSnapshot->mIndexedCats.end())
+	{
+		return true;
+	}
+	return query->mMatchedParents.find(cat_id) != query->mMatchedParents.end();
+}
+
+bool LLInventorySearchIndex::isStale(LLInventorySearchQuery* query) const
+{
+	return query && query->mSnapshot.get() != mSnapshot.get();
+}
+
+S32 LLInventorySearchIndex::getEntryCount() const
+{
+	return mSnapshot.isNull() ? 0 : (S32)mSnapshot->mEntries.size();
+}
@@ -0,0 +1,177 @@
+/** 
+ * @file llinventorysearchindex.h
+ * @brief Flat inventory search index and background filter queries
+ *
+ * $LicenseInfo:firstyear=2002&license=viewergpl$
+ * 
+ * Copyright (c) 2010, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLINVENTORYSEARCHINDEX_H
+#define LL_LLINVENTORYSEARCHINDEX_H
+
+#include <boost/unordered_set.hpp>
+
+#include "llapr.h"
+#include "llpermissionsflags.h"
+#include "llpointer.h"
+#include "llsingleton.h"
+#include "llthread.h"
+#include "lluuid.h"
+
+class LLInventorySearchSnapshot;
+class LLInventorySearchWorker;
+class LLInventorySearchObserver;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventorySearchQuery
+//
+// One run of an inventory filter over a snapshot of the search index.  The
+// query is scanned by the search thread in chunks and can be cancelled at any
+// point; once isDone() the results may be read from the main thread.
+//
+// The results are a superset of the items LLInventoryFilter::check() passes.
+// Label suffixes that depend on viewer state, such as " (worn)", are not in
+// the index, so items that may carry one are kept and left to check().
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventorySearchQuery : public LLThreadSafeRefCount
+{
+	friend class LLInventorySearchIndex;
+	friend class LLInventorySearchWorker;
+
+public:
+	struct Params
+	{
+		Params();
+
+		// Upper case, every one must be found in the searchable label
+		std::vector<std::string> mTokens;
+		U32				mSearchType;
+		U32				mFilterTypes;
+		PermissionMask	mPermissions;
+		time_t			mMinDate;
+		time_t			mMaxDate;
+		bool			mSkipLinks;
+	};
+
+	const Params& getParams() const { return mParams; }
+
+	// Returns true if every item passing params would also pass ours, so
+	// that only our matches need to be searched again.
+	bool canRefine(const Params& params) const;
+
+	void cancel() { mCancelled = 1; }
+	bool isCancelled() { return mCancelled != 0; }
+	bool isDone() { return mDone != 0; }
+
+	S32 getMatchCount() const { return (S32)mMatches.size(); }
+	F32 getSearchTime() const { return mSearchTime; }
+
+protected:
+	LLInventorySearchQuery(const Params& params, LLInventorySearchSnapshot* snapshot, LLInventorySearchQuery* base);
+	~LLInventorySearchQuery();
+
+	// Called from the search thread, returns true when the query is finished.
+	bool searchChunk(S32 count);
+	bool matchEntry(S32 index);
+
+private:
+	Params mParams;
+	LLPointer<LLInventorySearchSnapshot> mSnapshot;
+
+	// When refining, the matches of a finished query on the same snapshot.
+	// Released as soon as the search is complete.
+	LLPointer<LLInventorySearchQuery> mBase;
+	S32 mNextEntry;
+
+	// Snapshot entry indices that passed, in snapshot order
+	std::vector<S32> mMatches;
+	std::vector<bool> mMatched;
+	// Categories directly containing at least one match
+	boost::unordered_set<LLUUID> mMatchedParents;
+	F32 mSearchTime;
+
+	// Scratch space for labels with a suffix, search thread only
+	std::string mLabel;
+
+	LLAtomic32<S32> mCancelled;
+	LLAtomic32<S32> mDone;
+};
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLInventorySearchIndex
+//
+// Keeps a flat, upper cased copy of the searchable fields of every inventory
+// item so that text filters can be run off the main thread instead of over
+// the folder view hierarchy.  The copy is rebuilt lazily once enough of the
+// inventory has changed; until then changed items are simply not trusted.
+// A rebuild is spread over several frames on idle, and the previous copy is
+// searched in the meantime when it can still be trusted.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLInventorySearchIndex : public LLSingleton<LLInventorySearchIndex>
+{
+	friend class LLInventorySearchObserver;
+
+public:
+	LLInventorySearchIndex();
+	~LLInventorySearchIndex();
+
+	// Queues a search of the current snapshot.  When base is a finished query
+	// on the same snapshot that canRefine() params, only its matches are
+	// searched again.  Returns NULL while there is no usable snapshot yet,
+	// in which case the caller has to filter without the index.
+	LLPointer<LLInventorySearchQuery> search(const LLInventorySearchQuery::Params& params, LLInventorySearchQuery* base = NULL);
+
+	// Returns false only if the finished query proves item_id cannot pass
+	// the filter it was run for.  Items that changed since the snapshot was
+	// taken, or that are not in it, always return true.
+	bool isCandidate(LLInventorySearchQuery* query, const LLUUID& item_id);
+
+	// Returns false only if the finished query proves no item directly in
+	// cat_id can pass.  Categories the snapshot did not walk always return true.
+	bool hasCandidatesIn(LLInventorySearchQuery* query, const LLUUID& cat_id);
+
+	// Returns true if query was run on a snapshot that has since been
+	// replaced, in which case it should be run again.
+	bool isStale(LLInventorySearchQuery* query) const;
+
+	S32 getEntryCount() const;
+
+	static void cleanupClass();
+
+private:
+	void itemsChanged(U32 mask);
+	// Starts building a new snapshot, replacing one already being built.
+	void rebuild();
+	static void onIdle(void* data);
+
+	LLPointer<LLInventorySearchSnapshot> mSnapshot;
+	LLPointer<LLInventorySearchSnapshot> mPendingSnapshot;
+	LLInventorySearchWorker* mWorker;
+	LLInventorySearchObserver* mObserver;
+};
+
+#endif // LL_LLINVENTORYSEARCHINDEX_H
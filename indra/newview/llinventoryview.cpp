@@ -1529,6 +1529,7 @@ BOOL LLInventoryPanel::postBuild()
 	// build everything.
 	mInventoryObserver = new LLInventoryPanelObserver(this);
 	mInventory->addObserver(mInventoryObserver);
+	mFolders->setLazyItemViews(gSavedSettings.getBOOL("InventoryLazyItemViews"));
 	rebuildViewsFor(LLUUID::null, LLInventoryObserver::ADD);
 
 	// bit of a hack to make sure the inventory is open.
@@ -1741,7 +1742,9 @@ void LLInventoryPanel::modelChanged(U32 mask)
 					if (!view_item)
 					{
 						// this object was just created, need to build a view for it
-						if ((mask & LLInventoryObserver::ADD) != LLInventoryObserver::ADD)
+						// (lazy item views legitimately leave items without one)
+						if ((mask & LLInventoryObserver::ADD) != LLInventoryObserver::ADD
+							&& !mFolders->getLazyItemViews())
 						{
 							llwarns << *id_it << " is in model but not in view, but ADD flag not set" << llendl;
 						}
@@ -1764,7 +1767,13 @@ void LLInventoryPanel::modelChanged(U32 mask)
 						}*/ //Kadah: log spam D:
 
 						LLFolderViewFolder* new_parent = (LLFolderViewFolder*)mFolders->getItemByID(model_item->getParentUUID());
-						if (view_item->getParentFolder() != new_parent)
+						if (new_parent && new_parent->getItemsDeferred()
+							&& model_item->getType() != LLAssetType::AT_CATEGORY)
+						{
+							// moved into a folder whose items have not been built yet
+							view_item->destroyView();
+						}
+						else if (view_item->getParentFolder() != new_parent)
 						{
 							view_item->getParentFolder()->extractItem(view_item);
 							view_item->addToFolder(new_parent, mFolders);
@@ -1782,7 +1791,7 @@ void LLInventoryPanel::modelChanged(U32 mask)
 						// item in view but not model, need to delete view
 						view_item->destroyView();
 					}
-					else
+					else if (!mFolders->getLazyItemViews())
 					{
 						llwarns << *id_it << "Item does not exist in either view or model, but notification triggered" << llendl;
 					}
@@ -1814,13 +1823,43 @@ void LLInventoryPanel::rebuildViewsFor(const LLUUID& id, U32 mask)
 	buildNewViews(id);
 }
 
+void LLInventoryPanel::buildItemViews(const LLUUID& cat_id)
+{
+	LLFolderViewFolder* folderp = (LLFolderViewFolder*)mFolders->getItemByID(cat_id);
+	if (!folderp || !folderp->getItemsDeferred())
+	{
+		return;
+	}
+	folderp->setItemsDeferred(FALSE);
+
+	LLViewerInventoryCategory::cat_array_t* categories;
+	LLViewerInventoryItem::item_array_t* items;
+	mInventory->lockDirectDescendentArrays(cat_id, categories, items);
+	if (items)
+	{
+		S32 count = items->count();
+		for (S32 i = 0; i < count; ++i)
+		{
+			LLInventoryItem* item = items->get(i);
+			if (!mFolders->getItemByID(item->getUUID()))
+			{
+				buildNewViews(item->getUUID());
+			}
+		}
+	}
+	mInventory->unlockDirectDescendentArrays(cat_id);
+}
+
 void LLInventoryPanel::buildNewViews(const LLUUID& id)
 {
 	LLFolderViewItem* itemp = NULL;
 	LLInventoryObject* objectp = gInventory.getObject(id);
+	LLFolderViewFolder* folderp = NULL;
 
 	if (objectp)
 	{		
+		LLFolderViewFolder* parent_folder = (LLFolderViewFolder*)mFolders->getItemByID(objectp->getParentUUID());
+
 		if (objectp->getType() <= LLAssetType::AT_NONE ||
 			objectp->getType() >= LLAssetType::AT_COUNT)
 		{
@@ -1839,15 +1878,20 @@ void LLInventoryPanel::buildNewViews(const LLUUID& id)
 
 			if (new_listener)
 			{
-				LLFolderViewFolder* folderp = new LLFolderViewFolder(new_listener->getDisplayName(),
+				folderp = new LLFolderViewFolder(new_listener->getDisplayName(),
 													new_listener->getIcon(),
 													mFolders,
 													new_listener);
 				
 				folderp->setItemSortOrder(mFolders->getSortOrder());
+				folderp->setItemsDeferred(mFolders->getLazyItemViews());
 				itemp = folderp;
 			}
 		}
+		else if (parent_folder && parent_folder->getItemsDeferred())
+		{
+			// built by buildItemViews() when the folder is first needed
+		}
 		else // build new view for item
 		{
 			LLInventoryItem* item = (LLInventoryItem*)objectp;
@@ -1868,8 +1912,6 @@ void LLInventoryPanel::buildNewViews(const LLUUID& id)
 			}
 		}
 
-		LLFolderViewFolder* parent_folder = (LLFolderViewFolder*)mFolders->getItemByID(objectp->getParentUUID());
-
 		if (itemp)
 		{
 			if (parent_folder)
@@ -1900,7 +1942,7 @@ void LLInventoryPanel::buildNewViews(const LLUUID& id)
 				buildNewViews(cat->getUUID());
 			}
 		}
-		if(items)
+		if(items && !(folderp && folderp->getItemsDeferred()))
 		{
 			S32 count = items->count();
 			for(S32 i = 0; i < count; ++i)
@@ -2015,6 +2057,15 @@ void LLInventoryPanel::openDefaultFolderForType(LLAssetType::EType type)
 void LLInventoryPanel::setSelection(const LLUUID& obj_id, BOOL take_keyboard_focus)
 {
 	LLFolderViewItem* itemp = mFolders->getItemByID(obj_id);
+	if (!itemp)
+	{
+		LLInventoryObject* objectp = gInventory.getObject(obj_id);
+		if (objectp)
+		{
+			buildItemViews(objectp->getParentUUID());
+			itemp = mFolders->getItemByID(obj_id);
+		}
+	}
 	if(itemp && itemp->getListener())
 	{
 		itemp->getListener()->arrangeAndSet(itemp, TRUE, take_keyboard_focus);
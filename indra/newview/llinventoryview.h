@@ -141,6 +141,9 @@ public:
 
 	void unSelectAll()	{ mFolders->setSelection(NULL, FALSE, FALSE); }
 
+	// Builds the item views of a folder that was created with them deferred.
+	void buildItemViews(const LLUUID& cat_id);
+
 protected:
 	// Given the id and the parent, build all of the folder views.
 	void rebuildViewsFor(const LLUUID& id, U32 mask);
@@ -33,13 +33,481 @@
 #include "llviewerprecompiledheaders.h"
 
 #include <ctime>
+#include <deque>
 #include "lllogchat.h"
 #include "llappviewer.h"
 #include "llfloaterchat.h"
+#include "llthread.h"
 #include "llviewercontrol.h"
 
 const S32 LOG_RECALL_SIZE = 2048;
 
+// Number of lines shown from logs that have an index.
+const S32 LOG_RECALL_LINES = 32;
+
+// The index sidecar of a log holds the byte offset of every
+// LOG_INDEX_STRIDE'th line, as 8 byte little-endian values.
+const S32 LOG_INDEX_STRIDE = 16;
+const S32 LOG_INDEX_RECORD_SIZE = 8;
+
+// Open log files kept by the writer thread.
+const S32 LOG_MAX_OPEN_FILES = 16;
+
+#if LL_WINDOWS
+static const char LOG_EOL[] = "\r\n";
+#else
+static const char LOG_EOL[] = "\n";
+#endif
+
+static void write_index_record(LLFILE* fp, U64 offset)
+{
+	U8 record[LOG_INDEX_RECORD_SIZE];
+	for (S32 i = 0; i < LOG_INDEX_RECORD_SIZE; ++i)
+	{
+		record[i] = (U8)(offset >> (i * 8));
+	}
+	fwrite(record, 1, LOG_INDEX_RECORD_SIZE, fp);
+}
+
+static bool read_index_record(LLFILE* fp, S32 record_num, U64& offset)
+{
+	U8 record[LOG_INDEX_RECORD_SIZE];
+	if (fseek(fp, record_num * LOG_INDEX_RECORD_SIZE, SEEK_SET) ||
+		fread(record, 1, LOG_INDEX_RECORD_SIZE, fp) != LOG_INDEX_RECORD_SIZE)
+	{
+		return false;
+	}
+	offset = 0;
+	for (S32 i = 0; i < LOG_INDEX_RECORD_SIZE; ++i)
+	{
+		offset |= ((U64)record[i]) << (i * 8);
+	}
+	return true;
+}
+
+static S32 get_index_record_count(LLFILE* fp)
+{
+	if (fseek(fp, 0, SEEK_END))
+	{
+		return 0;
+	}
+	return ftell(fp) / LOG_INDEX_RECORD_SIZE;
+}
+
+// Reads one line without its line ending.  Returns false at the end of the file.
+static bool read_log_line(LLFILE* fp, std::string& line)
+{
+	line.clear();
+	char buffer[LOG_RECALL_SIZE];		/*Flawfinder: ignore*/
+	while (fgets(buffer, LOG_RECALL_SIZE, fp))
+	{
+		line += buffer;
+		if (line[line.size() - 1] == '\n')
+		{
+			break;
+		}
+	}
+	if (line.empty())
+	{
+		return false;
+	}
+	while (!line.empty() && (line[line.size() - 1] == '\n' || line[line.size() - 1] == '\r'))
+	{
+		line.erase(line.size() - 1);
+	}
+	return true;
+}
+
+// Is offset the start of a line in fp?
+static bool is_line_start(LLFILE* fp, U64 offset, U64 size)
+{
+	if (offset == 0)
+	{
+		return true;
+	}
+	if (offset >= size || fseek(fp, (long)(offset - 1), SEEK_SET))
+	{
+		return false;
+	}
+	return fgetc(fp) == '\n';
+}
+
+//----------------------------------------------------------------------------
+
+// Appends log lines and maintains their index sidecars.  Files are kept open
+// and fully buffered; they are only flushed on request.
+class LLLogChatWriter : public LLThread
+{
+public:
+	LLLogChatWriter();
+	~LLLogChatWriter();
+
+	// Called from the main thread.
+	void write(const std::string& filename, const std::string& line);
+	void flush(bool wait);
+	void closeAll();
+
+protected:
+	/*virtual*/ void run();
+	/*virtual*/ bool runCondition();
+
+private:
+	struct Op
+	{
+		enum EType { WRITE, FLUSH, CLOSE };
+		EType mType;
+		std::string mFilename;
+		std::string mLine;
+		bool mFlush;	// flush once this line is written
+		U32 mSerial;
+	};
+
+	struct LogFile
+	{
+		LLFILE* mFile;
+		LLFILE* mIndexFile;
+		U64 mSize;
+		U32 mLines;
+		U32 mLastUse;
+	};
+	typedef std::map<std::string, LogFile> file_map_t;
+
+	void queueOp(Op& op);
+	void processOps();
+	LogFile* openFile(const std::string& filename);
+	void buildIndex(const std::string& filename, LogFile& log);
+	void closeFile(file_map_t::iterator iter);
+	void flushFiles(bool close);
+
+	// Only touched from the writer thread
+	file_map_t mFiles;
+	U32 mUseCounter;
+
+	// Protected by mRunCondition
+	std::deque<Op> mOps;
+	U32 mNextSerial;
+
+	// Signalled when a flush or close request has been done
+	LLCondition mDoneCondition;
+	U32 mDoneSerial;
+};
+
+LLLogChatWriter::LLLogChatWriter()
+	: LLThread("chat log writer"),
+	  mUseCounter(0),
+	  mNextSerial(0),
+	  mDoneSerial(0)
+{
+}
+
+LLLogChatWriter::~LLLogChatWriter()
+{
+	// run() writes out whatever is still queued before it returns.
+	shutdown();
+}
+
+void LLLogChatWriter::queueOp(Op& op)
+{
+	lockData();
+	op.mSerial = ++mNextSerial;
+	mOps.push_back(op);
+	unlockData();
+	wake();
+}
+
+void LLLogChatWriter::write(const std::string& filename, const std::string& line)
+{
+	Op op;
+	op.mType = Op::WRITE;
+	op.mFilename = filename;
+	op.mLine = line;
+	// An interval of 0 means every line goes to disk as it is logged.
+	static LLCachedControl<F32> flush_interval(gSavedSettings, "LogChatFlushInterval");
+	op.mFlush = (flush_interval <= 0.f);
+	queueOp(op);
+}
+
+void LLLogChatWriter::flush(bool wait)
+{
+	Op op;
+	op.mType = Op::FLUSH;
+	op.mFlush = true;
+	queueOp(op);
+
+	if (wait && !isStopped())
+	{
+		mDoneCondition.lock();
+		while (mDoneSerial < op.mSerial && !isStopped())
+		{
+			mDoneCondition.wait();
+		}
+		mDoneCondition.unlock();
+	}
+}
+
+void LLLogChatWriter::closeAll()
+{
+	Op op;
+	op.mType = Op::CLOSE;
+	op.mFlush = true;
+	queueOp(op);
+}
+
+//virtual
+bool LLLogChatWriter::runCondition()
+{
+	// mRunCondition is locked
+	return !mOps.empty();
+}
+
+//virtual
+void LLLogChatWriter::run()
+{
+	while (1)
+	{
+		// Sleeps until there is something in mOps or we are quitting.
+		checkPause();
+
+		if (isQuitting())
+		{
+			break;
+		}
+
+		processOps();
+	}
+	processOps();
+	flushFiles(true);
+
+	// Nobody should be left waiting on a flush.
+	mDoneCondition.lock();
+	mDoneSerial = mNextSerial;
+	mDoneCondition.broadcast();
+	mDoneCondition.unlock();
+}
+
+void LLLogChatWriter::processOps()
+{
+	std::deque<Op> ops;
+	lockData();
+	ops.swap(mOps);
+	unlockData();
+
+	U32 done_serial = 0;
+	bool flush = false;
+	for (std::deque<Op>::iterator iter = ops.begin(); iter != ops.end(); ++iter)
+	{
+		Op& op = *iter;
+		switch (op.mType)
+		{
+		case Op::WRITE:
+			{
+				LogFile* log = openFile(op.mFilename);
+				if (!log)
+				{
+					break;
+				}
+				if (log->mIndexFile && log->mLines % LOG_INDEX_STRIDE == 0)
+				{
+					write_index_record(log->mIndexFile, log->mSize);
+				}
+				fputs(op.mLine.c_str(), log->mFile);
+				fputs(LOG_EOL, log->mFile);
+				log->mSize += op.mLine.size() + strlen(LOG_EOL);		/*Flawfinder: ignore*/
+				log->mLines++;
+				flush |= op.mFlush;
+			}
+			break;
+		case Op::FLUSH:
+			flushFiles(false);
+			done_serial = op.mSerial;
+			break;
+		case Op::CLOSE:
+			flushFiles(true);
+			done_serial = op.mSerial;
+			break;
+		}
+	}
+
+	if (flush)
+	{
+		flushFiles(false);
+	}
+
+	if (done_serial)
+	{
+		mDoneCondition.lock();
+		mDoneSerial = done_serial;
+		mDoneCondition.broadcast();
+		mDoneCondition.unlock();
+	}
+}
+
+LLLogChatWriter::LogFile* LLLogChatWriter::openFile(const std::string& filename)
+{
+	file_map_t::iterator iter = mFiles.find(filename);
+	if (iter != mFiles.end())
+	{
+		iter->second.mLastUse = ++mUseCounter;
+		return &iter->second;
+	}
+
+	if ((S32)mFiles.size() >= LOG_MAX_OPEN_FILES)
+	{
+		// Close the least recently used log.
+		file_map_t::iterator oldest = mFiles.begin();
+		for (iter = mFiles.begin(); iter != mFiles.end(); ++iter)
+		{
+			if (iter->second.mLastUse < oldest->second.mLastUse)
+			{
+				oldest = iter;
+			}
+		}
+		closeFile(oldest);
+	}
+
+	LogFile log;
+	log.mFile = LLFile::fopen(filename, "ab");		/*Flawfinder: ignore*/
+	if (!log.mFile)
+	{
+		llinfos << "Couldn't open chat history log!" << llendl;
+		return NULL;
+	}
+	fseek(log.mFile, 0, SEEK_END);
+	log.mSize = ftell(log.mFile);
+	log.mLines = 0;
+	log.mIndexFile = NULL;
+	log.mLastUse = ++mUseCounter;
+
+	buildIndex(filename, log);
+
+	return &(mFiles[filename] = log);
+}
+
+// Opens the index of a log for appending, and works out how many lines the
+// log has.  The index is rebuilt if it is missing or doesn't match the log.
+void LLLogChatWriter::buildIndex(const std::string& filename, LogFile& log)
+{
+	std::string index_filename = LLLogChat::makeIndexFileName(filename);
+
+	LLFILE* logp = NULL;
+	if (log.mSize)
+	{
+		logp = LLFile::fopen(filename, "rb");		/*Flawfinder: ignore*/
+		if (!logp)
+		{
+			return;
+		}
+	}
+
+	bool valid = false;
+	LLFILE* indexp = LLFile::fopen(index_filename, "rb");		/*Flawfinder: ignore*/
+	if (indexp)
+	{
+		S32 records = get_index_record_count(indexp);
+		U64 offset = 0;
+		if (!records)
+		{
+			valid = (log.mSize == 0);
+		}
+		else if (logp && read_index_record(indexp, records - 1, offset) &&
+				 is_line_start(logp, offset, log.mSize))
+		{
+			// Count the lines after the last indexed one.
+			std::string line;
+			fseek(logp, (long)offset, SEEK_SET);
+			log.mLines = (records - 1) * LOG_INDEX_STRIDE;
+			while (read_log_line(logp, line))
+			{
+				log.mLines++;
+			}
+			valid = true;
+		}
+		fclose(indexp);
+	}
+
+	if (valid)
+	{
+		log.mIndexFile = LLFile::fopen(index_filename, "ab");		/*Flawfinder: ignore*/
+	}
+	else
+	{
+		// Index every line already in the log.
+		log.mIndexFile = LLFile::fopen(index_filename, "wb");		/*Flawfinder: ignore*/
+		log.mLines = 0;
+		if (log.mIndexFile && logp)
+		{
+			fseek(logp, 0, SEEK_SET);
+			std::string line;
+			U64 offset = 0;
+			while (true)
+			{
+				if (log.mLines % LOG_INDEX_STRIDE == 0)
+				{
+					offset = ftell(logp);
+				}
+				if (!read_log_line(logp, line))
+				{
+					break;
+				}
+				if (log.mLines % LOG_INDEX_STRIDE == 0)
+				{
+					write_index_record(log.mIndexFile, offset);
+				}
+				log.mLines++;
+			}
+		}
+	}
+
+	if (logp)
+	{
+		fclose(logp);
+	}
+}
+
+void LLLogChatWriter::closeFile(file_map_t::iterator iter)
+{
+	fclose(iter->second.mFile);
+	if (iter->second.mIndexFile)
+	{
+		fclose(iter->second.mIndexFile);
+	}
+	mFiles.erase(iter);
+}
+
+void LLLogChatWriter::flushFiles(bool close)
+{
+	if (close)
+	{
+		while (!mFiles.empty())
+		{
+			closeFile(mFiles.begin());
+		}
+		return;
+	}
+	for (file_map_t::iterator iter = mFiles.begin(); iter != mFiles.end(); ++iter)
+	{
+		fflush(iter->second.mFile);
+		if (iter->second.mIndexFile)
+		{
+			fflush(iter->second.mIndexFile);
+		}
+	}
+}
+
+static LLLogChatWriter* sLogWriter = NULL;
+
+static LLLogChatWriter* get_log_writer()
+{
+	if (!sLogWriter)
+	{
+		sLogWriter = new LLLogChatWriter;
+		sLogWriter->start();
+	}
+	return sLogWriter;
+}
+
+//----------------------------------------------------------------------------
+
 //static
 std::string LLLogChat::makeLogFileName(std::string filename)
 {
@@ -108,6 +576,13 @@ std::string LLLogChat::timestamp(bool withdate)
 }
 
 
+//static
+std::string LLLogChat::makeIndexFileName(const std::string& log_filename)
+{
+	return gDirUtilp->getDirName(log_filename) + gDirUtilp->getDirDelimiter() +
+		   gDirUtilp->getBaseFileName(log_filename, true) + ".idx";
+}
+
 //static
 void LLLogChat::saveHistory(std::string filename, std::string line)
 {
@@ -119,17 +594,59 @@ void LLLogChat::saveHistory(std::string filename, std::string line)
 	//dont allow bad files names
 	filename = gDirUtilp->getScrubbedFileName(filename);
 
-	LLFILE* fp = LLFile::fopen(LLLogChat::makeLogFileName(filename), "a"); 		/*Flawfinder: ignore*/
-	if (!fp)
+	get_log_writer()->write(LLLogChat::makeLogFileName(filename), line);
+}
+
+//static
+void LLLogChat::idle()
+{
+	static LLCachedControl<F32> flush_interval(gSavedSettings, "LogChatFlushInterval");
+	static LLFrameTimer flush_timer;
+	// With an interval of 0 every line is flushed as it is written already
+	if (sLogWriter && flush_interval > 0.f && flush_timer.getElapsedTimeF32() > flush_interval)
 	{
-		llinfos << "Couldn't open chat history log!" << llendl;
+		sLogWriter->flush(false);
+		flush_timer.reset();
 	}
-	else
+}
+
+//static
+void LLLogChat::cleanupClass()
+{
+	// The destructor stops the thread and writes out what is left.
+	delete sLogWriter;
+	sLogWriter = NULL;
+}
+
+// Positions fptr so that reading to the end returns the last lines of the
+// log, using the index.  Returns false if there is no usable index.
+static bool seek_to_recall_start(LLFILE* fptr, const std::string& index_filename, S32 lines)
+{
+	LLFILE* indexp = LLFile::fopen(index_filename, "rb");		/*Flawfinder: ignore*/
+	if (!indexp)
 	{
-		fprintf(fp, "%s\n", line.c_str());
-		
-		fclose (fp);
+		return false;
+	}
+
+	// Record n is the start of line n * LOG_INDEX_STRIDE.  There are at most
+	// LOG_INDEX_STRIDE lines from the last record to the end of the log.
+	S32 records = get_index_record_count(indexp);
+	S32 record = llmax(0, records - (lines / LOG_INDEX_STRIDE) - 2);
+	U64 offset = 0;
+	bool found = records > 0 && read_index_record(indexp, record, offset);
+	fclose(indexp);
+	if (!found)
+	{
+		return false;
+	}
+
+	fseek(fptr, 0, SEEK_END);
+	U64 size = ftell(fptr);
+	if (!is_line_start(fptr, offset, size))
+	{
+		return false;
 	}
+	return fseek(fptr, (long)offset, SEEK_SET) == 0;
 }
 
 void LLLogChat::loadHistory(std::string filename , void (*callback)(ELogLineType,std::string,void*), void* userdata)
@@ -142,7 +659,14 @@ void LLLogChat::loadHistory(std::string filename , void (*callback)(ELogLineType
 	//dont allow bad files names
 	filename = gDirUtilp->getScrubbedFileName(filename);
 
-	LLFILE* fptr = LLFile::fopen(makeLogFileName(filename), "r");		/*Flawfinder: ignore*/
+	std::string log_filename = makeLogFileName(filename);
+	if (sLogWriter)
+	{
+		// Make sure the lines logged so far are in the file.
+		sLogWriter->flush(true);
+	}
+
+	LLFILE* fptr = LLFile::fopen(log_filename, "rb");		/*Flawfinder: ignore*/
 	if (!fptr)
 	{
 		//LLUIString message = LLFloaterChat::getInstance()->getString("IM_logging_string");
@@ -152,35 +676,51 @@ void LLLogChat::loadHistory(std::string filename , void (*callback)(ELogLineType
 	}
 	else
 	{
-		char buffer[LOG_RECALL_SIZE];		/*Flawfinder: ignore*/
-		char *bptr;
-		S32 len;
-		bool firstline=TRUE;
+		std::deque<std::string> lines;
+		std::string line;
 
-		if ( fseek(fptr, (LOG_RECALL_SIZE - 1) * -1  , SEEK_END) )		
-		{	//File is smaller than recall size.  Get it all.
-			firstline = FALSE;
-			if ( fseek(fptr, 0, SEEK_SET) )
+		if (seek_to_recall_start(fptr, makeIndexFileName(log_filename), LOG_RECALL_LINES))
+		{
+			while (read_log_line(fptr, line))
 			{
-				fclose(fptr);
-				return;
+				lines.push_back(line);
+				if ((S32)lines.size() > LOG_RECALL_LINES)
+				{
+					lines.pop_front();
+				}
 			}
 		}
-
-		while ( fgets(buffer, LOG_RECALL_SIZE, fptr)  && !feof(fptr) ) 
+		else
 		{
-			len = strlen(buffer) - 1;		/*Flawfinder: ignore*/
-			for ( bptr = (buffer + len); (*bptr == '\n' || *bptr == '\r') && bptr>buffer; bptr--)	*bptr='\0';
-			
-			if (!firstline)
-			{
-				callback(LOG_LINE,std::string(buffer),userdata);
+			// No index, recall the last LOG_RECALL_SIZE bytes.
+			bool firstline = true;
+			if ( fseek(fptr, (LOG_RECALL_SIZE - 1) * -1  , SEEK_END) )		
+			{	//File is smaller than recall size.  Get it all.
+				firstline = false;
+				if ( fseek(fptr, 0, SEEK_SET) )
+				{
+					fclose(fptr);
+					return;
+				}
 			}
-			else
+
+			while (read_log_line(fptr, line))
 			{
-				firstline = FALSE;
+				if (!firstline)
+				{
+					lines.push_back(line);
+				}
+				else
+				{
+					firstline = false;
+				}
 			}
 		}
+
+		for (std::deque<std::string>::iterator iter = lines.begin(); iter != lines.end(); ++iter)
+		{
+			callback(LOG_LINE,*iter,userdata);
+		}
 		callback(LOG_END,LLStringUtil::null,userdata);
 		
 		fclose(fptr);
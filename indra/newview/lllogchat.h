@@ -49,6 +49,16 @@ public:
 	static void loadHistory(std::string filename, 
 		                    void (*callback)(ELogLineType,std::string,void*), 
 							void* userdata);
+
+	// Lines are written by a background thread.  idle() asks it to flush
+	// every LogChatFlushInterval seconds, cleanupClass() writes out everything
+	// still buffered and stops it.
+	static void idle();
+	static void cleanupClass();
+
+	// Name of the index sidecar of a log made by makeLogFileName().
+	static std::string makeIndexFileName(const std::string& log_filename);
+
 private:
 	static std::string cleanFileName(std::string filename);
 };
@@ -1012,14 +1012,9 @@ BOOL LLWebBrowserTexture::render()
 			
 			if (width > 0 && height > 0)
 			{
-				U8* data = media_plugin->getBitsData();
-
-				// Offset the pixels pointer to match x_pos and y_pos
-				data += ( x_pos * media_plugin->getTextureDepth() * media_plugin->getBitsWidth() );
-				data += ( y_pos * media_plugin->getTextureDepth() );
-				
+				// setSubImage() offsets the source pointer by x_pos and y_pos itself
 				setSubImage(
-						data, 
+						media_plugin->getBitsData(), 
 						media_plugin->getBitsWidth(), 
 						media_plugin->getBitsHeight(),
 						x_pos, 
@@ -80,6 +80,12 @@
 
 LLMeshRepository gMeshRepo;
 
+static void mesh_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	gMeshRepo.getMemoryUsage(usage);
+}
+static LLMemoryAccount sMeshAccount("Mesh repository", mesh_memory_usage);
+
 const U32 MAX_MESH_REQUESTS_PER_SECOND = 100;
 
 // Maximum mesh version to support.  Three least significant digits are reserved for the minor version, 
@@ -2711,6 +2717,62 @@ S32 LLMeshRepository::getMeshSize(const LLUUID& mesh_id, S32 lod)
 	return -1;
 }
 
+static S64 hull_bytes(const LLModel::hull& hull)
+{
+	return (S64)(hull.capacity() * sizeof(LLVector3));
+}
+
+static S64 physics_mesh_bytes(const LLModel::PhysicsMesh& mesh)
+{
+	return (S64)((mesh.mPositions.capacity() + mesh.mNormals.capacity()) * sizeof(LLVector3));
+}
+
+void LLMeshRepository::getMemoryUsage(LLMemoryAccount::Usage& usage)
+{
+	for (skin_map::iterator iter = mSkinMap.begin(); iter != mSkinMap.end(); ++iter)
+	{
+		const LLMeshSkinInfo& skin = iter->second;
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(skin_map::value_type));
+		for (U32 i = 0; i < skin.mJointNames.size(); ++i)
+		{
+			usage.mBytes += sizeof(std::string) + LLMemoryAccount::stringBytes(skin.mJointNames[i]);
+		}
+		usage.mBytes += (skin.mInvBindMatrix.capacity() + skin.mAlternateBindMatrix.capacity()) * sizeof(LLMatrix4);
+		usage.mBytes += LLMemoryAccount::nodeBytes(skin.mJointMap.size(), sizeof(std::map<std::string, U32>::value_type));
+		usage.mCount++;
+	}
+
+	for (decomposition_map::iterator iter = mDecompositionMap.begin(); iter != mDecompositionMap.end(); ++iter)
+	{
+		const LLModel::Decomposition* decomp = iter->second;
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(decomposition_map::value_type)) + sizeof(LLModel::Decomposition);
+		for (U32 i = 0; i < decomp->mHull.size(); ++i)
+		{
+			usage.mBytes += sizeof(LLModel::hull) + hull_bytes(decomp->mHull[i]);
+		}
+		usage.mBytes += hull_bytes(decomp->mBaseHull);
+		for (U32 i = 0; i < decomp->mMesh.size(); ++i)
+		{
+			usage.mBytes += sizeof(LLModel::PhysicsMesh) + physics_mesh_bytes(decomp->mMesh[i]);
+		}
+		usage.mBytes += physics_mesh_bytes(decomp->mBaseHullMesh) + physics_mesh_bytes(decomp->mPhysicsShapeMesh);
+		usage.mCount++;
+	}
+
+	if (mThread)
+	{
+		// Headers are parsed LLSD, so count what they took on the wire
+		LLMutexLock lock(mThread->mHeaderMutex);
+		for (std::map<LLUUID, U32>::iterator iter = mThread->mMeshHeaderSize.begin();
+			 iter != mThread->mMeshHeaderSize.end(); ++iter)
+		{
+			usage.mBytes += iter->second;
+		}
+		usage.mBytes += LLMemoryAccount::nodeBytes(mThread->mMeshHeader.size(), sizeof(LLMeshRepoThread::mesh_header_map::value_type));
+		usage.mCount += mThread->mMeshHeader.size();
+	}
+}
+
 void LLMeshUploadThread::decomposeMeshMatrix(LLMatrix4& transformation,
 											 LLVector3& result_pos,
 											 LLQuaternion& result_rot,
@@ -35,6 +35,7 @@
 
 #include "llassettype.h"
 #include "llmodel.h"
+#include "llmemoryaccount.h"
 #include "lluuid.h"
 #include "llviewertexture.h"
 #include "llvolume.h"
@@ -503,6 +504,10 @@ public:
 
 	S32 getMeshSize(const LLUUID& mesh_id, S32 lod);
 
+	// Memory held by mesh headers, skin info and physics decompositions.
+	// Mesh volumes themselves are owned by the volume manager.
+	void getMemoryUsage(LLMemoryAccount::Usage& usage);
+
 	typedef std::map<LLVolumeParams, std::set<LLUUID> > mesh_load_map;
 	mesh_load_map mLoadingMeshes[4];
 
@@ -51,6 +51,8 @@
 #include "llfloateravatarinfo.h"
 #include "llfloaterworldmap.h"
 #include "llframetimer.h"
+#include "llpixelunpackbuffer.h"
+#include "llthread.h"
 #include "lltracker.h"
 #include "llmenugl.h"
 #include "llsurface.h"
@@ -87,6 +89,311 @@ const F32 MIN_DOT_RADIUS = 3.5f;
 const F32 DOT_SCALE = 0.75f;
 const F32 MIN_PICK_SCALE = 2.f;
 const S32 MOUSE_DRAG_SLOP = 2;				// How far the mouse needs to move before we think it's a drag
+const S32 OBJECT_TILE_SIZE = 16;			// Texels on a side of the tiles the object image is updated in
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Class LLNetMapRasterizer
+//
+// Draws object footprints into the mini map's object image off the main
+// thread.  The image is split into tiles and each tile remembers a hash of
+// the footprints that touched it, so only tiles where something moved,
+// appeared or went away are drawn again and handed back for upload.
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLNetMapRasterizer : public LLThread
+{
+public:
+	LLNetMapRasterizer();
+	~LLNetMapRasterizer();
+
+	// Called from the main thread.  Takes the contents of points; a job
+	// that has not been started yet is replaced.  A new image serial means
+	// the main thread's image was cleared and everything is drawn again.
+	void queueJob(std::vector<LLNetMapPoint>& points, S32 size, U32 serial, const LLVector3d& center, F32 tpm);
+
+	// Called from the main thread.  Copies the tiles that changed since the
+	// last call into image, which must be size x size RGBA, and appends
+	// their rects.  Returns false if there is no new result for that image.
+	bool getResult(U8* image, S32 size, U32 serial, std::vector<LLRect>& rects, LLVector3d& center, F32& tpm);
+
+protected:
+	/*virtual*/ void run();
+	/*virtual*/ bool runCondition();
+
+private:
+	struct Job
+	{
+		std::vector<LLNetMapPoint> mPoints;
+		S32 mSize;
+		U32 mSerial;
+		LLVector3d mCenter;
+		F32 mTPM;
+	};
+
+	void rasterize(Job& job);
+
+	// Only touched from the rasterizer thread
+	S32 mSize;
+	U32 mSerial;
+	std::vector<U32> mImage;
+	std::vector<U64> mTileHashes;
+	std::vector<std::vector<S32> > mTilePoints;
+	std::vector<bool> mTileDirty;
+
+	// Protected by mRunCondition
+	Job mJob;
+	bool mHasJob;
+	U32 mResultSerial;
+	std::vector<U32> mResultImage;
+	std::vector<bool> mResultDirty;
+	LLVector3d mResultCenter;
+	F32 mResultTPM;
+	bool mHasResult;
+};
+
+// Hash of a tile that no footprint touches
+const U64 EMPTY_TILE_HASH = 14695981039346656037ULL;
+
+static inline void hash_int(U64& hash, U32 value)
+{
+	for (S32 i = 0; i < 4; ++i)
+	{
+		hash ^= (value >> (i * 8)) & 0xff;
+		hash *= 1099511628211ULL;
+	}
+}
+
+LLNetMapRasterizer::LLNetMapRasterizer()
+	: LLThread("mini map rasterizer"),
+	  mSize(0),
+	  mSerial(0),
+	  mHasJob(false),
+	  mResultSerial(0),
+	  mResultTPM(1.f),
+	  mHasResult(false)
+{
+}
+
+LLNetMapRasterizer::~LLNetMapRasterizer()
+{
+	shutdown();
+}
+
+void LLNetMapRasterizer::queueJob(std::vector<LLNetMapPoint>& points, S32 size, U32 serial, const LLVector3d& center, F32 tpm)
+{
+	lockData();
+	mJob.mPoints.swap(points);
+	mJob.mSize = size;
+	mJob.mSerial = serial;
+	mJob.mCenter = center;
+	mJob.mTPM = tpm;
+	mHasJob = true;
+	unlockData();
+	wake();
+	points.clear();
+}
+
+bool LLNetMapRasterizer::getResult(U8* image, S32 size, U32 serial, std::vector<LLRect>& rects, LLVector3d& center, F32& tpm)
+{
+	lockData();
+	if (!mHasResult || mResultSerial != serial)
+	{
+		unlockData();
+		return false;
+	}
+
+	S32 tiles = size / OBJECT_TILE_SIZE;
+	U32* dest = (U32*)image;
+	for (S32 ty = 0; ty < tiles; ++ty)
+	{
+		S32 run_start = -1;
+		for (S32 tx = 0; tx <= tiles; ++tx)
+		{
+			bool dirty = tx < tiles && mResultDirty[ty * tiles + tx];
+			if (dirty)
+			{
+				S32 left = tx * OBJECT_TILE_SIZE;
+				for (S32 y = ty * OBJECT_TILE_SIZE; y < (ty + 1) * OBJECT_TILE_SIZE; ++y)
+				{
+					memcpy(dest + y * size + left, &mResultImage[y * size + left], OBJECT_TILE_SIZE * sizeof(U32));
+				}
+				mResultDirty[ty * tiles + tx] = false;
+				if (run_start < 0)
+				{
+					run_start = tx;
+				}
+			}
+			else if (run_start >= 0)
+			{
+				// One rect per run of dirty tiles along a row
+				rects.push_back(LLRect(run_start * OBJECT_TILE_SIZE, (ty + 1) * OBJECT_TILE_SIZE,
+									   tx * OBJECT_TILE_SIZE, ty * OBJECT_TILE_SIZE));
+				run_start = -1;
+			}
+		}
+	}
+	center = mResultCenter;
+	tpm = mResultTPM;
+	mHasResult = false;
+	unlockData();
+	return true;
+}
+
+//virtual
+bool LLNetMapRasterizer::runCondition()
+{
+	// mRunCondition is locked
+	return mHasJob;
+}
+
+//virtual
+void LLNetMapRasterizer::run()
+{
+	Job job;
+	while (1)
+	{
+		// Sleeps until there is a job or we are quitting.
+		checkPause();
+
+		if (isQuitting())
+		{
+			break;
+		}
+
+		lockData();
+		bool has_job = mHasJob;
+		if (has_job)
+		{
+			job.mPoints.swap(mJob.mPoints);
+			job.mSize = mJob.mSize;
+			job.mSerial = mJob.mSerial;
+			job.mCenter = mJob.mCenter;
+			job.mTPM = mJob.mTPM;
+			mHasJob = false;
+		}
+		unlockData();
+
+		if (has_job)
+		{
+			rasterize(job);
+		}
+	}
+}
+
+void LLNetMapRasterizer::rasterize(Job& job)
+{
+	const S32 size = job.mSize;
+	const S32 tiles = size / OBJECT_TILE_SIZE;
+	if (job.mSerial != mSerial)
+	{
+		// A new image starts out clear, as does the one on the main thread.
+		mSize = size;
+		mSerial = job.mSerial;
+		mImage.assign(size * size, 0);
+		mTileHashes.assign(tiles * tiles, EMPTY_TILE_HASH);
+		mTilePoints.clear();
+		mTilePoints.resize(tiles * tiles);
+	}
+
+	// Bin the footprints into the tiles they touch, in drawing order, and
+	// hash what each tile will hold.
+	std::vector<U64> hashes(tiles * tiles, EMPTY_TILE_HASH);
+	for (S32 t = 0; t < tiles * tiles; ++t)
+	{
+		mTilePoints[t].clear();
+	}
+	for (S32 i = 0; i < (S32)job.mPoints.size(); ++i)
+	{
+		const LLNetMapPoint& point = job.mPoints[i];
+		S32 neg_radius = point.mDiameter / 2;
+		S32 pos_radius = point.mDiameter - neg_radius;
+		S32 left = llmax(point.mX - neg_radius, 0);
+		S32 right = llmin(point.mX + pos_radius, size);
+		S32 bottom = llmax(point.mY - neg_radius, 0);
+		S32 top = llmin(point.mY + pos_radius, size);
+		if (left >= right || bottom >= top)
+		{
+			continue;
+		}
+		for (S32 ty = bottom / OBJECT_TILE_SIZE; ty <= (top - 1) / OBJECT_TILE_SIZE; ++ty)
+		{
+			for (S32 tx = left / OBJECT_TILE_SIZE; tx <= (right - 1) / OBJECT_TILE_SIZE; ++tx)
+			{
+				S32 t = ty * tiles + tx;
+				mTilePoints[t].push_back(i);
+				hash_int(hashes[t], left);
+				hash_int(hashes[t], right);
+				hash_int(hashes[t], bottom);
+				hash_int(hashes[t], top);
+				hash_int(hashes[t], point.mColor);
+			}
+		}
+	}
+
+	// Redraw the tiles whose contents changed
+	mTileDirty.assign(tiles * tiles, false);
+	for (S32 t = 0; t < tiles * tiles; ++t)
+	{
+		if (hashes[t] == mTileHashes[t])
+		{
+			continue;
+		}
+		mTileHashes[t] = hashes[t];
+		mTileDirty[t] = true;
+
+		S32 tile_left = (t % tiles) * OBJECT_TILE_SIZE;
+		S32 tile_bottom = (t / tiles) * OBJECT_TILE_SIZE;
+		for (S32 y = tile_bottom; y < tile_bottom + OBJECT_TILE_SIZE; ++y)
+		{
+			memset(&mImage[y * size + tile_left], 0, OBJECT_TILE_SIZE * sizeof(U32));
+		}
+		for (std::vector<S32>::iterator iter = mTilePoints[t].begin(); iter != mTilePoints[t].end(); ++iter)
+		{
+			const LLNetMapPoint& point = job.mPoints[*iter];
+			S32 neg_radius = point.mDiameter / 2;
+			S32 pos_radius = point.mDiameter - neg_radius;
+			S32 left = llmax(point.mX - neg_radius, tile_left);
+			S32 right = llmin(point.mX + pos_radius, tile_left + OBJECT_TILE_SIZE);
+			S32 bottom = llmax(point.mY - neg_radius, tile_bottom);
+			S32 top = llmin(point.mY + pos_radius, tile_bottom + OBJECT_TILE_SIZE);
+			for (S32 y = bottom; y < top; ++y)
+			{
+				U32* row = &mImage[y * size];
+				for (S32 x = left; x < right; ++x)
+				{
+					row[x] = point.mColor;
+				}
+			}
+		}
+	}
+
+	// Hand the changed tiles over.  Tiles left dirty by a result the main
+	// thread has not picked up yet stay dirty.
+	lockData();
+	if (mResultSerial != job.mSerial)
+	{
+		mResultSerial = job.mSerial;
+		mResultImage.assign(size * size, 0);
+		mResultDirty.assign(tiles * tiles, false);
+	}
+	for (S32 t = 0; t < tiles * tiles; ++t)
+	{
+		if (!mTileDirty[t])
+		{
+			continue;
+		}
+		S32 tile_left = (t % tiles) * OBJECT_TILE_SIZE;
+		S32 tile_bottom = (t / tiles) * OBJECT_TILE_SIZE;
+		for (S32 y = tile_bottom; y < tile_bottom + OBJECT_TILE_SIZE; ++y)
+		{
+			memcpy(&mResultImage[y * size + tile_left], &mImage[y * size + tile_left], OBJECT_TILE_SIZE * sizeof(U32));
+		}
+		mResultDirty[t] = true;
+	}
+	mResultCenter = job.mCenter;
+	mResultTPM = job.mTPM;
+	mHasResult = true;
+	unlockData();
+}
 
 LLNetMap::LLNetMap(const std::string& name) :
 	LLPanel(name),
@@ -97,13 +404,18 @@ LLNetMap::LLNetMap(const std::string& name) :
 	mTargetPanY( 0.f ),
 	mCurPanX( 0.f ),
 	mCurPanY( 0.f ),
-	mUpdateNow( FALSE )
+	mUpdateNow( FALSE ),
+	mObjectImageTPM( 1.f ),
+	mObjectImageSerial( 0 ),
+	mRasterizer( NULL ),
+	mPixelBuffer( NULL )
 {
 	mScale = gSavedSettings.getF32("MiniMapScale");
 	mPixelsPerMeter = mScale / LLWorld::getInstance()->getRegionWidthInMeters();
 	mDotRadius = llmax(DOT_SCALE * mPixelsPerMeter, MIN_DOT_RADIUS);
 
 	mObjectImageCenterGlobal = gAgent.getCameraPositionGlobal();
+	mObjectPointsCenterGlobal = mObjectImageCenterGlobal;
 	
 	// Register event listeners for popup menu
 	(new LLScaleMap())->registerListener(this, "MiniMap.ZoomLevel");
@@ -135,6 +447,10 @@ LLNetMap::LLNetMap(const std::string& name) :
 
 LLNetMap::~LLNetMap()
 {
+	delete mRasterizer;
+	mRasterizer = NULL;
+	delete mPixelBuffer;
+	mPixelBuffer = NULL;
 }
 
 void LLNetMap::setScale( F32 scale )
@@ -308,7 +624,7 @@ void LLNetMap::draw()
 			gGL.setAlphaRejectSettings(LLRender::CF_DEFAULT);
 		}
 
-		// Redraw object layer periodically
+		// Gather the object layer periodically, it is drawn on the rasterizer thread
 		if (mUpdateNow || (map_timer.getElapsedTimeF32() > 0.5f))
 		{
 			mUpdateNow = FALSE;
@@ -318,25 +634,26 @@ void LLNetMap::draw()
 			new_center.mV[0] -= mCurPanX;
 			new_center.mV[1] -= mCurPanY;
 			new_center.mV[2] = 0.f;
-			mObjectImageCenterGlobal = viewPosToGlobal(llround(new_center.mV[0]), llround(new_center.mV[1]), rotate_map);
-
-			// Create the base texture.
-			U8 *default_texture = mObjectRawImagep->getData();
-			memset( default_texture, 0, mObjectImagep->getWidth() * mObjectImagep->getHeight() * mObjectImagep->getComponents() );
+			mObjectPointsCenterGlobal = viewPosToGlobal(llround(new_center.mV[0]), llround(new_center.mV[1]), rotate_map);
 
 			// Draw buildings
-			//gObjectList.renderObjectsForMap(*this);
+			mObjectPoints.clear();
 			LLCachedControl<bool> mm_fastminimap(gSavedSettings, "mm_fastminimap");
 			if (!mm_fastminimap)
 			{
 				gObjectList.renderObjectsForMap(*this);
-				mObjectImagep->setSubImage(mObjectRawImagep, 0, 0, mObjectImagep->getWidth(), mObjectImagep->getHeight());
 			}
 
-			mObjectImagep->setSubImage(mObjectRawImagep, 0, 0, mObjectImagep->getWidth(), mObjectImagep->getHeight());
+			if (!mRasterizer)
+			{
+				mRasterizer = new LLNetMapRasterizer;
+				mRasterizer->start();
+			}
+			mRasterizer->queueJob(mObjectPoints, mObjectImagep->getWidth(), mObjectImageSerial, mObjectPointsCenterGlobal, mObjectMapTPM);
 			
 			map_timer.reset();
 		}
+		updateObjectImage();
 
 		LLVector3 map_center_agent = gAgent.getPosAgentFromGlobal(mObjectImageCenterGlobal);
 		map_center_agent -= gAgent.getCameraPositionAgent();
@@ -344,8 +661,10 @@ void LLNetMap::draw()
 		map_center_agent.mV[VY] *= mScale/region_width;
 
 		gGL.getTexUnit(0)->bind(mObjectImagep);
-		F32 image_half_width = 0.5f*mObjectMapPixels;
-		F32 image_half_height = 0.5f*mObjectMapPixels;
+		// Sized by the scale the image was drawn at, which lags a zoom until
+		// the rasterizer catches up.
+		F32 image_half_width = 0.5f * mObjectImagep->getWidth() / mObjectImageTPM * mScale / region_width;
+		F32 image_half_height = image_half_width;
 
 		gGL.begin(LLRender::QUADS);
 			gGL.texCoord2f(0.f, 1.f);
@@ -772,21 +1091,14 @@ void LLNetMap::updateMinorDirections()
 void LLNetMap::renderScaledPointGlobal( const LLVector3d& pos, const LLColor4U &color, F32 radius_meters )
 {
 	LLVector3 local_pos;
-	local_pos.setVec( pos - mObjectImageCenterGlobal );
+	local_pos.setVec( pos - mObjectPointsCenterGlobal );
 
 	// DEV-17370 - megaprims of size > 4096 cause lag.  (go figger.)
 	const F32 MAX_RADIUS = 256.0f;
 	F32 radius_clamped = llmin(radius_meters, MAX_RADIUS);
 	
 	S32 diameter_pixels = llround(2 * radius_clamped * mObjectMapTPM);
-	renderPoint( local_pos, color, diameter_pixels );
-}
-
-
-void LLNetMap::renderPoint(const LLVector3 &pos_local, const LLColor4U &color, 
-						   S32 diameter, S32 relative_height)
-{
-	if (diameter <= 0)
+	if (diameter_pixels <= 0)
 	{
 		return;
 	}
@@ -794,8 +1106,8 @@ void LLNetMap::renderPoint(const LLVector3 &pos_local, const LLColor4U &color,
 	const S32 image_width = (S32)mObjectImagep->getWidth();
 	const S32 image_height = (S32)mObjectImagep->getHeight();
 
-	S32 x_offset = llround(pos_local.mV[VX] * mObjectMapTPM + image_width / 2);
-	S32 y_offset = llround(pos_local.mV[VY] * mObjectMapTPM + image_height / 2);
+	S32 x_offset = llround(local_pos.mV[VX] * mObjectMapTPM + image_width / 2);
+	S32 y_offset = llround(local_pos.mV[VY] * mObjectMapTPM + image_height / 2);
 
 	if ((x_offset < 0) || (x_offset >= image_width))
 	{
@@ -806,65 +1118,31 @@ void LLNetMap::renderPoint(const LLVector3 &pos_local, const LLColor4U &color,
 		return;
 	}
 
-	U8 *datap = mObjectRawImagep->getData();
-
-	S32 neg_radius = diameter / 2;
-	S32 pos_radius = diameter - neg_radius;
-	S32 x, y;
+	LLNetMapPoint point;
+	point.mX = x_offset;
+	point.mY = y_offset;
+	point.mDiameter = diameter_pixels;
+	point.mColor = color.asRGBA();
+	mObjectPoints.push_back(point);
+}
 
-	if (relative_height > 0)
+void LLNetMap::updateObjectImage()
+{
+	if (!mRasterizer)
 	{
-		// ...point above agent
-		S32 px, py;
-
-		// vertical line
-		px = x_offset;
-		for (y = -neg_radius; y < pos_radius; y++)
-		{
-			py = y_offset + y;
-			if ((py < 0) || (py >= image_height))
-			{
-				continue;
-			}
-			S32 offset = px + py * image_width;
-			((U32*)datap)[offset] = color.asRGBA();
-		}
-
-		// top line
-		py = y_offset + pos_radius - 1;
-		for (x = -neg_radius; x < pos_radius; x++)
-		{
-			px = x_offset + x;
-			if ((px < 0) || (px >= image_width))
-			{
-				continue;
-			}
-			S32 offset = px + py * image_width;
-			((U32*)datap)[offset] = color.asRGBA();
-		}
+		return;
 	}
-	else
+
+	mDirtyRects.clear();
+	S32 size = mObjectImagep->getWidth();
+	if (mRasterizer->getResult(mObjectRawImagep->getData(), size, mObjectImageSerial, mDirtyRects, mObjectImageCenterGlobal, mObjectImageTPM)
+		&& !mDirtyRects.empty())
 	{
-		// ...point level with agent
-		for (x = -neg_radius; x < pos_radius; x++)
+		if (!mPixelBuffer)
 		{
-			S32 p_x = x_offset + x;
-			if ((p_x < 0) || (p_x >= image_width))
-			{
-				continue;
-			}
-
-			for (y = -neg_radius; y < pos_radius; y++)
-			{
-				S32 p_y = y_offset + y;
-				if ((p_y < 0) || (p_y >= image_height))
-				{
-					continue;
-				}
-				S32 offset = p_x + p_y * image_width;
-				((U32*)datap)[offset] = color.asRGBA();
-			}
+			mPixelBuffer = new LLPixelUnpackBuffer;
 		}
+		mObjectImagep->setSubImages(*mPixelBuffer, mObjectRawImagep->getData(), size, size, mDirtyRects);
 	}
 }
 
@@ -885,6 +1163,7 @@ void LLNetMap::createObjectImage()
 		img_size <<= 1;
 	}
 
+	bool recreated = false;
 	if( mObjectImagep.isNull() ||
 		(mObjectImagep->getWidth() != img_size) ||
 		(mObjectImagep->getHeight() != img_size) )
@@ -893,8 +1172,14 @@ void LLNetMap::createObjectImage()
 		U8* data = mObjectRawImagep->getData();
 		memset( data, 0, img_size * img_size * 4 );
 		mObjectImagep = LLViewerTextureManager::getLocalTexture(mObjectRawImagep.get(), FALSE);
+		mObjectImageSerial++;
+		recreated = true;
 	}
 	setScale(mScale);
+	if (recreated)
+	{
+		mObjectImageTPM = mObjectMapTPM;
+	}
 	mUpdateNow = TRUE;
 }
 
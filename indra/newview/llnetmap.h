@@ -42,6 +42,18 @@
 
 class LLTextBox;
 class LLViewerTexture;
+class LLNetMapRasterizer;
+class LLPixelUnpackBuffer;
+
+// An object footprint on the mini map: a square of mDiameter texels of the
+// object image, centred on mX, mY.
+struct LLNetMapPoint
+{
+	S32 mX;
+	S32 mY;
+	S32 mDiameter;
+	U32 mColor;
+};
 
 typedef enum e_minimap_center
 {
@@ -65,6 +77,8 @@ public:
 	virtual BOOL	handleScrollWheel(S32 x, S32 y, S32 clicks);
 	virtual BOOL	handleToolTip( S32 x, S32 y, std::string& msg, LLRect* sticky_rect_screen );
 
+	// Adds an object to the footprints gathered for the next object image.
+	// The image itself is drawn on the rasterizer thread.
 	void			renderScaledPointGlobal( const LLVector3d& pos, const LLColor4U &color, F32 radius );
 
 	static void mm_setcolor(LLUUID key,LLColor4 col); //moymod
@@ -77,8 +91,6 @@ private:
 	void			translatePan( F32 delta_x, F32 delta_y );
 	void			setPan( F32 x, F32 y )			{ mTargetPanX = x; mTargetPanY = y; }
 
-	void renderPoint(const LLVector3 &pos, const LLColor4U &color, 
-					 S32 diameter, S32 relative_height = 0);
 	LLVector3		globalPosToView(const LLVector3d& global_pos, BOOL rotated);
 	LLVector3d		viewPosToGlobal(S32 x,S32 y, BOOL rotated);
 
@@ -90,6 +102,7 @@ private:
 	void			setDirectionPos( LLTextBox* text_box, F32 rotation );
 	void			updateMinorDirections();
 	void			createObjectImage();
+	void			updateObjectImage();
 
 	LLHandle<LLView>	mPopupMenuHandle;
 
@@ -110,10 +123,18 @@ private:
 	S32				mMouseDownY;
 
 	BOOL						mUpdateNow;
-	LLVector3d					mObjectImageCenterGlobal;
+	LLVector3d					mObjectImageCenterGlobal;	// where the object image currently shows
+	F32							mObjectImageTPM;			// and at what scale
+	U32							mObjectImageSerial;			// bumped whenever the image is recreated
 	LLPointer<LLImageRaw>		mObjectRawImagep;
 	LLPointer<LLViewerTexture>	mObjectImagep;
 
+	std::vector<LLNetMapPoint>	mObjectPoints;				// gathered for the next rasterization
+	LLVector3d					mObjectPointsCenterGlobal;
+	LLNetMapRasterizer*			mRasterizer;
+	LLPixelUnpackBuffer*		mPixelBuffer;
+	std::vector<LLRect>			mDirtyRects;
+
 private:
 	LLUUID			mClosestAgentToCursor;
 	LLVector3d		mClosestAgentPosition;
@@ -74,6 +74,8 @@ LLPanelGroupGeneral::LLPanelGroupGeneral(const std::string& name,
 										 const LLUUID& group_id)
 :	LLPanelGroupTab(name, group_id),
 	mPendingMemberUpdate(FALSE),
+	mMemberProgress(0),
+	mMemberGeneration(0),
 	mChanged(FALSE),
 	mFirstUse(TRUE),
 	mGroupNameEditor(NULL),
@@ -818,11 +820,22 @@ void LLPanelGroupGeneral::update(LLGroupChange gc)
 	
 	if (mListVisibleMembers)
 	{
+		if (gc == GC_MEMBER_DATA
+			&& mMemberProgress > 0
+			&& mMemberGeneration == gdatap->getMemberGeneration()
+			&& mMemberProgress <= (S32)gdatap->mMemberOrder.size())
+		{
+			// More members arrived, append them after the rows already listed
+			mPendingMemberUpdate = TRUE;
+			return;
+		}
+
 		mListVisibleMembers->deleteAllItems();
+		mMemberProgress = 0;
+		mMemberGeneration = gdatap->getMemberGeneration();
 
-		if (gdatap->isMemberDataComplete())
+		if (!gdatap->mMemberOrder.empty())
 		{
-			mMemberProgress = gdatap->mMembers.begin();
 			mPendingMemberUpdate = TRUE;
 
 			sSDTime = 0.0f;
@@ -849,12 +862,19 @@ void LLPanelGroupGeneral::updateMembers()
 
 	LLGroupMgrGroupData* gdatap = LLGroupMgr::getInstance()->getGroupData(mGroupID);
 
-	if (!mListVisibleMembers || !gdatap 
-		|| !gdatap->isMemberDataComplete() || gdatap->mMembers.empty())
+	if (!mListVisibleMembers || !gdatap || gdatap->mMemberOrder.empty())
 	{
 		return;
 	}
 
+	if (mMemberGeneration != gdatap->getMemberGeneration())
+	{
+		// The member request was restarted, the rows listed so far are stale
+		mListVisibleMembers->deleteAllItems();
+		mMemberProgress = 0;
+		mMemberGeneration = gdatap->getMemberGeneration();
+	}
+
 	static LLTimer all_timer;
 	static LLTimer sd_timer;
 	static LLTimer element_timer;
@@ -863,11 +883,14 @@ void LLPanelGroupGeneral::updateMembers()
 	S32 i = 0;
 
 
-	for( ; mMemberProgress != gdatap->mMembers.end() && i<UPDATE_MEMBERS_PER_FRAME; 
+	// Members are listed in the order received, so rows can be added while
+	// the rest of the group is still arriving
+	S32 received = (S32)gdatap->mMemberOrder.size();
+	for( ; mMemberProgress < received && i<UPDATE_MEMBERS_PER_FRAME; 
 			++mMemberProgress, ++i)
 	{
 		//llinfos << "Adding " << iter->first << ", " << iter->second->getTitle() << llendl;
-		LLGroupMemberData* member = mMemberProgress->second;
+		LLGroupMemberData* member = gdatap->mMemberOrder[mMemberProgress];
 		if (!member)
 		{
 			continue;
@@ -904,7 +927,12 @@ void LLPanelGroupGeneral::updateMembers()
 	sAllTime += all_timer.getElapsedTimeF32();
 
 	llinfos << "Updated " << i << " of " << UPDATE_MEMBERS_PER_FRAME << "members in the list." << llendl;
-	if (mMemberProgress == gdatap->mMembers.end())
+	if (mMemberProgress < received)
+	{
+		mPendingMemberUpdate = TRUE;
+		mListVisibleMembers->setEnabled(FALSE);
+	}
+	else if (gdatap->isMemberDataComplete())
 	{
 		llinfos << "   member list completed." << llendl;
 		mListVisibleMembers->setEnabled(TRUE);
@@ -915,7 +943,8 @@ void LLPanelGroupGeneral::updateMembers()
 	}
 	else
 	{
-		mPendingMemberUpdate = TRUE;
+		// Caught up with the members received so far, update() will
+		// resume when the next GC_MEMBER_DATA arrives
 		mListVisibleMembers->setEnabled(FALSE);
 	}
 }
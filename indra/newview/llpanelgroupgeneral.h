@@ -112,7 +112,10 @@ private:
 	LLComboBox		*mComboActiveTitle;
 	LLComboBox		*mComboMature;
 
-	LLGroupMgrGroupData::member_list_t::iterator mMemberProgress;
+	// Index into LLGroupMgrGroupData::mMemberOrder of the next member to list
+	S32				mMemberProgress;
+	// LLGroupMgrGroupData::getMemberGeneration() of the listed members
+	U32				mMemberGeneration;
 };
 
 #endif
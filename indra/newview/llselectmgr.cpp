@@ -236,6 +236,7 @@ void LLSelectMgr::clearSelections()
 	mSelectedObjects->deleteAllNodes();
 	mHighlightedObjects->deleteAllNodes();
 	mRectSelectedObjects.clear();
+	mPendingSelects.clear();
 	mGridObjects.deleteAllNodes();
 }
 
@@ -337,14 +338,7 @@ LLObjectSelectionHandle LLSelectMgr::selectObjectOnly(LLViewerObject* object, S3
 
 	// Always send to simulator, so you get a copy of the 
 	// permissions structure back.
-	gMessageSystem->newMessageFast(_PREHASH_ObjectSelect);
-	gMessageSystem->nextBlockFast(_PREHASH_AgentData);
-	gMessageSystem->addUUIDFast(_PREHASH_AgentID, gAgent.getID() );
-	gMessageSystem->addUUIDFast(_PREHASH_SessionID, gAgent.getSessionID());
-	gMessageSystem->nextBlockFast(_PREHASH_ObjectData);
-	gMessageSystem->addU32Fast(_PREHASH_ObjectLocalID, object->getLocalID() );
-	LLViewerRegion* regionp = object->getRegion();
-	gMessageSystem->sendReliable( regionp->getHost());
+	queueSelect(object);
 
 	updatePointAt();
 	updateSelectionCenter();
@@ -414,7 +408,11 @@ LLObjectSelectionHandle LLSelectMgr::selectObjectAndFamily(LLViewerObject* obj,
 
 	// Always send to simulator, so you get a copy of the permissions
 	// structure back.
-	sendSelect();
+	for (std::vector<LLViewerObject*>::iterator iter = objects.begin();
+		 iter != objects.end(); ++iter)
+	{
+		queueSelect(*iter);
+	}
 
 	// Stop the object from moving (this anticipates changes on the
 	// simulator in LLTask::userSelect)
@@ -490,7 +488,11 @@ LLObjectSelectionHandle LLSelectMgr::selectObjectAndFamily(const std::vector<LLV
 	// all the objects on a sim.
 	if (send_to_sim)
 	{
-		sendSelect();
+		for (std::vector<LLViewerObject*>::iterator iter = objects.begin();
+			 iter != objects.end(); ++iter)
+		{
+			queueSelect(*iter);
+		}
 	}
 
 	// leave component mode
@@ -602,6 +604,8 @@ void LLSelectMgr::deselectObjectAndFamily(LLViewerObject* object, BOOL send_to_s
 
 	if (!send_to_sim) return;
 
+	sendPendingSelects();
+
 	//-----------------------------------------------------------
 	// Inform simulator of deselection
 	//-----------------------------------------------------------
@@ -664,6 +668,8 @@ void LLSelectMgr::deselectObjectOnly(LLViewerObject* object, BOOL send_to_sim)
 
 	if (send_to_sim && object->getPositionRegion().mV[VZ] < 4096.0)
 	{
+		sendPendingSelects();
+
 		LLViewerRegion* region = object->getRegion();
 		gMessageSystem->newMessageFast(_PREHASH_ObjectDeselect);
 		gMessageSystem->nextBlockFast(_PREHASH_AgentData);
@@ -1010,15 +1016,11 @@ LLObjectSelectionHandle LLSelectMgr::selectHighlightedObjects()
 
 		mSelectedObjects->mSelectType = getSelectTypeForObject(objectp);
 
-		// request properties on root objects
-		if (objectp->isRootEdit())
-		{
-			requestObjectPropertiesFamily(objectp);
-		}
+		// let sim know this object is selected.  The ObjectProperties reply
+		// carries everything a per root RequestObjectPropertiesFamily would,
+		// and unlike it can be packed many objects to a message.
+		queueSelect(objectp);
 	}
-
-	// pack up messages to let sim know these objects are selected
-	sendSelect();
 	unhighlightAll();
 	updateSelectionCenter();
 	saveSelectedObjectTransform(SELECT_ACTION_TYPE_PICK);
@@ -3888,8 +3890,75 @@ void LLSelectMgr::packHingeHead(void *user_data)
 }
 #endif
 
+void LLSelectMgr::queueSelect(LLViewerObject* object)
+{
+	mPendingSelects.insert(object);
+}
+
+void LLSelectMgr::sendPendingSelects()
+{
+	if (mPendingSelects.empty())
+	{
+		return;
+	}
+
+	// Group by region so that each one gets as few packets as possible
+	typedef std::map<LLViewerRegion*, std::vector<U32> > region_ids_t;
+	region_ids_t region_ids;
+	for (std::set<LLPointer<LLViewerObject> >::iterator iter = mPendingSelects.begin();
+		 iter != mPendingSelects.end(); ++iter)
+	{
+		LLViewerObject* objectp = *iter;
+		// skip anything deselected or killed since it was queued
+		if (objectp->isDead() || !objectp->isSelected() || !objectp->getRegion())
+		{
+			continue;
+		}
+		region_ids[objectp->getRegion()].push_back(objectp->getLocalID());
+	}
+	mPendingSelects.clear();
+
+	LLMessageSystem* msg = gMessageSystem;
+	for (region_ids_t::iterator iter = region_ids.begin();
+		 iter != region_ids.end(); ++iter)
+	{
+		const LLHost& host = iter->first->getHost();
+		const std::vector<U32>& ids = iter->second;
+
+		S32 select_count = 0;
+		for (U32 i = 0; i < ids.size(); i++)
+		{
+			if (!select_count)
+			{
+				msg->newMessageFast(_PREHASH_ObjectSelect);
+				msg->nextBlockFast(_PREHASH_AgentData);
+				msg->addUUIDFast(_PREHASH_AgentID, gAgent.getID());
+				msg->addUUIDFast(_PREHASH_SessionID, gAgent.getSessionID());
+			}
+
+			msg->nextBlockFast(_PREHASH_ObjectData);
+			msg->addU32Fast(_PREHASH_ObjectLocalID, ids[i]);
+			select_count++;
+
+			if (msg->isSendFull(NULL) || select_count >= MAX_OBJECTS_PER_PACKET)
+			{
+				msg->sendReliable(host);
+				select_count = 0;
+			}
+		}
+
+		if (select_count)
+		{
+			msg->sendReliable(host);
+		}
+	}
+}
+
 void LLSelectMgr::sendSelect()
 {
+	// the whole selection is about to be sent anyway
+	mPendingSelects.clear();
+
 	if (!mSelectedObjects->getNumNodes())
 	{
 		return;
@@ -4295,6 +4364,9 @@ void LLSelectMgr::sendListToRegions(const std::string& message_name,
 	S32 packets_sent = 0;
 	S32 objects_in_this_packet = 0;
 
+	// the simulator must see the objects as selected first
+	sendPendingSelects();
+
 	//clear update override data (allow next update through)
 	struct f : public LLSelectedNodeFunctor
 	{
@@ -4379,6 +4451,36 @@ void LLSelectMgr::sendListToRegions(const std::string& message_name,
 	{
 		return;
 	}
+
+	// Selections spanning several regions would otherwise start a new
+	// packet at every region change.  Group the nodes by region, keeping
+	// their order within each one.
+	std::vector<LLSelectNode*> ordered_nodes;
+	std::map<LLViewerRegion*, S32> region_order;
+	std::vector<S32> node_regions;
+	while (!nodes_to_send.empty())
+	{
+		node = nodes_to_send.front();
+		nodes_to_send.pop();
+		LLViewerRegion* regionp = node->getObject()->getRegion();
+		std::map<LLViewerRegion*, S32>::iterator found = region_order.find(regionp);
+		if (found == region_order.end())
+		{
+			found = region_order.insert(std::make_pair(regionp, (S32)region_order.size())).first;
+		}
+		ordered_nodes.push_back(node);
+		node_regions.push_back(found->second);
+	}
+	for (S32 region = 0; region < (S32)region_order.size(); region++)
+	{
+		for (U32 i = 0; i < ordered_nodes.size(); i++)
+		{
+			if (node_regions[i] == region)
+			{
+				nodes_to_send.push(ordered_nodes[i]);
+			}
+		}
+	}
 	
 	node = nodes_to_send.front();
 	nodes_to_send.pop();
@@ -6953,6 +7055,8 @@ void LLSelectMgr::sendSelectionMove()
 	}
 	
 	//saveSelectedObjectTransform(SELECT_ACTION_TYPE_PICK);
+
+	sendPendingSelects();
 	
 	U32 update_type = UPD_POSITION | UPD_ROTATION;
 	LLViewerRegion *last_region, *curr_region = node->getObject()->getRegion();
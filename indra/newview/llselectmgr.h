@@ -640,6 +640,10 @@ public:
 	void sendDehinge();
 #endif
 	void sendSelect();
+	// Sends ObjectSelect for the objects selected since the last call,
+	// packed per region.  Called once a frame and before anything else is
+	// sent about the selection, so the simulator sees messages in order.
+	void sendPendingSelects();
 
 	static void registerObjectPropertiesFamilyRequest(const LLUUID& id);
 	void requestObjectPropertiesFamily(LLViewerObject* object);	// asks sim for creator, permissions, resources, etc.
@@ -670,6 +674,7 @@ private:
 	void convertTransient(); // converts temporarily selected objects to full-fledged selections
 	ESelectType getSelectTypeForObject(LLViewerObject* object);
 	void addAsFamily(std::vector<LLViewerObject*>& objects, BOOL add_to_end = FALSE);
+	void queueSelect(LLViewerObject* object);
 	void generateSilhouette(LLSelectNode *nodep, const LLVector3& view_point);
 	void updateSelectionSilhouette(LLObjectSelectionHandle object_handle, S32& num_sils_genned, std::vector<LLViewerObject*>& changed_objects);
 	// Send one message to each region containing an object on selection list.
@@ -721,6 +726,8 @@ private:
 	LLObjectSelectionHandle					mHoverObjects;
 	LLObjectSelectionHandle					mHighlightedObjects;
 	std::set<LLPointer<LLViewerObject> >	mRectSelectedObjects;
+	// Newly selected objects the simulator has not been told about yet
+	std::set<LLPointer<LLViewerObject> >	mPendingSelects;
 	
 	LLObjectSelection		mGridObjects;
 	LLQuaternion			mGridRotation;
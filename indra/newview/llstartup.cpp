@@ -43,6 +43,7 @@
 #include "imageids.h"
 #include "llares.h"
 #include "llaudioengine.h"
+#include "llaudiodecodemgr.h"
 
 #ifdef LL_FMOD
 #include "llaudioengine_fmod.h"
@@ -69,6 +70,8 @@
 #include "llmd5.h"
 #include "llmemorystream.h"
 #include "llmessageconfig.h"
+#include "llmessagelog.h"
+#include "llmessagereplay.h"
 #include "llnotifications.h"
 #include "llpostprocess.h"
 #include "llregionhandle.h"
@@ -80,6 +83,7 @@
 #include "llsocks5.h"
 #include "llstring.h"
 #include "llui.h"
+#include "lluictrlfactory.h"
 #include "lluserrelations.h"
 #include "llversionviewer.h"
 #include "llvfs.h"
@@ -665,6 +669,23 @@ bool idle_startup()
 
 		LL_INFOS("AppInit") << "Message System Initialized." << LL_ENDL;
 
+		LLMessageLog::setCaptureSize(gSavedSettings.getU32("MessageLogCaptureSize") * 1024);
+
+		std::string replay_capture = gSavedSettings.getString("ReplayMessageCapture");
+		if (!replay_capture.empty() && gMessageSystem && gMessageSystem->isOK())
+		{
+			// Benchmark run: push a saved packet capture through the
+			// message handlers without logging in, then quit.
+			register_viewer_callbacks(gMessageSystem);
+			LLMessageReplay replay;
+			if (replay.load(replay_capture))
+			{
+				replay.replay(gMessageSystem);
+			}
+			LLAppViewer::instance()->forceQuit();
+			return FALSE;
+		}
+
 		//-------------------------------------------------
 		// Init the socks 5 proxy and open the control TCP
 		// connection if the user is using SOCKS5
@@ -718,6 +739,10 @@ bool idle_startup()
 				if(init)
 				{
 					gAudiop->setMuted(TRUE);
+					if (gAudioDecodeMgrp)
+					{
+						gAudioDecodeMgrp->setCacheSize(gSavedSettings.getU32("AudioDecodedCacheSize") * 1024 * 1024);
+					}
 				}
 				else
 				{
@@ -2899,6 +2924,12 @@ bool idle_startup()
 
 		LLStartUp::setStartupState( STATE_STARTED );
 
+		const LLUICtrlFactory::LayoutStats& layout_stats = LLUICtrlFactory::getLayoutStats();
+		LL_INFOS("AppInit") << "UI layouts loaded during startup: "
+							<< layout_stats.mParsed << " parsed in " << layout_stats.mParseTime * 1000.f << " ms, "
+							<< layout_stats.mCacheHits << " from cache in " << layout_stats.mCacheTime * 1000.f << " ms"
+							<< LL_ENDL;
+
 		if (gSavedSettings.getBOOL("RenderFarClipStepping"))
 		{
 			// progressive draw distance stepping if requested.
@@ -55,6 +55,7 @@ extern LLPipeline gPipeline;
 LLSurfacePatch::LLSurfacePatch() :
 	mHasReceivedData(FALSE),
 	mSTexUpdate(FALSE),
+	mSTexPending(FALSE),
 	mDirty(FALSE),
 	mDirtyZStats(TRUE),
 	mHeightsGenerated(FALSE),
@@ -712,7 +713,10 @@ BOOL LLSurfacePatch::updateTexture()
 			{
 				if (mVObjp)
 				{
-					mVObjp->dirtyGeom();
+					if (!mSTexPending)
+					{
+						mVObjp->dirtyGeom();
+					}
 					gPipeline.markGLRebuild(mVObjp);
 					return TRUE;
 				}
@@ -742,11 +746,19 @@ void LLSurfacePatch::updateGL()
 							  tex_patch_size, tex_patch_size))
 	{
 		mSTexUpdate = FALSE;
+		mSTexPending = FALSE;
 
 		// Also generate the water texture
 		mSurfacep->generateWaterTexture((F32)origin_region.mdV[VX], (F32)origin_region.mdV[VY],
 										tex_patch_size, tex_patch_size);
 	}
+	else
+	{
+		// Blend is still running on the composition thread (or the detail
+		// textures aren't ready); poll again from the next idle update.
+		mSTexPending = TRUE;
+		mSurfacep->dirtySurfacePatch(this);
+	}
 }
 
 void LLSurfacePatch::dirtyZ()
@@ -147,6 +147,7 @@ public:
 public:
 	BOOL mHasReceivedData;	// has the patch EVER received height data?
 	BOOL mSTexUpdate;		// Does the surface texture need to be updated?
+	BOOL mSTexPending;		// Waiting on LLVLComposition for the surface texture
 
 protected:
 	LLSurfacePatch *mNeighborPatches[8]; // Adjacent patches
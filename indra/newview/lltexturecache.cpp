@@ -898,6 +898,30 @@ const char* old_textures_dirname = "textures";
 //change the location of the texture cache to prevent from being deleted by old version viewers.
 const char* textures_dirname = "texturecache";
 
+static void texture_cache_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	if (LLAppViewer::getTextureCache())
+	{
+		LLAppViewer::getTextureCache()->getMemoryUsage(usage);
+	}
+}
+static LLMemoryAccount sTextureCacheAccount("Texture cache index", texture_cache_memory_usage);
+
+void LLTextureCache::getMemoryUsage(LLMemoryAccount::Usage& usage)
+{
+	LLMutexLock lock(&mHeaderMutex);
+	usage.mBytes += LLMemoryAccount::nodeBytes(mHeaderIDMap.size(), sizeof(id_map_t::value_type));
+	usage.mBytes += LLMemoryAccount::nodeBytes(mTexturesSizeMap.size(), sizeof(size_map_t::value_type));
+	usage.mBytes += LLMemoryAccount::nodeBytes(mLRU.size(), sizeof(LLUUID));
+	usage.mBytes += LLMemoryAccount::nodeBytes(mFreeList.size(), sizeof(S32));
+	usage.mBytes += LLMemoryAccount::nodeBytes(mUpdatedEntryMap.size(), sizeof(idx_entry_map_t::value_type));
+	for (purge_map_t::iterator iter = mFilesToDelete.begin(); iter != mFilesToDelete.end(); ++iter)
+	{
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(purge_map_t::value_type)) + LLMemoryAccount::stringBytes(iter->second);
+	}
+	usage.mCount += mHeaderIDMap.size();
+}
+
 void LLTextureCache::setDirNames(ELLPath location)
 {
 	std::string delem = gDirUtilp->getDirDelimiter();
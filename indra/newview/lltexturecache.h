@@ -35,6 +35,7 @@
 
 #include "lldir.h"
 #include "llstl.h"
+#include "llmemoryaccount.h"
 #include "llstring.h"
 #include "lluuid.h"
 
@@ -140,6 +141,8 @@ public:
 	S64 getMaxUsage() { return sCacheMaxTexturesSize; }
 	U32 getEntries() { return mHeaderEntriesInfo.mEntries; }
 	U32 getMaxEntries() { return sCacheMaxEntries; };
+	// Memory held by the header index, one count per cached texture
+	void getMemoryUsage(LLMemoryAccount::Usage& usage);
 	BOOL isInCache(const LLUUID& id) ;
 	BOOL isInLocal(const LLUUID& id) ;
 
@@ -491,8 +491,8 @@ void display(BOOL rebuild, F32 zoom_factor, int subfield, BOOL for_snapshot)
 	// Progressively increase draw distance after TP when required.
 	if (gSavedDrawDistance > 0.0f && gAgent.getTeleportState() == LLAgent::TELEPORT_NONE)
 	{
-		if (gTeleportArrivalTimer.getElapsedTimeF32() >=
-			(F32)gSavedSettings.getU32("RenderFarClipSteppingInterval"))
+		static LLControlHandle<U32> far_clip_stepping_interval(gSavedSettings, "RenderFarClipSteppingInterval");
+		if (gTeleportArrivalTimer.getElapsedTimeF32() >= (F32)far_clip_stepping_interval)
 		{
 			gTeleportArrivalTimer.reset();
 			F32 current = gSavedSettings.getF32("RenderFarClip");
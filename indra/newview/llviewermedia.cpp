@@ -42,10 +42,12 @@
 #include "llviewertexturelist.h"
 #include "llpluginclassmedia.h"
 #include "llplugincookiestore.h"
+#include "llpixelunpackbuffer.h"
 
 #include "llurldispatcher.h"
 
 #include "llevent.h"		// LLSimpleListener
+#include "llgl.h"
 #include "lluuid.h"
 #include "llkeyboard.h"
 
@@ -429,6 +431,39 @@ void LLViewerMedia::updateMedia()
 	}
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////
+// static
+void LLViewerMedia::getUploadStats(std::vector<std::string>& lines)
+{
+	U64 total_bytes = 0;
+	impl_list::iterator iter = sViewerMediaImplList.begin();
+	impl_list::iterator end = sViewerMediaImplList.end();
+	for(; iter != end; iter++)
+	{
+		LLViewerMediaImpl* pimpl = *iter;
+		if(!pimpl->mMediaSource)
+		{
+			continue;
+		}
+		
+		lines.push_back(llformat("%s %dx%d: %d rects, %.1f KB in %.2f ms (avg %.2f ms), %.1f MB total",
+								 pimpl->mMimeType.c_str(),
+								 pimpl->mMediaSource->getBitsWidth(),
+								 pimpl->mMediaSource->getBitsHeight(),
+								 pimpl->mUploadRectsLast,
+								 pimpl->mUploadBytesLast / 1024.f,
+								 pimpl->mUploadTimeLast * 1000.f,
+								 pimpl->mUploadTimeAverage * 1000.f,
+								 (F32)(pimpl->mUploadBytesTotal / (1024.0 * 1024.0))));
+		total_bytes += pimpl->mUploadBytesTotal;
+	}
+	
+	lines.push_back(llformat("Media uploads: %d instances, %.1f MB total%s",
+							 (S32)sViewerMediaImplList.size(),
+							 (F32)(total_bytes / (1024.0 * 1024.0)),
+							 gGLManager.mHasPixelBufferObject ? "" : " (no PBO)"));
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////
 // static
 void LLViewerMedia::clearAllCookies()
@@ -811,7 +846,13 @@ LLViewerMediaImpl::LLViewerMediaImpl(const std::string& media_url,
 	mSuspendUpdates(false),
 	mVisible(true),
 	mHasFocus(false),
-	mBackgroundColor(LLColor4::black) // Do not set to white or may get "white flash" bug.
+	mBackgroundColor(LLColor4::black), // Do not set to white or may get "white flash" bug.
+	mUploadBytesTotal(0),
+	mUploadBytesLast(0),
+	mUploadRectsLast(0),
+	mUploadTimeLast(0.f),
+	mUploadTimeAverage(0.f),
+	mPixelBuffer(NULL)
 { 
 	createMediaSource();
 }
@@ -826,6 +867,9 @@ LLViewerMediaImpl::~LLViewerMediaImpl()
 	
 	destroyMediaSource();
 	LLViewerMedia::removeMedia(this);
+	
+	delete mPixelBuffer;
+	mPixelBuffer = NULL;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -1539,34 +1583,51 @@ void LLViewerMediaImpl::update()
 		
 	if(placeholder_image)
 	{
-		LLRect dirty_rect;
-		if(mMediaSource->getDirty(&dirty_rect))
+		if(mMediaSource->getDirty())
 		{
-			// Constrain the dirty rect to be inside the texture
-			S32 x_pos = llmax(dirty_rect.mLeft, 0);
-			S32 y_pos = llmax(dirty_rect.mBottom, 0);
-			S32 width = llmin(dirty_rect.mRight, placeholder_image->getWidth()) - x_pos;
-			S32 height = llmin(dirty_rect.mTop, placeholder_image->getHeight()) - y_pos;
+			// Only the tiles the plugin has touched since the last upload, rather than one rect covering all of them.
+			std::vector<LLRect> dirty_rects;
+			mMediaSource->getDirtyRects(dirty_rects);
 			
-			if(width > 0 && height > 0)
+			// Constrain the dirty rects to be inside both the texture and the plugin's bits
+			S32 max_width = llmin(placeholder_image->getWidth(), mMediaSource->getBitsWidth());
+			S32 max_height = llmin(placeholder_image->getHeight(), mMediaSource->getBitsHeight());
+			std::vector<LLRect>::iterator iter = dirty_rects.begin();
+			while(iter != dirty_rects.end())
 			{
-
-				U8* data = mMediaSource->getBitsData();
-
-				// Offset the pixels pointer to match x_pos and y_pos
-				data += ( x_pos * mMediaSource->getTextureDepth() * mMediaSource->getBitsWidth() );
-				data += ( y_pos * mMediaSource->getTextureDepth() );
+				iter->mLeft = llmax(iter->mLeft, 0);
+				iter->mBottom = llmax(iter->mBottom, 0);
+				iter->mRight = llmin(iter->mRight, max_width);
+				iter->mTop = llmin(iter->mTop, max_height);
+				if(iter->mRight <= iter->mLeft || iter->mTop <= iter->mBottom)
+				{
+					iter = dirty_rects.erase(iter);
+				}
+				else
+				{
+					++iter;
+				}
+			}
+			
+			U8* data = mMediaSource->getBitsData();
+			if(data && !dirty_rects.empty())
+			{
+				if(!mPixelBuffer)
+				{
+					mPixelBuffer = new LLPixelUnpackBuffer;
+				}
 				
-				placeholder_image->setSubImage(
-						data, 
-						mMediaSource->getBitsWidth(), 
+				LLTimer upload_timer;
+				mUploadBytesLast = placeholder_image->setSubImages(
+						*mPixelBuffer,
+						data,
+						mMediaSource->getBitsWidth(),
 						mMediaSource->getBitsHeight(),
-						x_pos, 
-						y_pos, 
-						width, 
-						height,
-						TRUE);		// force a fast update (i.e. don't call analyzeAlpha, etc.)
-
+						dirty_rects);
+				mUploadTimeLast = upload_timer.getElapsedTimeF32();
+				mUploadTimeAverage = lerp(mUploadTimeAverage, mUploadTimeLast, 0.1f);
+				mUploadRectsLast = (S32)dirty_rects.size();
+				mUploadBytesTotal += mUploadBytesLast;
 			}
 			
 			mMediaSource->resetDirty();
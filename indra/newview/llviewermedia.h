@@ -47,6 +47,7 @@ class LLViewerMediaImpl;
 class LLUUID;
 class LLViewerTexture;
 class LLPluginCookieStore;
+class LLPixelUnpackBuffer;
 
 typedef LLPointer<LLViewerMediaImpl> viewer_media_t;
 ///////////////////////////////////////////////////////////////////////////////
@@ -111,6 +112,9 @@ class LLViewerMedia
 	static void addSessionCookie(const std::string &name, const std::string &value, const std::string &domain, const std::string &path = std::string("/"), bool secure = false );
 	static void removeCookie(const std::string &name, const std::string &domain, const std::string &path = std::string("/") );
 	
+	// One line per media instance with its texture upload statistics, for DebugShowMediaInfo.
+	static void getUploadStats(std::vector<std::string>& lines);
+
 	static void openIDSetup(const std::string &openid_url, const std::string &openid_token);
 	static void openIDCookieResponse(const std::string &cookie);
 
@@ -303,7 +307,16 @@ public:
 	bool mTrustedBrowser;
 	std::string mTarget;
 
+	// Texture upload statistics
+	U64 mUploadBytesTotal;
+	U32 mUploadBytesLast;
+	S32 mUploadRectsLast;
+	F32 mUploadTimeLast;		// seconds
+	F32 mUploadTimeAverage;		// seconds, exponentially smoothed
+
 private:
+	LLPixelUnpackBuffer* mPixelBuffer;
+
 	LLViewerTexture* updatePlaceholderImage(); // Should really return a LLViewerMediaTexture*
 };
 
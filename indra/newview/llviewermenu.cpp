@@ -134,6 +134,7 @@
 #include "llfloatermap.h"
 #include "llfloatermediabrowser.h"
 #include "llfloatermemleak.h"
+#include "llfloatermemoryaccounts.h"
 #include "llfloatermute.h"
 #include "llfloaternotificationsconsole.h"
 #include "llfloateropenobject.h"
@@ -234,6 +235,7 @@
 #include "floaterblacklist.h"
 #include "floatermedialists.h"
 
+#include "lggautocorrect.h"
 #include "lggcontactsetsfloater.h"
 
 using namespace LLVOAvatarDefines;
@@ -465,6 +467,7 @@ void handle_crash(void*);
 void handle_dump_followcam(void*);
 void handle_viewer_enable_message_log(void*);
 void handle_viewer_disable_message_log(void*);
+void handle_save_packet_capture(void*);
 void handle_send_postcard(void*);
 void handle_gestures_old(void*);
 void handle_focus(void *);
@@ -801,6 +804,8 @@ void init_client_menu(LLMenuGL* menu)
 						 &handle_show_notifications_console, NULL, NULL, '5', MASK_CONTROL|MASK_SHIFT ));
 		sub->append(new LLMenuItemCallGL("Region Debug Console", 
 					&handle_region_debug_console, NULL, NULL, 'C', MASK_CONTROL|MASK_SHIFT));		
+		sub->append(new LLMenuItemCallGL("Memory Accounts...",
+					&LLFloaterMemoryAccounts::show, NULL, NULL));
 
 		sub->appendSeparator();
 
@@ -877,6 +882,8 @@ void init_client_menu(LLMenuGL* menu)
 
 	menu->append(new LLMenuItemCallGL("Clear Group Cache", 
 									  LLGroupMgr::debugClearAllGroups));
+	menu->append(new LLMenuItemCallGL("Dump Group Memory", 
+									  LLGroupMgr::debugDumpGroupMemory));
 	menu->appendSeparator();
 
 	sub_menu = new LLMenuGL("Rendering");
@@ -928,6 +935,8 @@ void init_client_menu(LLMenuGL* menu)
 			&handle_viewer_enable_message_log,  NULL));
 		sub->append(new LLMenuItemCallGL("Disable Message Log", 
 			&handle_viewer_disable_message_log, NULL));
+		sub->append(new LLMenuItemCallGL("Save Packet Capture", 
+			&handle_save_packet_capture, NULL));
 
 		sub->appendSeparator();
 
@@ -1122,6 +1131,8 @@ void init_debug_ui_menu(LLMenuGL* menu)
 	menu->append(new LLMenuItemCallGL("Editable UI", &edit_ui));
 	menu->append(new LLMenuItemCallGL( "Dump SelectMgr", &dump_select_mgr));
 	menu->append(new LLMenuItemCallGL( "Dump Inventory", &dump_inventory));
+	menu->append(new LLMenuItemCallGL( "Benchmark Inventory Views", &LLFolderView::debugBenchmarkViews));
+	menu->append(new LLMenuItemCallGL( "Benchmark Auto Correct", &LGGAutoCorrect::debugBenchmarkReplace));
 	menu->append(new LLMenuItemCallGL( "Dump Hippos", &handle_hippos, NULL, NULL, 'H', MASK_CONTROL | MASK_ALT | MASK_SHIFT));
 	menu->append(new LLMenuItemCallGL( "Dump Focus Holder", &handle_dump_focus, NULL, NULL, 'F', MASK_ALT | MASK_CONTROL));
 	menu->append(new LLMenuItemCallGL( "Print Selected Object Info",	&print_object_info, NULL, NULL, 'P', MASK_CONTROL|MASK_SHIFT ));
@@ -6103,6 +6114,16 @@ void handle_viewer_disable_message_log(void*)
 	gMessageSystem->stopLogging();
 }
 
+void handle_save_packet_capture(void*)
+{
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "packets.pcap");
+	if (LLMessageLog::saveCapture(filename))
+	{
+		LLChat chat(llformat("Saved %d packets to %s", LLMessageLog::getEntryCount(), filename.c_str()));
+		LLFloaterChat::addChat(chat);
+	}
+}
+
 // TomY TODO: Move!
 class LLShowFloater : public view_listener_t
 {
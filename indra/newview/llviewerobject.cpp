@@ -205,7 +205,8 @@ LLViewerObject::LLViewerObject(const LLUUID &id, const LLPCode pcode, LLViewerRe
 	mDead(FALSE),
 	mOrphaned(FALSE),
 	mUserSelected(FALSE),
-	mOnActiveList(FALSE),
+	mActiveListIndex(-1),
+	mListIndex(-1),
 	mOnMap(FALSE),
 	mStatic(FALSE),
 	mNumFaces(0),
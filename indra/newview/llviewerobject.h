@@ -173,8 +173,13 @@ public:
 
 
 	virtual BOOL    isActive() const; // Whether this object needs to do an idleUpdate.
-	BOOL			onActiveList() const				{return mOnActiveList;}
-	void			setOnActiveList(BOOL on_active)		{ mOnActiveList = on_active; }
+	BOOL			onActiveList() const				{return mActiveListIndex >= 0;}
+	// Position in LLViewerObjectList's active array, -1 when not on it
+	S32				getActiveListIndex() const			{ return mActiveListIndex; }
+	void			setActiveListIndex(S32 index)		{ mActiveListIndex = index; }
+	// Position in LLViewerObjectList's object array, -1 once removed from it
+	S32				getListIndex() const				{ return mListIndex; }
+	void			setListIndex(S32 index)				{ mListIndex = index; }
 
 	virtual BOOL	isAttachment() const { return FALSE; }
 	virtual LLVOAvatar* getAvatar() const;  //get the avatar this object is attached to, or NULL if object is not an attachment
@@ -685,7 +690,8 @@ protected:
 	BOOL			mDead;
 	BOOL			mOrphaned;					// This is an orphaned child
 	BOOL			mUserSelected;				// Cached user select information
-	BOOL			mOnActiveList;
+	S32				mActiveListIndex;
+	S32				mListIndex;
 	BOOL			mOnMap;						// On the map.
 	BOOL			mStatic;					// Object doesn't move.
 	S32				mNumFaces;
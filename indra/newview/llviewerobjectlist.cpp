@@ -96,7 +96,7 @@ extern LLPipeline	gPipeline;
 // Statics for object lookup tables.
 U32						LLViewerObjectList::sSimulatorMachineIndex = 1; // Not zero deliberately, to speed up index check.
 std::map<U64, U32>		LLViewerObjectList::sIPAndPortToIndex;
-std::map<U64, LLUUID>	LLViewerObjectList::sIndexAndLocalIDToUUID;
+LLViewerObjectList::local_id_map_t	LLViewerObjectList::sIndexAndLocalIDToUUID;
 
 LLViewerObjectList::LLViewerObjectList()
 {
@@ -105,13 +105,14 @@ LLViewerObjectList::LLViewerObjectList()
 	mCurLazyUpdateIndex = 0;
 	mCurBin = 0;
 	mNumDeadObjects = 0;
-	mMinNumDeadObjects = 20;
 	mNumOrphans = 0;
 	mNumNewObjects = 0;
 	mWasPaused = FALSE;
 	mNumDeadObjectUpdates = 0;
 	mNumUnknownKills = 0;
 	mNumUnknownUpdates = 0;
+	mUpdatingActive = FALSE;
+	mNumRemovedActive = 0;
 }
 
 LLViewerObjectList::~LLViewerObjectList()
@@ -125,7 +126,11 @@ void LLViewerObjectList::destroy()
 
 	resetObjectBeacons();
 	mActiveObjects.clear();
+	mNumRemovedActive = 0;
 	mDeadObjects.clear();
+	mNewDeadObjects.clear();
+	mReclaimObjects.clear();
+	mReclaimBuffers.clear();
 	mMapObjects.clear();
 	mUUIDObjectMap.clear();
 	mUUIDAvatarMap.clear();
@@ -149,7 +154,8 @@ void LLViewerObjectList::getUUIDFromLocal(LLUUID &id,
 
 	U64	indexid = (((U64)index) << 32) | (U64)local_id;
 
-	id = get_if_there(sIndexAndLocalIDToUUID, indexid, LLUUID::null);
+	local_id_map_t::const_iterator iter = sIndexAndLocalIDToUUID.find(indexid);
+	id = (iter != sIndexAndLocalIDToUUID.end()) ? iter->second : LLUUID::null;
 }
 
 U64 LLViewerObjectList::getIndex(const U32 local_id,
@@ -183,7 +189,7 @@ BOOL LLViewerObjectList::removeFromLocalIDTable(const LLViewerObject* objectp)
 		
 		U64	indexid = (((U64)index) << 32) | (U64)local_id;
 		
-		std::map<U64, LLUUID>::iterator iter = sIndexAndLocalIDToUUID.find(indexid);
+		local_id_map_t::iterator iter = sIndexAndLocalIDToUUID.find(indexid);
 		if (iter == sIndexAndLocalIDToUUID.end())
 		{
 			return FALSE;
@@ -892,35 +898,22 @@ void LLViewerObjectList::update(LLAgent &agent, LLWorld &world)
 	S32 num_active_objects = 0;
 	LLViewerObject *objectp = NULL;	
 	
-	// Make a copy of the list in case something in idleUpdate() messes with it
-	std::vector<LLViewerObject*> idle_list;
-	idle_list.reserve( mActiveObjects.size() );
-
- 	for (std::set<LLPointer<LLViewerObject> >::iterator active_iter = mActiveObjects.begin();
-		active_iter != mActiveObjects.end(); active_iter++)
-	{
-		objectp = *active_iter;
-		if (objectp)
-		{
-			idle_list.push_back( objectp );
-		}
-		else
-		{	// There shouldn't be any NULL pointers in the list, but they have caused
-			// crashes before.  This may be idleUpdate() messing with the list.
-			llwarns << "LLViewerObjectList::update has a NULL objectp" << llendl;
-		}
-	}
+	// idleUpdate() may add or remove active objects.  Objects added now
+	// wait for the next frame, as they are past the end we walk to, and
+	// removed ones leave an empty slot until compactActiveObjects().
+	mUpdatingActive = TRUE;
+	const S32 idle_count = (S32)mActiveObjects.size();
 
 	static LLCachedControl<bool> sFreezeTime(gSavedSettings, "FreezeTime");
 
 	if (sFreezeTime)
 	{
-		for (std::vector<LLViewerObject*>::iterator iter = idle_list.begin();
-			iter != idle_list.end(); iter++)
+		for (S32 i = 0; i < idle_count; ++i)
 		{
-			objectp = *iter;
-			if (objectp->getPCode() == LLViewerObject::LL_VO_CLOUDS ||
-				objectp->isAvatar())
+			objectp = mActiveObjects[i];
+			if (objectp &&
+				(objectp->getPCode() == LLViewerObject::LL_VO_CLOUDS ||
+				 objectp->isAvatar()))
 			{
 				objectp->idleUpdate(agent, world, frame_time);
 			}
@@ -928,10 +921,13 @@ void LLViewerObjectList::update(LLAgent &agent, LLWorld &world)
 	}
 	else
 	{
-		for (std::vector<LLViewerObject*>::iterator idle_iter = idle_list.begin();
-			idle_iter != idle_list.end(); idle_iter++)
+		for (S32 i = 0; i < idle_count; ++i)
 		{
-			objectp = *idle_iter;
+			objectp = mActiveObjects[i];
+			if (!objectp)
+			{
+				continue;
+			}
 			if (!objectp->idleUpdate(agent, world, frame_time))
 			{
 				//  If Idle Update returns false, kill object!
@@ -949,6 +945,7 @@ void LLViewerObjectList::update(LLAgent &agent, LLWorld &world)
 			killObject(objectp);
 		}
 	}
+	compactActiveObjects();
 
 	fetchObjectCosts();
 	fetchPhysicsFlags();
@@ -1150,6 +1147,7 @@ void LLViewerObjectList::cleanupReferences(LLViewerObject *objectp)
 	else
 	{
 		mDeadObjects.insert(objectp->mID);
+		mNewDeadObjects.push_back(objectp);
 	}
 
 	// Cleanup any references we have to this object
@@ -1170,8 +1168,7 @@ void LLViewerObjectList::cleanupReferences(LLViewerObject *objectp)
 	if (objectp->onActiveList())
 	{
 		//llinfos << "Removing " << objectp->mID << " " << objectp->getPCodeString() << " from active list in cleanupReferences." << llendl;
-		objectp->setOnActiveList(FALSE);
-		mActiveObjects.erase(objectp);
+		removeActiveObject(objectp);
 	}
 
 	if (objectp->isOnMap())
@@ -1207,6 +1204,26 @@ void LLViewerObjectList::removeDrawable(LLDrawable* drawablep)
 	}
 }
 
+void LLViewerObjectList::reclaimVertexBuffers(LLDrawable* drawablep)
+{
+	// Once the viewer is exiting, GL may go away before the next
+	// cleanDeadObjects(), so let the faces release their buffers.
+	if (!drawablep || LLApp::isExiting())
+	{
+		return;
+	}
+
+	for (S32 i = 0; i < drawablep->getNumFaces(); i++)
+	{
+		LLFace* facep = drawablep->getFace(i);
+		if (facep && facep->getVertexBuffer())
+		{
+			mReclaimBuffers.push_back(facep->getVertexBuffer());
+			facep->clearVertexBuffer();
+		}
+	}
+}
+
 BOOL LLViewerObjectList::killObject(LLViewerObject *objectp)
 {
 	// Don't ever kill gAgentAvatarp, just force it to the agent's region
@@ -1257,8 +1274,10 @@ void LLViewerObjectList::killObjects(LLViewerRegion *regionp)
 		}
 	}
 
-	// Have to clean right away because the region is becoming invalid.
-	cleanDeadObjects(false);
+	// Have to clean right away because the region is becoming invalid.  Only
+	// the references go now; the objects themselves are destroyed over the
+	// next frames.
+	cleanDeadObjects();
 	llinfos << "Removed " << count << " objects for region " << regionp->getName() << " in " << kill_timer.getElapsedTimeF64() * 1000.0 << "ms" << llendl;
 }
 
@@ -1286,6 +1305,7 @@ void LLViewerObjectList::killAllObjects()
 		mObjects.clear();
 	}
 
+	compactActiveObjects();
 	if (!mActiveObjects.empty())
 	{
 		llwarns << "Some objects still on active object list!" << llendl;
@@ -1299,115 +1319,87 @@ void LLViewerObjectList::killAllObjects()
 	}
 }
 
-// It looks like it causes crashes in various parts of the viewer code when
-// dead objects are not cleaned up immediately... Probably the reason why
-// LL never made any use of the use_timer parameter (see the comment after
-// the call to cleanDeadObjects()() in llappviewer.cpp)...
-#define DELAYED_CLEANUP 0
+void LLViewerObjectList::addToObjectList(LLViewerObject* objectp)
+{
+	objectp->setListIndex((S32)mObjects.size());
+	mObjects.push_back(objectp);
+}
 
 void LLViewerObjectList::cleanDeadObjects(bool use_timer)
 {
-#if DELAYED_CLEANUP
-	LLTimer kill_timer;
+	// Each dead object knows its slot in mObjects, so removing it is a swap
+	// with the last entry instead of a scan of the whole list.  The object
+	// itself is only moved to the reclaim list: nothing can find it any more,
+	// but destroying it (and whatever it alone still holds) can wait.
+	for (vobj_list_t::iterator iter = mNewDeadObjects.begin();
+		 iter != mNewDeadObjects.end(); ++iter)
+	{
+		LLViewerObject* objectp = *iter;
+		S32 index = objectp->getListIndex();
+		if (index < 0 || index >= (S32)mObjects.size() || mObjects[index] != objectp)
+		{
+			llwarns << "Dead object " << objectp->mID << " is not where the object list expects it" << llendl;
+		}
+		else
+		{
+			S32 last = (S32)mObjects.size() - 1;
+			if (index != last)
+			{
+				mObjects[index] = mObjects[last];
+				mObjects[index]->setListIndex(index);
+			}
+			mObjects.pop_back();
+		}
+		objectp->setListIndex(-1);
+		mReclaimObjects.push_back(objectp);
+	}
+	mNewDeadObjects.clear();
 
-	static S32 min_dead_objects = 32;
-	static S32 max_dead_objects = 512;
-	static S32 dead_objects_increment = 48;
+	// Blow away the dead list.
+	mDeadObjects.clear();
+	mNumDeadObjects = 0;
+
+	reclaimDeadObjects(use_timer);
+}
 
-	if (use_timer && mNumDeadObjects < mMinNumDeadObjects)
+void LLViewerObjectList::reclaimDeadObjects(bool use_timer)
+{
+	if (mReclaimObjects.empty() && mReclaimBuffers.empty())
 	{
-		// Not enough dead objects, don't scan the whole object list until there are a few.
-		// However, the longer it takes to reach this quota, the less demanding we are,
-		// so decrease the lower limit but never demand less than min_dead_objects.
-		mMinNumDeadObjects = llmax(min_dead_objects, mMinNumDeadObjects - dead_objects_increment);
 		return;
 	}
-#else
-	if (!mNumDeadObjects)
+
+	if (!use_timer)
 	{
-		// No dead objects, don't need to scan object list.
+		mReclaimObjects.clear();
+		mReclaimBuffers.clear();
 		return;
 	}
-#endif
 
-	// Scan for all of the dead objects and remove any "global" references to them.
+	// However small the time budget, a backlog is always worked off within
+	// RECLAIM_FRAMES frames so that it cannot keep growing.
+	const S32 MIN_RECLAIM_COUNT = 32;
+	const S32 RECLAIM_FRAMES = 32;
+	static LLCachedControl<F32> reclaim_time(gSavedSettings, "DeadObjectReclaimTime");
 
-	// We first move all dead objects to the end of the std::vector (the swap
-	// is VERY cheap) and only then call erase once: calling erase on a vector
-	// is very expensive!
+	S32 backlog = (S32)(mReclaimObjects.size() + mReclaimBuffers.size());
+	S32 min_count = llmax(MIN_RECLAIM_COUNT, backlog / RECLAIM_FRAMES);
+	F64 max_time = llmax((F32)reclaim_time, 0.f) * 0.001;
+	LLTimer reclaim_timer;
 
-	vobj_list_t::iterator iter = mObjects.begin();		// Runs over all objects.
-	vobj_list_t::iterator const end = mObjects.end();
-	vobj_list_t::iterator last = end;					// Points to the last object that is not dead.
 	S32 count = 0;
-
-	// Find the first Dead object.
-	while (iter != last && !(*iter)->isDead())
-		++iter;
-
-	// While iter did not bump into last, continue the search.
-	while (iter != last)
+	while (!mReclaimObjects.empty()
+		   && (count < min_count || reclaim_timer.getElapsedTimeF64() < max_time))
 	{
-		// Find the next not Dead object from the end.
-		do
-		{
-			--last;
-			++count;
-		}
-		while (last != iter && (*last)->isDead());
-		if (iter == last)
-		{
-			// There no more Dead objects left before last.
-			break;
-		}
-
-		// Swap both object Pointers.
-		vobj_list_t::value_type::swap(*iter, *last);
-		if (count == mNumDeadObjects)
-		{
-			// There aren't any more dead objects.
-			break;
-		}
-
-		// Find the next Dead object at the beginning.
-		do
-		{
-			++iter;
-		}
-		while (iter != last && !(*iter)->isDead());
+		mReclaimObjects.pop_front();
+		++count;
 	}
-	llassert(end - last == count);	// Paranoia...
-	mObjects.erase(last, end);
-
-#if DELAYED_CLEANUP
-	if (use_timer && count)
+	while (!mReclaimBuffers.empty()
+		   && (count < min_count || reclaim_timer.getElapsedTimeF64() < max_time))
 	{
-		const F32 MIN_TIME = 1.0f;	// Only clean up when it will take at least that many milliseconds.
-		const F32 MAX_TIME = 5.0f;	// Always clean up before it would take that many milliseconds.
-		const S32 ABSOLUTE_MINIMUM = 32; 	// Never require less than this many dead objects.
-
-		// Adjust the requirements based on the actual function timing
-		F32 ellapsed_time = (F32)(kill_timer.getElapsedTimeF64() * 1000.0);
-		min_dead_objects = llmax(ABSOLUTE_MINIMUM, (S32)(MIN_TIME / ellapsed_time * (F32)count));
-		max_dead_objects = (S32)(MAX_TIME / MIN_TIME * (F32)min_dead_objects);
-		dead_objects_increment = llmax(1, (max_dead_objects - min_dead_objects) / 10);
-
-		// Now compute our requirement for the next call
-		mMinNumDeadObjects = llmin(max_dead_objects,
-								   llmax(min_dead_objects, mNumDeadObjects + dead_objects_increment));
-
-		llinfos << "Cleaned up " << count
-				<< " dead objects from the objects list in " << ellapsed_time
-				<< "ms (next dead objects number requirement: min = " << min_dead_objects
-				<< " - max = " << max_dead_objects
-				<< " - increment = " << dead_objects_increment << ")"
-				<< llendl;
+		mReclaimBuffers.pop_front();
+		++count;
 	}
-#endif
-
-	// Blow away the dead list.
-	mDeadObjects.clear();
-	mNumDeadObjects = 0;
 }
 
 void LLViewerObjectList::updateActive(LLViewerObject *objectp)
@@ -1424,18 +1416,74 @@ void LLViewerObjectList::updateActive(LLViewerObject *objectp)
 		if (active)
 		{
 			//llinfos << "Adding " << objectp->mID << " " << objectp->getPCodeString() << " to active list." << llendl;
-			mActiveObjects.insert(objectp);
-			objectp->setOnActiveList(TRUE);
+			addActiveObject(objectp);
 		}
 		else
 		{
 			//llinfos << "Removing " << objectp->mID << " " << objectp->getPCodeString() << " from active list." << llendl;
-			mActiveObjects.erase(objectp);
-			objectp->setOnActiveList(FALSE);
+			removeActiveObject(objectp);
 		}
 	}
 }
 
+void LLViewerObjectList::addActiveObject(LLViewerObject* objectp)
+{
+	objectp->setActiveListIndex((S32)mActiveObjects.size());
+	mActiveObjects.push_back(objectp);
+}
+
+void LLViewerObjectList::removeActiveObject(LLViewerObject* objectp)
+{
+	S32 index = objectp->getActiveListIndex();
+	if (index < 0 || index >= (S32)mActiveObjects.size() || mActiveObjects[index] != objectp)
+	{
+		llwarns << "Object " << objectp->mID << " is not where the active list expects it" << llendl;
+		objectp->setActiveListIndex(-1);
+		return;
+	}
+	objectp->setActiveListIndex(-1);
+
+	if (mUpdatingActive)
+	{
+		mActiveObjects[index] = NULL;
+		mNumRemovedActive++;
+		return;
+	}
+
+	S32 last = (S32)mActiveObjects.size() - 1;
+	if (index != last)
+	{
+		mActiveObjects[index] = mActiveObjects[last];
+		mActiveObjects[index]->setActiveListIndex(index);
+	}
+	mActiveObjects.pop_back();
+}
+
+void LLViewerObjectList::compactActiveObjects()
+{
+	mUpdatingActive = FALSE;
+	if (!mNumRemovedActive)
+	{
+		return;
+	}
+
+	S32 count = 0;
+	for (S32 i = 0; i < (S32)mActiveObjects.size(); ++i)
+	{
+		if (mActiveObjects[i].notNull())
+		{
+			if (i != count)
+			{
+				mActiveObjects[count] = mActiveObjects[i];
+				mActiveObjects[count]->setActiveListIndex(count);
+			}
+			count++;
+		}
+	}
+	mActiveObjects.resize(count);
+	mNumRemovedActive = 0;
+}
+
 
 void LLViewerObjectList::updateObjectCost(LLViewerObject* object)
 {
@@ -1852,7 +1900,7 @@ LLViewerObject *LLViewerObjectList::createObjectViewer(const LLPCode pcode, LLVi
 			mUUIDAvatarMap[fullid] = avatarp;
 	}
 
-	mObjects.push_back(objectp);
+	addToObjectList(objectp);
 
 	updateActive(objectp);
 
@@ -1898,7 +1946,7 @@ LLViewerObject *LLViewerObjectList::createObject(const LLPCode pcode, LLViewerRe
 					gMessageSystem->getSenderIP(),
 					gMessageSystem->getSenderPort());
 
-	mObjects.push_back(objectp);
+	addToObjectList(objectp);
 
 	updateActive(objectp);
 
@@ -2121,5 +2169,3 @@ bool LLViewerObjectList::OrphanInfo::operator!=(const OrphanInfo &rhs) const
 {
 	return !operator==(rhs);
 }
-
-
@@ -33,8 +33,11 @@
 #ifndef LL_LLVIEWEROBJECTLIST_H
 #define LL_LLVIEWEROBJECTLIST_H
 
+#include <deque>
 #include <map>
 #include <set>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
 // common includes
 #include "llstat.h"
@@ -46,6 +49,7 @@
 class LLNetMap;
 class LLDebugBeacon;
 class LLVOAvatar;
+class LLVertexBuffer;
 
 const U32 CLOSE_BIN_SIZE = 10;
 const U32 NUM_BINS = 128;
@@ -83,8 +87,15 @@ public:
 	void killObjects(LLViewerRegion *regionp); // Kill all objects owned by a particular region.
 	void killAllObjects();
 	void removeDrawable(LLDrawable* drawablep);
+	// Takes over the vertex buffers of a dying drawable's faces so that
+	// they are released by cleanDeadObjects() instead of all at once.
+	void reclaimVertexBuffers(LLDrawable* drawablep);
 
-	void cleanDeadObjects(const bool use_timer = true);	// Clean up the dead object list.
+	// Removes the objects killed since the last call from the object list,
+	// then destroys objects killed earlier.  With use_timer, destruction is
+	// spread over frames within DeadObjectReclaimTime, otherwise everything
+	// is destroyed now.
+	void cleanDeadObjects(const bool use_timer = true);
 
 	// Simulator and viewer side object updates...
 	void processUpdateCore(LLViewerObject* objectp, void** data, U32 block, const EObjectUpdateType update_type, LLDataPacker* dpp, BOOL justCreated);
@@ -206,7 +217,6 @@ public:
 	S32 mNumDeadObjectUpdates;
 	S32 mNumUnknownKills;
 	S32 mNumDeadObjects;
-	S32 mMinNumDeadObjects;
 protected:
 	std::vector<U64>	mOrphanParents;	// LocalID/ip,port of orphaned objects
 	std::vector<OrphanInfo> mOrphanChildren;	// UUID's of orphaned objects
@@ -215,14 +225,34 @@ protected:
 	typedef std::vector<LLPointer<LLViewerObject> > vobj_list_t;
 
 	vobj_list_t mObjects;
-	std::set<LLPointer<LLViewerObject> > mActiveObjects;
+
+	// Dense, unordered; each object knows its own slot so that removal
+	// is a swap with the last entry.  While update() walks the array
+	// removed slots are only cleared and compacted afterwards.
+	vobj_list_t mActiveObjects;
+	BOOL mUpdatingActive;
+	S32 mNumRemovedActive;
+
+	void addActiveObject(LLViewerObject* objectp);
+	void removeActiveObject(LLViewerObject* objectp);
+	void compactActiveObjects();
 
 	vobj_list_t mMapObjects;
 
-	std::set<LLUUID> mDeadObjects;
+	boost::unordered_set<LLUUID> mDeadObjects;
+	// Killed since the last cleanDeadObjects(), still in mObjects
+	vobj_list_t mNewDeadObjects;
+	// Out of every list and waiting to be destroyed, oldest first
+	std::deque<LLPointer<LLViewerObject> > mReclaimObjects;
+	std::deque<LLPointer<LLVertexBuffer> > mReclaimBuffers;
+
+	void addToObjectList(LLViewerObject* objectp);
+	void reclaimDeadObjects(bool use_timer);
 
-	std::map<LLUUID, LLPointer<LLViewerObject> > mUUIDObjectMap;
-	std::map<LLUUID, LLPointer<LLVOAvatar> > mUUIDAvatarMap;
+	typedef boost::unordered_map<LLUUID, LLPointer<LLViewerObject> > uuid_object_map_t;
+	typedef boost::unordered_map<LLUUID, LLPointer<LLVOAvatar> > uuid_avatar_map_t;
+	uuid_object_map_t mUUIDObjectMap;
+	uuid_avatar_map_t mUUIDAvatarMap;
 
 	//set of objects that need to update their cost
 	std::set<LLUUID> mStaleObjectCost;
@@ -239,7 +269,8 @@ protected:
 	static U32 sSimulatorMachineIndex;
 	static std::map<U64, U32> sIPAndPortToIndex;
 
-	static std::map<U64, LLUUID> sIndexAndLocalIDToUUID;
+	typedef boost::unordered_map<U64, LLUUID> local_id_map_t;
+	static local_id_map_t sIndexAndLocalIDToUUID;
 
 	std::set<LLViewerObject *> mSelectPickList;
 
@@ -274,7 +305,7 @@ extern LLViewerObjectList gObjectList;
 // Inlines
 inline LLViewerObject *LLViewerObjectList::findObject(const LLUUID &id)
 {
-	std::map<LLUUID, LLPointer<LLViewerObject> >::iterator iter = mUUIDObjectMap.find(id);
+	uuid_object_map_t::iterator iter = mUUIDObjectMap.find(id);
 	if (iter != mUUIDObjectMap.end())
 	{
 		return iter->second;
@@ -287,7 +318,7 @@ inline LLViewerObject *LLViewerObjectList::findObject(const LLUUID &id)
 
 inline LLVOAvatar *LLViewerObjectList::findAvatar(const LLUUID &id)
 {
-	std::map<LLUUID, LLPointer<LLVOAvatar> >::const_iterator iter = mUUIDAvatarMap.find(id);
+	uuid_avatar_map_t::const_iterator iter = mUUIDAvatarMap.find(id);
 	return (iter != mUUIDAvatarMap.end()) ? iter->second.get() : NULL;
 }
 
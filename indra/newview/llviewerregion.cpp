@@ -1287,6 +1287,29 @@ void LLViewerRegion::dumpCache()
 	}
 }
 
+void LLViewerRegion::getCacheMemoryUsage(LLMemoryAccount::Usage& usage) const
+{
+	for (cache_map_t::const_iterator iter = mCacheMap.begin(); iter != mCacheMap.end(); ++iter)
+	{
+		usage.mBytes += LLMemoryAccount::nodeBytes(1, sizeof(cache_map_t::value_type)) + iter->second->getSize();
+	}
+	usage.mCount += mCacheMap.size();
+}
+
+static void object_cache_memory_usage(LLMemoryAccount::Usage& usage)
+{
+	if (!LLWorld::instanceExists())
+	{
+		return;
+	}
+	const LLWorld::region_list_t& regions = LLWorld::getInstance()->getRegionList();
+	for (LLWorld::region_list_t::const_iterator iter = regions.begin(); iter != regions.end(); ++iter)
+	{
+		(*iter)->getCacheMemoryUsage(usage);
+	}
+}
+static LLMemoryAccount sObjectCacheAccount("Object cache", object_cache_memory_usage);
+
 void LLViewerRegion::unpackRegionHandshake()
 {
 	LLMessageSystem *msg = gMessageSystem;
@@ -49,6 +49,7 @@
 #include "llregionflags.h"
 #include "lluuid.h"
 #include "lldatapacker.h"
+#include "llmemoryaccount.h"
 #include "llvocache.h"
 #include "llweb.h"
 
@@ -284,6 +285,7 @@ public:
 	void addCacheMissFull(const U32 local_id);
 
 	void dumpCache();
+	void getCacheMemoryUsage(LLMemoryAccount::Usage& usage) const;
 
 	void unpackRegionHandshake();
 
@@ -47,6 +47,7 @@
 #include "llimagej2c.h"
 #include "llimagetga.h"
 #include "llmemtype.h"
+#include "llpixelunpackbuffer.h"
 #include "llstl.h"
 #include "lltextureentry.h"
 #include "llvfile.h"
@@ -854,6 +855,12 @@ void LLViewerTexture::setExplicitFormat(LLGLint internal_format, LLGLenum primar
 	llassert(mGLTexturep.notNull());
 	mGLTexturep->setExplicitFormat(internal_format, primary_format, type_format, swap_bytes);
 }
+
+void LLViewerTexture::setAllowCompression(BOOL allow)
+{
+	llassert(mGLTexturep.notNull());
+	mGLTexturep->setAllowCompression(allow);
+}
 void LLViewerTexture::setAddressMode(LLTexUnit::eTextureAddressMode mode)
 {
 	llassert(mGLTexturep.notNull());
@@ -939,6 +946,12 @@ BOOL LLViewerTexture::setSubImage(const U8* datap, S32 data_width, S32 data_heig
 	return mGLTexturep->setSubImage(datap, data_width, data_height, x_pos, y_pos, width, height, fast_update);
 }
 
+U32 LLViewerTexture::setSubImages(LLPixelUnpackBuffer& buffer, const U8* datap, S32 data_width, S32 data_height, const std::vector<LLRect>& rects)
+{
+	llassert(mGLTexturep.notNull());
+	return buffer.upload(mGLTexturep, datap, data_width, data_height, rects);
+}
+
 void LLViewerTexture::setGLTextureCreated (bool initialized)
 {
 	llassert(mGLTexturep.notNull());
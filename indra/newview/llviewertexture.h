@@ -39,6 +39,7 @@
 #include "llhost.h"
 #include "llgltypes.h"
 #include "llrender.h"
+#include "llrect.h"
 
 #include <map>
 #include <list>
@@ -48,6 +49,7 @@
 
 class LLFace;
 class LLImageGL;
+class LLPixelUnpackBuffer;
 class LLImageRaw;
 class LLViewerObject;
 class LLViewerTexture;
@@ -214,9 +216,12 @@ public:
 
 	void       setFilteringOption(LLTexUnit::eTextureFilterOptions option);
 	void       setExplicitFormat(LLGLint internal_format, LLGLenum primary_format, LLGLenum type_format = 0, BOOL swap_bytes = FALSE);
+	void       setAllowCompression(BOOL allow);
 	void       setAddressMode(LLTexUnit::eTextureAddressMode mode);
 	BOOL       setSubImage(const LLImageRaw* imageraw, S32 x_pos, S32 y_pos, S32 width, S32 height, bool fast_update = false);
 	BOOL       setSubImage(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, bool fast_update = false);
+	// Streams several sub-images through buffer in one go.  Returns the number of bytes uploaded.
+	U32        setSubImages(LLPixelUnpackBuffer& buffer, const U8* datap, S32 data_width, S32 data_height, const std::vector<LLRect>& rects);
 	void       setGLTextureCreated(bool initialized);
 	void       setCategory(S32 category);
 
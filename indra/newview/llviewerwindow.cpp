@@ -45,6 +45,7 @@
 // linden library includes
 #include "indra_constants.h"
 #include "llaudioengine.h"					// gAudiop
+#include "llaudiodecodemgr.h"
 #include "llbox.h"							// gBox
 #include "llfocusmgr.h"
 #include "llfontgl.h"
@@ -54,6 +55,7 @@
 #include "llmenugl.h"
 #include "llmodaldialog.h"
 #include "llmousehandler.h"
+#include "llpixelunpackbuffer.h"
 #include "llpostprocess.h"					// gPostProcess
 #include "llrect.h"
 #include "llrender.h"
@@ -122,6 +124,7 @@
 #include "llviewergesture.h"				// gGestureList
 #include "llviewerkeyboard.h"
 #include "llviewerjoystick.h"
+#include "llviewermedia.h"
 #include "llviewermediafocus.h"
 #include "llviewermenu.h"
 #include "llviewermessage.h"				// send_sound_trigger()
@@ -370,6 +373,48 @@ public:
 			ypos += y_inc;
 		}*/
 		
+		static LLCachedControl<bool> debug_show_media_info(gSavedSettings, "DebugShowMediaInfo");
+		if (debug_show_media_info)
+		{
+			std::vector<std::string> lines;
+			LLViewerMedia::getUploadStats(lines);
+			for (std::vector<std::string>::iterator iter = lines.begin(); iter != lines.end(); ++iter)
+			{
+				addText(xpos, ypos, *iter);
+				ypos += y_inc;
+			}
+		}
+
+		static LLCachedControl<bool> debug_show_audio_decode_info(gSavedSettings, "DebugShowAudioDecodeInfo");
+		if (debug_show_audio_decode_info && gAudioDecodeMgrp)
+		{
+			const LLAudioDecodeMgr::Stats& stats = gAudioDecodeMgrp->getStats();
+			addText(xpos, ypos, llformat("Sound cache: %d entries, %.1f MB, %d hits, %d misses",
+										 stats.mCacheEntries, stats.mCacheBytes / (1024.f * 1024.f),
+										 stats.mCacheHits, stats.mCacheMisses));
+			ypos += y_inc;
+			addText(xpos, ypos, llformat("Sound decodes: %d done, %d failed, %d pending",
+										 stats.mDecodes, stats.mFailedDecodes, stats.mPending));
+			ypos += y_inc;
+			addText(xpos, ypos, llformat("Sound decode latency: %.1f ms avg, %.1f ms max, %.1f ms decoding",
+										 stats.mAverageLatency * 1000.f, stats.mMaxLatency * 1000.f,
+										 stats.mAverageDecodeTime * 1000.f));
+			ypos += y_inc;
+		}
+
+		if (LLControlGroup::getLookupTracking())
+		{
+			LLControlGroup::lookup_report_t report;
+			LLControlGroup::getLookupReport(report, 10);
+			for (LLControlGroup::lookup_report_t::iterator iter = report.begin(); iter != report.end(); ++iter)
+			{
+				addText(xpos, ypos, llformat("%8.2f/frame %s", iter->second, iter->first.c_str()));
+				ypos += y_inc;
+			}
+			addText(xpos, ypos, "Settings looked up by name:");
+			ypos += y_inc;
+		}
+
 		static LLCachedControl<bool> debug_show_render_info(gSavedSettings, "DebugShowRenderInfo");
 		if (debug_show_render_info)
 		{
@@ -570,7 +615,8 @@ public:
 			addText(xpos, ypos, "View Matrix");
 			ypos += y_inc;
 		}
-		if (gSavedSettings.getBOOL("DebugShowColor"))
+		static LLControlHandle<bool> debug_show_color(gSavedSettings, "DebugShowColor");
+		if (debug_show_color)
 		{
 			U8 color[4];
 			LLCoordGL coord = gViewerWindow->getCurrentMouse();
@@ -3624,7 +3670,9 @@ LLPickInfo LLViewerWindow::pickImmediate(S32 x, S32 y_from_bot, BOOL pick_transp
 		return LLPickInfo();
 	}
 
-	BOOL in_build_mode = gSavedSettings.getBOOL("BuildBtnState");
+	// Called for every hover pick.
+	static LLControlHandle<bool> build_btn_state(gSavedSettings, "BuildBtnState");
+	BOOL in_build_mode = build_btn_state;
 	if (in_build_mode || LLDrawPoolAlpha::sShowDebugAlpha)
 	{
 		// build mode allows interaction with all transparent objects
@@ -4729,6 +4777,9 @@ void LLViewerWindow::stopGL(BOOL save_state)
 		LLViewerDynamicTexture::destroyGL();
 		stop_glerror();
 
+		LLPixelUnpackBuffer::destroyAllGL();
+		stop_glerror();
+
 		if (gPipeline.isInit())
 		{
 			gPipeline.destroyGL();
@@ -64,6 +64,54 @@ F32 bilinear(const F32 v00, const F32 v01, const F32 v10, const F32 v11, const F
 }
 
 
+// Receives a finished patch blend from LLVLCompositionThread.  Held by both
+// the request and mPendingTextures, so a composition can be destroyed (or
+// drop a stale blend) while the worker is still busy with it.
+class LLVLComposition::TextureResponder : public LLVLCompositionThread::Responder
+{
+public:
+	TextureResponder(S32 x_begin, S32 y_begin, S32 x_end, S32 y_end, S32 tex_width, S32 tex_height) :
+		mTexXBegin(x_begin),
+		mTexYBegin(y_begin),
+		mTexXEnd(x_end),
+		mTexYEnd(y_end),
+		mTexWidth(tex_width),
+		mTexHeight(tex_height),
+		mElapsed(0.f),
+		mSuccess(FALSE)
+	{
+		mDone = FALSE;
+	}
+
+	// Called from the worker thread
+	/*virtual*/ void completed(bool success, LLImageRaw* raw, F32 elapsed)
+	{
+		mRawImage = raw;
+		mElapsed = elapsed;
+		mSuccess = success;
+		mDone = TRUE; // last, publishes the fields above
+	}
+
+	BOOL isDone()					{ return mDone; }
+	BOOL isSuccess() const			{ return mSuccess; }
+	LLImageRaw* getRawImage() const	{ return mRawImage; }
+	F32 getElapsed() const			{ return mElapsed; }
+
+	const S32 mTexXBegin;
+	const S32 mTexYBegin;
+	const S32 mTexXEnd;
+	const S32 mTexYEnd;
+	const S32 mTexWidth;
+	const S32 mTexHeight;
+
+private:
+	LLPointer<LLImageRaw> mRawImage;
+	F32 mElapsed;
+	BOOL mSuccess;
+	LLAtomic32<BOOL> mDone;
+};
+
+
 LLVLComposition::LLVLComposition(LLSurface *surfacep, const U32 width, const F32 scale) :
 	LLViewerLayer(width, scale),
 	mParamsReady(FALSE)
@@ -113,6 +161,9 @@ void LLVLComposition::setDetailTextureID(S32 corner, const LLUUID& id)
 	mDetailTextures[corner] = LLViewerTextureManager::getFetchedTexture(id);
 	mDetailTextures[corner]->setNoDelete();
 	mRawImages[corner] = NULL;
+
+	// Anything still blending used the old detail texture
+	mPendingTextures.clear();
 }
 
 BOOL LLVLComposition::generateHeights(const F32 x, const F32 y,
@@ -148,12 +199,14 @@ BOOL LLVLComposition::generateHeights(const F32 x, const F32 y,
 		y_end = mWidth;
 	}
 
+	// A blend in flight for this patch was sampling the old values
+	mPendingTextures.erase(getPatchKey(x_begin, y_begin));
+
 	LLVector3d origin_global = from_region_handle(mSurfacep->getRegion()->getHandle());
 
 	// For perlin noise generation...
 	const F32 slope_squared = 1.5f*1.5f;
 	const F32 xyScale = 4.9215f; //0.93284f;
-	const F32 zScale = 4; //0.92165f;
 	const F32 z_offset = 0.f;
 	const F32 noise_magnitude = 2.f;		//  Degree to which noise modulates composition layer (versus
 											//  simple height)
@@ -163,56 +216,72 @@ BOOL LLVLComposition::generateHeights(const F32 x, const F32 y,
 	const S32 NUM_TEXTURES = 4;
 
 	const F32 xyScaleInv = (1.f / xyScale);
-	const F32 zScaleInv = (1.f / zScale);
 
 	const F32 inv_width = 1.f/mWidth;
 
 	// OK, for now, just have the composition value equal the height at the point.
+	// Texels are processed four at a time so the noise can be evaluated with
+	// noise2_4()/turbulence2_4(); a short final run is padded by repeating
+	// its last texel.
 	for (S32 j = y_begin; j < y_end; j++)
 	{
-		for (S32 i = x_begin; i < x_end; i++)
+		for (S32 i = x_begin; i < x_end; i += 4)
 		{
+			S32 count = llmin(4, x_end - i);
+
+			F32 height[4];
+			F32 start_height[4];
+			F32 height_range[4];
+			F32 vec_x[4], vec_y[4];
+			F32 vec1_x[4], vec1_y[4];
+			F32 low_freq[4];
+			F32 high_freq[4];
 
-			F32 vec[3];
-			F32 vec1[3];
-			F32 twiddle;
-
-			// Bilinearly interpolate the start height and height range of the textures
-			F32 start_height = bilinear(mStartHeight[SOUTHWEST],
-										mStartHeight[SOUTHEAST],
-										mStartHeight[NORTHWEST],
-										mStartHeight[NORTHEAST],
-										i*inv_width, j*inv_width); // These will be bilinearly interpolated
-			F32 height_range = bilinear(mHeightRange[SOUTHWEST],
-										mHeightRange[SOUTHEAST],
-										mHeightRange[NORTHWEST],
-										mHeightRange[NORTHEAST],
-										i*inv_width, j*inv_width); // These will be bilinearly interpolated
-
-			LLVector3 location(i*mScale, j*mScale, 0.f);
-
-			F32 height = mSurfacep->resolveHeightRegion(location) + z_offset;
-
-			// Step 0: Measure the exact height at this texel
-			vec[0] = (F32)(origin_global.mdV[VX]+location.mV[VX])*xyScaleInv;	//  Adjust to non-integer lattice
-			vec[1] = (F32)(origin_global.mdV[VY]+location.mV[VY])*xyScaleInv;
-			vec[2] = height*zScaleInv;
-			//
-			//  Choose material value by adding to the exact height a random value 
-			//
-			vec1[0] = vec[0]*(0.2222222222f);
-			vec1[1] = vec[1]*(0.2222222222f);
-			vec1[2] = vec[2]*(0.2222222222f);
-			twiddle = noise2(vec1)*6.5f;					//  Low freq component for large divisions
-
-			twiddle += turbulence2(vec, 2)*slope_squared;	//  High frequency component
-			twiddle *= noise_magnitude;
-
-			F32 scaled_noisy_height = (height + twiddle - start_height) * F32(NUM_TEXTURES) / height_range;
-
-			scaled_noisy_height = llmax(0.f, scaled_noisy_height);
-			scaled_noisy_height = llmin(3.f, scaled_noisy_height);
-			*(mDatap + i + j*mWidth) = scaled_noisy_height;
+			for (S32 k = 0; k < 4; k++)
+			{
+				S32 x = i + llmin(k, count - 1);
+
+				// Bilinearly interpolate the start height and height range of the textures
+				start_height[k] = bilinear(mStartHeight[SOUTHWEST],
+										   mStartHeight[SOUTHEAST],
+										   mStartHeight[NORTHWEST],
+										   mStartHeight[NORTHEAST],
+										   x*inv_width, j*inv_width); // These will be bilinearly interpolated
+				height_range[k] = bilinear(mHeightRange[SOUTHWEST],
+										   mHeightRange[SOUTHEAST],
+										   mHeightRange[NORTHWEST],
+										   mHeightRange[NORTHEAST],
+										   x*inv_width, j*inv_width); // These will be bilinearly interpolated
+
+				LLVector3 location(x*mScale, j*mScale, 0.f);
+
+				height[k] = mSurfacep->resolveHeightRegion(location) + z_offset;
+
+				// Step 0: Measure the exact height at this texel
+				vec_x[k] = (F32)(origin_global.mdV[VX]+location.mV[VX])*xyScaleInv;	//  Adjust to non-integer lattice
+				vec_y[k] = (F32)(origin_global.mdV[VY]+location.mV[VY])*xyScaleInv;
+				//
+				//  Choose material value by adding to the exact height a random value 
+				//
+				vec1_x[k] = vec_x[k]*(0.2222222222f);
+				vec1_y[k] = vec_y[k]*(0.2222222222f);
+			}
+
+			noise2_4(vec1_x, vec1_y, low_freq);			//  Low freq component for large divisions
+			turbulence2_4(vec_x, vec_y, 2, high_freq);	//  High frequency component
+
+			for (S32 k = 0; k < count; k++)
+			{
+				F32 twiddle = low_freq[k]*6.5f;
+				twiddle += high_freq[k]*slope_squared;
+				twiddle *= noise_magnitude;
+
+				F32 scaled_noisy_height = (height[k] + twiddle - start_height[k]) * F32(NUM_TEXTURES) / height_range[k];
+
+				scaled_noisy_height = llmax(0.f, scaled_noisy_height);
+				scaled_noisy_height = llmin(3.f, scaled_noisy_height);
+				*(mDatap + i + k + j*mWidth) = scaled_noisy_height;
+			}
 		}
 	}
 	return TRUE;
@@ -266,7 +335,46 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 	llassert(x >= 0.f);
 	llassert(y >= 0.f);
 
-	LLTimer gen_timer;
+	///////////////////////////////////////
+	//
+	// Generate and clamp x/y bounding box.
+	//
+	//
+
+	S32 x_begin, y_begin, x_end, y_end;
+	x_begin = (S32)(x * mScaleInv);
+	y_begin = (S32)(y * mScaleInv);
+	x_end = llround( (x + width) * mScaleInv );
+	y_end = llround( (y + width) * mScaleInv );
+
+	if (x_end > mWidth)
+	{
+		llwarns << "x end > width" << llendl;
+		x_end = mWidth;
+	}
+	if (y_end > mWidth)
+	{
+		llwarns << "y end > width" << llendl;
+		y_end = mWidth;
+	}
+
+	const U32 patch_key = getPatchKey(x_begin, y_begin);
+	pending_texture_map_t::iterator pending_it = mPendingTextures.find(patch_key);
+	if (pending_it != mPendingTextures.end())
+	{
+		LLPointer<TextureResponder> responder = pending_it->second;
+		if (!responder->isDone())
+		{
+			// Still blending
+			return FALSE;
+		}
+		mPendingTextures.erase(pending_it);
+		if (responder->isSuccess())
+		{
+			return uploadTexture(responder);
+		}
+		// Failed, so start over below
+	}
 
 	///////////////////////////
 	//
@@ -275,9 +383,6 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 	//
 
 	// These have already been validated by generateComposition.
-	U8* st_data[4];
-	S32 st_data_size[4]; // for debugging
-
 	for (S32 i = 0; i < 4; i++)
 	{
 		if (mRawImages[i].isNull())
@@ -315,34 +420,8 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 				mRawImages[i] = newraw; // deletes old
 			}
 		}
-		st_data[i] = mRawImages[i]->getData();
-		st_data_size[i] = mRawImages[i]->getDataSize();
 	}
 
-	///////////////////////////////////////
-	//
-	// Generate and clamp x/y bounding box.
-	//
-	//
-
-	S32 x_begin, y_begin, x_end, y_end;
-	x_begin = (S32)(x * mScaleInv);
-	y_begin = (S32)(y * mScaleInv);
-	x_end = llround( (x + width) * mScaleInv );
-	y_end = llround( (y + width) * mScaleInv );
-
-	if (x_end > mWidth)
-	{
-		llwarns << "x end > width" << llendl;
-		x_end = mWidth;
-	}
-	if (y_end > mWidth)
-	{
-		llwarns << "y end > width" << llendl;
-		y_end = mWidth;
-	}
-
-
 	///////////////////////////////////////////
 	//
 	// Generate target texture information, stride ratios.
@@ -351,16 +430,12 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 
 	LLViewerTexture *texturep;
 	U32 tex_width, tex_height, tex_comps;
-	U32 tex_stride;
 	F32 tex_x_scalef, tex_y_scalef;
-	S32 tex_x_begin, tex_y_begin, tex_x_end, tex_y_end;
-	F32 tex_x_ratiof, tex_y_ratiof;
 
 	texturep = mSurfacep->getSTexture();
 	tex_width = texturep->getWidth();
 	tex_height = texturep->getHeight();
 	tex_comps = texturep->getComponents();
-	tex_stride = tex_width * tex_comps;
 
 	U32 st_comps = 3;
 	U32 st_width = BASE_SIZE;
@@ -372,101 +447,74 @@ BOOL LLVLComposition::generateTexture(const F32 x, const F32 y,
 		return FALSE;
 	}
 
+	LLVLCompositionThread::Params params;
+	for (S32 i = 0; i < 4; i++)
+	{
+		params.mDetailImages[i] = mRawImages[i];
+	}
+	params.mDetailWidth = st_width;
+	params.mDetailHeight = st_height;
+
 	tex_x_scalef = (F32)tex_width / (F32)mWidth;
 	tex_y_scalef = (F32)tex_height / (F32)mWidth;
-	tex_x_begin = (S32)((F32)x_begin * tex_x_scalef);
-	tex_y_begin = (S32)((F32)y_begin * tex_y_scalef);
-	tex_x_end = (S32)((F32)x_end * tex_x_scalef);
-	tex_y_end = (S32)((F32)y_end * tex_y_scalef);
-
-	tex_x_ratiof = (F32)mWidth*mScale / (F32)tex_width;
-	tex_y_ratiof = (F32)mWidth*mScale / (F32)tex_height;
-
-	LLPointer<LLImageRaw> raw = new LLImageRaw(tex_width, tex_height, tex_comps);
-	U8 *rawp = raw->getData();
-
-	F32 tex_width_inv = 1.f/tex_width;
-	F32 tex_height_inv = 1.f/tex_height;
-
-	F32 st_x_stride, st_y_stride;
-	st_x_stride = ((F32)st_width / (F32)mTexScaleX)*((F32)mWidth / (F32)tex_width);
-	st_y_stride = ((F32)st_height / (F32)mTexScaleY)*((F32)mWidth / (F32)tex_height);
-
-	llassert(st_x_stride > 0.f);
-	llassert(st_y_stride > 0.f);
-	////////////////////////////////
-	//
-	// Iterate through the target texture, striding through the
-	// subtextures and interpolating appropriately.
-	//
-	//
-
-	F32 sti, stj;
-	S32 st_offset;
-	sti = (tex_x_begin * st_x_stride) - st_width*(llfloor((tex_x_begin * st_x_stride)/st_width));
-	stj = (tex_y_begin * st_y_stride) - st_height*(llfloor((tex_y_begin * st_y_stride)/st_height));
+	params.mTexWidth = tex_width;
+	params.mTexHeight = tex_height;
+	params.mTexXBegin = (S32)((F32)x_begin * tex_x_scalef);
+	params.mTexYBegin = (S32)((F32)y_begin * tex_y_scalef);
+	params.mTexXEnd = (S32)((F32)x_end * tex_x_scalef);
+	params.mTexYEnd = (S32)((F32)y_end * tex_y_scalef);
+
+	params.mTexXRatio = (F32)mWidth*mScale / (F32)tex_width;
+	params.mTexYRatio = (F32)mWidth*mScale / (F32)tex_height;
+
+	params.mSTXStride = ((F32)st_width / (F32)mTexScaleX)*((F32)mWidth / (F32)tex_width);
+	params.mSTYStride = ((F32)st_height / (F32)mTexScaleY)*((F32)mWidth / (F32)tex_height);
+
+	llassert(params.mSTXStride > 0.f);
+	llassert(params.mSTYStride > 0.f);
+
+	// Copy the composition rows this patch samples, with a row of apron on
+	// each side for the bilinear lookup.
+	params.mCompWidth = mWidth;
+	params.mCompScaleInv = mScaleInv;
+	params.mCompRowBegin = llclamp(llfloor(params.mTexYBegin * params.mTexYRatio * mScaleInv) - 1, 0, mWidth - 1);
+	S32 comp_row_end = llclamp(llfloor(params.mTexYEnd * params.mTexYRatio * mScaleInv) + 2, params.mCompRowBegin + 1, mWidth);
+	params.mCompRows = comp_row_end - params.mCompRowBegin;
+	params.mComposition.assign(mDatap + params.mCompRowBegin * mWidth, mDatap + comp_row_end * mWidth);
+
+	LLPointer<TextureResponder> responder = new TextureResponder(params.mTexXBegin, params.mTexYBegin,
+																  params.mTexXEnd, params.mTexYEnd,
+																  tex_width, tex_height);
+	LLVLCompositionThread::sLocal->compose(params, responder);
+	mPendingTextures[patch_key] = responder;
+
+	return FALSE;
+}
 
-	st_offset = (llfloor(stj * st_width) + llfloor(sti)) * st_comps;
-	for (S32 j = tex_y_begin; j < tex_y_end; j++)
+BOOL LLVLComposition::uploadTexture(TextureResponder* responder)
+{
+	LLViewerTexture* texturep = mSurfacep->getSTexture();
+	if (texturep->getWidth() != responder->mTexWidth ||
+		texturep->getHeight() != responder->mTexHeight)
 	{
-		U32 offset = j * tex_stride + tex_x_begin * tex_comps;
-		sti = (tex_x_begin * st_x_stride) - st_width*((U32)(tex_x_begin * st_x_stride)/st_width);
-		for (S32 i = tex_x_begin; i < tex_x_end; i++)
-		{
-			S32 tex0, tex1;
-			F32 composition = getValueScaled(i*tex_x_ratiof, j*tex_y_ratiof);
-
-			tex0 = llfloor( composition );
-			tex0 = llclamp(tex0, 0, 3);
-			composition -= tex0;
-			tex1 = tex0 + 1;
-			tex1 = llclamp(tex1, 0, 3);
-
-			F32 xy_int_i, xy_int_j;
-
-			xy_int_i = i * tex_width_inv;
-			xy_int_j = j * tex_height_inv;
-
-			st_offset = (lltrunc(sti) + lltrunc(stj)*st_width) * st_comps;
-			for (U32 k = 0; k < tex_comps; k++)
-			{
-				// Linearly interpolate based on composition.
-				if (st_offset >= st_data_size[tex0] || st_offset >= st_data_size[tex1])
-				{
-					// SJB: This shouldn't be happening, but does... Rounding error?
-					//llwarns << "offset 0 [" << tex0 << "] =" << st_offset << " >= size=" << st_data_size[tex0] << llendl;
-					//llwarns << "offset 1 [" << tex1 << "] =" << st_offset << " >= size=" << st_data_size[tex1] << llendl;
-				}
-				else
-				{
-					F32 a = *(st_data[tex0] + st_offset);
-					F32 b = *(st_data[tex1] + st_offset);
-					rawp[ offset ] = (U8)lltrunc( a + composition * (b - a) );
-				}
-				offset++;
-				st_offset++;
-			}
+		// Surface texture was resized while blending; discard and regenerate.
+		return FALSE;
+	}
 
-			sti += st_x_stride;
-			if (sti >= st_width)
-			{
-				sti -= st_width;
-			}
-		}
+	LLTimer gen_timer;
 
-		stj += st_y_stride;
-		if (stj >= st_height)
-		{
-			stj -= st_height;
-		}
-	}
+	LLImageRaw* raw = responder->getRawImage();
+	S32 tex_x_begin = responder->mTexXBegin;
+	S32 tex_y_begin = responder->mTexYBegin;
+	S32 tex_x_end = responder->mTexXEnd;
+	S32 tex_y_end = responder->mTexYEnd;
 
 	if (!texturep->hasGLTexture())
 	{
 		texturep->createGLTexture(0, raw);
 	}
 	texturep->setSubImage(raw, tex_x_begin, tex_y_begin, tex_x_end - tex_x_begin, tex_y_end - tex_y_begin);
-	LLSurface::sTextureUpdateTime += gen_timer.getElapsedTimeF32();
+	LLSurface::sTextureUpdateTime += gen_timer.getElapsedTimeF32() + responder->getElapsed();
 	LLSurface::sTexelsUpdated += (tex_x_end - tex_x_begin) * (tex_y_end - tex_y_begin);
 
 	for (S32 i = 0; i < 4; i++)
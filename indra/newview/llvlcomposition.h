@@ -35,6 +35,7 @@
 
 #include "llviewerlayer.h"
 #include "llviewertexture.h"
+#include "llvlcompositionthread.h"
 
 class LLSurface;
 
@@ -49,7 +50,9 @@ public:
 	// Viewer side hack to generate composition values
 	BOOL generateHeights(const F32 x, const F32 y, const F32 width, const F32 height);
 	BOOL generateComposition();
-	// Generate texture from composition values.
+	// Generate texture from composition values.  The blend runs on
+	// LLVLCompositionThread; this returns FALSE until a later call finds the
+	// result ready and uploads it.
 	BOOL generateTexture(const F32 x, const F32 y, const F32 width, const F32 height);		
 
 	// Use these as indeces ito the get/setters below that use 'corner'
@@ -74,6 +77,12 @@ public:
 	friend class LLDrawPoolTerrain;
 	void setParamsReady()		{ mParamsReady = TRUE; }
 	BOOL getParamsReady() const	{ return mParamsReady; }
+protected:
+	class TextureResponder;
+	BOOL uploadTexture(TextureResponder* responder);
+
+	static U32 getPatchKey(S32 x_begin, S32 y_begin)	{ return ((U32)x_begin << 16) | (U32)y_begin; }
+
 protected:
 	BOOL mParamsReady;
 	LLSurface *mSurfacep;
@@ -87,6 +96,11 @@ protected:
 
 	F32 mTexScaleX;
 	F32 mTexScaleY;
+
+	// Blends in flight on LLVLCompositionThread, keyed by patch origin.
+	// Dropping an entry abandons the result.
+	typedef std::map<U32, LLPointer<TextureResponder> > pending_texture_map_t;
+	pending_texture_map_t mPendingTextures;
 };
 
 #endif //LL_LLVLCOMPOSITION_H
@@ -0,0 +1,300 @@
+/** 
+ * @file llvlcompositionthread.cpp
+ * @brief Worker thread that blends terrain detail textures into surface texture patches.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llvlcompositionthread.h"
+
+#include "llmath.h"
+#include "llsimdmath.h"
+#include "lltimer.h"
+
+//============================================================================
+
+/*static*/ LLVLCompositionThread* LLVLCompositionThread::sLocal = NULL;
+
+//============================================================================
+// Run on MAIN thread
+//static
+void LLVLCompositionThread::initClass(bool local_is_threaded)
+{
+	llassert(sLocal == NULL);
+	sLocal = new LLVLCompositionThread(local_is_threaded);
+}
+
+//static
+S32 LLVLCompositionThread::updateClass(U32 ms_elapsed)
+{
+	sLocal->update(ms_elapsed);
+	return sLocal->getPending();
+}
+
+//static
+void LLVLCompositionThread::cleanupClass()
+{
+	sLocal->setQuitting();
+	while (sLocal->getPending())
+	{
+		sLocal->update(0);
+	}
+	delete sLocal;
+	sLocal = NULL;
+}
+
+//----------------------------------------------------------------------------
+
+LLVLCompositionThread::LLVLCompositionThread(bool threaded) :
+	LLQueuedThread("terraincomposition", threaded)
+{
+}
+
+LLVLCompositionThread::~LLVLCompositionThread()
+{
+	// ~LLQueuedThread() will be called here
+}
+
+LLVLCompositionThread::handle_t LLVLCompositionThread::compose(const Params& params, Responder* responder, U32 priority)
+{
+	handle_t handle = generateHandle();
+
+	if (priority == 0) priority = PRIORITY_NORMAL;
+
+	Request* req = new Request(handle, priority, params, responder);
+
+	bool res = addRequest(req);
+	if (!res)
+	{
+		llerrs << "LLVLCompositionThread::compose called after LLVLCompositionThread::cleanupClass()" << llendl;
+	}
+
+	return handle;
+}
+
+LLVLCompositionThread::Responder::~Responder()
+{
+}
+
+//============================================================================
+
+LLVLCompositionThread::Params::Params() :
+	mDetailWidth(0),
+	mDetailHeight(0),
+	mCompWidth(0),
+	mCompRowBegin(0),
+	mCompRows(0),
+	mCompScaleInv(1.f),
+	mTexWidth(0),
+	mTexHeight(0),
+	mTexXBegin(0),
+	mTexYBegin(0),
+	mTexXEnd(0),
+	mTexYEnd(0),
+	mTexXRatio(1.f),
+	mTexYRatio(1.f),
+	mSTXStride(1.f),
+	mSTYStride(1.f)
+{
+}
+
+//============================================================================
+
+LLVLCompositionThread::Request::Request(handle_t handle, U32 priority,
+										const Params& params, Responder* responder) :
+	QueuedRequest(handle, priority, FLAG_AUTO_COMPLETE),
+	mParams(params),
+	mElapsed(0.f),
+	mResponder(responder)
+{
+}
+
+LLVLCompositionThread::Request::~Request()
+{
+}
+
+// virtual, called from own thread
+void LLVLCompositionThread::Request::finishRequest(bool completed)
+{
+	if (mResponder.notNull())
+	{
+		mResponder->completed(completed && mRawImage.notNull(), mRawImage, mElapsed);
+		mResponder = NULL;
+	}
+}
+
+// Same interpolation as LLViewerLayer::getValueScaled(), against the copied rows.
+F32 LLVLCompositionThread::Request::getCompositionScaled(F32 x, F32 y) const
+{
+	S32 x1, x2, y1, y2;
+	F32 x_frac, y_frac;
+
+	x_frac = x*mParams.mCompScaleInv;
+	x1 = llfloor(x_frac);
+	x2 = x1 + 1;
+	x_frac -= x1;
+
+	y_frac = y*mParams.mCompScaleInv;
+	y1 = llfloor(y_frac);
+	y2 = y1 + 1;
+	y_frac -= y1;
+
+	const S32 last = mParams.mCompWidth - 1;
+	x1 = llclamp(x1, 0, last);
+	x2 = llclamp(x2, 0, last);
+	y1 = llclamp(llclamp(y1, 0, last) - mParams.mCompRowBegin, 0, mParams.mCompRows - 1);
+	y2 = llclamp(llclamp(y2, 0, last) - mParams.mCompRowBegin, 0, mParams.mCompRows - 1);
+
+	const F32* datap = &mParams.mComposition[0];
+	S32 row1 = y1 * mParams.mCompWidth;
+	S32 row2 = y2 * mParams.mCompWidth;
+
+	F32 row1_left  = datap[ row1 + x1 ];
+	F32 row1_right = datap[ row1 + x2 ];
+	F32 row2_left  = datap[ row2 + x1 ];
+	F32 row2_right = datap[ row2 + x2 ];
+
+	F32 row1_interp = row1_left - x_frac * (row1_left - row1_right);
+	F32 row2_interp = row2_left - x_frac * (row2_left - row2_right);
+
+	return row1_interp - y_frac * (row1_interp - row2_interp);
+}
+
+bool LLVLCompositionThread::Request::processRequest()
+{
+	LLTimer gen_timer;
+
+	const S32 tex_comps = 3;
+	const S32 tex_stride = mParams.mTexWidth * tex_comps;
+	const S32 st_width = mParams.mDetailWidth;
+	const S32 st_height = mParams.mDetailHeight;
+	const S32 st_last = st_width * st_height - 1;
+
+	if (mParams.mComposition.empty() || !st_width || !st_height)
+	{
+		return true; // done (failed)
+	}
+
+	const U8* st_data[DETAIL_COUNT];
+	for (S32 i = 0; i < DETAIL_COUNT; i++)
+	{
+		if (mParams.mDetailImages[i].isNull()
+			|| mParams.mDetailImages[i]->getDataSize() < (st_last + 1) * tex_comps)
+		{
+			return true; // done (failed)
+		}
+		st_data[i] = mParams.mDetailImages[i]->getData();
+	}
+
+	// LLImageGL::setSubImage() addresses the patch within a full size
+	// source image, so the result covers the whole surface texture.
+	mRawImage = new LLImageRaw(mParams.mTexWidth, mParams.mTexHeight, tex_comps);
+	U8* rawp = mRawImage->getData();
+
+	const S32 tex_x_begin = mParams.mTexXBegin;
+	const S32 tex_x_end = mParams.mTexXEnd;
+	const F32 st_x_stride = mParams.mSTXStride;
+	const F32 st_y_stride = mParams.mSTYStride;
+
+	F32 sti, stj;
+	stj = (mParams.mTexYBegin * st_y_stride) - st_height*(llfloor((mParams.mTexYBegin * st_y_stride)/st_height));
+
+	for (S32 j = mParams.mTexYBegin; j < mParams.mTexYEnd; j++)
+	{
+		U8* dstp = rawp + j * tex_stride + tex_x_begin * tex_comps;
+		sti = (tex_x_begin * st_x_stride) - st_width*((U32)(tex_x_begin * st_x_stride)/st_width);
+		const S32 st_row = llclamp(lltrunc(stj), 0, st_height - 1) * st_width;
+
+		// Gather four texels worth of detail samples and blend weights,
+		// then blend all twelve channels with three SSE lerps.
+		LL_ALIGN_16(F32 a[12]) = { 0.f };
+		LL_ALIGN_16(F32 b[12]) = { 0.f };
+		LL_ALIGN_16(F32 w[12]) = { 0.f };
+		LL_ALIGN_16(U8 blended[16]);
+
+		S32 i = tex_x_begin;
+		while (i < tex_x_end)
+		{
+			const S32 count = llmin(4, tex_x_end - i);
+			for (S32 k = 0; k < count; k++)
+			{
+				F32 composition = getCompositionScaled((i + k)*mParams.mTexXRatio, j*mParams.mTexYRatio);
+
+				S32 tex0 = llclamp(llfloor(composition), 0, 3);
+				composition -= tex0;
+				S32 tex1 = llclamp(tex0 + 1, 0, 3);
+
+				// Clamping here stands in for the old bounds check that
+				// skipped texels lost to rounding at the detail texture edge.
+				const S32 st_offset = llclamp(lltrunc(sti) + st_row, 0, st_last) * tex_comps;
+				const U8* ap = st_data[tex0] + st_offset;
+				const U8* bp = st_data[tex1] + st_offset;
+				for (S32 c = 0; c < tex_comps; c++)
+				{
+					a[k*tex_comps + c] = ap[c];
+					b[k*tex_comps + c] = bp[c];
+					w[k*tex_comps + c] = composition;
+				}
+
+				sti += st_x_stride;
+				if (sti >= st_width)
+				{
+					sti -= st_width;
+				}
+			}
+
+			// a + w * (b - a), truncated to U8
+			__m128i res[3];
+			for (S32 q = 0; q < 3; q++)
+			{
+				__m128 va = _mm_load_ps(a + q*4);
+				__m128 vb = _mm_load_ps(b + q*4);
+				__m128 vw = _mm_load_ps(w + q*4);
+				res[q] = _mm_cvttps_epi32(_mm_add_ps(va, _mm_mul_ps(vw, _mm_sub_ps(vb, va))));
+			}
+			__m128i lo = _mm_packs_epi32(res[0], res[1]);
+			__m128i hi = _mm_packs_epi32(res[2], res[2]);
+			_mm_store_si128((__m128i*)blended, _mm_packus_epi16(lo, hi));
+
+			memcpy(dstp, blended, count * tex_comps);
+			dstp += count * tex_comps;
+			i += count;
+		}
+
+		stj += st_y_stride;
+		if (stj >= st_height)
+		{
+			stj -= st_height;
+		}
+	}
+
+	mElapsed = gen_timer.getElapsedTimeF32();
+	return true;
+}
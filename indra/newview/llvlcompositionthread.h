@@ -0,0 +1,129 @@
+/** 
+ * @file llvlcompositionthread.h
+ * @brief Worker thread that blends terrain detail textures into surface texture patches.
+ *
+ * $LicenseInfo:firstyear=2011&license=viewergpl$
+ * 
+ * Copyright (c) 2011, Linden Research, Inc.
+ * 
+ * Second Life Viewer Source Code
+ * The source code in this file ("Source Code") is provided by Linden Lab
+ * to you under the terms of the GNU General Public License, version 2.0
+ * ("GPL"), unless you have obtained a separate licensing agreement
+ * ("Other License"), formally executed by you and Linden Lab.  Terms of
+ * the GPL can be found in doc/GPL-license.txt in this distribution, or
+ * online at http://secondlifegrid.net/programs/open_source/licensing/gplv2
+ * 
+ * There are special exceptions to the terms and conditions of the GPL as
+ * it is applied to this Source Code. View the full text of the exception
+ * in the file doc/FLOSS-exception.txt in this software distribution, or
+ * online at
+ * http://secondlifegrid.net/programs/open_source/licensing/flossexception
+ * 
+ * By copying, modifying or distributing this software, you acknowledge
+ * that you have read and understood your obligations described above,
+ * and agree to abide by those obligations.
+ * 
+ * ALL LINDEN LAB SOURCE CODE IS PROVIDED "AS IS." LINDEN LAB MAKES NO
+ * WARRANTIES, EXPRESS, IMPLIED OR OTHERWISE, REGARDING ITS ACCURACY,
+ * COMPLETENESS OR PERFORMANCE.
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVLCOMPOSITIONTHREAD_H
+#define LL_LLVLCOMPOSITIONTHREAD_H
+
+#include "llimage.h"
+#include "llpointer.h"
+#include "llqueuedthread.h"
+
+//============================================================================
+// Terrain texture composition.
+//
+// LLVLComposition snapshots everything a patch blend needs into Params on
+// the main thread (ref-counted detail images and a copy of the composition
+// rows the patch samples), so the worker never touches LLSurface or the
+// layer itself.  The main thread only uploads the finished LLImageRaw.
+//============================================================================
+
+class LLVLCompositionThread : public LLQueuedThread
+{
+public:
+	enum { DETAIL_COUNT = 4 };
+
+	class Responder : public LLThreadSafeRefCount
+	{
+	protected:
+		virtual ~Responder();
+	public:
+		// Called from the worker thread.
+		virtual void completed(bool success, LLImageRaw* raw, F32 elapsed) = 0;
+	};
+
+	struct Params
+	{
+		Params();
+
+		// Detail textures, all mDetailWidth x mDetailHeight with 3 components
+		LLPointer<LLImageRaw> mDetailImages[DETAIL_COUNT];
+		S32 mDetailWidth;
+		S32 mDetailHeight;
+
+		// Rows [mCompRowBegin, mCompRowBegin + mCompRows) of the composition layer
+		std::vector<F32> mComposition;
+		S32 mCompWidth;
+		S32 mCompRowBegin;
+		S32 mCompRows;
+		F32 mCompScaleInv;
+
+		// Target surface texture and the patch rectangle within it
+		S32 mTexWidth;
+		S32 mTexHeight;
+		S32 mTexXBegin;
+		S32 mTexYBegin;
+		S32 mTexXEnd;
+		S32 mTexYEnd;
+		F32 mTexXRatio;
+		F32 mTexYRatio;
+
+		// Detail texture texels stepped per surface texel
+		F32 mSTXStride;
+		F32 mSTYStride;
+	};
+
+	class Request : public QueuedRequest
+	{
+	protected:
+		virtual ~Request(); // use deleteRequest()
+
+	public:
+		Request(handle_t handle, U32 priority, const Params& params, Responder* responder);
+
+		/*virtual*/ bool processRequest();
+		/*virtual*/ void finishRequest(bool completed);
+
+	private:
+		F32 getCompositionScaled(F32 x, F32 y) const;
+
+		Params mParams;
+		LLPointer<LLImageRaw> mRawImage;
+		F32 mElapsed;
+		LLPointer<Responder> mResponder;
+	};
+
+public:
+	LLVLCompositionThread(bool threaded = true);
+	~LLVLCompositionThread();
+
+	handle_t compose(const Params& params, Responder* responder, U32 priority = 0);
+
+	// static initializers
+	static void initClass(bool local_is_threaded = true); // Setup sLocal
+	static S32 updateClass(U32 ms_elapsed);
+	static void cleanupClass();		// Delete sLocal
+
+public:
+	static LLVLCompositionThread* sLocal;
+};
+
+#endif // LL_LLVLCOMPOSITIONTHREAD_H
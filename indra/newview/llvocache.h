@@ -54,6 +54,7 @@ public:
 	U32 getCRC() const				{ return mCRC; }
 	S32 getHitCount() const			{ return mHitCount; }
 	S32 getCRCChangeCount() const	{ return mCRCChangeCount; }
+	S32 getSize() const				{ return sizeof(LLVOCacheEntry) + mDP.getBufferSize(); }
 
 	void dump() const;
 	void writeToFile(LLFILE *fp) const;
@@ -240,6 +240,8 @@ public:
 	// World Mipmap delegation: currently used when drawing the mipmap
 	void	equalizeBoostLevels();
 	LLPointer<LLViewerFetchedTexture> getObjectsTile(U32 grid_x, U32 grid_y, S32 level, bool load = true) { return mWorldMipmap.getObjectsTile(grid_x, grid_y, level, load); }
+	bool	isObjectsTilePending(U32 grid_x, U32 grid_y, S32 level) { return mWorldMipmap.isObjectsTilePending(grid_x, grid_y, level); }
+	void	prefetchObjectsTile(U32 grid_x, U32 grid_y, S32 level) { mWorldMipmap.prefetchObjectsTile(grid_x, grid_y, level); }
 
 private:
 	bool clearItems(bool force = false);	// Clears the item lists
@@ -176,7 +176,8 @@ LLWorldMapView::LLWorldMapView(const std::string& name, const LLRect& rect)
 	mMouseDownPanY(0),
 	mMouseDownX(0),
 	mMouseDownY(0),
-	mSelectIDStart(0)
+	mSelectIDStart(0),
+	mLastPrefetchScale(0.f)
 {
 	//LL_INFOS("World Map") << "Creating the Map -> LLWorldMapView::LLWorldMapView()" << LL_ENDL;
 
@@ -680,9 +681,70 @@ void LLWorldMapView::drawMipmap(S32 width, S32 height)
 	// Render the current level
 	sVisibleTilesLoaded = drawMipmapLevel(width, height, level);
 
+	// And get ready for the next ones
+	prefetchMipmap(width, height, level);
+
 	return;
 }
 
+// Ask for the tiles the view is about to uncover when it's panning, and for the next level when it's zooming
+void LLWorldMapView::prefetchMipmap(S32 width, S32 height, S32 level)
+{
+	LLVector3d center = viewPosToGlobal(width / 2, height / 2);
+	F64 delta_x = center[VX] - mLastPrefetchCenter[VX];
+	F64 delta_y = center[VY] - mLastPrefetchCenter[VY];
+	F32 delta_scale = sMapScale - mLastPrefetchScale;
+	bool first = (mLastPrefetchScale == 0.f);
+	mLastPrefetchCenter = center;
+	mLastPrefetchScale = sMapScale;
+	if (first)
+	{
+		return;
+	}
+
+	LLVector3d pos_SW = viewPosToGlobal(0, 0);
+	LLVector3d pos_NE = viewPosToGlobal(width, height);
+
+	if (delta_x != 0.0 || delta_y != 0.0)
+	{
+		// Half a screen ahead in the direction of the pan
+		F64 offset_x = (delta_x > 0.0 ? 0.5 : (delta_x < 0.0 ? -0.5 : 0.0)) * (pos_NE[VX] - pos_SW[VX]);
+		F64 offset_y = (delta_y > 0.0 ? 0.5 : (delta_y < 0.0 ? -0.5 : 0.0)) * (pos_NE[VY] - pos_SW[VY]);
+		prefetchMipmapLevel(LLVector3d(pos_SW[VX] + offset_x, pos_SW[VY] + offset_y, pos_SW[VZ]),
+							LLVector3d(pos_NE[VX] + offset_x, pos_NE[VY] + offset_y, pos_NE[VZ]), level);
+	}
+
+	if (delta_scale > 0.f && level > 1)
+	{
+		// Zooming in
+		prefetchMipmapLevel(pos_SW, pos_NE, level - 1);
+	}
+	else if (delta_scale < 0.f && level < LLWorldMipmap::MAP_LEVELS)
+	{
+		// Zooming out
+		prefetchMipmapLevel(pos_SW, pos_NE, level + 1);
+	}
+}
+
+void LLWorldMapView::prefetchMipmapLevel(const LLVector3d& pos_SW, const LLVector3d& pos_NE, S32 level)
+{
+	// Same walk as drawMipmapLevel()
+	S32 tile_width = LLWorldMipmap::MAP_TILE_SIZE * (1 << (level - 1));
+	U32 grid_x, grid_y;
+	for (F64 index_y = pos_SW[VY]; index_y < pos_NE[VY] + tile_width; index_y += tile_width)
+	{
+		for (F64 index_x = pos_SW[VX]; index_x < pos_NE[VX] + tile_width; index_x += tile_width)
+		{
+			if (index_x < 0.0 || index_y < 0.0)
+			{
+				continue;
+			}
+			LLWorldMipmap::globalToMipmap(index_x, index_y, level, &grid_x, &grid_y);
+			LLWorldMap::getInstance()->prefetchObjectsTile(grid_x, grid_y, level);
+		}
+	}
+}
+
 // Return true if all the tiles required to render that level have been fetched or are truly missing
 bool LLWorldMapView::drawMipmapLevel(S32 width, S32 height, S32 level, bool load)
 {
@@ -766,7 +828,7 @@ bool LLWorldMapView::drawMipmapLevel(S32 width, S32 height, S32 level, bool load
 				//	LL_INFOS("World Map") << "Unfetched tile. level = " << level << LL_ENDL;
 				//}
 			}
-			else
+			else if (!LLWorldMap::getInstance()->isObjectsTilePending(grid_x, grid_y, level))
 			{
 				// Unexistent tiles are counted as "completed"
 				completed_tiles++;
@@ -91,6 +91,8 @@ public:
 	void			drawFrustum();
 	void			drawMipmap(S32 width, S32 height);
 	bool			drawMipmapLevel(S32 width, S32 height, S32 level, bool load = true);
+	void			prefetchMipmap(S32 width, S32 height, S32 level);
+	void			prefetchMipmapLevel(const LLVector3d& pos_SW, const LLVector3d& pos_NE, S32 level);
 
 	static void		cleanupTextures();
 
@@ -190,6 +192,10 @@ public:
 	static BOOL		sHandledLastClick;
 	S32				mSelectIDStart;
 
+	// Where the view was at the last draw, to prefetch tiles in the direction it's moving
+	LLVector3d		mLastPrefetchCenter;
+	F32				mLastPrefetchScale;
+
 	// Keep the list of regions that are displayed on screen. Avoids iterating through the whole region map after draw().
 	typedef std::vector<U64> handle_list_t;
 	handle_list_t mVisibleRegions; // set every frame
@@ -34,6 +34,9 @@
 
 #include "llworldmipmap.h"
 
+#include "llbufferstream.h"
+#include "llframetimer.h"
+#include "llhttpclient.h"
 #include "llviewercontrol.h"
 #include "llviewertexturelist.h"
 #include "math.h"	// log()
@@ -41,16 +44,93 @@
 #include "llworldmap.h"
 #include "hippogridmanager.h"
 
+#include <algorithm>
+
 // Turn this on to output tile stats in the standard output
 #define DEBUG_TILES_STAT 0
 
+// Tile downloads in flight at once
+const S32 MAX_TILE_DOWNLOADS = 8;
+// Prefetches accepted between two draws, the view asks again for what it still wants
+const S32 MAX_TILE_PREFETCHES = 64;
+// Seconds before a tile whose download failed for any reason but a 404 is asked for again
+const F64 TILE_RETRY_DELAY = 30.0;
+
+std::set<LLWorldMipmap*> LLWorldMipmap::sInstances;
+
+// Writes a tile downloaded from S3 into the disk cache
+class LLWorldMapTileResponder : public LLHTTPClient::Responder
+{
+public:
+	LLWorldMapTileResponder(LLWorldMipmap* mipmap, U32 grid_x, U32 grid_y, S32 level, const std::string& filename)
+	:	mMipmap(mipmap),
+		mGridX(grid_x),
+		mGridY(grid_y),
+		mLevel(level),
+		mFilename(filename)
+	{
+	}
+
+	/*virtual*/ void completedRaw(U32 status, const std::string& reason,
+								  const LLChannelDescriptors& channels,
+								  const LLIOPipe::buffer_ptr_t& buffer)
+	{
+		S32 size = 0;
+		S32 replaced_size = 0;
+		if (status >= 200 && status < 300)
+		{
+			size = buffer->countAfter(channels.in(), NULL);
+		}
+		if (size > 0)
+		{
+			// A stale copy is being refreshed, its bytes come off the disk cache total
+			llstat stat_data;
+			if (LLFile::stat(mFilename, &stat_data) == 0)
+			{
+				replaced_size = (S32)stat_data.st_size;
+			}
+
+			std::vector<U8> data(size);
+			buffer->readAfter(channels.in(), NULL, &data[0], size);
+
+			// Written aside and renamed, so that a partly written tile is never loaded
+			std::string temp_filename = mFilename + ".tmp";
+			LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+			bool written = fp && (fwrite(&data[0], 1, size, fp) == (size_t)size);
+			if (fp)
+			{
+				written = (fclose(fp) == 0) && written;
+			}
+			LLFile::remove(mFilename);
+			if (!written || LLFile::rename(temp_filename, mFilename) != 0)
+			{
+				LLFile::remove(temp_filename);
+				size = 0;
+			}
+		}
+		LLWorldMipmap::tileDownloaded(mMipmap, mGridX, mGridY, mLevel, status, size, replaced_size);
+	}
+
+private:
+	LLWorldMipmap* mMipmap;
+	U32 mGridX;
+	U32 mGridY;
+	S32 mLevel;
+	std::string mFilename;
+};
+
 LLWorldMipmap::LLWorldMipmap() :
-	mCurrentLevel(0)
+	mDownloads(0),
+	mDiskCacheSize(-1),
+	mCurrentLevel(0),
+	mFrame(0)
 {
+	sInstances.insert(this);
 }
 
 LLWorldMipmap::~LLWorldMipmap()
 {
+	sInstances.erase(this);
 	reset();
 }
 
@@ -60,7 +140,11 @@ void LLWorldMipmap::reset()
 	for (int level = 0; level < MAP_LEVELS; level++)
 	{
 		mWorldObjectsMipMap[level].clear();
+		mMissingTiles[level].clear();
+		mFailedTiles[level].clear();
 	}
+	mRequests.clear();
+	mPrefetches.clear();
 }
 
 // This method should be called before each use of the mipmap (typically, before each draw), so that to let
@@ -69,6 +153,11 @@ void LLWorldMipmap::reset()
 // The result of this strategy is that if a tile is not used during 2 consecutive loops, its boost level drops to 0.
 void LLWorldMipmap::equalizeBoostLevels()
 {
+	// Download what the last draw asked for and release what it hasn't needed for a while
+	startDownloads();
+	trimTiles();
+	mFrame++;
+
 #if DEBUG_TILES_STAT
 	S32 nb_missing = 0;
 	S32 nb_tiles = 0;
@@ -81,7 +170,7 @@ void LLWorldMipmap::equalizeBoostLevels()
 		// For each tile
 		for (sublevel_tiles_t::iterator iter = level_mipmap.begin(); iter != level_mipmap.end(); iter++)
 		{
-			LLPointer<LLViewerFetchedTexture> img = iter->second;
+			LLPointer<LLViewerFetchedTexture> img = iter->second.mImage;
 			S32 current_boost_level = img->getBoostLevel();
 			if (current_boost_level == LLViewerTexture::BOOST_MAP_VISIBLE)
 			{
@@ -109,7 +198,8 @@ void LLWorldMipmap::equalizeBoostLevels()
 		}
 	}
 #if DEBUG_TILES_STAT
-	LL_INFOS("World Map") << "LLWorldMipmap tile stats : total requested = " << nb_tiles << ", visible = " << nb_visible << ", missing = " << nb_missing << LL_ENDL;
+	LL_INFOS("World Map") << "LLWorldMipmap tile stats : total requested = " << nb_tiles << ", visible = " << nb_visible << ", missing = " << nb_missing
+						  << ", downloading = " << mDownloads << ", disk cache = " << mDiskCacheSize << LL_ENDL;
 #endif // DEBUG_TILES_STAT
 }
 
@@ -123,10 +213,13 @@ void LLWorldMipmap::dropBoostLevels()
 		// For each tile
 		for (sublevel_tiles_t::iterator iter = level_mipmap.begin(); iter != level_mipmap.end(); iter++)
 		{
-			LLPointer<LLViewerFetchedTexture> img = iter->second;
+			LLPointer<LLViewerFetchedTexture> img = iter->second.mImage;
 			img->setBoostLevel(LLViewerTexture::BOOST_NONE);
 		}
 	}
+	// Nothing asked for while hidden is wanted anymore
+	mRequests.clear();
+	mPrefetches.clear();
 }
 
 LLPointer<LLViewerFetchedTexture> LLWorldMipmap::getObjectsTile(U32 grid_x, U32 grid_y, S32 level, bool load)
@@ -156,12 +249,24 @@ LLPointer<LLViewerFetchedTexture> LLWorldMipmap::getObjectsTile(U32 grid_x, U32
 		if (load)
 		{
 			// Load it 
-//			LLPointer<LLViewerFetchedTexture> img = loadObjectsTile(grid_x, grid_y, level);
 			LLPointer<LLViewerFetchedTexture> img;
 
 			//hack for opensims.
 			if(gHippoGridManager->getConnectedGrid()->getPlatform() == HippoGridInfo::PLATFORM_SECONDLIFE)
-			  img = loadObjectsTile(grid_x, grid_y, level);
+			{
+				if (isTileUnavailable(level, handle) || mDownloadingTiles[level-1].count(handle))
+				{
+					return NULL;
+				}
+				if (!isTileCached(getTileFilename(grid_x, grid_y, level)))
+				{
+					// Download it first, it gets loaded once it's on disk
+					TileRequest request = { grid_x, grid_y, level };
+					mRequests.push_back(request);
+					return NULL;
+				}
+				img = loadObjectsTile(grid_x, grid_y, level);
+			}
 			else
 			{
 			  LLSimInfo* info = LLWorldMap::getInstance()->simInfoFromHandle(handle);
@@ -169,15 +274,17 @@ LLPointer<LLViewerFetchedTexture> LLWorldMipmap::getObjectsTile(U32 grid_x, U32
 			  {
 				img = LLViewerTextureManager::getFetchedTexture(info->getMapImageID(), MIPMAP_TRUE, LLViewerTexture::BOOST_MAP, LLViewerTexture::LOD_TEXTURE);
 				img->setBoostLevel(LLViewerTexture::BOOST_MAP);
+				// Not compressed: the same texture can be in use outside of the map
 			  }
 			  else
 			   return NULL;
 			}
 
 			// Insert the image in the map
-			level_mipmap.insert(sublevel_tiles_t::value_type( handle, img ));
-			// Find the element again in the map (it's there now...)
-			found = level_mipmap.find(handle);
+			MipmapTile tile;
+			tile.mImage = img;
+			tile.mLastUsed = mFrame;
+			found = level_mipmap.insert(sublevel_tiles_t::value_type( handle, tile )).first;
 		}
 		else
 		{
@@ -187,7 +294,7 @@ LLPointer<LLViewerFetchedTexture> LLWorldMipmap::getObjectsTile(U32 grid_x, U32
 	}
 
 	// Get the image pointer and check if this asset is missing
-	LLPointer<LLViewerFetchedTexture> img = found->second;
+	LLPointer<LLViewerFetchedTexture> img = found->second.mImage;
 	if (img->isMissingAsset())
 	{
 		// Return NULL if asset missing
@@ -199,15 +306,49 @@ LLPointer<LLViewerFetchedTexture> LLWorldMipmap::getObjectsTile(U32 grid_x, U32
 		if (load)
 		{
 			img->setBoostLevel(LLViewerTexture::BOOST_MAP_VISIBLE);
+			found->second.mLastUsed = mFrame;
 		}
 		return img;
 	}
 }
 
+bool LLWorldMipmap::isObjectsTilePending(U32 grid_x, U32 grid_y, S32 level)
+{
+	if (gHippoGridManager->getConnectedGrid()->getPlatform() != HippoGridInfo::PLATFORM_SECONDLIFE)
+	{
+		return false;
+	}
+	// Neither loaded (possibly as a missing asset) nor known to be missing on the server
+	U64 handle = convertGridToHandle(grid_x, grid_y);
+	return (mWorldObjectsMipMap[level-1].find(handle) == mWorldObjectsMipMap[level-1].end())
+		&& !mMissingTiles[level-1].count(handle);
+}
+
+void LLWorldMipmap::prefetchObjectsTile(U32 grid_x, U32 grid_y, S32 level)
+{
+	if (level < 1 || level > MAP_LEVELS || (S32)mPrefetches.size() >= MAX_TILE_PREFETCHES)
+	{
+		return;
+	}
+	if (gHippoGridManager->getConnectedGrid()->getPlatform() != HippoGridInfo::PLATFORM_SECONDLIFE)
+	{
+		// Those come through the texture fetcher
+		return;
+	}
+	U64 handle = convertGridToHandle(grid_x, grid_y);
+	if (mWorldObjectsMipMap[level-1].count(handle) || mDownloadingTiles[level-1].count(handle) || isTileUnavailable(level, handle))
+	{
+		return;
+	}
+	// Whether it's on disk already is checked when it's about to be downloaded
+	TileRequest request = { grid_x, grid_y, level };
+	mPrefetches.push_back(request);
+}
+
 LLPointer<LLViewerFetchedTexture> LLWorldMipmap::loadObjectsTile(U32 grid_x, U32 grid_y, S32 level)
 {
-	// Get the grid coordinates
-	std::string imageurl = gSavedSettings.getString("MapServerURL") + llformat("map-%d-%d-%d-objects.jpg", level, grid_x, grid_y);
+	// Get the cached tile
+	std::string imageurl = "file://" + getTileFilename(grid_x, grid_y, level);
 
 	// DO NOT COMMIT!! DEBUG ONLY!!!
 	// Use a local jpeg for every tile to test map speed without S3 access
@@ -217,6 +358,8 @@ LLPointer<LLViewerFetchedTexture> LLWorldMipmap::loadObjectsTile(U32 grid_x, U32
 
 	LLPointer<LLViewerFetchedTexture> img = LLViewerTextureManager::getFetchedTextureFromUrl(imageurl,TRUE, LLViewerTexture::BOOST_MAP, LLViewerTexture::LOD_TEXTURE);
 	img->setBoostLevel(LLViewerTexture::BOOST_MAP);
+	// Tiles are opaque pictures, they lose little to compression and there can be a lot of them
+	img->setAllowCompression(gSavedSettings.getBOOL("WorldMapCompressTiles"));
 
 	// Return the smart pointer
 	return img;
@@ -238,15 +381,27 @@ void LLWorldMipmap::cleanMissedTilesFromLevel(S32 level)
 		return;
 	}
 
+	// Downloads that failed get another chance too
+	mMissingTiles[level-1].clear();
+	mFailedTiles[level-1].clear();
+
 	// Iterate through the subresolution level and suppress the tiles that are marked as missing
 	// Note: erasing in a map while iterating through it is bug prone. Using a postfix increment is mandatory here.
+	bool cached = (gHippoGridManager->getConnectedGrid()->getPlatform() == HippoGridInfo::PLATFORM_SECONDLIFE);
 	sublevel_tiles_t& level_mipmap = mWorldObjectsMipMap[level-1];
 	sublevel_tiles_t::iterator it = level_mipmap.begin();
 	while (it != level_mipmap.end())
 	{
-		LLPointer<LLViewerFetchedTexture> img = it->second;
+		LLPointer<LLViewerFetchedTexture> img = it->second.mImage;
 		if (img->isMissingAsset())
 		{
+			if (cached)
+			{
+				// The cached file didn't load, download it again
+				U32 pos_x, pos_y;
+				from_region_handle(it->first, &pos_x, &pos_y);
+				LLFile::remove(getTileFilename(pos_x / REGION_WIDTH_UNITS, pos_y / REGION_WIDTH_UNITS, level));
+			}
 			level_mipmap.erase(it++);
 		}
 		else
@@ -257,6 +412,183 @@ void LLWorldMipmap::cleanMissedTilesFromLevel(S32 level)
 	return;
 }
 
+std::string LLWorldMipmap::getTileFilename(U32 grid_x, U32 grid_y, S32 level)
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "maptiles", llformat("map-%d-%d-%d-objects.jpg", level, grid_x, grid_y));
+}
+
+// A tile is used from the disk cache until it's WorldMapTileCacheMaxAge hours old, as the map server
+// renders them again every so often.
+bool LLWorldMipmap::isTileCached(const std::string& filename)
+{
+	llstat stat_data;
+	if (LLFile::stat(filename, &stat_data) != 0)
+	{
+		return false;
+	}
+	F64 age = difftime(time(NULL), stat_data.st_mtime);
+	return age < gSavedSettings.getF32("WorldMapTileCacheMaxAge") * 3600.0;
+}
+
+void LLWorldMipmap::startDownloads()
+{
+	if (mDiskCacheSize < 0)
+	{
+		// First use: make sure the cache is there and within its size
+		LLFile::mkdir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "maptiles"));
+		trimDiskCache();
+	}
+
+	std::string server_url = gSavedSettings.getString("MapServerURL");
+	for (S32 pass = 0; pass < 2 && mDownloads < MAX_TILE_DOWNLOADS; pass++)
+	{
+		// Shown tiles first, then the prefetches
+		std::vector<TileRequest>& requests = (pass == 0) ? mRequests : mPrefetches;
+		for (std::vector<TileRequest>::iterator it = requests.begin(); it != requests.end() && mDownloads < MAX_TILE_DOWNLOADS; ++it)
+		{
+			U64 handle = convertGridToHandle(it->mGridX, it->mGridY);
+			S32 index = it->mLevel - 1;
+			if (mDownloadingTiles[index].count(handle) || isTileUnavailable(it->mLevel, handle))
+			{
+				continue;
+			}
+			std::string filename = getTileFilename(it->mGridX, it->mGridY, it->mLevel);
+			if (pass > 0 && isTileCached(filename))
+			{
+				continue;
+			}
+			std::string imageurl = server_url + llformat("map-%d-%d-%d-objects.jpg", it->mLevel, it->mGridX, it->mGridY);
+			LLHTTPClient::get(imageurl, new LLWorldMapTileResponder(this, it->mGridX, it->mGridY, it->mLevel, filename));
+			mDownloadingTiles[index].insert(handle);
+			mDownloads++;
+		}
+	}
+	// Whatever didn't get a slot is asked for again by the next draw if it's still wanted
+	mRequests.clear();
+	mPrefetches.clear();
+}
+
+//static
+void LLWorldMipmap::tileDownloaded(LLWorldMipmap* mipmap, U32 grid_x, U32 grid_y, S32 level, U32 status, S32 size, S32 replaced_size)
+{
+	if (!sInstances.count(mipmap))
+	{
+		return;
+	}
+	U64 handle = mipmap->convertGridToHandle(grid_x, grid_y);
+	mipmap->mDownloadingTiles[level-1].erase(handle);
+	mipmap->mDownloads--;
+	// The older copy is gone even when writing the new one failed
+	mipmap->mDiskCacheSize += size - replaced_size;
+	if (size > 0)
+	{
+		// Gets loaded from disk the next time it's drawn
+		if (mipmap->mDiskCacheSize > (S64)gSavedSettings.getU32("WorldMapTileCacheSize") * 1024 * 1024)
+		{
+			mipmap->trimDiskCache();
+		}
+	}
+	else if (status == 404)
+	{
+		// Typically the region is empty and S3 has no tile for it
+		mipmap->mMissingTiles[level-1].insert(handle);
+	}
+	else
+	{
+		// Server trouble or a full disk, which may not last
+		mipmap->mFailedTiles[level-1][handle] = LLFrameTimer::getElapsedSeconds() + TILE_RETRY_DELAY;
+	}
+}
+
+bool LLWorldMipmap::isTileUnavailable(S32 level, U64 handle)
+{
+	if (mMissingTiles[level-1].count(handle))
+	{
+		return true;
+	}
+	std::map<U64, F64>::iterator failed = mFailedTiles[level-1].find(handle);
+	if (failed == mFailedTiles[level-1].end())
+	{
+		return false;
+	}
+	if (failed->second > LLFrameTimer::getElapsedSeconds())
+	{
+		return true;
+	}
+	mFailedTiles[level-1].erase(failed);
+	return false;
+}
+
+void LLWorldMipmap::trimTiles()
+{
+	U32 max_tiles = gSavedSettings.getU32("WorldMapMaxTiles");
+	U32 tile_count = 0;
+	for (S32 level = 0; level < MAP_LEVELS; level++)
+	{
+		tile_count += mWorldObjectsMipMap[level].size();
+	}
+	if (tile_count <= max_tiles)
+	{
+		return;
+	}
+
+	// Least recently drawn first, sparing the ones the last draw used
+	std::vector<std::pair<U32, std::pair<S32, U64> > > tiles;
+	for (S32 level = 0; level < MAP_LEVELS; level++)
+	{
+		sublevel_tiles_t& level_mipmap = mWorldObjectsMipMap[level];
+		for (sublevel_tiles_t::iterator iter = level_mipmap.begin(); iter != level_mipmap.end(); ++iter)
+		{
+			if (iter->second.mLastUsed + 1 < mFrame)
+			{
+				tiles.push_back(std::make_pair(iter->second.mLastUsed, std::make_pair(level, iter->first)));
+			}
+		}
+	}
+	std::sort(tiles.begin(), tiles.end());
+	for (U32 i = 0; i < tiles.size() && tile_count > max_tiles; i++, tile_count--)
+	{
+		mWorldObjectsMipMap[tiles[i].second.first].erase(tiles[i].second.second);
+	}
+}
+
+void LLWorldMipmap::trimDiskCache()
+{
+	std::string dirname = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "maptiles");
+	std::string delimiter = gDirUtilp->getDirDelimiter();
+
+	// Oldest first
+	std::vector<std::pair<time_t, std::pair<std::string, S64> > > files;
+	S64 total = 0;
+	std::string name;
+	while (gDirUtilp->getNextFileInDir(dirname + delimiter, "*.jpg", name, false))
+	{
+		std::string filename = dirname + delimiter + name;
+		llstat stat_data;
+		if (LLFile::stat(filename, &stat_data) == 0)
+		{
+			files.push_back(std::make_pair(stat_data.st_mtime, std::make_pair(filename, (S64)stat_data.st_size)));
+			total += (S64)stat_data.st_size;
+		}
+	}
+	std::sort(files.begin(), files.end());
+
+	// Leave some room so this doesn't run again for every new tile
+	S64 budget = (S64)gSavedSettings.getU32("WorldMapTileCacheSize") * 1024 * 1024;
+	if (total > budget)
+	{
+		S64 target = budget / 4 * 3;
+		for (U32 i = 0; i < files.size() && total > target; i++)
+		{
+			if (LLFile::remove(files[i].second.first) == 0)
+			{
+				total -= files[i].second.second;
+			}
+		}
+	}
+	mDiskCacheSize = total;
+}
+
 // static methods
 // Compute the level in the world mipmap (between 1 and MAP_LEVELS, as in the URL) given the scale (size of a sim in screen pixels)
 S32 LLWorldMipmap::scaleToLevel(F32 scale)
@@ -34,6 +34,8 @@
 #define LL_LLWORLDMIPMAP_H
 
 #include <map>
+#include <set>
+#include <vector>
 
 #include "llpointer.h"			// LLPointer
 #include "indra_constants.h"	// REGION_WIDTH_UNITS
@@ -56,6 +58,10 @@ class LLViewerFetchedTexture;
 // Implementation notes:
 // - On the S3 servers, the tiles are rendered in 2 flavors: Objects and Terrain.
 // - For the moment, LLWorldMipmap implements access only to the Objects tiles.
+// - Tiles are downloaded into a disk cache of their own (WorldMapTileCacheSize) rather than through
+//   the texture fetcher, and loaded as textures from there. Tiles around the view in the direction
+//   it's moving can be downloaded ahead with prefetchObjectsTile().
+// - Only WorldMapMaxTiles tiles are held at once, the ones drawn the longest time ago are released first.
 class LLWorldMipmap
 {
 public:
@@ -74,6 +80,13 @@ public:
 	void	dropBoostLevels();
 	// Get the tile smart pointer, does the loading if necessary
 	LLPointer<LLViewerFetchedTexture> getObjectsTile(U32 grid_x, U32 grid_y, S32 level, bool load = true);
+	// True if getObjectsTile() returns NULL because the tile is still being downloaded rather than missing
+	bool	isObjectsTilePending(U32 grid_x, U32 grid_y, S32 level);
+	// Download the tile into the disk cache, if it's not there already, without loading it
+	void	prefetchObjectsTile(U32 grid_x, U32 grid_y, S32 level);
+	// Called when a tile download is done, size is 0 if it failed and replaced_size is the size of
+	// the older cached copy it overwrote, if any
+	static void tileDownloaded(LLWorldMipmap* mipmap, U32 grid_x, U32 grid_y, S32 level, U32 status, S32 size, S32 replaced_size);
 
 	// Helper functions: those are here as they depend solely on the topology of the mipmap though they don't access it
 	// Convert sim scale (given in sim width in display pixels) into a mipmap level
@@ -84,18 +97,57 @@ public:
 private:
 	// Get a handle (key) from grid coordinates
 	U64		convertGridToHandle(U32 grid_x, U32 grid_y) { return to_region_handle(grid_x * REGION_WIDTH_UNITS, grid_y * REGION_WIDTH_UNITS); }
-	// Load the relevant tile from S3
+	// Load the relevant tile from the disk cache
 	LLPointer<LLViewerFetchedTexture> loadObjectsTile(U32 grid_x, U32 grid_y, S32 level);
 	// Clear a level from its "missing" tiles
 	void cleanMissedTilesFromLevel(S32 level);
+	// True if the server doesn't have the tile, or its download failed too recently to try again
+	bool	isTileUnavailable(S32 level, U64 handle);
+
+	// Disk cache of the tiles downloaded from S3
+	std::string getTileFilename(U32 grid_x, U32 grid_y, S32 level);
+	bool	isTileCached(const std::string& filename);
+	// Start downloading the tiles asked for since the last call, shown ones first
+	void	startDownloads();
+	// Release the least recently drawn tiles above WorldMapMaxTiles
+	void	trimTiles();
+	// Delete the oldest files above WorldMapTileCacheSize
+	void	trimDiskCache();
+
+	struct MipmapTile
+	{
+		LLPointer<LLViewerFetchedTexture> mImage;
+		U32 mLastUsed;		// mFrame when it was last drawn
+	};
 
 	// The mipmap is organized by resolution level (MAP_LEVELS of them). Each resolution level is an std::map
 	// using a region_handle as a key and storing a smart pointer to the image as a value.
-	typedef std::map<U64, LLPointer<LLViewerFetchedTexture> > sublevel_tiles_t;
+	typedef std::map<U64, MipmapTile> sublevel_tiles_t;
 	sublevel_tiles_t mWorldObjectsMipMap[MAP_LEVELS];
 //	sublevel_tiles_t mWorldTerrainMipMap[MAP_LEVELS];
 
+	struct TileRequest
+	{
+		U32 mGridX;
+		U32 mGridY;
+		S32 mLevel;
+	};
+	std::vector<TileRequest> mRequests;		// Shown tiles not in the disk cache yet
+	std::vector<TileRequest> mPrefetches;	// Tiles that may be shown soon
+
+	// Per level, the tiles being downloaded, the ones the map server doesn't have (404) and the ones
+	// whose download failed otherwise, with the time they can be asked for again
+	std::set<U64> mDownloadingTiles[MAP_LEVELS];
+	std::set<U64> mMissingTiles[MAP_LEVELS];
+	std::map<U64, F64> mFailedTiles[MAP_LEVELS];
+	S32 mDownloads;			// Number of tile downloads in flight
+	S64 mDiskCacheSize;		// Bytes used by the disk cache, -1 until it's been looked at
+
 	S32 mCurrentLevel;		// The level last accessed by a getObjectsTile()
+	U32 mFrame;				// Number of equalizeBoostLevels() calls, i.e. draws
+
+	// Live instances, so that a download completing after its mipmap is gone is dropped
+	static std::set<LLWorldMipmap*> sInstances;
 };
 
 #endif // LL_LLWORLDMIPMAP_H
@@ -32,6 +32,9 @@
 
 #include "llviewerprecompiledheaders.h"
 
+#include "llmath.h"
+#include "llsimdmath.h"
+
 #include "noise.h"
 
 #include "llrand.h"
@@ -88,3 +91,92 @@ F32 noise2(F32 *vec)
 	return lerp_m(sy, a, b);
 }
 
+
+void noise2_4(const F32 *vx, const F32 *vy, F32 *out)
+{
+	if (gNoiseStart) {
+		gNoiseStart = 0;
+		init();
+	}
+
+	// Same lattice setup as fast_setup(), four samples at a time.
+	const __m128 nf = _mm_set1_ps(4096.f);	// NF32, #undef'd by noise.h
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 three = _mm_set1_ps(3.f);
+	const __m128 two = _mm_set1_ps(2.f);
+
+	__m128 tx = _mm_add_ps(_mm_loadu_ps(vx), nf);
+	__m128 ty = _mm_add_ps(_mm_loadu_ps(vy), nf);
+	__m128i ix = _mm_cvttps_epi32(tx);
+	__m128i iy = _mm_cvttps_epi32(ty);
+
+	__m128 rx0 = _mm_sub_ps(tx, _mm_cvtepi32_ps(ix));
+	__m128 ry0 = _mm_sub_ps(ty, _mm_cvtepi32_ps(iy));
+	__m128 rx1 = _mm_sub_ps(rx0, one);
+	__m128 ry1 = _mm_sub_ps(ry0, one);
+
+	LL_ALIGN_16(S32 bx[4]);
+	LL_ALIGN_16(S32 by[4]);
+	_mm_store_si128((__m128i*)bx, ix);
+	_mm_store_si128((__m128i*)by, iy);
+
+	// The permutation lookups are data dependent, so gather the four
+	// gradient pairs per sample with scalar loads.
+	LL_ALIGN_16(F32 g00x[4]); LL_ALIGN_16(F32 g00y[4]);
+	LL_ALIGN_16(F32 g10x[4]); LL_ALIGN_16(F32 g10y[4]);
+	LL_ALIGN_16(F32 g01x[4]); LL_ALIGN_16(F32 g01y[4]);
+	LL_ALIGN_16(F32 g11x[4]); LL_ALIGN_16(F32 g11y[4]);
+	for (S32 k = 0; k < 4; k++)
+	{
+		U8 bx0 = (U8)bx[k];
+		U8 bx1 = bx0 + 1;
+		U8 by0 = (U8)by[k];
+		U8 by1 = by0 + 1;
+
+		S32 i = p[bx0];
+		S32 j = p[bx1];
+
+		const F32* q = g2[p[i + by0]];
+		g00x[k] = q[0]; g00y[k] = q[1];
+		q = g2[p[j + by0]];
+		g10x[k] = q[0]; g10y[k] = q[1];
+		q = g2[p[i + by1]];
+		g01x[k] = q[0]; g01y[k] = q[1];
+		q = g2[p[j + by1]];
+		g11x[k] = q[0]; g11y[k] = q[1];
+	}
+
+	// s_curve(t) = t * t * (3 - 2t)
+	__m128 sx = _mm_mul_ps(_mm_mul_ps(rx0, rx0), _mm_sub_ps(three, _mm_mul_ps(two, rx0)));
+	__m128 sy = _mm_mul_ps(_mm_mul_ps(ry0, ry0), _mm_sub_ps(three, _mm_mul_ps(two, ry0)));
+
+	__m128 u = _mm_add_ps(_mm_mul_ps(rx0, _mm_load_ps(g00x)), _mm_mul_ps(ry0, _mm_load_ps(g00y)));
+	__m128 v = _mm_add_ps(_mm_mul_ps(rx1, _mm_load_ps(g10x)), _mm_mul_ps(ry0, _mm_load_ps(g10y)));
+	__m128 a = _mm_add_ps(u, _mm_mul_ps(sx, _mm_sub_ps(v, u)));
+
+	u = _mm_add_ps(_mm_mul_ps(rx0, _mm_load_ps(g01x)), _mm_mul_ps(ry1, _mm_load_ps(g01y)));
+	v = _mm_add_ps(_mm_mul_ps(rx1, _mm_load_ps(g11x)), _mm_mul_ps(ry1, _mm_load_ps(g11y)));
+	__m128 b = _mm_add_ps(u, _mm_mul_ps(sx, _mm_sub_ps(v, u)));
+
+	_mm_storeu_ps(out, _mm_add_ps(a, _mm_mul_ps(sy, _mm_sub_ps(b, a))));
+}
+
+void turbulence2_4(const F32 *vx, const F32 *vy, F32 freq, F32 *out)
+{
+	__m128 t = _mm_setzero_ps();
+	__m128 x = _mm_loadu_ps(vx);
+	__m128 y = _mm_loadu_ps(vy);
+
+	LL_ALIGN_16(F32 fx[4]);
+	LL_ALIGN_16(F32 fy[4]);
+	LL_ALIGN_16(F32 n[4]);
+	for ( ; freq >= 1.f ; freq *= 0.5f)
+	{
+		__m128 f = _mm_set1_ps(freq);
+		_mm_store_ps(fx, _mm_mul_ps(f, x));
+		_mm_store_ps(fy, _mm_mul_ps(f, y));
+		noise2_4(fx, fy, n);
+		t = _mm_add_ps(t, _mm_div_ps(_mm_load_ps(n), f));
+	}
+	_mm_storeu_ps(out, t);
+}
@@ -41,6 +41,11 @@ F32 clouds3(float *v, float freq);
 F32 noise2(float *vec);
 F32 noise3(float *vec);
 
+// Four-wide SSE2 versions of noise2() and turbulence2(). vx and vy each hold
+// four sample coordinates; results are written to out[0..3].
+void noise2_4(const F32 *vx, const F32 *vy, F32 *out);
+void turbulence2_4(const F32 *vx, const F32 *vy, F32 freq, F32 *out);
+
 inline F32 bias(F32 a, F32 b)
 {
 	return (F32)pow(a, (F32)(log(b) / log(0.5f)));